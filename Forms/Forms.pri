@@ -24,6 +24,7 @@ FORMS += \
     $$PWD/RgtSrvDialog.ui \
     $$PWD/SeeNSaveTab.ui \
     $$PWD/ShankMapping.ui \
+    $$PWD/ShankOvWindow.ui \
     $$PWD/ShankWindow.ui \
     $$PWD/TextBrowser.ui \
     $$PWD/TrigImmedPanel.ui \
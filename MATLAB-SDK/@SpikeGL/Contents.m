@@ -80,8 +80,8 @@
 %                Returns a vector containing the indices of
 %                channels being saved.
 %
-%    [daqData,headCt] = FetchIm( myObj, streamID, start_scan, scan_ct, channel_subset, downsample_ratio ),
-%                       FetchNi( myObj, start_scan, scan_ct, channel_subset, downsample_ratio )
+%    [daqData,headCt] = FetchIm( myObj, streamID, start_scan, scan_ct, channel_subset, downsample_ratio, ref_type, ref_radius ),
+%                       FetchNi( myObj, start_scan, scan_ct, channel_subset, downsample_ratio, ref_type, ref_radius )
 %
 %                Get MxN matrix of stream data.
 %                M = scan_ct = max samples to fetch.
@@ -93,6 +93,11 @@
 %
 %                downsample_ratio is an integer (default = 1).
 %
+%                ref_type selects spatial referencing of the neural
+%                channels, done before subsetting (default = 0):
+%                {0=none, 1=local average, 2=CAR (mean), 3=CMR (median)}.
+%                ref_radius is the local average radius (default = 1).
+%
 %                Also returns headCt = index of first timepoint in matrix.
 %
 %    [daqData,headCt] = FetchLatestIm( myObj, streamID, scan_ct, channel_subset, downsample_ratio ),
@@ -133,6 +138,14 @@
 %                Returns index of first scan in latest file,
 %                or zero if not available.
 %
+%    lat = GetTrigLatency( myobj )
+%
+%                Returns 3x4 matrix of trigger latencies for the current
+%                run. Rows are stages {edge found, files open, first
+%                write}; columns are {count, p50, p99, max}, times in
+%                milliseconds from the edge sample's arrival. Only TTL
+%                and spike triggers record latencies.
+%
 %    time = GetTime( myobj )
 %
 %                Returns (double) number of seconds since SpikeGLX application
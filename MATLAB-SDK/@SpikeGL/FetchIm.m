@@ -1,4 +1,4 @@
-% [daqData,headCt] = FetchIm( myObj, streamID, start_scan, scan_ct, channel_subset, downsample_ratio )
+% [daqData,headCt] = FetchIm( myObj, streamID, start_scan, scan_ct, channel_subset, downsample_ratio, ref_type, ref_radius )
 %
 %     Get MxN matrix of stream data.
 %     M = scan_ct = max samples to fetch.
@@ -10,6 +10,11 @@
 %
 %     downsample_ratio is an integer (default = 1).
 %
+%     ref_type selects spatial referencing of the neural
+%     channels, done before subsetting (default = 0):
+%     {0=none, 1=local average, 2=CAR (mean), 3=CMR (median)}.
+%     ref_radius is the local average radius (default = 1).
+%
 %     Also returns headCt = index of first timepoint in matrix.
 %
 function [mat,headCt] = FetchIm( s, streamID, start_scan, scan_ct, varargin )
@@ -46,9 +51,20 @@ function [mat,headCt] = FetchIm( s, streamID, start_scan, scan_ct, varargin )
         end
     end
 
+    reftype = 0;
+    refrad  = 1;
+
+    if( nargin >= 7 )
+        reftype = varargin{3};
+    end
+
+    if( nargin >= 8 )
+        refrad = varargin{4};
+    end
+
     ok = CalinsNetMex( 'sendString', s.handle, ...
-            sprintf( 'FETCHIM %d %ld %d %s %d\n', ...
-            streamID, start_scan, scan_ct, subset, dwnsmp ) );
+            sprintf( 'FETCHIM %d %ld %d %s %d %d %d\n', ...
+            streamID, start_scan, scan_ct, subset, dwnsmp, reftype, refrad ) );
 
     line = CalinsNetMex( 'readLine', s.handle );
 
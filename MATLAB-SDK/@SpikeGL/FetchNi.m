@@ -1,4 +1,4 @@
-% [daqData,headCt] = FetchNi( myObj, start_scan, scan_ct, channel_subset, downsample_ratio )
+% [daqData,headCt] = FetchNi( myObj, start_scan, scan_ct, channel_subset, downsample_ratio, ref_type, ref_radius )
 %
 %     Get MxN matrix of stream data.
 %     M = scan_ct = max samples to fetch.
@@ -10,6 +10,11 @@
 %
 %     downsample_ratio is an integer (default = 1).
 %
+%     ref_type selects spatial referencing of the neural
+%     channels, done before subsetting (default = 0):
+%     {0=none, 1=local average, 2=CAR (mean), 3=CMR (median)}.
+%     ref_radius is the local average radius (default = 1).
+%
 %     Also returns headCt = index of first timepoint in matrix.
 %
 function [mat,headCt] = FetchNi( s, start_scan, scan_ct, varargin )
@@ -42,9 +47,20 @@ function [mat,headCt] = FetchNi( s, start_scan, scan_ct, varargin )
         end
     end
 
+    reftype = 0;
+    refrad  = 1;
+
+    if( nargin >= 6 )
+        reftype = varargin{3};
+    end
+
+    if( nargin >= 7 )
+        refrad = varargin{4};
+    end
+
     ok = CalinsNetMex( 'sendString', s.handle, ...
-            sprintf( 'FETCHNI %ld %d %s %d\n', ...
-            start_scan, scan_ct, subset, dwnsmp ) );
+            sprintf( 'FETCHNI %ld %d %s %d %d %d\n', ...
+            start_scan, scan_ct, subset, dwnsmp, reftype, refrad ) );
 
     line = CalinsNetMex( 'readLine', s.handle );
 
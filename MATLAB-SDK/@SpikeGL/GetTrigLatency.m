@@ -0,0 +1,11 @@
+% lat = GetTrigLatency( myobj )
+%
+%     Returns 3x4 matrix of trigger latencies for the current
+%     run. Rows are stages {edge found, files open, first write};
+%     columns are {count, p50, p99, max}, times in milliseconds
+%     from the edge sample's arrival.
+%
+function [ret] = GetTrigLatency( s )
+
+    ret = reshape( str2num( DoQueryCmd( s, 'GETTRIGLATENCY' ) ), 4, 3 )';
+end
@@ -97,6 +97,8 @@ win32 {
 #   "DEFINES += OPENGL54"
 # Note: This 32-bit MinGW app uses MEM > 2GB:
 #   "QMAKE_LFLAGS += -Wl,--large-address-aware"
+# Note: SIMD filter/scan kernels need SSE2 (default on x64/MSVC):
+#   "QMAKE_CXXFLAGS += -msse2"
 
     contains(DEFINES, HAVE_IMEC) {
         QMAKE_LIBDIR    += $${_PRO_FILE_PWD_}/IMEC
@@ -120,6 +122,7 @@ win32 {
 #    DEFINES         += OPENGL54
     DEFINES         += _CRT_SECURE_NO_WARNINGS WIN32
     QMAKE_LFLAGS    += -Wl,--large-address-aware
+    win32-g++:QMAKE_CXXFLAGS += -msse2
 }
 
 unix {
@@ -79,9 +79,6 @@ void AOCtl::User::saveSettings( bool remote ) const
 /* Derived -------------------------------------------------------- */
 /* ---------------------------------------------------------------- */
 
-#define MAX10BIT    512
-#define MAX16BIT    32768
-
 
 // Derive the data actually needed within the audio device callback
 // functions. This must be called any time AO parameters change.
@@ -146,17 +143,24 @@ void AOCtl::Derived::usr2drv( AOCtl *aoC )
 
     if( E.loCutStr != "OFF" ) {
 
+        std::vector<SOSCoeffs>  S, L;
+
         if( E.loCutStr != "0" ) {
 
             loCut = E.loCutStr.toDouble();
-            hipass.setBiquad( bq_type_highpass, loCut / srate );
+            SOSDesign::highpass( S, sos_butterworth, 2, loCut / srate );
         }
 
         if( E.hiCutStr != "INF" ) {
 
             hiCut = E.hiCutStr.toDouble();
-            lopass.setBiquad( bq_type_lowpass, hiCut / srate );
+            SOSDesign::lowpass( L, sos_butterworth, 2, hiCut / srate );
+            S.insert( S.end(), L.begin(), L.end() );
         }
+
+        // Low cuts of .1 to 10 Hz put Fc near DC: use doubles.
+
+        flt.setSections( S, loCut > 0 && loCut / srate < 1e-3 );
     }
 
 // ------
@@ -2,7 +2,7 @@
 #define AOCTL_H
 
 #include "AODevBase.h"
-#include "Biquad.h"
+#include "BiquadMC.h"
 
 #include <QWidget>
 #include <QMutex>
@@ -47,19 +47,18 @@ private:
     };
 
     struct Derived {
-        Biquad  hipass,
-                lopass;
-        double  srate,
-                loCut,
-                hiCut,
-                lVol,
-                rVol;
-        int     streamID,   // {-1=nidq,0,1,2,...}
-                lChan,
-                rChan,
-                nNeural,
-                maxBits,
-                maxLatency;
+        BiquadMC    flt;    // hipass + lopass, one pass
+        double      srate,
+                    loCut,
+                    hiCut,
+                    lVol,
+                    rVol;
+        int         streamID,   // {-1=nidq,0,1,2,...}
+                    lChan,
+                    rChan,
+                    nNeural,
+                    maxBits,
+                    maxLatency;
 
         void usr2drv( AOCtl *aoC );
 
@@ -455,28 +455,21 @@ void AODevRtAudio::devStop()
 /* ---------------------------------------------------------------- */
 
 // nChan is either {1,2}.
-// iChan is either {0,1}.
+// Filter is applied to channel range [c0,cLim), so both
+// stereo channels are done in one pass, each with its own
+// filter state.
 //
 void AODevRtAudio::filter(
     qint16  *data,
     int     ntpts,
     int     nChan,
-    int     ichan )
+    int     c0,
+    int     cLim )
 {
     AOCtl::Derived  &drv = aoC->drv;
 
-    if( drv.loCut > -1 || drv.hiCut > -1 ) {
-
-        if( drv.loCut > -1 ) {
-            drv.hipass.apply1BlockwiseMem1(
-                data, drv.maxBits, ntpts, nChan, ichan );
-        }
-
-        if( drv.hiCut > -1 ) {
-            drv.lopass.apply1BlockwiseMem1(
-                data, drv.maxBits, ntpts, nChan, ichan );
-        }
-    }
+    if( drv.loCut > -1 || drv.hiCut > -1 )
+        drv.flt.applyBlockwiseMem( data, drv.maxBits, ntpts, nChan, c0, cLim );
 }
 
 
@@ -564,7 +557,7 @@ fetched:
 // Filter channels
 
     if( drv.lChan < drv.nNeural )
-        ME->filter( dst, nBufferFrames, 1, 0 );
+        ME->filter( dst, nBufferFrames, 1, 0, 1 );
 
 // Apply volume
 
@@ -637,11 +630,11 @@ fetched:
 
 // Filter channels
 
-    if( drv.lChan < drv.nNeural )
-        ME->filter( dst, nBufferFrames, 2, 0 );
+    int c0      = (drv.lChan < drv.nNeural ? 0 : 1),
+        cLim    = (drv.rChan < drv.nNeural ? 2 : 1);
 
-    if( drv.rChan < drv.nNeural )
-        ME->filter( dst, nBufferFrames, 2, 1 );
+    if( cLim > c0 )
+        ME->filter( dst, nBufferFrames, 2, c0, cLim );
 
 // Apply volume
 
@@ -41,7 +41,8 @@ private:
         qint16  *data,
         int     ntpts,
         int     nChan,
-        int     ichan );
+        int     c0,
+        int     cLim );
 
     void latency();
 
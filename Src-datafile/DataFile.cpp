@@ -393,6 +393,8 @@ bool DataFile::openForWrite( const DAQ::Params &p, const QString &binName )
 //    trgSpikeRefractS=0.5
 //    trgSpikeStream=nidq
 //    trgSpikeAIChan=4
+//    trgSpikeChans=
+//    trgSpikeNOfM=1
 //    trgSpikeInarow=5
 //    trgSpikeNS=10
 //    trgSpikeIsNInf=false
@@ -480,6 +482,8 @@ bool DataFile::openForWrite( const DAQ::Params &p, const QString &binName )
         kvp["trgSpikeRefractS"] = p.trgSpike.refractSecs;
         kvp["trgSpikeStream"]   = p.trgSpike.stream;
         kvp["trgSpikeAIChan"]   = p.trgSpike.aiChan;
+        kvp["trgSpikeChans"]    = p.trgSpike.chanStr;
+        kvp["trgSpikeNOfM"]     = p.trgSpike.nOfM;
         kvp["trgSpikeInarow"]   = p.trgSpike.inarow;
         kvp["trgSpikeNS"]       = p.trgSpike.nS;
         kvp["trgSpikeThresh"]   = p.trgSpike.T;
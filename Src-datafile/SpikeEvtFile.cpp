@@ -0,0 +1,409 @@
+
+#include "SpikeEvtFile.h"
+#include "Util.h"
+#include "DAQ.h"
+#include "DataFile.h"
+#include "Subset.h"
+
+#include <algorithm>
+
+
+// Fraction of one core (real time) per probe. Snippet mode has
+// no budget: the snippets are the only AP record.
+#define SPKEVT_BUDGET   0.25
+#define SPKEVT_NOBUDGET 1e9
+
+#define SPKEVT_RECSZ    12
+
+// Snippet geometry.
+#define SNP_NCHAN       8
+#define SNP_PRE_SECS    0.0005
+#define SNP_POST_SECS   0.0010
+#define SNP_NONE        0xFFFF
+
+
+static inline uchar *put16( uchar *B, quint16 v )
+{
+    B[0] = uchar(v);
+    B[1] = uchar(v >> 8);
+    return B + 2;
+}
+
+
+static inline uchar *put64( uchar *B, quint64 v )
+{
+    for( int k = 0; k < 8; ++k )
+        B[k] = uchar(v >> (8*k));
+
+    return B + 8;
+}
+
+/* ---------------------------------------------------------------- */
+/* SpikeEvtStats -------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+void SpikeEvtStats::add(
+    const SpikeDetect::Stats    &before,
+    const SpikeDetect::Stats    &after )
+{
+    QMutexLocker    ml( &mtx );
+
+    S.nSamp += after.nSamp - before.nSamp;
+    S.nSkip += after.nSkip - before.nSkip;
+    S.nEvt  += after.nEvt  - before.nEvt;
+    S.busyT += after.busyT - before.busyT;
+}
+
+
+// " Spk=events (Msmp/s scanned, skip%)", or empty.
+//
+QString SpikeEvtStats::statusStr() const
+{
+    QMutexLocker    ml( &mtx );
+
+    if( !S.nSamp && !S.nSkip )
+        return QString::null;
+
+    return QString(" Spk=%1 (%2 MS/s, %3% skip)")
+            .arg( S.nEvt )
+            .arg( S.busyT > 0 ? 1e-6 * S.nSamp / S.busyT : 0, 0, 'f', 0 )
+            .arg( 100.0 * S.nSkip / (S.nSamp + S.nSkip), 0, 'f', 1 );
+}
+
+/* ---------------------------------------------------------------- */
+/* SpikeEvtFile --------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Detect on the saved AP channels of probe (ip).
+//
+bool SpikeEvtFile::openForWrite(
+    const DAQ::Params   &p,
+    int                 ip,
+    const QString       &apBinName )
+{
+    const CimCfg::AttrEach  &E = p.im.each[ip];
+
+    QBitArray       apBits;
+    QVector<uint>   vAP, vc;
+    QVector<short>  vT;
+    int             nAP = E.imCumTypCnt[CimCfg::imSumAP];
+
+    E.apSaveBits( apBits );
+    Subset::bits2Vec( vAP, apBits );
+
+    foreach( uint ic, vAP ) {
+
+        if( int(ic) < nAP ) {
+            vc.push_back( ic );
+            vT.push_back(
+                qBound( -512, p.im.vToInt10( p.sns.spkEvtT, ip, ic ), 511 ) );
+        }
+    }
+
+    det.init(
+        E.sns.shankMap, vc, vT,
+        E.imCumTypCnt[CimCfg::imSumAll], nAP,
+        p.im.all.srate,
+        p.sns.spkSnipOnly ? SPKEVT_NOBUDGET : SPKEVT_BUDGET );
+
+    QString name = apBinName;
+
+    if( name.endsWith( ".bin" ) )
+        name.chop( 4 );
+
+    f.setFileName( name + ".spk" );
+
+    if( !f.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        Error()
+            << "Error opening file: ["
+            << f.fileName()
+            << "].";
+        return false;
+    }
+
+    if( !p.sns.spkSnipOnly )
+        return true;
+
+// -------
+// Snippet
+// -------
+
+    mapNeighbors( E.sns.shankMap, vc, nAP );
+
+    nPre    = int(SNP_PRE_SECS * p.im.all.srate);
+    nSamp   = nPre + int(SNP_POST_SECS * p.im.all.srate);
+    nKeep   = nSamp + nPre + det.maxWidth();
+    histCt  = 0;
+
+    hist.clear();
+    pend.clear();
+
+    fSnp.setFileName( name + ".snp" );
+
+    if( !fSnp.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        Error()
+            << "Error opening file: ["
+            << fSnp.fileName()
+            << "].";
+        return false;
+    }
+
+    return true;
+}
+
+
+// Record snippet geometry in AP meta data.
+//
+void SpikeEvtFile::setMeta( DataFile *df ) const
+{
+    if( !snipOnly() )
+        return;
+
+    df->setParam( "snpNChan", SNP_NCHAN );
+    df->setParam( "snpNPre", nPre );
+    df->setParam( "snpNSamp", nSamp );
+}
+
+
+bool SpikeEvtFile::write( const vec_i16 &data, quint64 headCt )
+{
+    if( !f.isOpen() || data.empty() )
+        return true;
+
+    SpikeDetect::Stats  S0      = det.stats();
+    int                 nC      = det.nChans(),
+                        ntpts   = (int)data.size() / nC;
+    bool                done;
+
+    evt.clear();
+    done = det.detect( evt, &data[0], ntpts, headCt );
+
+    if( stats )
+        stats->add( S0, det.stats() );
+
+    if( !snipOnly() ) {
+
+        int ne = (int)evt.size();
+
+        if( !ne )
+            return true;
+
+        buf.resize( ne * SPKEVT_RECSZ );
+
+        uchar   *B = (uchar*)buf.data();
+
+        for( int ie = 0; ie < ne; ++ie, B += SPKEVT_RECSZ )
+            packEvt( B, evt[ie] );
+
+        return writeRecs( f, buf );
+    }
+
+// -------
+// Snippet
+// -------
+
+// Skipped for budget, or a gap in counts:
+// pending windows can't be completed.
+
+    quint64 nLost = det.stats().nSkip - S0.nSkip;
+
+    if( nLost ) {
+        Error()
+            << "Snippet file lost "
+            << nLost
+            << " AP channel-samples at count "
+            << headCt
+            << ": [" << fSnp.fileName() << "].";
+    }
+
+    if( !done || histCt + hist.size() / nC != headCt ) {
+
+        hist.clear();
+        pend.clear();
+        histCt = headCt;
+
+        if( !done )
+            return true;
+    }
+
+    const short *F = det.filtered();
+
+    hist.insert( hist.end(), F, F + ntpts * nC );
+    pend.insert( pend.end(), evt.begin(), evt.end() );
+
+    if( !writeSnips( headCt + ntpts ) )
+        return false;
+
+// Keep enough history for pre-peak samples of
+// the next block's earliest possible event.
+
+    int nRow = (int)hist.size() / nC;
+
+    if( nRow > nKeep ) {
+        hist.erase( hist.begin(), hist.begin() + (nRow - nKeep) * nC );
+        histCt += nRow - nKeep;
+    }
+
+    return true;
+}
+
+
+void SpikeEvtFile::close()
+{
+    if( fSnp.isOpen() )
+        fSnp.close();
+
+    if( f.isOpen() )
+        f.close();
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// For each detected chan: itself, then the (SNP_NCHAN-1) nearest
+// used and detected sites on its shank, by (col,row) distance.
+//
+void SpikeEvtFile::mapNeighbors(
+    const ShankMap      &SM,
+    const QVector<uint> &vc,
+    int                 nAP )
+{
+    QVector<QPair<int,uint> >   D;
+    int                         nE = SM.e.size();
+
+    nbr.assign( nAP * SNP_NCHAN, SNP_NONE );
+
+    foreach( uint ic, vc ) {
+
+        quint16 *N = &nbr[ic * SNP_NCHAN];
+
+        N[0] = ic;
+
+        if( int(ic) >= nE )
+            continue;
+
+        const ShankMapDesc  &C = SM.e[ic];
+
+        D.clear();
+
+        foreach( uint jc, vc ) {
+
+            if( jc == ic || int(jc) >= nE )
+                continue;
+
+            const ShankMapDesc  &J = SM.e[jc];
+
+            if( J.s != C.s || !J.u )
+                continue;
+
+            int dc = J.c - C.c,
+                dr = J.r - C.r;
+
+            D.push_back( QPair<int,uint>( dc*dc + dr*dr, jc ) );
+        }
+
+        int nN = qMin( SNP_NCHAN - 1, D.size() );
+
+        std::partial_sort( D.begin(), D.begin() + nN, D.end() );
+
+        for( int k = 0; k < nN; ++k )
+            N[1 + k] = D[k].second;
+    }
+}
+
+
+// Write, in arrival order, each pending event whose
+// window ends at or before (endCt).
+//
+bool SpikeEvtFile::writeSnips( quint64 endCt )
+{
+    int np      = (int)pend.size(),
+        szSnp   = SPKEVT_RECSZ + 2*SNP_NCHAN + 2*nSamp*SNP_NCHAN,
+        nr      = 0,
+        nk      = 0;
+
+    buf.resize( np * SPKEVT_RECSZ );
+    bufSnp.resize( np * szSnp );
+
+    uchar   *B = (uchar*)buf.data(),
+            *S = (uchar*)bufSnp.data();
+
+    for( int ie = 0; ie < np; ++ie ) {
+
+        const SpikeDetect::Event    &E = pend[ie];
+
+        if( E.ct + nSamp - nPre <= endCt ) {
+            packEvt( B + nr * SPKEVT_RECSZ, E );
+            packSnip( S + nr * szSnp, E );
+            ++nr;
+        }
+        else
+            pend[nk++] = E;
+    }
+
+    pend.resize( nk );
+
+    if( !nr )
+        return true;
+
+    buf.resize( nr * SPKEVT_RECSZ );
+    bufSnp.resize( nr * szSnp );
+
+    return writeRecs( fSnp, bufSnp ) && writeRecs( f, buf );
+}
+
+
+bool SpikeEvtFile::writeRecs( QFile &F, const QByteArray &B )
+{
+    if( F.write( B ) != B.size() ) {
+        Error()
+            << "Error writing file: ["
+            << F.fileName()
+            << "].";
+        return false;
+    }
+
+    return true;
+}
+
+
+void SpikeEvtFile::packEvt( uchar *B, const SpikeDetect::Event &E ) const
+{
+    B = put64( B, E.ct );
+    B = put16( B, E.chan );
+        put16( B, quint16(E.amp) );
+}
+
+
+// Window rows not in history (file start) are zero.
+//
+void SpikeEvtFile::packSnip( uchar *B, const SpikeDetect::Event &E ) const
+{
+    const quint16   *N  = &nbr[E.chan * SNP_NCHAN];
+    int             nC  = det.nChans();
+
+    packEvt( B, E );
+    B += SPKEVT_RECSZ;
+
+    for( int k = 0; k < SNP_NCHAN; ++k )
+        B = put16( B, N[k] );
+
+    qint64  row = qint64(E.ct) - nPre - qint64(histCt);
+
+    for( int it = 0; it < nSamp; ++it, ++row ) {
+
+        if( row < 0 ) {
+            memset( B, 0, 2*SNP_NCHAN );
+            B += 2*SNP_NCHAN;
+            continue;
+        }
+
+        const short *R = &hist[row * nC];
+
+        for( int k = 0; k < SNP_NCHAN; ++k )
+            B = put16( B, N[k] == SNP_NONE ? 0 : quint16(R[N[k]]) );
+    }
+}
+
+
@@ -0,0 +1,121 @@
+#ifndef SPIKEEVTFILE_H
+#define SPIKEEVTFILE_H
+
+#include "SGLTypes.h"
+#include "SpikeDetect.h"
+
+#include <QFile>
+#include <QMutex>
+
+namespace DAQ {
+struct Params;
+}
+
+class DataFile;
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Per-run detection totals, shared by all SpikeEvtFiles.
+//
+class SpikeEvtStats
+{
+private:
+    mutable QMutex      mtx;
+    SpikeDetect::Stats  S;
+
+public:
+    void reset()
+        {QMutexLocker ml( &mtx ); S = SpikeDetect::Stats();}
+
+    void add(
+        const SpikeDetect::Stats    &before,
+        const SpikeDetect::Stats    &after );
+
+    QString statusStr() const;
+};
+
+
+// Spike-event sidecar of an imec AP file: "xxx.ap.spk" beside
+// "xxx.ap.bin". Headerless, fixed 12-byte little-endian records,
+// in count order within each channel:
+//
+//   quint64 sample - stream count, same basis as firstSample
+//   quint16 chan   - acquired channel index
+//   qint16  amp    - filtered, referenced peak (int10 units)
+//
+// Detection (SpikeDetect) runs in write(), on the thread writing
+// the probe's AP data, before the block goes to the AP file; the
+// filter starts fresh with each file.
+//
+// Snippet mode (p.sns.spkSnipOnly): no AP samples are saved (the
+// AP meta file is still written), instead each event also gets a
+// fixed-size record in "xxx.ap.snp", in the same order as the .spk
+// records, so record k of either file indexes record k of the other:
+//
+//   quint64 sample
+//   quint16 chan
+//   qint16  amp
+//   quint16 nbr[snpNChan]              - acq chans, 0xFFFF = none
+//   qint16  wave[snpNSamp][snpNChan]   - filtered, referenced
+//
+// The window starts at (sample - snpNPre). Neighbors are the
+// nearest saved sites on the same shank by ShankMap (col,row),
+// center first. Events still awaiting post-peak samples when the
+// file closes are dropped from both files. Detection never skips
+// blocks for CPU budget here; should a block be skipped anyway,
+// its samples are logged as lost.
+//
+class SpikeEvtFile
+{
+private:
+    QFile                           f,
+                                    fSnp;
+    SpikeDetect                     det;
+    std::vector<SpikeDetect::Event> evt,
+                                    pend;
+    std::vector<short>              hist;   // filtered rows
+    std::vector<quint16>            nbr;    // [chan][snpNChan]
+    QByteArray                      buf,
+                                    bufSnp;
+    SpikeEvtStats                   *stats;
+    quint64                         histCt;
+    int                             nPre,
+                                    nSamp,
+                                    nKeep;
+
+public:
+    SpikeEvtFile( SpikeEvtStats *stats )
+    :   stats(stats), histCt(0), nPre(0), nSamp(0), nKeep(0)   {}
+    virtual ~SpikeEvtFile() {close();}
+
+    QString fileName() const    {return f.fileName();}
+    bool snipOnly() const       {return fSnp.isOpen();}
+
+    bool openForWrite(
+        const DAQ::Params   &p,
+        int                 ip,
+        const QString       &apBinName );
+
+    void setMeta( DataFile *df ) const;
+
+    bool write( const vec_i16 &data, quint64 headCt );
+
+    void close();
+
+private:
+    void mapNeighbors(
+        const ShankMap      &SM,
+        const QVector<uint> &vc,
+        int                 nAP );
+
+    bool writeSnips( quint64 endCt );
+    bool writeRecs( QFile &F, const QByteArray &B );
+    void packEvt( uchar *B, const SpikeDetect::Event &E ) const;
+    void packSnip( uchar *B, const SpikeDetect::Event &E ) const;
+};
+
+#endif  // SPIKEEVTFILE_H
+
+
@@ -6,7 +6,8 @@ HEADERS += \
     $$PWD/DataFileIMLF.h \
     $$PWD/DataFileNI.h \
     $$PWD/ExportCtl.h \
-    $$PWD/SampleBufQ.h
+    $$PWD/SampleBufQ.h \
+    $$PWD/SpikeEvtFile.h
 
 SOURCES += \
     $$PWD/DataFile.cpp \
@@ -15,6 +16,7 @@ SOURCES += \
     $$PWD/DataFileIMLF.cpp \
     $$PWD/DataFileNI.cpp \
     $$PWD/ExportCtl.cpp \
-    $$PWD/SampleBufQ.cpp
+    $$PWD/SampleBufQ.cpp \
+    $$PWD/SpikeEvtFile.cpp
 
 
@@ -94,6 +94,21 @@ void Biquad::setBiquad(
 }
 
 
+void Biquad::getCoeffs(
+    double  &a0,
+    double  &a1,
+    double  &a2,
+    double  &b1,
+    double  &b2 ) const
+{
+    a0 = this->a0;
+    a1 = this->a1;
+    a2 = this->a2;
+    b1 = this->b1;
+    b2 = this->b2;
+}
+
+
 void Biquad::applyBlockwiseMem(
     short   *data,
     int     maxInt,
@@ -82,6 +82,14 @@ public:
 
     void setType( int type );
     int  getType()  {return type;}
+    double getFc()  {return Fc;}
+    double getQ()   {return Q;}
+    void getCoeffs(
+        double  &a0,
+        double  &a1,
+        double  &a2,
+        double  &b1,
+        double  &b2 ) const;
     void setQ( double Q );
     void setFc( double Fc );
     void setPeakGain( double peakGainDB );
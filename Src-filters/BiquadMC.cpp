@@ -0,0 +1,357 @@
+
+#include "BiquadMC.h"
+
+#include <QtGlobal>
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BIQUADMC_SSE2
+#include <emmintrin.h>
+#endif
+
+
+/* ---------------------------------------------------------------- */
+/* Kernels -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// State layout: Z[(2*s + 0)*nC + c] = z1, Z[(2*s + 1)*nC + c] = z2,
+// for section s and channel offset c in [0,nC).
+//
+// NSEC is a compile-time constant so the section loops fully unroll
+// and each stage's state lives in registers for the whole block.
+
+#ifdef BIQUADMC_SSE2
+// Groups of 8 channels are done in SSE2 lanes. Returns the first
+// channel not processed.
+//
+template<int NSEC>
+static int sseGroups(
+    const SOSCoeffs *S,
+    float           *Z,
+    int             nC,
+    short           *data,
+    int             maxInt,
+    int             ntpts,
+    int             nchans,
+    int             c0,
+    int             cLim )
+{
+    __m128  A0[NSEC], A1[NSEC], A2[NSEC], B1[NSEC], B2[NSEC];
+    int     c = c0;
+
+    for( int is = 0; is < NSEC; ++is ) {
+        A0[is] = _mm_set1_ps( S[is].a0 );
+        A1[is] = _mm_set1_ps( S[is].a1 );
+        A2[is] = _mm_set1_ps( S[is].a2 );
+        B1[is] = _mm_set1_ps( S[is].b1 );
+        B2[is] = _mm_set1_ps( S[is].b2 );
+    }
+
+    const __m128i   HI  = _mm_set1_epi16( short(maxInt - 1) ),
+                    LO  = _mm_set1_epi16( short(-maxInt) );
+
+    for( ; c + 8 <= cLim; c += 8 ) {
+
+        __m128  z1L[NSEC], z1H[NSEC], z2L[NSEC], z2H[NSEC];
+        short   *d = &data[c];
+
+        for( int is = 0; is < NSEC; ++is ) {
+
+            float   *z1 = &Z[(2*is)*nC + c - c0],
+                    *z2 = z1 + nC;
+
+            z1L[is] = _mm_loadu_ps( z1 );
+            z1H[is] = _mm_loadu_ps( z1 + 4 );
+            z2L[is] = _mm_loadu_ps( z2 );
+            z2H[is] = _mm_loadu_ps( z2 + 4 );
+        }
+
+        for( int it = 0; it < ntpts; ++it, d += nchans ) {
+
+            __m128i s   = _mm_loadu_si128( (const __m128i*)d );
+            __m128  xL  = _mm_cvtepi32_ps(
+                            _mm_srai_epi32( _mm_unpacklo_epi16( s, s ), 16 ) ),
+                    xH  = _mm_cvtepi32_ps(
+                            _mm_srai_epi32( _mm_unpackhi_epi16( s, s ), 16 ) );
+
+            for( int is = 0; is < NSEC; ++is ) {
+
+                __m128  yL = _mm_add_ps( _mm_mul_ps( xL, A0[is] ), z1L[is] ),
+                        yH = _mm_add_ps( _mm_mul_ps( xH, A0[is] ), z1H[is] );
+
+                z1L[is] = _mm_sub_ps(
+                            _mm_add_ps( _mm_mul_ps( xL, A1[is] ), z2L[is] ),
+                            _mm_mul_ps( yL, B1[is] ) );
+                z1H[is] = _mm_sub_ps(
+                            _mm_add_ps( _mm_mul_ps( xH, A1[is] ), z2H[is] ),
+                            _mm_mul_ps( yH, B1[is] ) );
+                z2L[is] = _mm_sub_ps(
+                            _mm_mul_ps( xL, A2[is] ),
+                            _mm_mul_ps( yL, B2[is] ) );
+                z2H[is] = _mm_sub_ps(
+                            _mm_mul_ps( xH, A2[is] ),
+                            _mm_mul_ps( yH, B2[is] ) );
+
+                xL = yL;
+                xH = yH;
+            }
+
+            s = _mm_packs_epi32( _mm_cvttps_epi32( xL ),
+                                 _mm_cvttps_epi32( xH ) );
+            s = _mm_max_epi16( _mm_min_epi16( s, HI ), LO );
+
+            _mm_storeu_si128( (__m128i*)d, s );
+        }
+
+        for( int is = 0; is < NSEC; ++is ) {
+
+            float   *z1 = &Z[(2*is)*nC + c - c0],
+                    *z2 = z1 + nC;
+
+            _mm_storeu_ps( z1, z1L[is] );
+            _mm_storeu_ps( z1 + 4, z1H[is] );
+            _mm_storeu_ps( z2, z2L[is] );
+            _mm_storeu_ps( z2 + 4, z2H[is] );
+        }
+    }
+
+    return c;
+}
+#endif
+
+
+// Channels [cFirst,cLim) in precision T. Timepoint-major so each
+// row is touched once; the inner loop over contiguous channel
+// state is simple enough for the compiler to vectorize.
+//
+template<typename T, int NSEC>
+static void scalarChans(
+    const SOSCoeffs *S,
+    T               *Z,
+    int             nC,
+    short           *data,
+    int             maxInt,
+    int             ntpts,
+    int             nchans,
+    int             c0,
+    int             cFirst,
+    int             cLim )
+{
+    T   a0[NSEC], a1[NSEC], a2[NSEC], b1[NSEC], b2[NSEC];
+
+    for( int is = 0; is < NSEC; ++is ) {
+        a0[is] = S[is].a0;
+        a1[is] = S[is].a1;
+        a2[is] = S[is].a2;
+        b1[is] = S[is].b1;
+        b2[is] = S[is].b2;
+    }
+
+    for( int it = 0; it < ntpts; ++it, data += nchans ) {
+
+        for( int c = cFirst; c < cLim; ++c ) {
+
+            T   x = data[c];
+
+            for( int is = 0; is < NSEC; ++is ) {
+
+                T   &z1 = Z[(2*is)*nC + c - c0],
+                    &z2 = Z[(2*is + 1)*nC + c - c0],
+                    y   = x * a0[is] + z1;
+
+                z1 = x * a1[is] + z2 - b1[is] * y;
+                z2 = x * a2[is] - b2[is] * y;
+                x  = y;
+            }
+
+            data[c] = qBound( -maxInt, int(x), maxInt - 1 );
+        }
+    }
+}
+
+
+template<int NSEC>
+static void fusedPass(
+    const SOSCoeffs *S,
+    float           *fZ,
+    double          *dZ,
+    int             nC,
+    short           *data,
+    int             maxInt,
+    int             ntpts,
+    int             nchans,
+    int             c0,
+    int             cLim )
+{
+    if( dZ ) {
+        scalarChans<double,NSEC>(
+            S, dZ, nC, data, maxInt, ntpts, nchans, c0, c0, cLim );
+        return;
+    }
+
+    int c = c0;
+
+#ifdef BIQUADMC_SSE2
+    c = sseGroups<NSEC>( S, fZ, nC, data, maxInt, ntpts, nchans, c0, cLim );
+#endif
+
+    if( c < cLim ) {
+        scalarChans<float,NSEC>(
+            S, fZ, nC, data, maxInt, ntpts, nchans, c0, c, cLim );
+    }
+}
+
+/* ---------------------------------------------------------------- */
+/* BiquadMC ------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+BiquadMC::BiquadMC()
+    :   sos(1), memC(0), type(bq_type_lowpass), dblPrec(false)
+{
+}
+
+
+BiquadMC::BiquadMC(
+    int     type,
+    double  Fc,
+    double  Q,
+    bool    dblPrec )
+{
+    setBiquad( type, Fc, Q, dblPrec );
+}
+
+
+// Coefficients come from a scalar Biquad so the two
+// classes always implement identical designs.
+//
+void BiquadMC::setBiquad(
+    int     type,
+    double  Fc,
+    double  Q,
+    bool    dblPrec )
+{
+    Biquad      B( type, Fc, Q );
+    SOSCoeffs   S;
+
+    B.getCoeffs( S.a0, S.a1, S.a2, S.b1, S.b2 );
+
+    sos.assign( 1, S );
+
+    this->type      = type;
+    this->dblPrec   = dblPrec;
+
+    clearMem();
+}
+
+
+void BiquadMC::setSections(
+    const std::vector<SOSCoeffs>    &S,
+    bool                            dblPrec )
+{
+    sos = S;
+
+    if( sos.empty() )
+        sos.resize( 1 );
+
+    this->type      = -1;
+    this->dblPrec   = dblPrec;
+
+    clearMem();
+}
+
+
+void BiquadMC::clearMem()
+{
+    fz.clear();
+    dz.clear();
+    memC = 0;
+}
+
+
+void BiquadMC::getMem( Mem &M ) const
+{
+    M.fz    = fz;
+    M.dz    = dz;
+    M.memC  = memC;
+}
+
+
+// Caller must restore into the same design (sections and
+// precision) that produced (M).
+//
+void BiquadMC::setMem( const Mem &M )
+{
+    fz      = M.fz;
+    dz      = M.dz;
+    memC    = M.memC;
+}
+
+
+// Note: The filter is linear, so we run directly in integer units
+// rather than normalizing to [-1,1] as Biquad does. Truncation to
+// int matches Biquad's int() conversion.
+//
+void BiquadMC::applyBlockwiseMem(
+    short   *data,
+    int     maxInt,
+    int     ntpts,
+    int     nchans,
+    int     c0,
+    int     cLim )
+{
+    if( ntpts <= 0 || cLim <= c0 )
+        return;
+
+    int nC = cLim - c0;
+
+    sizeMem( nC );
+
+    int nS = sos.size();
+
+    for( int s0 = 0; s0 < nS; s0 += BIQUADMC_MAXFUSED ) {
+
+        const SOSCoeffs *S  = &sos[s0];
+        float           *fZ = (dblPrec ? 0 : &fz[2*s0*nC]);
+        double          *dZ = (dblPrec ? &dz[2*s0*nC] : 0);
+
+        switch( qMin( nS - s0, BIQUADMC_MAXFUSED ) ) {
+            case 1:
+                fusedPass<1>(
+                    S, fZ, dZ, nC, data, maxInt, ntpts, nchans, c0, cLim );
+                break;
+            case 2:
+                fusedPass<2>(
+                    S, fZ, dZ, nC, data, maxInt, ntpts, nchans, c0, cLim );
+                break;
+            case 3:
+                fusedPass<3>(
+                    S, fZ, dZ, nC, data, maxInt, ntpts, nchans, c0, cLim );
+                break;
+            default:
+                fusedPass<4>(
+                    S, fZ, dZ, nC, data, maxInt, ntpts, nchans, c0, cLim );
+                break;
+        }
+    }
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+void BiquadMC::sizeMem( int nC )
+{
+    if( nC == memC )
+        return;
+
+    int n = 2 * sos.size() * nC;
+
+    if( dblPrec )
+        dz.assign( n, 0 );
+    else
+        fz.assign( n, 0 );
+
+    memC = nC;
+}
+
+
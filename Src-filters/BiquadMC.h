@@ -0,0 +1,115 @@
+#ifndef BIQUADMC_H
+#define BIQUADMC_H
+
+#include "Biquad.h"
+#include "SOSDesign.h"
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Multichannel Biquad
+// -------------------
+// Same filter designs as Biquad, but organized for whole blocks of
+// interleaved int16 data (timepoint-major, nchans per timepoint).
+//
+// Biquad walks one channel at a time, striding (nchans) through the
+// block, and does each sample in double precision. For a 384-channel
+// probe that touches every cache line of the block once per channel.
+//
+// Here, channels are placed in SIMD lanes instead: eight adjacent
+// channels are loaded in one 16-byte read, widened to float, run
+// through the difference equations together, and saturated back to
+// int16 with a single pack and min/max. The per-channel state stays
+// in registers for the whole block, so each row of the block is
+// read and written exactly once per group of eight channels.
+//
+// Float state is adequate for the usual spike-band filters. Pass
+// dblPrec = true for cutoffs very close to DC (Fc < ~1e-3), where
+// the poles sit near the unit circle and float rounding shows.
+//
+// The same BIQUAD_TRANS_WIDE transient caveat applies.
+//
+// Cascades
+// --------
+// setSections() loads a cascade of second-order sections (see
+// SOSDesign) in place of the single setBiquad() stage. All sections
+// are applied in the same pass: each sample is converted once, run
+// through every stage while still in registers, and saturated once
+// at the end. Kernels are compiled separately for 1..4 sections so
+// the stage loop fully unrolls. Longer cascades run as successive
+// fused passes of up to four sections, with int16 rounding (and
+// saturation) between passes only.
+//
+#define BIQUADMC_MAXFUSED   4
+
+class BiquadMC
+{
+public:
+    // Snapshot of per-channel filter state, so a later block
+    // can resume exactly where an earlier one left off.
+    struct Mem {
+        std::vector<float>  fz;
+        std::vector<double> dz;
+        int                 memC;
+
+        Mem() : memC(0) {}
+    };
+
+private:
+    std::vector<SOSCoeffs>  sos;
+    std::vector<float>      fz;     // [sec][z1,z2][chan]
+    std::vector<double>     dz;
+    int                     memC,
+                            type;
+    bool                    dblPrec;
+
+public:
+    BiquadMC();
+    BiquadMC(
+        int     type,
+        double  Fc,
+        double  Q = 0,
+        bool    dblPrec = false );
+
+    void setBiquad(
+        int     type,
+        double  Fc,
+        double  Q = 0,
+        bool    dblPrec = false );
+
+    // Replace stages with cascade (S), applied in order.
+    // Type reported as -1.
+    void setSections(
+        const std::vector<SOSCoeffs>    &S,
+        bool                            dblPrec = false );
+
+    int  getType() const        {return type;}
+    int  getNSections() const   {return sos.size();}
+    bool isDblPrec() const      {return dblPrec;}
+
+    void clearMem();
+    void getMem( Mem &M ) const;
+    void setMem( const Mem &M );
+
+    // Apply filter in-place to (ntpts) worth of data, starting at
+    // address (data). (nchans) includes (neural + aux) channels,
+    // so is the array stride between timepoints. Filter will only
+    // be applied to channel range [c0,cLim). Class retains state
+    // data for each channel in the filtered range between calls.
+    // Output is clamped to [-maxInt, maxInt-1].
+    void applyBlockwiseMem(
+        short   *data,
+        int     maxInt,
+        int     ntpts,
+        int     nchans,
+        int     c0,
+        int     cLim );
+
+private:
+    void sizeMem( int nC );
+};
+
+#endif  // BIQUADMC_H
+
+
@@ -0,0 +1,190 @@
+
+#include "EdgeScan.h"
+
+#include <QtGlobal>
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EDGESCAN_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+
+/* ---------------------------------------------------------------- */
+/* Statics -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Index of lowest set bit; (m) nonzero.
+//
+static inline int ctz64( quint64 m )
+{
+#if defined(_MSC_VER)
+    unsigned long   i;
+#if defined(_M_X64)
+    _BitScanForward64( &i, m );
+    return i;
+#else
+    if( _BitScanForward( &i, (unsigned long)m ) )
+        return i;
+
+    _BitScanForward( &i, (unsigned long)(m >> 32) );
+    return 32 + i;
+#endif
+#else
+    return __builtin_ctzll( m );
+#endif
+}
+
+/* ---------------------------------------------------------------- */
+/* EdgeScan ------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+void EdgeScan::setAnalog( int T, bool rising, int inarow )
+{
+    this->T         = T;
+    this->bitMask   = 0;
+    this->inarow    = qMax( inarow, 1 );
+    this->isBit     = false;
+    this->rising    = rising;
+
+    reset();
+}
+
+
+void EdgeScan::setBit( int bit, bool rising, int inarow )
+{
+    this->T         = 0;
+    this->bitMask   = 1 << bit;
+    this->inarow    = qMax( inarow, 1 );
+    this->isBit     = true;
+    this->rising    = rising;
+
+    reset();
+}
+
+
+// Per 64-sample piece, with p the next sample to examine:
+//
+// - Unarmed: skip to just past the next miss.
+// - Armed, no run: skip to the next hit.
+// - In a run: extend it to the next miss (q). The run qualifies
+//   once its length reaches inarow; if q is past the piece, the
+//   length carries into the next piece.
+//
+bool EdgeScan::scan( int &edgeRow, const short *data, int ntpts, int nchans )
+{
+    for( int t0 = 0; t0 < ntpts; t0 += 64 ) {
+
+        int     n       = qMin( ntpts - t0, 64 ),
+                p       = 0;
+        quint64 valid   = (n == 64 ? ~0ULL : (1ULL << n) - 1),
+                hit     = hitMask( data + t0*nchans, n, nchans ),
+                miss    = ~hit & valid;
+
+        while( p < n ) {
+
+            quint64 from = valid & (~0ULL << p);
+
+            if( !armed ) {
+
+                if( !(miss & from) )
+                    break;
+
+                p       = ctz64( miss & from ) + 1;
+                armed   = true;
+                continue;
+            }
+
+            if( !run ) {
+
+                if( !(hit & from) )
+                    break;
+
+                p       = ctz64( hit & from );
+                from    = valid & (~0ULL << p);
+            }
+
+            int q = (miss & from ? ctz64( miss & from ) : n);
+
+            if( q - p >= inarow - run ) {
+                edgeRow = t0 + p - run;
+                reset();
+                return true;
+            }
+
+            if( q >= n ) {
+                run += q - p;
+                break;
+            }
+
+            run = 0;
+            p   = q + 1;
+        }
+    }
+
+    return false;
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Bit i set if sample i (of n <= 64) is a hit.
+//
+// Strided samples are first gathered to a contiguous row; the
+// compare or bit-test then classifies 16 samples per step.
+//
+quint64 EdgeScan::hitMask( const short *d, int n, int nchans ) const
+{
+    short   row[64];
+    quint64 lo  = 0;
+    int     i   = 0;
+
+    if( nchans != 1 ) {
+
+        for( int k = 0; k < n; ++k )
+            row[k] = d[k*nchans];
+
+        d = row;
+    }
+
+#ifdef EDGESCAN_SSE2
+    const __m128i   vT  = _mm_set1_epi16( T ),
+                    vB  = _mm_set1_epi16( bitMask ),
+                    v0  = _mm_setzero_si128();
+
+    for( ; i + 16 <= n; i += 16 ) {
+
+        __m128i a = _mm_loadu_si128( (const __m128i*)&d[i] ),
+                b = _mm_loadu_si128( (const __m128i*)&d[i + 8] );
+
+        if( isBit ) {
+            a = _mm_cmpeq_epi16( _mm_and_si128( a, vB ), v0 );
+            b = _mm_cmpeq_epi16( _mm_and_si128( b, vB ), v0 );
+        }
+        else {
+            a = _mm_cmplt_epi16( a, vT );
+            b = _mm_cmplt_epi16( b, vT );
+        }
+
+        lo |= quint64(uint(_mm_movemask_epi8( _mm_packs_epi16( a, b ) ))) << i;
+    }
+#endif
+
+    if( isBit ) {
+        for( ; i < n; ++i )
+            lo |= quint64(!(d[i] & bitMask)) << i;
+    }
+    else {
+        for( ; i < n; ++i )
+            lo |= quint64(d[i] < T) << i;
+    }
+
+    return (rising ? ~lo : lo);
+}
+
+
@@ -0,0 +1,68 @@
+#ifndef EDGESCAN_H
+#define EDGESCAN_H
+
+#include <qglobal.h>
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Edge detection on one channel of int16 data, read at a stride
+// (nchans) so interleaved blocks need no copying.
+//
+// A sample is a "hit" if it is in the target state:
+// - analog rising:  x >= T
+// - analog falling: x <  T
+// - bit rising:     bit set
+// - bit falling:    bit clear
+//
+// An edge is a run of (inarow) hits, counted from its first
+// sample, that follows a miss (the channel must first be seen
+// out of the target state: armed). These are the rules of the
+// AIQ and ColorTTLCtl edge finders.
+//
+// Samples are classified 64 at a time into a hit bitmask (SIMD
+// compare or bit-test), then runs are found with bit scans, so
+// quiet data cost a few ops per 64 samples.
+//
+// Arming and run length carry across scan() calls; a block can
+// be fed in pieces. After an edge is reported the scanner is
+// reset (unarmed).
+//
+class EdgeScan
+{
+private:
+    int     T,
+            bitMask,
+            inarow,
+            run;
+    bool    isBit,
+            rising,
+            armed;
+
+public:
+    EdgeScan()
+    :   T(0), bitMask(0), inarow(1), run(0),
+        isBit(false), rising(true), armed(false)    {}
+
+    void setAnalog( int T, bool rising, int inarow );
+    void setBit( int bit, bool rising, int inarow );
+
+    void reset( bool armed = false )
+        {run = 0; this->armed = armed;}
+
+    // Hits counted so far in an unfinished run.
+    int runLen() const  {return run;}
+
+    // Scan (ntpts) samples at (data), stepping (nchans). If found,
+    // return true and set (edgeRow), the run's first sample,
+    // relative to (data); negative if run began in an earlier call.
+    bool scan( int &edgeRow, const short *data, int ntpts, int nchans );
+
+private:
+    quint64 hitMask( const short *d, int n, int nchans ) const;
+};
+
+#endif  // EDGESCAN_H
+
+
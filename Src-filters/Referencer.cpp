@@ -0,0 +1,426 @@
+
+#include "Referencer.h"
+#include "ShankMap.h"
+
+#include <QMap>
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REFERENCER_SSE2
+#include <emmintrin.h>
+#endif
+
+
+/* ---------------------------------------------------------------- */
+/* Statics -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+#ifdef REFERENCER_SSE2
+// Branch-free round to nearest.
+//
+static inline short sat16( float v )
+{
+    return qBound( -32768, _mm_cvtss_si32( _mm_set_ss( v ) ), 32767 );
+}
+
+
+static inline __m128 lvl4( const float *L )
+{
+    return _mm_loadu_ps( L );
+}
+
+
+static inline __m128 lvl4( const int *L )
+{
+    return _mm_cvtepi32_ps( _mm_loadu_si128( (const __m128i*)L ) );
+}
+#else
+static inline short sat16( float v )
+{
+    int i = (v >= 0 ? int(v + 0.5f) : int(v - 0.5f));
+
+    return qBound( -32768, i, 32767 );
+}
+#endif
+
+
+// R[c] = d[c] - L[c], as float, c in [0,n).
+//
+template<typename T>
+static void centerRow( float *R, const short *d, const T *L, int n )
+{
+    int c = 0;
+
+#ifdef REFERENCER_SSE2
+    for( ; c + 8 <= n; c += 8 ) {
+
+        __m128i s   = _mm_loadu_si128( (const __m128i*)&d[c] );
+        __m128  xL  = _mm_cvtepi32_ps(
+                        _mm_srai_epi32( _mm_unpacklo_epi16( s, s ), 16 ) ),
+                xH  = _mm_cvtepi32_ps(
+                        _mm_srai_epi32( _mm_unpackhi_epi16( s, s ), 16 ) );
+
+        if( L ) {
+            xL = _mm_sub_ps( xL, lvl4( &L[c] ) );
+            xH = _mm_sub_ps( xH, lvl4( &L[c + 4] ) );
+        }
+
+        _mm_storeu_ps( &R[c], xL );
+        _mm_storeu_ps( &R[c + 4], xH );
+    }
+#endif
+
+    if( L ) {
+        for( ; c < n; ++c )
+            R[c] = d[c] - float(L[c]);
+    }
+    else {
+        for( ; c < n; ++c )
+            R[c] = d[c];
+    }
+}
+
+
+static float sumRow( const float *R, int n )
+{
+    float   sum = 0;
+    int     c   = 0;
+
+#ifdef REFERENCER_SSE2
+    __m128  S   = _mm_setzero_ps();
+
+    for( ; c + 4 <= n; c += 4 )
+        S = _mm_add_ps( S, _mm_loadu_ps( &R[c] ) );
+
+    float   s4[4];
+
+    _mm_storeu_ps( s4, S );
+    sum = (s4[0] + s4[1]) + (s4[2] + s4[3]);
+#endif
+
+    for( ; c < n; ++c )
+        sum += R[c];
+
+    return sum;
+}
+
+
+// d[c] = sat(d[c] - ref), c in [0,n).
+//
+static void subRow( short *d, float ref, int n )
+{
+    int c = 0;
+
+#ifdef REFERENCER_SSE2
+    const __m128    F = _mm_set1_ps( ref );
+
+    for( ; c + 8 <= n; c += 8 ) {
+
+        __m128i s   = _mm_loadu_si128( (const __m128i*)&d[c] );
+        __m128  xL  = _mm_cvtepi32_ps(
+                        _mm_srai_epi32( _mm_unpacklo_epi16( s, s ), 16 ) ),
+                xH  = _mm_cvtepi32_ps(
+                        _mm_srai_epi32( _mm_unpackhi_epi16( s, s ), 16 ) );
+
+        s = _mm_packs_epi32(
+                _mm_cvtps_epi32( _mm_sub_ps( xL, F ) ),
+                _mm_cvtps_epi32( _mm_sub_ps( xH, F ) ) );
+
+        _mm_storeu_si128( (__m128i*)&d[c], s );
+    }
+#endif
+
+    for( ; c < n; ++c )
+        d[c] = sat16( d[c] - ref );
+}
+
+/* ---------------------------------------------------------------- */
+/* Referencer ----------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+void Referencer::setNone()
+{
+    used.clear();
+    nbrLim.clear();
+    nbrIdx.clear();
+    nbrWt.clear();
+    type    = ref_none;
+    allUsed = false;
+}
+
+
+// For each used channel, list the used sites in a square of
+// half-width (radius) on the same shank, excluding itself.
+// Lists are sorted for cache friendliness.
+//
+void Referencer::setLocal(
+    const ShankMap  &SM,
+    int             c0,
+    int             cLim,
+    int             radius )
+{
+    setNone();
+
+    this->c0    = c0;
+    this->cLim  = cLim;
+
+    if( radius <= 0 )
+        return;
+
+    setUsed( SM );
+
+    QMap<ShankMapDesc,uint> ISM;
+    SM.inverseMap( ISM );
+
+    std::vector<int>    V;
+    int                 nU = used.size();
+
+    nbrLim.push_back( 0 );
+
+    for( int k = 0; k < nU; ++k ) {
+
+        const ShankMapDesc  &E = SM.e[used[k]];
+
+        int xL  = qMax( int(E.c)  - radius, 0 ),
+            xH  = qMin( uint(E.c) + radius + 1, SM.nc ),
+            yL  = qMax( int(E.r)  - radius, 0 ),
+            yH  = qMin( uint(E.r) + radius + 1, SM.nr );
+
+        V.clear();
+
+        for( int ix = xL; ix < xH; ++ix ) {
+
+            for( int iy = yL; iy < yH; ++iy ) {
+
+                QMap<ShankMapDesc,uint>::iterator   it;
+
+                it = ISM.find( ShankMapDesc( E.s, ix, iy, 1 ) );
+
+                if( it == ISM.end() )
+                    continue;
+
+                int i = it.value();
+
+                // Exclude self and out-of-range
+                // Make zero-based
+
+                if( i != used[k] && i >= c0 && i < cLim )
+                    V.push_back( i - c0 );
+            }
+        }
+
+        std::sort( V.begin(), V.end() );
+
+        nbrIdx.insert( nbrIdx.end(), V.begin(), V.end() );
+        nbrLim.push_back( nbrIdx.size() );
+        nbrWt.push_back( V.size() ? 1.0f / V.size() : 0.0f );
+    }
+
+    type = ref_local;
+}
+
+
+void Referencer::setGlobal(
+    const ShankMap  &SM,
+    int             c0,
+    int             cLim,
+    bool            median )
+{
+    setNone();
+
+    this->c0    = c0;
+    this->cLim  = cLim;
+
+    setUsed( SM );
+
+    type = (median ? ref_median : ref_mean);
+}
+
+
+void Referencer::setSel(
+    const ShankMap  &SM,
+    int             c0,
+    int             cLim,
+    int             sel,
+    int             radius )
+{
+    switch( sel ) {
+        case ref_local:     setLocal( SM, c0, cLim, radius ); break;
+        case ref_mean:      setGlobal( SM, c0, cLim, false ); break;
+        case ref_median:    setGlobal( SM, c0, cLim, true ); break;
+        default:            setNone(); break;
+    }
+}
+
+
+void Referencer::apply(
+    short       *data,
+    const float *lvl,
+    int         ntpts,
+    int         nchans,
+    int         tstep,
+    const char  *want )
+{
+    applyT( data, lvl, ntpts, nchans, tstep, want );
+}
+
+
+void Referencer::apply(
+    short       *data,
+    const int   *lvl,
+    int         ntpts,
+    int         nchans,
+    int         tstep,
+    const char  *want )
+{
+    applyT( data, lvl, ntpts, nchans, tstep, want );
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+void Referencer::setUsed( const ShankMap &SM )
+{
+    int lim = qMin( cLim, SM.e.size() );
+
+    for( int ic = c0; ic < lim; ++ic ) {
+
+        if( SM.e[ic].u )
+            used.push_back( ic );
+    }
+
+    allUsed = (int)used.size() == cLim - c0;
+}
+
+
+template<typename T>
+void Referencer::applyT(
+    short       *data,
+    const T     *lvl,
+    int         ntpts,
+    int         nchans,
+    int         tstep,
+    const char  *want )
+{
+    if( !isActive() || ntpts <= 0 )
+        return;
+
+    int     nU      = used.size(),
+            nC      = cLim - c0,
+            step    = qMax( tstep, 1 ),
+            dstep   = step * nchans;
+    bool    all     = true;
+
+    if( want ) {
+
+        outK.clear();
+
+        for( int k = 0; k < nU; ++k ) {
+
+            if( want[used[k]] )
+                outK.push_back( k );
+        }
+
+        if( outK.empty() )
+            return;
+
+        all = (int)outK.size() == nU;
+    }
+
+    row.resize( nC );
+
+    if( type == ref_median )
+        tmp.resize( used.size() );
+
+    data += c0;
+
+    if( lvl )
+        lvl += c0;
+
+    for( int it = 0; it < ntpts; it += step, data += dstep ) {
+
+        centerRow( &row[0], data, lvl, nC );
+
+        if( type == ref_local )
+            localRow( data, all );
+        else
+            globalRow( data, all );
+    }
+}
+
+
+void Referencer::localRow( short *d, bool all )
+{
+    if( nbrIdx.empty() )
+        return;
+
+    const float *R  = &row[0];
+    const int   *I  = &nbrIdx[0];
+    int         nK  = (all ? used.size() : outK.size());
+
+    for( int i = 0; i < nK; ++i ) {
+
+        int k       = (all ? i : outK[i]),
+            il      = nbrLim[k],
+            ilim    = nbrLim[k+1];
+
+        if( il == ilim )
+            continue;
+
+        float   sum = 0;
+
+        for( ; il < ilim; ++il )
+            sum += R[I[il]];
+
+        short   &v = d[used[k] - c0];
+
+        v = sat16( v - sum * nbrWt[k] );
+    }
+}
+
+
+void Referencer::globalRow( short *d, bool all )
+{
+    int     nU = used.size();
+    float   ref;
+
+    if( type == ref_median ) {
+
+        for( int k = 0; k < nU; ++k )
+            tmp[k] = row[used[k] - c0];
+
+        std::nth_element( tmp.begin(), tmp.begin() + nU/2, tmp.end() );
+        ref = tmp[nU/2];
+    }
+    else if( allUsed )
+        ref = sumRow( &row[0], nU ) / nU;
+    else {
+
+        float   sum = 0;
+
+        for( int k = 0; k < nU; ++k )
+            sum += row[used[k] - c0];
+
+        ref = sum / nU;
+    }
+
+    if( all && allUsed )
+        subRow( d, ref, nU );
+    else if( all ) {
+        for( int k = 0; k < nU; ++k ) {
+            short   &v = d[used[k] - c0];
+            v = sat16( v - ref );
+        }
+    }
+    else {
+        for( int i = 0, nK = outK.size(); i < nK; ++i ) {
+            short   &v = d[used[outK[i]] - c0];
+            v = sat16( v - ref );
+        }
+    }
+}
+
+
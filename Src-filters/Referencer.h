@@ -0,0 +1,124 @@
+#ifndef REFERENCER_H
+#define REFERENCER_H
+
+#include <vector>
+
+struct ShankMap;
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Spatial referencing of whole blocks of interleaved int16 data
+// (timepoint-major, nchans per timepoint), in-place.
+//
+// Types:
+// - ref_local:  Subtract mean of the sites within (radius) columns
+//               and rows of each site, on the same shank (excluding
+//               the site itself). This is the graphs' -<S> average.
+// - ref_mean:   Subtract mean of all used sites (CAR).
+// - ref_median: Subtract median of all used sites (CMR).
+//
+// Only sites marked used (ShankMapDesc.u) contribute, and only
+// used sites are referenced; others pass through unchanged.
+//
+// The neighbor lists are built once by setLocal() as a compact
+// sparse plan (CSR arrays). Per timepoint, the row is widened to
+// float with the caller's DC levels removed (SIMD), then each
+// reference value is gathered from that row. Because the row is a
+// copy, results are independent of update order.
+//
+// Caller's DC levels (lvl) are indexed like the data row, may be
+// null, and are NOT removed from the output; output = d - ref, so
+// existing display code that subtracts lvl[ic] still applies.
+//
+// Optional (want) flags, indexed like the data row, restrict which
+// channels are written; references still draw on all used sites.
+//
+class Referencer
+{
+public:
+    enum RefType {
+        ref_none    = 0,
+        ref_local   = 1,
+        ref_mean    = 2,
+        ref_median  = 3
+    };
+
+private:
+    std::vector<int>    used,       // channels referenced
+                        nbrLim,     // CSR: used[k] nbrs in
+                        nbrIdx,     // [nbrLim[k],nbrLim[k+1])
+                        outK;       // wanted k, if not all
+    std::vector<float>  nbrWt,      // 1/nNbrs per used[k]
+                        row,
+                        tmp;
+    int                 c0,
+                        cLim,
+                        type;
+    bool                allUsed;    // used == [c0,cLim)
+
+public:
+    Referencer() : c0(0), cLim(0), type(ref_none), allUsed(false) {}
+
+    void setNone();
+
+    // Referencing applies to channels [c0,cLim), which are
+    // indexed in (SM) as SM.e[ic].
+    void setLocal(
+        const ShankMap  &SM,
+        int             c0,
+        int             cLim,
+        int             radius );
+
+    void setGlobal(
+        const ShankMap  &SM,
+        int             c0,
+        int             cLim,
+        bool            median );
+
+    // Set from a UI/remote selector:
+    // {0=none, 1=local(radius), 2=global mean, 3=global median}.
+    void setSel(
+        const ShankMap  &SM,
+        int             c0,
+        int             cLim,
+        int             sel,
+        int             radius );
+
+    int  getType() const    {return type;}
+    bool isActive() const   {return type != ref_none && used.size();}
+
+    // Reference every (tstep)th timepoint of the block.
+    void apply(
+        short       *data,
+        const float *lvl,
+        int         ntpts,
+        int         nchans,
+        int         tstep = 1,
+        const char  *want = 0 );
+    void apply(
+        short       *data,
+        const int   *lvl,
+        int         ntpts,
+        int         nchans,
+        int         tstep = 1,
+        const char  *want = 0 );
+
+private:
+    void setUsed( const ShankMap &SM );
+    template<typename T>
+    void applyT(
+        short       *data,
+        const T     *lvl,
+        int         ntpts,
+        int         nchans,
+        int         tstep,
+        const char  *want );
+    void localRow( short *d, bool all );
+    void globalRow( short *d, bool all );
+};
+
+#endif  // REFERENCER_H
+
+
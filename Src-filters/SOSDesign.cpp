@@ -0,0 +1,291 @@
+
+#include "SOSDesign.h"
+
+#include <algorithm>
+#include <complex>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI    3.14159265358979323846
+#endif
+
+typedef std::complex<double>    cplx;
+
+
+/* ---------------------------------------------------------------- */
+/* Analog prototypes ---------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Each prototype pole pair (or real pole) reduces to a natural
+// frequency w0 (relative to the -3 dB cutoff) and quality Q.
+// A real pole is marked by Q = 0.
+//
+struct Proto {
+    double  w0, Q;
+
+    bool operator<( const Proto &rhs ) const
+        {return Q < rhs.Q;}
+};
+
+
+// Poles lie on the unit circle, left half-plane.
+//
+static void butterPoles( std::vector<Proto> &P, int N )
+{
+    for( int k = 0; k < N / 2; ++k ) {
+
+        double  th = M_PI * (2*k + N + 1) / (2.0 * N);
+        Proto   p;
+
+        p.w0    = 1.0;
+        p.Q     = -0.5 / cos( th );
+        P.push_back( p );
+    }
+
+    if( N & 1 ) {
+
+        Proto   p;
+
+        p.w0    = 1.0;
+        p.Q     = 0;
+        P.push_back( p );
+    }
+}
+
+
+// |H(jw)| for all-pole prototype with unity DC gain.
+//
+static double allPoleMag( const std::vector<cplx> &r, double w )
+{
+    double  g = 1.0;
+
+    for( int i = 0, n = r.size(); i < n; ++i )
+        g *= std::abs( r[i] ) / std::abs( cplx( 0, w ) - r[i] );
+
+    return g;
+}
+
+
+// Roots of the reverse Bessel polynomial:
+//
+//  theta_N(s) = sum_k (2N-k)! / (2^(N-k) k! (N-k)!) s^k
+//
+// by Durand-Kerner iteration, then scaled so that |H| is
+// -3 dB at w = 1.
+//
+static void besselPoles( std::vector<Proto> &P, int N )
+{
+// Monic coefficients c[0..N], c[N] = 1
+
+    std::vector<double> c( N + 1 );
+
+    for( int k = 0; k <= N; ++k ) {
+
+        // (2N-k)! / (2^(N-k) k! (N-k)!) built incrementally
+        // in double to avoid factorial overflow.
+
+        double  a = 1.0;
+
+        for( int i = N - k + 1; i <= 2*N - k; ++i )
+            a *= i;
+
+        for( int i = 2; i <= k; ++i )
+            a /= i;
+
+        a /= pow( 2.0, N - k );
+        c[k] = a;
+    }
+
+    for( int k = 0; k < N; ++k )
+        c[k] /= c[N];
+
+    c[N] = 1.0;
+
+// Durand-Kerner
+
+    std::vector<cplx>   r( N );
+    cplx                seed( 0.4, 0.9 );
+
+    r[0] = 1.0;
+
+    for( int i = 1; i < N; ++i )
+        r[i] = r[i-1] * seed;
+
+    for( int iter = 0; iter < 500; ++iter ) {
+
+        double  dmax = 0;
+
+        for( int i = 0; i < N; ++i ) {
+
+            cplx    num = 1.0,
+                    den = 1.0;
+
+            for( int k = N - 1; k >= 0; --k )
+                num = num * r[i] + c[k];
+
+            for( int j = 0; j < N; ++j ) {
+
+                if( j != i )
+                    den *= r[i] - r[j];
+            }
+
+            cplx    d = num / den;
+
+            r[i]    -= d;
+            dmax    = std::max( dmax, std::abs( d ) );
+        }
+
+        if( dmax < 1e-14 )
+            break;
+    }
+
+// Normalize -3 dB point to w = 1 (bisection; |H| is monotonic)
+
+    double  lo = 0, hi = 2.0 * N + 2;
+
+    for( int i = 0; i < 100; ++i ) {
+
+        double  mid = 0.5 * (lo + hi);
+
+        if( allPoleMag( r, mid ) > sqrt( 0.5 ) )
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    double  wc = 0.5 * (lo + hi);
+
+// One entry per upper-half-plane pole or real pole
+
+    for( int i = 0; i < N; ++i ) {
+
+        double  im = r[i].imag();
+        Proto   p;
+
+        if( im < -1e-9 )
+            continue;
+
+        p.w0 = std::abs( r[i] ) / wc;
+
+        if( im > 1e-9 )
+            p.Q = p.w0 / (-2.0 * r[i].real() / wc);
+        else
+            p.Q = 0;
+
+        P.push_back( p );
+    }
+}
+
+/* ---------------------------------------------------------------- */
+/* SOSDesign ------------------------------------------------------ */
+/* ---------------------------------------------------------------- */
+
+bool SOSDesign::lowpass(
+    std::vector<SOSCoeffs>  &sos,
+    int                     family,
+    int                     order,
+    double                  Fc )
+{
+    sos.clear();
+    return design( sos, family, order, Fc, false );
+}
+
+
+bool SOSDesign::highpass(
+    std::vector<SOSCoeffs>  &sos,
+    int                     family,
+    int                     order,
+    double                  Fc )
+{
+    sos.clear();
+    return design( sos, family, order, Fc, true );
+}
+
+
+bool SOSDesign::bandpass(
+    std::vector<SOSCoeffs>  &sos,
+    int                     family,
+    int                     order,
+    double                  FcLo,
+    double                  FcHi )
+{
+    sos.clear();
+
+    if( FcLo >= FcHi )
+        return false;
+
+    return design( sos, family, order, FcLo, true )
+        && design( sos, family, order, FcHi, false );
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Bilinear transform of each prototype section, prewarped so
+// cutoff lands at Fc. Lowpass sections scale K by w0; highpass
+// (s -> 1/s) sections divide by it, Q unchanged. Formulas are
+// Biquad's, with K replaced by the section's Kw.
+//
+// Appends to (sos). Returns false if arguments out of range.
+//
+bool SOSDesign::design(
+    std::vector<SOSCoeffs>  &sos,
+    int                     family,
+    int                     order,
+    double                  Fc,
+    bool                    isHP )
+{
+    if( order < 1 || order > SOS_MAX_ORDER || Fc <= 0 || Fc >= 0.5 )
+        return false;
+
+    std::vector<Proto>  P;
+
+    if( family == sos_bessel )
+        besselPoles( P, order );
+    else
+        butterPoles( P, order );
+
+    std::sort( P.begin(), P.end() );
+
+    double  K = tan( M_PI * Fc );
+
+    for( int i = 0, n = P.size(); i < n; ++i ) {
+
+        const Proto &p  = P[i];
+        double      Kw  = (isHP ? K / p.w0 : K * p.w0);
+        SOSCoeffs   S;
+
+        if( !p.Q ) {
+
+            double  norm = 1 / (1 + Kw);
+
+            S.a0 = (isHP ? norm : Kw * norm);
+            S.a1 = (isHP ? -S.a0 : S.a0);
+            S.b1 = (Kw - 1) * norm;
+        }
+        else {
+
+            double  norm = 1 / (1 + Kw / p.Q + Kw * Kw);
+
+            if( isHP ) {
+                S.a0 = norm;
+                S.a1 = -2 * S.a0;
+            }
+            else {
+                S.a0 = Kw * Kw * norm;
+                S.a1 = 2 * S.a0;
+            }
+
+            S.a2 = S.a0;
+            S.b1 = 2 * (Kw * Kw - 1) * norm;
+            S.b2 = (1 - Kw / p.Q + Kw * Kw) * norm;
+        }
+
+        sos.push_back( S );
+    }
+
+    return true;
+}
+
+
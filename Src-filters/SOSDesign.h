@@ -0,0 +1,83 @@
+#ifndef SOSDESIGN_H
+#define SOSDESIGN_H
+
+#include <vector>
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// One second-order section, using Biquad's notation:
+//
+//  y[n] = a0*x[n] + a1*x[n-1] + a2*x[n-2] - b1*y[n-1] - b2*y[n-2]
+//
+// A first-order section has a2 = b2 = 0.
+//
+struct SOSCoeffs {
+    double  a0, a1, a2, b1, b2;
+
+    SOSCoeffs()
+    :   a0(1.0), a1(0.0), a2(0.0), b1(0.0), b2(0.0)    {}
+    SOSCoeffs( double a0, double a1, double a2, double b1, double b2 )
+    :   a0(a0), a1(a1), a2(a2), b1(b1), b2(b2)          {}
+};
+
+enum SOSFamily {
+    sos_butterworth = 0,
+    sos_bessel
+};
+
+// Digital IIR designs (bilinear transform, prewarped at Fc) returned
+// as cascades of second-order sections, for use with BiquadMC.
+//
+// Fc is a normalized cutoff frequency, as for Biquad.
+//
+// Butterworth: Fc is the -3 dB point; order 2 reproduces Biquad's
+// lowpass/highpass with Q = sqrt(0.5) exactly.
+//
+// Bessel: analog prototype poles are found from the reverse Bessel
+// polynomial and scaled so that Fc is also the -3 dB point.
+//
+// Orders 1..SOS_MAX_ORDER are supported; odd orders get one
+// first-order section. Sections are ordered by increasing Q to
+// keep intermediate gains modest.
+//
+// A bandpass is the highpass cascade followed by the lowpass
+// cascade; the result is applied in one pass by BiquadMC.
+//
+#define SOS_MAX_ORDER   10
+
+class SOSDesign
+{
+public:
+    static bool lowpass(
+        std::vector<SOSCoeffs>  &sos,
+        int                     family,
+        int                     order,
+        double                  Fc );
+
+    static bool highpass(
+        std::vector<SOSCoeffs>  &sos,
+        int                     family,
+        int                     order,
+        double                  Fc );
+
+    static bool bandpass(
+        std::vector<SOSCoeffs>  &sos,
+        int                     family,
+        int                     order,
+        double                  FcLo,
+        double                  FcHi );
+
+private:
+    static bool design(
+        std::vector<SOSCoeffs>  &sos,
+        int                     family,
+        int                     order,
+        double                  Fc,
+        bool                    isHP );
+};
+
+#endif  // SOSDESIGN_H
+
+
@@ -0,0 +1,252 @@
+
+#include "SpikeDetect.h"
+#include "BiquadMC.h"
+#include "Util.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPIKEDETECT_SSE2
+#include <emmintrin.h>
+#endif
+
+
+/* ---------------------------------------------------------------- */
+/* SpikeDetect ---------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+SpikeDetect::SpikeDetect()
+    :   flt(0), srate(1), budget(1), dataT(0),
+        nchans(0), nNeu(0), c0(0), cLim(0), maxW(1), nzero(0)
+{
+}
+
+
+SpikeDetect::~SpikeDetect()
+{
+    if( flt )
+        delete flt;
+}
+
+
+void SpikeDetect::init(
+    const ShankMap          &SM,
+    const QVector<uint>     &chans,
+    const QVector<short>    &T,
+    int                     nchans,
+    int                     nNeu,
+    double                  srate,
+    double                  budget )
+{
+    this->nchans    = nchans;
+    this->nNeu      = nNeu;
+    this->srate     = srate;
+    this->budget    = budget;
+
+    maxW = qMax( 1, int(0.001 * srate) );
+
+    if( flt )
+        delete flt;
+
+    flt = new BiquadMC( bq_type_highpass, 300/srate );
+
+    ref.setGlobal( SM, 0, nNeu, false );
+
+    if( chans.isEmpty() ) {
+        c0      = 0;
+        cLim    = 0;
+        thr.clear();
+    }
+    else {
+        c0      = chans.first();
+        cLim    = chans.last() + 1;
+
+        thr.assign( cLim - c0, -32768 );
+
+        for( int i = 0, n = chans.size(); i < n; ++i )
+            thr[chans[i] - c0] = T[i];
+    }
+
+    S       = Stats();
+    dataT   = 0;
+
+    reset();
+}
+
+
+void SpikeDetect::reset()
+{
+    int nL = cLim - c0;
+
+    st.assign( nL, 0 );
+    peak.assign( nL, 0 );
+    wid.assign( nL, 0 );
+    peakCt.assign( nL, 0 );
+
+    if( flt )
+        flt->clearMem();
+
+    nzero = BIQUAD_TRANS_WIDE;
+}
+
+
+bool SpikeDetect::detect(
+    std::vector<Event>  &evt,
+    const short         *data,
+    int                 ntpts,
+    quint64             headCt )
+{
+    int nL = cLim - c0;
+
+    if( !nL || ntpts <= 0 )
+        return false;
+
+// ------
+// Budget
+// ------
+
+    dataT += ntpts / srate;
+
+    if( S.busyT > budget * dataT ) {
+
+        S.nSkip += quint64(ntpts) * nL;
+        reset();
+        return false;
+    }
+
+    double  t0 = getTime();
+
+// -----------------
+// Filter, reference
+// -----------------
+
+    work.assign( data, data + ntpts * nchans );
+
+    short   *W = &work[0];
+
+    flt->applyBlockwiseMem( W, MAX10BIT, ntpts, nchans, 0, nNeu );
+
+    // Filter restarted from rest: zero its transient
+
+    if( nzero > 0 ) {
+
+        int nz = qMin( nzero, ntpts );
+
+        for( int it = 0; it < nz; ++it )
+            memset( W + it*nchans, 0, nNeu*sizeof(short) );
+
+        nzero -= nz;
+    }
+
+    if( ref.isActive() )
+        ref.apply( W, (const float*)0, ntpts, nchans );
+
+// ------
+// Detect
+// ------
+
+    const short *T  = &thr[0],
+                *A  = &st[0];
+    int         nE  = (int)evt.size();
+
+#ifdef SPIKEDETECT_SSE2
+    const __m128i   v0  = _mm_setzero_si128();
+    int             nV  = nL & ~7;
+#endif
+
+    for( int it = 0; it < ntpts; ++it ) {
+
+        const short *row    = W + it*nchans + c0;
+        quint64     ct      = headCt + it;
+        int         c       = 0;
+
+#ifdef SPIKEDETECT_SSE2
+        for( ; c < nV; c += 8 ) {
+
+            __m128i x = _mm_loadu_si128( (const __m128i*)&row[c] ),
+                    t = _mm_loadu_si128( (const __m128i*)&T[c] ),
+                    s = _mm_loadu_si128( (const __m128i*)&A[c] );
+            int     m = _mm_movemask_epi8(
+                            _mm_or_si128(
+                                _mm_cmplt_epi16( x, t ),
+                                _mm_cmpgt_epi16( s, v0 ) ) );
+
+            for( int k = 0; m; ++k, m >>= 2 ) {
+
+                if( m & 1 )
+                    visit( evt, c + k, row[c + k], ct );
+            }
+        }
+#endif
+
+        for( ; c < nL; ++c ) {
+
+            if( row[c] < T[c] || A[c] )
+                visit( evt, c, row[c], ct );
+        }
+    }
+
+    S.nSamp += quint64(ntpts) * nL;
+    S.nEvt  += evt.size() - nE;
+    S.busyT += getTime() - t0;
+
+    return true;
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Lane (c) is below threshold or mid-excursion.
+//
+inline void SpikeDetect::visit(
+    std::vector<Event>  &evt,
+    int                 c,
+    short               x,
+    quint64             ct )
+{
+    bool    below = (x < thr[c]);
+
+    switch( st[c] ) {
+
+        case 0:
+            if( below ) {
+                st[c]       = 1;
+                peak[c]     = x;
+                peakCt[c]   = ct;
+                wid[c]      = 1;
+            }
+            break;
+
+        case 1:
+            if( below ) {
+
+                if( x < peak[c] ) {
+                    peak[c]     = x;
+                    peakCt[c]   = ct;
+                }
+
+                if( ++wid[c] < maxW )
+                    break;
+            }
+
+            {
+                Event   E;
+                E.ct    = peakCt[c];
+                E.chan  = c0 + c;
+                E.amp   = peak[c];
+                evt.push_back( E );
+            }
+
+            st[c] = (below ? 2 : 0);
+            break;
+
+        default:
+            if( !below )
+                st[c] = 0;
+            break;
+    }
+}
+
+
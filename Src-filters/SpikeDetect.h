@@ -0,0 +1,119 @@
+#ifndef SPIKEDETECT_H
+#define SPIKEDETECT_H
+
+#include "Referencer.h"
+
+#include <qglobal.h>
+#include <QVector>
+
+class BiquadMC;
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Online spike detection on whole blocks of interleaved int16 data
+// (timepoint-major, nchans per timepoint).
+//
+// Each block is copied, highpassed (300 Hz, BiquadMC) and common-
+// average referenced (Referencer) over channels [0,nNeu). Then each
+// excursion of a detected channel below its threshold yields one
+// event at its most negative sample: (count, channel, amplitude).
+// An excursion longer than maxW samples is reported at maxW and not
+// re-armed until the channel returns above threshold.
+//
+// The filter restarts from rest at init(), reset() and after any
+// budget skip; its first BIQUAD_TRANS_WIDE rows are zeroed so the
+// transient can't cross threshold.
+//
+// Rows are classified eight channels per SSE2 compare; only lanes
+// that are below threshold or mid-excursion are visited, so quiet
+// data cost about one compare per eight samples.
+//
+// CPU budget: when cumulative detect time exceeds (budget) times
+// the real time of the data offered, whole blocks are skipped (and
+// counted) until the balance recovers.
+//
+class SpikeDetect
+{
+public:
+    struct Event {
+        quint64 ct;
+        quint16 chan;
+        qint16  amp;
+    };
+
+    struct Stats {
+        quint64 nSamp,  // channel-samples scanned
+                nSkip,  // channel-samples skipped for budget
+                nEvt;
+        double  busyT;
+
+        Stats() : nSamp(0), nSkip(0), nEvt(0), busyT(0)    {}
+    };
+
+private:
+    BiquadMC                *flt;
+    Referencer              ref;
+    std::vector<short>      work,
+                            thr,    // per lane; -32768 = not detected
+                            st,     // per lane {0=idle,1=excursion,2=hold}
+                            peak,
+                            wid;
+    std::vector<quint64>    peakCt;
+    Stats                   S;
+    double                  srate,
+                            budget,
+                            dataT;
+    int                     nchans,
+                            nNeu,
+                            c0,
+                            cLim,
+                            maxW,
+                            nzero;  // filter transient rows left
+
+public:
+    SpikeDetect();
+    virtual ~SpikeDetect();
+
+    // Detect on (chans) (sorted ascending, all < nNeu), with
+    // per-channel thresholds (T) indexed like (chans). Referencing
+    // uses the used sites of (SM) over [0,nNeu).
+    void init(
+        const ShankMap          &SM,
+        const QVector<uint>     &chans,
+        const QVector<short>    &T,
+        int                     nchans,
+        int                     nNeu,
+        double                  srate,
+        double                  budget );
+
+    void reset();
+
+    int nChans() const          {return nchans;}
+    int maxWidth() const        {return maxW;}
+    const Stats &stats() const  {return S;}
+
+    // Filtered, referenced copy of the last block detect()
+    // processed (nchans per timepoint).
+    const short *filtered() const   {return &work[0];}
+
+    // Append this block's events to (evt).
+    // Return false if block skipped for budget.
+    bool detect(
+        std::vector<Event>  &evt,
+        const short         *data,
+        int                 ntpts,
+        quint64             headCt );
+
+private:
+    inline void visit(
+        std::vector<Event>  &evt,
+        int                 c,
+        short               x,
+        quint64             ct );
+};
+
+#endif  // SPIKEDETECT_H
+
+
@@ -1,8 +1,18 @@
 
 HEADERS += \
-    $$PWD/Biquad.h
+    $$PWD/Biquad.h \
+    $$PWD/BiquadMC.h \
+    $$PWD/EdgeScan.h \
+    $$PWD/Referencer.h \
+    $$PWD/SOSDesign.h \
+    $$PWD/SpikeDetect.h
 
 SOURCES += \
-    $$PWD/Biquad.cpp
+    $$PWD/Biquad.cpp \
+    $$PWD/BiquadMC.cpp \
+    $$PWD/EdgeScan.cpp \
+    $$PWD/Referencer.cpp \
+    $$PWD/SOSDesign.cpp \
+    $$PWD/SpikeDetect.cpp
 
 
@@ -0,0 +1,172 @@
+
+#include "BinMinMax.h"
+#include "GraphStats.h"
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BINMINMAX_SSE2
+#include <emmintrin.h>
+#endif
+
+
+/* ---------------------------------------------------------------- */
+/* BinMinMax ------------------------------------------------------ */
+/* ---------------------------------------------------------------- */
+
+// Within a bin, sums of samples are exact int32 (bins are far
+// shorter than 64K timepoints); squares can reach 2^30, so are
+// summed as float per bin. Both are flushed to double per bin.
+//
+void BinMinMax::scan(
+    const short *data,
+    int         ntpts,
+    int         nchans,
+    int         c0,
+    int         cLim,
+    int         binWid,
+    const char  *want )
+{
+    this->c0    = c0;
+    nc          = cLim - c0;
+    nb          = (binWid > 0 ? (ntpts + binWid - 1) / binWid : 0);
+    n           = ntpts;
+
+    mn.resize( nb * nc );
+    mx.resize( nb * nc );
+    s1.assign( nc, 0.0 );
+    s2.assign( nc, 0.0 );
+
+    if( nc <= 0 || !nb )
+        return;
+
+    int c = 0;
+
+#ifdef BINMINMAX_SSE2
+    const __m128i   z   = _mm_setzero_si128();
+    int             nV  = nc & ~7;
+
+    for( ; c < nV; c += 8 ) {
+
+        if( want ) {
+
+            const char  *W = want + c0 + c;
+
+            if( !(W[0] | W[1] | W[2] | W[3] | W[4] | W[5] | W[6] | W[7]) )
+                continue;
+        }
+
+        const short *d  = data + c0 + c;
+        double      *S1 = &s1[c],
+                    *S2 = &s2[c];
+
+        for( int ib = 0, it = 0; ib < nb; ++ib ) {
+
+            int     iLim    = qMin( it + binWid, ntpts );
+            __m128i x       = _mm_loadu_si128( (const __m128i*)d ),
+                    vmin    = x,
+                    vmax    = x,
+                    a1lo    = _mm_setzero_si128(),
+                    a1hi    = _mm_setzero_si128();
+            __m128  a2lo    = _mm_setzero_ps(),
+                    a2hi    = _mm_setzero_ps();
+
+            for( ;; ) {
+
+                // sign-extend to int32 lanes
+
+                __m128i lo = _mm_srai_epi32( _mm_unpacklo_epi16( x, x ), 16 ),
+                        hi = _mm_srai_epi32( _mm_unpackhi_epi16( x, x ), 16 );
+
+                a1lo = _mm_add_epi32( a1lo, lo );
+                a1hi = _mm_add_epi32( a1hi, hi );
+
+                // madd of (x,0) pairs = x*x per int32 lane
+
+                lo = _mm_unpacklo_epi16( x, z );
+                hi = _mm_unpackhi_epi16( x, z );
+
+                a2lo = _mm_add_ps( a2lo,
+                        _mm_cvtepi32_ps( _mm_madd_epi16( lo, lo ) ) );
+                a2hi = _mm_add_ps( a2hi,
+                        _mm_cvtepi32_ps( _mm_madd_epi16( hi, hi ) ) );
+
+                d += nchans;
+
+                if( ++it >= iLim )
+                    break;
+
+                x       = _mm_loadu_si128( (const __m128i*)d );
+                vmin    = _mm_min_epi16( vmin, x );
+                vmax    = _mm_max_epi16( vmax, x );
+            }
+
+            _mm_storeu_si128( (__m128i*)&mn[ib*nc + c], vmin );
+            _mm_storeu_si128( (__m128i*)&mx[ib*nc + c], vmax );
+
+            qint32  t1[8];
+            float   t2[8];
+
+            _mm_storeu_si128( (__m128i*)&t1[0], a1lo );
+            _mm_storeu_si128( (__m128i*)&t1[4], a1hi );
+            _mm_storeu_ps( &t2[0], a2lo );
+            _mm_storeu_ps( &t2[4], a2hi );
+
+            for( int k = 0; k < 8; ++k ) {
+                S1[k] += t1[k];
+                S2[k] += t2[k];
+            }
+        }
+    }
+#endif
+
+// Scalar for remaining channels
+
+    for( ; c < nc; ++c ) {
+
+        if( want && !want[c0 + c] )
+            continue;
+
+        const short *d = data + c0 + c;
+
+        for( int ib = 0, it = 0; ib < nb; ++ib ) {
+
+            int     iLim    = qMin( it + binWid, ntpts );
+            short   vmin    = *d,
+                    vmax    = *d;
+            qint32  a1      = 0;
+            float   a2      = 0;
+
+            for( ; it < iLim; ++it, d += nchans ) {
+
+                int v = *d;
+
+                if( v < vmin )
+                    vmin = v;
+                else if( v > vmax )
+                    vmax = v;
+
+                a1 += v;
+                a2 += float(v*v);
+            }
+
+            mn[ib*nc + c] = vmin;
+            mx[ib*nc + c] = vmax;
+            s1[c] += a1;
+            s2[c] += a2;
+        }
+    }
+}
+
+
+// Shifted sums: sum(x-off) = S1 - n*off,
+// sum((x-off)^2) = S2 - 2*off*S1 + n*off^2.
+//
+void BinMinMax::addStats( GraphStats &stat, int ic, double off ) const
+{
+    double  S1 = s1[ic - c0],
+            S2 = s2[ic - c0];
+
+    stat.addSums( S1 - n*off, S2 - 2*off*S1 + n*off*off, n );
+}
+
+
@@ -0,0 +1,62 @@
+#ifndef BINMINMAX_H
+#define BINMINMAX_H
+
+#include <qglobal.h>
+
+#include <vector>
+
+class GraphStats;
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Bin-max downsampling of interleaved int16 data (timepoint-major,
+// nchans per timepoint) for channels [c0,cLim).
+//
+// One pass over the block yields, per bin of (binWid) timepoints
+// and per channel, the min and max sample; and, per channel, the
+// sum and sum of squares of all samples. Rows are read eight
+// channels per SSE2 vector, so min/max/sums cost a few ops per
+// eight samples, and results are stored bin-major (one contiguous
+// row of channels per bin); readers pick their channel at stride.
+//
+// Optional (want) flags, indexed like the data row, skip unwanted
+// channels (whole vectors of them); their results are undefined.
+//
+class BinMinMax
+{
+private:
+    std::vector<short>  mn,     // [bin][chan]
+                        mx;
+    std::vector<double> s1,     // [chan]
+                        s2;
+    int                 c0,
+                        nc,
+                        nb,
+                        n;
+
+public:
+    BinMinMax() : c0(0), nc(0), nb(0), n(0)  {}
+
+    void scan(
+        const short *data,
+        int         ntpts,
+        int         nchans,
+        int         c0,
+        int         cLim,
+        int         binWid,
+        const char  *want = 0 );
+
+    int nBins() const   {return nb;}
+
+    short binMin( int ib, int ic ) const    {return mn[ib*nc + ic - c0];}
+    short binMax( int ib, int ic ) const    {return mx[ib*nc + ic - c0];}
+
+    // Add channel's samples, less (off), to (stat).
+    void addStats( GraphStats &stat, int ic, double off ) const;
+};
+
+#endif  // BINMINMAX_H
+
+
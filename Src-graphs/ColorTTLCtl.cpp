@@ -9,6 +9,7 @@
 #include "HelpButDialog.h"
 #include "SignalBlocker.h"
 #include "Subset.h"
+#include "EdgeScan.h"
 
 #include <QMessageBox>
 #include <QSettings>
@@ -566,267 +567,36 @@ bool ColorTTLCtl::getChan(
 }
 
 
-bool ColorTTLCtl::findRisingEdge(
-    int         &outCt,
-    const short *data,
-    int         ntpts,
-    int         offset,
-    int         nchans,
-    int         chan,
-    qint16      T ) const
-{
-    const short *d      = &data[chan + offset*nchans],
-                *dlim   = &data[chan +  ntpts*nchans];
-    int         nhi     = 0;
-    bool        found   = false;
-
-// -------------------
-// Must start on a low
-// -------------------
-
-    if( *d >= T ) {
-
-        while( (d += nchans) < dlim ) {
-
-            if( *d < T )
-                goto seek_edge;
-        }
-
-        goto exit;
-    }
-
-// -------------------
-// Seek edge candidate
-// -------------------
-
-seek_edge:
-    while( (d += nchans) < dlim ) {
-
-        if( *d >= T ) {
-
-            // Mark edge start
-            outCt   = (d - &data[chan]) / nchans;
-            nhi     = 1;
-
-            if( set.inarow == 1 ) {
-                found = true;
-                goto exit;
-            }
-
-            // Check extended run length
-            while( (d += nchans) < dlim ) {
-
-                if( *d >= T ) {
-
-                    if( ++nhi >= set.inarow ) {
-                        found = true;
-                        goto exit;
-                    }
-                }
-                else {
-                    nhi = 0;
-                    break;
-                }
-            }
-        }
-    }
-
-// ----
-// Exit
-// ----
-
-exit:
-    return found;
-}
-
-
-bool ColorTTLCtl::findBitRisingEdge(
-    int         &outCt,
-    const short *data,
-    int         ntpts,
-    int         offset,
-    int         nchans,
-    int         chan,
-    int         bit ) const
-{
-    const short *d      = &data[chan + offset*nchans],
-                *dlim   = &data[chan +  ntpts*nchans];
-    int         nhi     = 0;
-    bool        found   = false;
-
-// -------------------
-// Must start on a low
-// -------------------
-
-    if( (*d >> bit) & 1 ) {
-
-        while( (d += nchans) < dlim ) {
-
-            if( !((*d >> bit) & 1))
-                goto seek_edge;
-        }
-
-        goto exit;
-    }
-
-// -------------------
-// Seek edge candidate
-// -------------------
-
-seek_edge:
-    while( (d += nchans) < dlim ) {
-
-        if( (*d >> bit) & 1 ) {
-
-            // Mark edge start
-            outCt   = (d - &data[chan]) / nchans;
-            nhi     = 1;
-
-            if( set.inarow == 1 ) {
-                found = true;
-                goto exit;
-            }
-
-            // Check extended run length
-            while( (d += nchans) < dlim ) {
-
-                if( (*d >> bit) & 1 ) {
-
-                    if( ++nhi >= set.inarow ) {
-                        found = true;
-                        goto exit;
-                    }
-                }
-                else {
-                    nhi = 0;
-                    break;
-                }
-            }
-        }
-    }
-
-// ----
-// Exit
-// ----
-
-exit:
-    return found;
-}
-
-
-bool ColorTTLCtl::findFallingEdge(
-    int         &outCt,
-    const short *data,
-    int         ntpts,
-    int         offset,
-    int         nchans,
-    int         chan,
-    qint16      T ) const
-{
-    const short *d      = &data[chan + offset*nchans],
-                *dlim   = &data[chan +  ntpts*nchans];
-    int         nlo     = 0;
-    bool        found   = false;
-
-// -------------------
-// Seek edge candidate
-// -------------------
-
-    while( (d += nchans) < dlim ) {
-
-        if( *d < T ) {
-
-            // Mark edge start
-            outCt   = (d - &data[chan]) / nchans;
-            nlo     = 1;
-
-            if( set.inarow == 1 ) {
-                found = true;
-                goto exit;
-            }
-
-            // Check extended run length
-            while( (d += nchans) < dlim ) {
-
-                if( *d < T ) {
-
-                    if( ++nlo >= set.inarow ) {
-                        found = true;
-                        goto exit;
-                    }
-                }
-                else {
-                    nlo = 0;
-                    break;
-                }
-            }
-        }
-    }
-
-// ----
-// Exit
-// ----
-
-exit:
-    return found;
-}
-
-
-bool ColorTTLCtl::findBitFallingEdge(
-    int         &outCt,
-    const short *data,
-    int         ntpts,
-    int         offset,
-    int         nchans,
-    int         chan,
-    int         bit ) const
+// Scan one block from row offset. A rising search must first
+// see a low at offset or later. A falling search is made only
+// while high, so starts armed and examines from offset+1.
+//
+bool ColorTTLCtl::findEdge(
+    int             &outCt,
+    const vec_i16   &data,
+    int             ntpts,
+    int             offset,
+    int             nchans,
+    int             chan,
+    EdgeScan        &E,
+    bool            isHigh ) const
 {
-    const short *d      = &data[chan + offset*nchans],
-                *dlim   = &data[chan +  ntpts*nchans];
-    int         nlo     = 0;
-    bool        found   = false;
-
-// -------------------
-// Seek edge candidate
-// -------------------
+    int edgeRow;
 
-    while( (d += nchans) < dlim ) {
+    if( isHigh )
+        ++offset;
 
-        if( !((*d >> bit) & 1) ) {
-
-            // Mark edge start
-            outCt   = (d - &data[chan]) / nchans;
-            nlo     = 1;
-
-            if( set.inarow == 1 ) {
-                found = true;
-                goto exit;
-            }
-
-            // Check extended run length
-            while( (d += nchans) < dlim ) {
+    if( offset >= ntpts )
+        return false;
 
-                if( !((*d >> bit) & 1) ) {
+    E.reset( isHigh );
 
-                    if( ++nlo >= set.inarow ) {
-                        found = true;
-                        goto exit;
-                    }
-                }
-                else {
-                    nlo = 0;
-                    break;
-                }
-            }
-        }
+    if( E.scan( edgeRow, &data[chan + offset*nchans], ntpts - offset, nchans ) ) {
+        outCt = offset + edgeRow;
+        return true;
     }
 
-// ----
-// Exit
-// ----
-
-exit:
-    return found;
+    return false;
 }
 
 
@@ -848,10 +618,19 @@ void ColorTTLCtl::processEvents(
         int     clr     = vClr[i],
                 nextCt  = 0,
                 chan, bit, thresh;
-        bool    isAnalog,
-                found;
+        bool    found;
 
-        isAnalog = getChan( chan, bit, thresh, clr, ip );
+        EdgeScan    rise,
+                    fall;
+
+        if( getChan( chan, bit, thresh, clr, ip ) ) {
+            rise.setAnalog( thresh, true, set.inarow );
+            fall.setAnalog( thresh, false, set.inarow );
+        }
+        else {
+            rise.setBit( bit, true, set.inarow );
+            fall.setBit( bit, false, set.inarow );
+        }
 
         while( nextCt < ntpts ) {
 
@@ -859,16 +638,9 @@ void ColorTTLCtl::processEvents(
 
                 // Low, seeking high
 
-                if( isAnalog ) {
-                    found = findRisingEdge(
-                                nextCt, &data[0], ntpts,
-                                nextCt, nC, chan, thresh );
-                }
-                else {
-                    found = findBitRisingEdge(
-                                nextCt, &data[0], ntpts,
-                                nextCt, nC, chan, bit );
-                }
+                found = findEdge(
+                            nextCt, data, ntpts,
+                            nextCt, nC, chan, rise, false );
 
                 if( found ) {
 
@@ -897,16 +669,9 @@ void ColorTTLCtl::processEvents(
 
             // high, seeking low
 
-            if( isAnalog ) {
-                found = findFallingEdge(
-                            nextCt, &data[0], ntpts,
-                            nextCt, nC, chan, thresh );
-            }
-            else {
-                found = findBitFallingEdge(
-                            nextCt, &data[0], ntpts,
-                            nextCt, nC, chan, bit );
-            }
+            found = findEdge(
+                        nextCt, data, ntpts,
+                        nextCt, nC, chan, fall, true );
 
             // always update painting
 
@@ -16,6 +16,7 @@ namespace Ui {
 class ColorTTLDialog;
 }
 
+class EdgeScan;
 class HelpButDialog;
 class MGraphX;
 
@@ -129,41 +130,15 @@ private:
         int     clr,
         int     ip ) const;
 
-    bool findRisingEdge(
-        int         &outCt,
-        const short *data,
-        int         ntpts,
-        int         offset,
-        int         nchans,
-        int         chan,
-        qint16      T ) const;
-
-    bool findBitRisingEdge(
-        int         &outCt,
-        const short *data,
-        int         ntpts,
-        int         offset,
-        int         nchans,
-        int         chan,
-        int         bit ) const;
-
-    bool findFallingEdge(
-        int         &outCt,
-        const short *data,
-        int         ntpts,
-        int         offset,
-        int         nchans,
-        int         chan,
-        qint16      T ) const;
-
-    bool findBitFallingEdge(
-        int         &outCt,
-        const short *data,
-        int         ntpts,
-        int         offset,
-        int         nchans,
-        int         chan,
-        int         bit ) const;
+    bool findEdge(
+        int             &outCt,
+        const vec_i16   &data,
+        int             ntpts,
+        int             offset,
+        int             nchans,
+        int             chan,
+        EdgeScan        &E,
+        bool            isHigh ) const;
 
     void processEvents(
         const vec_i16   &data,
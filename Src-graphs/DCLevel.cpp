@@ -0,0 +1,61 @@
+
+#include "DCLevel.h"
+
+#include <math.h>
+
+
+/* ---------------------------------------------------------------- */
+/* DCLevel -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+void DCLevel::init( int nNeural, double srate, double tauSecs )
+{
+    nN      = nNeural;
+    tauSmp  = qMax( tauSecs * srate, 1.0 );
+    reset();
+}
+
+
+void DCLevel::reset()
+{
+    lvl.fill( 0.0F, nN );
+    primed = false;
+}
+
+
+void DCLevel::prime(
+    const qint16    *d,
+    int             ntpts,
+    int             nchans,
+    int             dwnSmp )
+{
+    if( primed || !nN || ntpts <= 0 )
+        return;
+
+    QVector<double> sum( nN, 0.0 );
+    double          *S      = &sum[0];
+    int             dStep   = nchans * dwnSmp,
+                    dtpts   = (ntpts + dwnSmp - 1) / dwnSmp;
+
+    for( int it = 0; it < ntpts; it += dwnSmp, d += dStep ) {
+
+        for( int ic = 0; ic < nN; ++ic )
+            S[ic] += d[ic];
+    }
+
+    for( int ic = 0; ic < nN; ++ic )
+        lvl[ic] = S[ic] / dtpts;
+
+    primed = true;
+}
+
+
+// Exponential running mean: a block of (ntpts)
+// counts as that many steps of the one-sample filter.
+//
+float DCLevel::weight( int ntpts ) const
+{
+    return 1.0 - exp( -ntpts / tauSmp );
+}
+
+
@@ -0,0 +1,58 @@
+#ifndef DCLEVEL_H
+#define DCLEVEL_H
+
+#include <QVector>
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Per-channel DC level for display, channels [0,nN).
+//
+// No pass of its own: the pass that already visits a channel's
+// samples to draw them (binning or downsampling) sums (x - lvl),
+// and add() moves lvl by that block mean, weighted as an exponential
+// running mean with time constant tauSecs. The first block a channel
+// sees sets all levels outright (prime(), one strided pass).
+//
+// Live and file views share this, so both remove the same level
+// from the same data.
+//
+class DCLevel
+{
+private:
+    double          tauSmp;
+    int             nN;
+    bool            primed;
+
+public:
+    QVector<float>  lvl;
+
+public:
+    DCLevel() : tauSmp(1), nN(0), primed(false)  {}
+
+    void init( int nNeural, double srate, double tauSecs = 1.0 );
+    void reset();
+
+    // If not yet primed, set levels from this block's mean.
+    void prime(
+        const qint16    *d,
+        int             ntpts,
+        int             nchans,
+        int             dwnSmp );
+
+    // Channel ic: (n) samples from a block of (ntpts)
+    // timepoints summed to (sumResid) after subtracting lvl.
+    void add( int ic, double sumResid, int n, int ntpts )
+    {
+        if( ic < nN && n > 0 )
+            lvl[ic] += weight( ntpts ) * sumResid / n;
+    }
+
+private:
+    float weight( int ntpts ) const;
+};
+
+#endif  // DCLEVEL_H
+
+
@@ -0,0 +1,221 @@
+
+#include "FVFltCache.h"
+#include "DataFile.h"
+
+#include <QBitArray>
+
+#include <string.h>
+
+
+/* ---------------------------------------------------------------- */
+/* Statics -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+static qint64 entryBytes( const vec_i16 &data, const BiquadMC::Mem &M )
+{
+    return data.size() * sizeof(qint16)
+            + M.fz.size() * sizeof(float)
+            + M.dz.size() * sizeof(double);
+}
+
+/* ---------------------------------------------------------------- */
+/* FVFltCache ----------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+FVFltCache::FVFltCache( qint64 maxBytes )
+    :   df(0), chunk(1), nScans(0), maxBytes(maxBytes), curBytes(0),
+        useClock(0), nchans(0), maxInt(0), c0(0), cLim(0)
+{
+}
+
+
+void FVFltCache::setFile( const DataFile *df )
+{
+    QString name    = df->binFileName();
+    int     nC      = df->numChans();
+
+    if( name != file || nC != nchans ) {
+
+        clear();
+
+        file    = name;
+        nchans  = nC;
+    }
+
+    this->df    = df;
+    nScans      = df->scanCount();
+    chunk       = qMax( qint64(df->samplingRateHz()), qint64(1) );
+}
+
+
+void FVFltCache::setFilter(
+    const BiquadMC  &F,
+    const QString   &key,
+    int             maxInt,
+    int             c0,
+    int             cLim )
+{
+    if( key == fltKey
+        && maxInt == this->maxInt
+        && c0 == this->c0
+        && cLim == this->cLim ) {
+
+        return;
+    }
+
+    clear();
+
+    flt             = F;
+    fltKey          = key;
+    this->maxInt    = maxInt;
+    this->c0        = c0;
+    this->cLim      = cLim;
+}
+
+
+void FVFltCache::clear()
+{
+    map.clear();
+    curBytes = 0;
+}
+
+
+qint64 FVFltCache::readScans(
+    vec_i16 &dst,
+    qint64  scan0,
+    qint64  num2read )
+{
+    if( !df || !nchans || scan0 < 0 || scan0 >= nScans )
+        return -1;
+
+    num2read = qMin( num2read, nScans - scan0 );
+
+    dst.resize( num2read * nchans );
+
+    qint64  nDone = 0;
+
+    while( nDone < num2read ) {
+
+        qint64      pos = scan0 + nDone,
+                    k   = pos / chunk;
+        const Entry *E  = getChunk( k );
+
+        if( !E )
+            break;
+
+        qint64  off     = pos - k * chunk,
+                nthis   = qMin(
+                            qint64(E->data.size() / nchans) - off,
+                            num2read - nDone );
+
+        memcpy(
+            &dst[nDone * nchans],
+            &E->data[off * nchans],
+            nthis * nchans * sizeof(qint16) );
+
+        nDone += nthis;
+    }
+
+    if( !nDone )
+        return -1;
+
+    if( nDone < num2read )
+        dst.resize( nDone * nchans );
+
+    return nDone;
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Return cached chunk (k), filtering it first if needed.
+// Pointer is valid until the next call.
+//
+const FVFltCache::Entry *FVFltCache::getChunk( qint64 k )
+{
+    QMap<qint64,Entry>::iterator    it = map.find( k );
+
+    if( it != map.end() ) {
+        it->lastUse = ++useClock;
+        return &it.value();
+    }
+
+    qint64  pos     = k * chunk,
+            nthis   = qMin( chunk, nScans - pos );
+
+    if( nthis <= 0 )
+        return 0;
+
+// ------------
+// Filter state
+// ------------
+
+    it = map.find( k - 1 );
+
+    if( it != map.end() )
+        flt.setMem( it->end );
+    else {
+
+        qint64  xflt = qMin( (qint64)BIQUAD_TRANS_WIDE, pos );
+
+        flt.clearMem();
+
+        if( xflt > 0 ) {
+
+            vec_i16 warm;
+
+            if( df->readScans( warm, pos - xflt, xflt, QBitArray() ) == xflt )
+                flt.applyBlockwiseMem( &warm[0], maxInt, xflt, nchans, c0, cLim );
+        }
+    }
+
+// ------------
+// Filter chunk
+// ------------
+
+    vec_i16 data;
+
+    if( df->readScans( data, pos, nthis, QBitArray() ) != nthis )
+        return 0;
+
+    flt.applyBlockwiseMem( &data[0], maxInt, nthis, nchans, c0, cLim );
+
+    Entry   &E = map[k];
+
+    E.data.swap( data );
+    flt.getMem( E.end );
+    E.lastUse = ++useClock;
+
+    curBytes += entryBytes( E.data, E.end );
+
+    evict();
+
+    return &E;
+}
+
+
+// Drop least recently used entries until within budget,
+// always keeping the newest.
+//
+void FVFltCache::evict()
+{
+    while( curBytes > maxBytes && map.size() > 1 ) {
+
+        QMap<qint64,Entry>::iterator    it      = map.begin(),
+                                        end     = map.end(),
+                                        oldest  = it;
+
+        for( ++it; it != end; ++it ) {
+
+            if( it->lastUse < oldest->lastUse )
+                oldest = it;
+        }
+
+        curBytes -= entryBytes( oldest->data, oldest->end );
+
+        map.erase( oldest );
+    }
+}
+
+
@@ -0,0 +1,85 @@
+#ifndef FVFLTCACHE_H
+#define FVFLTCACHE_H
+
+#include "SGLTypes.h"
+#include "BiquadMC.h"
+
+#include <QMap>
+#include <QString>
+
+class DataFile;
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Filtered-chunk cache for FileViewerWindow.
+//
+// The file is divided into fixed chunks of about one second
+// (grid independent of view position and zoom). Each chunk is
+// stored filtered, along with the filter state at its end.
+//
+// To filter chunk k:
+// - If k is cached, it is simply copied out (no refiltering).
+// - If k-1 is cached, the filter resumes from k-1's end state,
+//   so forward scrolling is transient-free and reads nothing
+//   twice.
+// - Otherwise the filter is warmed up on the BIQUAD_TRANS_WIDE
+//   scans preceding chunk k, which are then discarded.
+//
+// Entries are valid for one (file, filter, channel range); a
+// change to any of these empties the cache. Memory is capped
+// at maxBytes; least recently used chunks are evicted first.
+//
+#define FVFLTCACHE_MAXBYTES     (128*1024*1024)
+
+class FVFltCache
+{
+private:
+    struct Entry {
+        vec_i16         data;
+        BiquadMC::Mem   end;
+        quint64         lastUse;
+    };
+
+    QMap<qint64,Entry>  map;
+    BiquadMC            flt;
+    QString             file,
+                        fltKey;
+    const DataFile      *df;
+    qint64              chunk,
+                        nScans,
+                        maxBytes,
+                        curBytes;
+    quint64             useClock;
+    int                 nchans,
+                        maxInt,
+                        c0,
+                        cLim;
+
+public:
+    FVFltCache( qint64 maxBytes = FVFLTCACHE_MAXBYTES );
+
+    // Call before each use; cheap if nothing changed.
+    void setFile( const DataFile *df );
+    void setFilter(
+        const BiquadMC  &F,
+        const QString   &key,
+        int             maxInt,
+        int             c0,
+        int             cLim );
+
+    void clear();
+
+    // Like DataFile::readScans() for all channels, but filtered.
+    // Return number of scans actually read or -1 on failure.
+    qint64 readScans( vec_i16 &dst, qint64 scan0, qint64 num2read );
+
+private:
+    const Entry *getChunk( qint64 k );
+    void evict();
+};
+
+#endif  // FVFLTCACHE_H
+
+
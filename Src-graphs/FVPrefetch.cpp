@@ -0,0 +1,428 @@
+
+#include "FVPrefetch.h"
+#include "Util.h"
+#include "DataFile.h"
+
+#include <QThread>
+
+
+/* ---------------------------------------------------------------- */
+/* FVPWorker ------------------------------------------------------ */
+/* ---------------------------------------------------------------- */
+
+FVPWorker::FVPWorker(
+    DataFile            *df,
+    const QVector<int>  &usrType,
+    int                 nNeurChans,
+    int                 nSpikeChans,
+    int                 maxInt,
+    qint64              maxBytes )
+    :   QObject(0), df(df),
+        hipass( bq_type_highpass, 300.0 / df->samplingRateHz() ),
+        usrType(usrType), maxBytes(maxBytes),
+        nNeurChans(nNeurChans), nSpikeChans(nSpikeChans),
+        maxInt(maxInt), curBytes(0), useClock(0),
+        newReq(false), pleaseStop(false)
+{
+}
+
+
+FVPWorker::~FVPWorker()
+{
+    if( df )
+        delete df;
+}
+
+
+void FVPWorker::request(
+    const FVWinParams       &P,
+    const QVector<qint64>   &next )
+{
+    QMutexLocker    ml( &reqMtx );
+
+    req     = P;
+    reqNext = next;
+    newReq  = true;
+
+    condReq.wakeAll();
+}
+
+
+// On success, mapMtx stays locked until unlockWindow().
+//
+const FVWindow *FVPWorker::lockWindow( const FVWinKey &K )
+{
+    mapMtx.lock();
+
+    QMap<FVWinKey,Entry>::iterator  it = map.find( K );
+
+    if( it == map.end() ) {
+        mapMtx.unlock();
+        return 0;
+    }
+
+    it->lastUse = ++useClock;
+
+    return &it->W;
+}
+
+
+void FVPWorker::stop()
+{
+    QMutexLocker    ml( &reqMtx );
+
+    pleaseStop = true;
+    condReq.wakeAll();
+}
+
+
+void FVPWorker::run()
+{
+    for(;;) {
+
+        FVWinParams     P;
+        QVector<qint64> next;
+
+        reqMtx.lock();
+
+        while( !newReq && !pleaseStop )
+            condReq.wait( &reqMtx );
+
+        if( pleaseStop ) {
+            reqMtx.unlock();
+            break;
+        }
+
+        P       = req;
+        next    = reqNext;
+        newReq  = false;
+
+        reqMtx.unlock();
+
+        // Requested view, then neighbors
+
+        if( !haveWindow( P.K ) && !makeWindow( P ) )
+            continue;
+
+        for( int i = 0, n = next.size(); i < n; ++i ) {
+
+            P.K.pos = next[i];
+
+            if( !haveWindow( P.K ) && !makeWindow( P ) )
+                break;
+        }
+    }
+
+    emit finished();
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+bool FVPWorker::haveWindow( const FVWinKey &K ) const
+{
+    QMutexLocker    ml( &mapMtx );
+
+    return map.contains( K );
+}
+
+
+// Abandon current work if stopping, or if GUI now wants
+// something other than the window being made.
+//
+bool FVPWorker::superseded() const
+{
+    QMutexLocker    ml( &reqMtx );
+
+    return pleaseStop || (newReq && !(req.K == making));
+}
+
+
+// Chunked like the former GUI-thread code: long spans are
+// processed as ~1 second pieces, with DC state carried across.
+//
+bool FVPWorker::makeWindow( FVWinParams &P )
+{
+    const FVWinKey  &K = P.K;
+
+    qint64  nScans  = df->scanCount();
+    int     nG      = usrType.size(),
+            dwnSmp  = K.dwnSmp;
+
+    if( K.pos < 0 || K.pos >= nScans || !nG )
+        return true;
+
+    making = K;
+
+// ------
+// Window
+// ------
+
+    qint64      xpos    = K.pos,
+                ntpts   = qMin( K.num2Read, nScans - xpos );
+    FVWindow    W;
+
+    W.nPts      = (ntpts + dwnSmp - 1) / dwnSmp;
+    W.binMax    = K.flags & FVWinKey::fBinMax;
+
+    W.y.assign( nG * W.nPts, 0.0F );
+
+    if( W.binMax )
+        W.y2.assign( nG * W.nPts, 0.0F );
+
+// -----------------
+// Pick a chunk size
+// -----------------
+
+// nominally 1 second's worth, but a multiple of dwnSmp
+
+    qint64  chunk = qMax( int(df->samplingRateHz()/dwnSmp), 1 ) * dwnSmp;
+
+// ------------
+// Filter setup
+// ------------
+
+// Unfiltered chunks are cached too, so neighboring windows
+// at any offset are composed without rereading the file.
+
+    fc.setFile( df );
+
+    if( K.flags & FVWinKey::f300Hz )
+        fc.setFilter( hipass, "hp300", maxInt, 0, nSpikeChans );
+    else
+        fc.setFilter( BiquadMC(), "none", maxInt, 0, 0 );
+
+    dc.init( nNeurChans, df->samplingRateHz() );
+
+    bool    dcOn = K.flags & FVWinKey::fDCChk;
+
+// --------------
+// Process chunks
+// --------------
+
+    qint64  nRem    = ntpts;
+    int     yoff    = 0;
+
+    while( nRem > 0 ) {
+
+        if( superseded() )
+            return false;
+
+        vec_i16 data;
+        qint64  nthis = qMin( chunk, nRem );
+
+        nthis = fc.readScans( data, xpos, nthis );
+
+        if( nthis <= 0 )
+            break;
+
+        xpos    += nthis;
+        nRem    -= nthis;
+
+        if( dcOn )
+            dc.prime( &data[0], nthis, nG, dwnSmp );
+
+        // Spatial referencing: only every dwnSmp'th
+        // timepoint is drawn unless binning.
+
+        P.ref.apply(
+            &data[0], dc.lvl.constData(), nthis, nG,
+            (W.binMax ? 1 : dwnSmp) );
+
+        compose( W, &data[0], nthis, nG, yoff, dwnSmp, dcOn );
+
+        yoff += (nthis + dwnSmp - 1) / dwnSmp;
+    }
+
+// -----
+// Store
+// -----
+
+    mapMtx.lock();
+
+    Entry   &E = map[K];
+
+    E.W.y.swap( W.y );
+    E.W.y2.swap( W.y2 );
+    E.W.nPts    = W.nPts;
+    E.W.binMax  = W.binMax;
+    E.lastUse   = ++useClock;
+
+    curBytes += E.W.bytes();
+
+    evict();
+
+    mapMtx.unlock();
+
+    emit windowReady();
+
+    return true;
+}
+
+
+// Downsample one chunk of all channels into W at yoff.
+// If (dcOn), neural sums of (x - lvl) taken here update dc.
+//
+void FVPWorker::compose(
+    FVWindow        &W,
+    const qint16    *data,
+    int             ntpts,
+    int             nG,
+    int             yoff,
+    int             dwnSmp,
+    bool            dcOn )
+{
+    double  ysc     = 1.0 / maxInt;
+    int     dstep   = dwnSmp * nG;
+
+    for( int ig = 0; ig < nG; ++ig ) {
+
+        const qint16    *d      = &data[ig];
+        float           *Y      = &W.y[ig * W.nPts + yoff];
+        float           lvl     = (ig < nNeurChans ? dc.lvl[ig] : 0);
+        double          sum     = 0;
+        int             type    = usrType[ig],
+                        n       = 0;
+
+        if( type == 0 && W.binMax ) {
+
+            // -------------------
+            // Neural downsampling
+            // -------------------
+
+            // Within each bin, report both max and min
+            // values. This ensures spikes aren't missed.
+            // Max in y, min in y2.
+
+            float   *Y2     = &W.y2[ig * W.nPts + yoff];
+            int     ndRem   = ntpts;
+
+            for( int it = 0; it < ntpts; it += dwnSmp ) {
+
+                const qint16    *Dmax   = d,
+                                *Dmin   = d;
+                int             vmax    = *d,
+                                vmin    = vmax,
+                                bsum    = vmax,
+                                binWid  = dwnSmp;
+
+                d += nG;
+
+                if( ndRem < binWid )
+                    binWid = ndRem;
+
+                for( int ib = 1; ib < binWid; ++ib, d += nG ) {
+
+                    bsum += *d;
+
+                    if( *d > vmax ) {
+                        vmax    = *d;
+                        Dmax    = d;
+                    }
+                    else if( *d < vmin ) {
+                        vmin    = *d;
+                        Dmin    = d;
+                    }
+                }
+
+                ndRem  -= binWid;
+                sum    += bsum;
+                n      += binWid;
+
+                *Y++    = (*Dmax - lvl) * ysc;
+                *Y2++   = (*Dmin - lvl) * ysc;
+            }
+        }
+        else if( type < 2 ) {
+
+            // Neural (DC removed) or aux
+
+            for( int it = 0; it < ntpts; it += dwnSmp, d += dstep, ++n ) {
+                sum += *d;
+                *Y++ = (*d - lvl) * ysc;
+            }
+        }
+        else {
+
+            // -------
+            // Digital
+            // -------
+
+            for( int it = 0; it < ntpts; it += dwnSmp, d += dstep )
+                *Y++ = *d;
+        }
+
+        // DC level tracks the sums just taken
+
+        if( dcOn && ig < nNeurChans )
+            dc.add( ig, sum - n*lvl, n, ntpts );
+    }
+}
+
+
+// Drop least recently used windows until within budget,
+// always keeping the newest. Caller holds mapMtx.
+//
+void FVPWorker::evict()
+{
+    while( curBytes > maxBytes && map.size() > 1 ) {
+
+        QMap<FVWinKey,Entry>::iterator  it      = map.begin(),
+                                        end     = map.end(),
+                                        oldest  = it;
+
+        for( ++it; it != end; ++it ) {
+
+            if( it->lastUse < oldest->lastUse )
+                oldest = it;
+        }
+
+        curBytes -= oldest->W.bytes();
+
+        map.erase( oldest );
+    }
+}
+
+/* ---------------------------------------------------------------- */
+/* FVPrefetch ----------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+FVPrefetch::FVPrefetch(
+    DataFile            *df,
+    const QVector<int>  &usrType,
+    int                 nNeurChans,
+    int                 nSpikeChans,
+    int                 maxInt,
+    qint64              maxBytes )
+{
+    thread  = new QThread;
+    worker  = new FVPWorker(
+                df, usrType, nNeurChans,
+                nSpikeChans, maxInt, maxBytes );
+
+    worker->moveToThread( thread );
+
+    Connect( thread, SIGNAL(started()), worker, SLOT(run()) );
+    Connect( worker, SIGNAL(finished()), worker, SLOT(deleteLater()) );
+    Connect( worker, SIGNAL(destroyed()), thread, SLOT(quit()), Qt::DirectConnection );
+
+    thread->start();
+}
+
+
+FVPrefetch::~FVPrefetch()
+{
+// worker object auto-deleted asynchronously
+// thread object manually deleted synchronously (so we can call wait())
+
+    if( thread->isRunning() ) {
+
+        worker->stop();
+        thread->wait();
+    }
+
+    delete thread;
+}
+
+
@@ -0,0 +1,202 @@
+#ifndef FVPREFETCH_H
+#define FVPREFETCH_H
+
+#include "DCLevel.h"
+#include "FVFltCache.h"
+#include "Referencer.h"
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+
+class DataFile;
+class QThread;
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Identifies one prepared FileViewerWindow view: file position,
+// span and downsampling, plus everything that alters the values.
+//
+struct FVWinKey {
+    enum flags {
+        fBinMax     = 0x01,
+        f300Hz      = 0x02,
+        fDCChk      = 0x04
+    };
+
+    qint64  pos,
+            num2Read;
+    int     dwnSmp,
+            flags,
+            refGen;     // bumped when Referencer plan changes
+
+    FVWinKey()
+    :   pos(-1), num2Read(0), dwnSmp(1), flags(0), refGen(0)    {}
+
+    bool operator==( const FVWinKey &rhs ) const
+    {
+        return pos == rhs.pos && num2Read == rhs.num2Read
+                && dwnSmp == rhs.dwnSmp && flags == rhs.flags
+                && refGen == rhs.refGen;
+    }
+
+    bool operator<( const FVWinKey &rhs ) const
+    {
+        if( pos != rhs.pos )            return pos < rhs.pos;
+        if( num2Read != rhs.num2Read )  return num2Read < rhs.num2Read;
+        if( dwnSmp != rhs.dwnSmp )      return dwnSmp < rhs.dwnSmp;
+        if( flags != rhs.flags )        return flags < rhs.flags;
+        return refGen < rhs.refGen;
+    }
+};
+
+struct FVWinParams {
+    FVWinKey    K;
+    Referencer  ref;
+};
+
+// Display-ready window: per-channel downsampled values, already
+// filtered, referenced, DC-corrected and scaled. Arrays are
+// channel-major: channel ig occupies [ig*nPts, (ig+1)*nPts).
+// If binMax, neural channels have bin max in y, min in y2.
+//
+struct FVWindow {
+    std::vector<float>  y,
+                        y2;
+    int                 nPts;
+    bool                binMax;
+
+    FVWindow() : nPts(0), binMax(false) {}
+
+    qint64 bytes() const
+        {return (y.size() + y2.size()) * sizeof(float);}
+};
+
+
+// Background reader for FileViewerWindow.
+//
+// All file reading, filtering and downsampling happen here, on
+// the worker thread. The GUI posts the view it wants with
+// request(), then on windowReady() (or immediately, if cached)
+// composes graphs from the prepared FVWindow.
+//
+// After the requested view, the worker prepares the views the
+// GUI names as likely next (the neighbors in scroll direction).
+// Raw/filtered chunks are kept by an FVFltCache, and prepared
+// windows in an LRU of maxBytes. A newer request preempts work
+// in progress at the next chunk boundary.
+//
+#define FVPREFETCH_MAXBYTES     (64*1024*1024)
+
+class FVPWorker : public QObject
+{
+    Q_OBJECT
+
+private:
+    struct Entry {
+        FVWindow    W;
+        quint64     lastUse;
+    };
+
+    // Worker thread only
+    DataFile                *df;
+    FVFltCache              fc;
+    BiquadMC                hipass;
+    DCLevel                 dc;
+    FVWinKey                making;
+    // Const after construction
+    QVector<int>            usrType;
+    qint64                  maxBytes;
+    int                     nNeurChans,
+                            nSpikeChans,
+                            maxInt;
+    // Guarded by mapMtx
+    QMap<FVWinKey,Entry>    map;
+    qint64                  curBytes;
+    quint64                 useClock;
+    // Guarded by reqMtx
+    FVWinParams             req;
+    QVector<qint64>         reqNext;
+    bool                    newReq,
+                            pleaseStop;
+    mutable QMutex          mapMtx,
+                            reqMtx;
+    QWaitCondition          condReq;
+
+public:
+    FVPWorker(
+        DataFile            *df,
+        const QVector<int>  &usrType,
+        int                 nNeurChans,
+        int                 nSpikeChans,
+        int                 maxInt,
+        qint64              maxBytes );
+    virtual ~FVPWorker();
+
+    void request( const FVWinParams &P, const QVector<qint64> &next );
+
+    const FVWindow *lockWindow( const FVWinKey &K );
+    void unlockWindow()     {mapMtx.unlock();}
+
+    void stop();
+
+signals:
+    void windowReady();
+    void finished();
+
+public slots:
+    void run();
+
+private:
+    bool haveWindow( const FVWinKey &K ) const;
+    bool superseded() const;
+    bool makeWindow( FVWinParams &P );
+    void compose(
+        FVWindow        &W,
+        const qint16    *data,
+        int             ntpts,
+        int             nG,
+        int             yoff,
+        int             dwnSmp,
+        bool            dcOn );
+    void evict();
+};
+
+
+class FVPrefetch
+{
+private:
+    QThread     *thread;
+    FVPWorker   *worker;
+
+public:
+    // Takes ownership of (df), which must be open for
+    // reading and used by no other thread.
+    FVPrefetch(
+        DataFile            *df,
+        const QVector<int>  &usrType,
+        int                 nNeurChans,
+        int                 nSpikeChans,
+        int                 maxInt,
+        qint64              maxBytes = FVPREFETCH_MAXBYTES );
+    virtual ~FVPrefetch();
+
+    const QObject *getWorker() const    {return worker;}
+
+    // Prepare (P), then windows at (next) positions, same params.
+    void request( const FVWinParams &P, const QVector<qint64> &next )
+        {worker->request( P, next );}
+
+    // Null if (K) not ready. Else, caller must unlockWindow().
+    const FVWindow *lockWindow( const FVWinKey &K )
+        {return worker->lockWindow( K );}
+    void unlockWindow()
+        {worker->unlockWindow();}
+};
+
+#endif  // FVPREFETCH_H
+
+
@@ -10,6 +10,7 @@
 #include <QDoubleSpinBox>
 #include <QPushButton>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QAction>
 #include <QLabel>
 
@@ -22,6 +23,7 @@ FVToolbar::FVToolbar( FileViewerWindow *fv, int fType ) : fv(fv)
     QSpinBox        *V;
     QPushButton     *B;
     QCheckBox       *C;
+    QComboBox       *CB;
     QAction         *A;
     QLabel          *L;
 
@@ -148,13 +150,25 @@ FVToolbar::FVToolbar( FileViewerWindow *fv, int fType ) : fv(fv)
 
         L = new QLabel( "-<S>", this );
         L->setTextFormat( Qt::PlainText );
-        L->setToolTip( "Spatially average spike channels" );
+        L->setToolTip( "Spatially reference spike channels" );
         L->setStyleSheet( "padding-bottom: 1px" );
         addWidget( L );
 
+        CB = new QComboBox( this );
+        CB->setToolTip(
+            "Local: mean of sites within radius;"
+            " CAR: mean of all sites; CMR: median of all sites" );
+        CB->addItem( "Off" );
+        CB->addItem( "Local" );
+        CB->addItem( "CAR" );
+        CB->addItem( "CMR" );
+        CB->setCurrentIndex( fv->tbGetSAveSel() );
+        ConnectUI( CB, SIGNAL(currentIndexChanged(int)), fv, SLOT(tbSAveSelChanged(int)) );
+        addWidget( CB );
+
         V = new QSpinBox( this );
-        V->setToolTip( "Averaging radius: {N electrodes, 0=OFF}" );
-        V->setMinimum( 0 );
+        V->setToolTip( "Local averaging radius: {N electrodes}" );
+        V->setMinimum( 1 );
         V->setMaximum( 400 );
         V->setValue( fv->tbGetSAveRad() );
         ConnectUI( V, SIGNAL(valueChanged(int)), fv, SLOT(tbSAveRadChanged(int)) );
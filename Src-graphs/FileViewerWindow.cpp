@@ -16,7 +16,6 @@
 #include "DataFileIMLF.h"
 #include "DataFileNI.h"
 #include "MGraph.h"
-#include "Biquad.h"
 #include "ExportCtl.h"
 #include "ClickableLabel.h"
 #include "Subset.h"
@@ -55,46 +54,6 @@ public:
     int tag() const         {return mtag;}
 };
 
-/* ---------------------------------------------------------------- */
-/* class DCAve ---------------------------------------------------- */
-/* ---------------------------------------------------------------- */
-
-void FileViewerWindow::DCAve::init( int nChannels, int nNeural )
-{
-    nC      = nChannels;
-    nN      = nNeural;
-    lvlOk   = false;
-    lvl.fill( 0, nN );
-}
-
-
-void FileViewerWindow::DCAve::updateLvl(
-    const qint16    *d,
-    int             ntpts,
-    int             dwnSmp )
-{
-    if( lvlOk || !nN )
-        return;
-
-    sum.fill( 0.0F, nN );
-
-    int     *L      = &lvl[0];
-    float   *S      = &sum[0];
-    int     dStep   = nC * dwnSmp,
-            dtpts   = (ntpts + dwnSmp - 1) / dwnSmp;
-
-    for( int it = 0; it < ntpts; it += dwnSmp, d += dStep ) {
-
-        for( int ic = 0; ic < nN; ++ic )
-            S[ic] += d[ic];
-    }
-
-    for( int ic = 0; ic < nN; ++ic )
-        L[ic] = S[ic]/dtpts;
-
-    lvlOk = true;
-}
-
 /* ---------------------------------------------------------------- */
 /* Statics -------------------------------------------------------- */
 /* ---------------------------------------------------------------- */
@@ -109,8 +68,8 @@ QVector<FVLink> FileViewerWindow::vlnk;
 
 FileViewerWindow::FileViewerWindow()
     :   QMainWindow(0), tMouseOver(-1.0), yMouseOver(-1.0),
-        df(0), shankMap(0), chanMap(0), hipass(0),
-        igSelected(-1), igMaximized(-1), igMouseOver(-1),
+        df(0), shankMap(0), chanMap(0), prefetch(0),
+        igSelected(-1), igMaximized(-1), igMouseOver(-1), refGen(0),
         didLayout(false), selDrag(false), zoomDrag(false)
 {
     initDataIndepStuff();
@@ -133,8 +92,8 @@ FileViewerWindow::~FileViewerWindow()
     if( chanMap )
         delete chanMap;
 
-    if( hipass )
-        delete hipass;
+    if( prefetch )
+        delete prefetch;
 }
 
 
@@ -166,7 +125,6 @@ bool FileViewerWindow::viewFile( const QString &fname, QString *errMsg )
     addToolBar( tbar = new FVToolbar( this, fType ) );
     scanGrp->setRanges( true );
     scanGrp->enableManualUpdate( sav.all.manualUpdate );
-    initHipass();
 
 // --------------------------
 // Manage previous array data
@@ -193,8 +151,9 @@ bool FileViewerWindow::viewFile( const QString &fname, QString *errMsg )
     grfVisBits.fill( true, nG );
 
     initGraphs();
+    initPrefetch();
 
-    sAveTable( tbGetSAveRad() );
+    sAveTable();
 
 // ---------------
 // Initialize view
@@ -344,6 +303,20 @@ void FileViewerWindow::tbHipassClicked( bool b )
 }
 
 
+void FileViewerWindow::tbSAveSelChanged( int sel )
+{
+    if( fType < 2 )
+        sav.im.sAveSel = sel;
+    else
+        sav.ni.sAveSel = sel;
+
+    saveSettings();
+
+    sAveTable();
+    updateGraphs();
+}
+
+
 void FileViewerWindow::tbSAveRadChanged( int radius )
 {
     if( fType < 2 )
@@ -353,7 +326,7 @@ void FileViewerWindow::tbSAveRadChanged( int radius )
 
     saveSettings();
 
-    sAveTable( radius );
+    sAveTable();
     updateGraphs();
 }
 
@@ -1631,13 +1604,47 @@ bool FileViewerWindow::openFile( const QString &fname, QString *errMsg )
 }
 
 
-void FileViewerWindow::initHipass()
+// The prefetcher reads through its own DataFile object
+// so it never shares a file position with the GUI thread.
+//
+void FileViewerWindow::initPrefetch()
 {
-    if( hipass )
-        delete hipass;
+    if( prefetch ) {
+        delete prefetch;
+        prefetch = 0;
+    }
+
+    curWin      = FVWinKey();
+    shownWin    = FVWinKey();
+
+    DataFile    *dfr;
+
+    switch( fType ) {
+        case 0:  dfr = new DataFileIMAP( df->probeNum() ); break;
+        case 1:  dfr = new DataFileIMLF( df->probeNum() ); break;
+        default: dfr = new DataFileNI;
+    }
+
+    if( !dfr->openForRead( df->binFileName() ) ) {
+
+        Error() << "FileViewer can't open prefetch reader.";
+        delete dfr;
+        return;
+    }
+
+    int             nG = grfY.size();
+    QVector<int>    usrType( nG );
+
+    for( int ig = 0; ig < nG; ++ig )
+        usrType[ig] = grfY[ig].usrType;
 
-    hipass =
-    new Biquad( bq_type_highpass, 300.0 / df->samplingRateHz() );
+    prefetch = new FVPrefetch(
+                    dfr, usrType, nNeurChans, nSpikeChans,
+                    (fType < 2 ? MAX10BIT : MAX16BIT) );
+
+    ConnectUI(
+        prefetch->getWorker(), SIGNAL(windowReady()),
+        this, SLOT(prefetchReady()) );
 }
 
 
@@ -1804,6 +1811,8 @@ void FileViewerWindow::loadSettings()
     sav.im.ySclAp       = settings.value( "ySclAp", 1.0 ).toDouble();
     sav.im.ySclLf       = settings.value( "ySclLf", 1.0 ).toDouble();
     sav.im.sAveRad      = settings.value( "sAveRad", 0 ).toInt();
+    sav.im.sAveSel      = settings.value( "sAveSel", int(sav.im.sAveRad > 0) ).toInt();
+    sav.im.sAveRad      = qMax( sav.im.sAveRad, 1 );
     sav.im.dcChkOnAp    = settings.value( "dcChkOnAp", true ).toBool();
     sav.im.dcChkOnLf    = settings.value( "dcChkOnLf", true ).toBool();
     sav.im.binMaxOn     = settings.value( "binMaxOn", false ).toBool();
@@ -1816,6 +1825,8 @@ void FileViewerWindow::loadSettings()
     settings.beginGroup( "FileViewer_Nidq" );
     sav.ni.ySclNeu      = settings.value( "ySclNeu", 1.0 ).toDouble();
     sav.ni.sAveRad      = settings.value( "sAveRad", 0 ).toInt();
+    sav.ni.sAveSel      = settings.value( "sAveSel", int(sav.ni.sAveRad > 0) ).toInt();
+    sav.ni.sAveRad      = qMax( sav.ni.sAveRad, 1 );
     sav.ni.bp300Hz      = settings.value( "bp300Hz", true ).toBool();
     sav.ni.dcChkOn      = settings.value( "dcChkOn", true ).toBool();
     sav.ni.binMaxOn     = settings.value( "binMaxOn", false ).toBool();
@@ -1858,6 +1869,7 @@ void FileViewerWindow::saveSettings() const
 
         if( fType == 0 ) {
             settings.setValue( "ySclAp", sav.im.ySclAp );
+            settings.setValue( "sAveSel", sav.im.sAveSel );
             settings.setValue( "sAveRad", sav.im.sAveRad );
             settings.setValue( "dcChkOnAp", sav.im.dcChkOnAp );
             settings.setValue( "binMaxOn", sav.im.binMaxOn );
@@ -1877,6 +1889,7 @@ void FileViewerWindow::saveSettings() const
 
         settings.beginGroup( "FileViewer_Nidq" );
         settings.setValue( "ySclNeu", sav.ni.ySclNeu );
+        settings.setValue( "sAveSel", sav.ni.sAveSel );
         settings.setValue( "sAveRad", sav.ni.sAveRad );
         settings.setValue( "bp300Hz", sav.ni.bp300Hz );
         settings.setValue( "dcChkOn", sav.ni.dcChkOn );
@@ -2076,88 +2089,21 @@ void FileViewerWindow::toggleMaximized()
 }
 
 
-// For each channel [0,nSpikeChan), calculate an 8-way
-// neighborhood of indices into a timepoint's channels.
-// - The index list excludes the central channel.
-// - The list is sorted for cache friendliness.
+// Build referencing plan for channels [0,nSpikeChans)
+// from current {sAveSel, sAveRad}.
 //
-void FileViewerWindow::sAveTable( int radius )
+void FileViewerWindow::sAveTable()
 {
-    TSM.clear();
+    ++refGen;
 
-    if( !nSpikeChans )
+    if( !nSpikeChans ) {
+        ref.setNone();
         return;
-
-    TSM.resize( nSpikeChans );
-
-    QMap<ShankMapDesc,uint> ISM;
-    shankMap->inverseMap( ISM );
-
-    for( int ic = 0; ic < nSpikeChans; ++ic ) {
-
-        const ShankMapDesc  &E = shankMap->e[ic];
-
-        if( !E.u )
-            continue;
-
-        QVector<int>    &V = TSM[ic];
-
-        int xL  = qMax( int(E.c)  - radius, 0 ),
-            xH  = qMin( uint(E.c) + radius + 1, shankMap->nc ),
-            yL  = qMax( int(E.r)  - radius, 0 ),
-            yH  = qMin( uint(E.r) + radius + 1, shankMap->nr );
-
-        for( int ix = xL; ix < xH; ++ix ) {
-
-            for( int iy = yL; iy < yH; ++iy ) {
-
-                QMap<ShankMapDesc,uint>::iterator   it;
-
-                it = ISM.find( ShankMapDesc( E.s, ix, iy, 1 ) );
-
-                if( it == ISM.end() )
-                    continue;
-
-                int i = it.value();
-
-                // Exclude self
-                // Make zero-based
-
-                if( i != ic )
-                    V.push_back( i );
-            }
-        }
-
-        qSort( V );
-    }
-}
-
-
-// Space and time averaging for value: d_ig = &data[ig].
-//
-int FileViewerWindow::s_t_Ave( const qint16 *d_ig, int ig )
-{
-    const QVector<int>  &V = TSM[ig];
-    const int           *L = &dc.lvl[0];
-
-    int sum = 0,
-        nv  = V.size();
-
-    if( nv ) {
-
-        const qint16    *d = d_ig - ig;
-
-        for( int iv = 0; iv < nv; ++iv ) {
-
-            int k = V[iv];
-
-            sum += d[k] - L[k];
-        }
-
-        return *d_ig - sum/nv - L[ig];
     }
 
-    return *d_ig - L[ig];
+    ref.setSel(
+        *shankMap, 0, nSpikeChans,
+        tbGetSAveSel(), tbGetSAveRad() );
 }
 
 
@@ -2204,275 +2150,131 @@ void FileViewerWindow::zoomTime()
 /* updateGraphs --------------------------------------------------- */
 /* ---------------------------------------------------------------- */
 
-#define MAX10BIT    512
-#define MAX16BIT    32768
-
-
 // Notes:
 //
-// - User has random access to file data, and if filter is enabled,
-// the first xflt data points of any block would ordinarily show a
-// transient artifact. Therefore, we will always load an extra xflt
-// scans, process the larger block, and trim the lead portion off
-// when passing ybuf data to graph.
+// - All file reading and processing is done by the prefetch thread
+// (see FVPrefetch). Here we only name the view we want, and the
+// views likely to follow, then compose graphs from the prepared
+// window, now if it's cached, else when prefetchReady() fires.
 //
-// - The code is simpler if we load a timespan, then process the
-// data channel-by-channel. That is, we go over all the timepoints
-// again and again. However, if the span is large this causes lots
-// of memory paging and that's very slow.
-//
-// - Rather, we treat a long span as several short chunks. We have to
-// retain state data for filters and DC calcs across chunks.
+// - User has random access to file data, and if filter is enabled,
+// the first BIQUAD_TRANS_WIDE data points of any block would
+// ordinarily show a transient artifact. Filtered data therefore
+// come from an FVFltCache, which filters the file on a fixed chunk
+// grid, carrying filter state from each chunk into the next (or
+// warming up on the preceding scans), and keeps the results.
 //
 void FileViewerWindow::updateGraphs()
 {
-// -------------
-// Channel setup
-// -------------
-
-    double  ysc,
-            srate   = df->samplingRateHz();
-    int     maxInt  = (fType < 2 ? MAX10BIT : MAX16BIT),
-            nG      = df->numChans(),
-            nVis    = grfVisBits.count( true );
-
-    ysc = 1.0 / maxInt;
-
-    QVector<uint>   iv2ig;
-
-    Subset::bits2Vec( iv2ig, grfVisBits );
+    if( !prefetch )
+        return;
 
 // -----------
 // Scans setup
 // -----------
 
-    qint64  pos     = scanGrp->curPos(),
-            xpos, num2Read;
-    int     xflt    = qMin( (qint64)BIQUAD_TRANS_WIDE, pos ),
-            dwnSmp;
-    bool    drawBinMax;
+    FVWinParams P;
+    FVWinKey    &K      = P.K;
+    double      srate   = df->samplingRateHz();
 
-    xpos        = pos - xflt;
-    num2Read    = xflt + sav.all.xSpan * srate;
-    dwnSmp      = num2Read / (2 * mscroll->viewport()->width());
+    K.pos       = scanGrp->curPos();
+    K.num2Read  = sav.all.xSpan * srate;
+    K.dwnSmp    = K.num2Read / (2 * mscroll->viewport()->width());
 
 // Note: dwnSmp oversamples by 2X.
 
-    if( dwnSmp < 1 )
-        dwnSmp = 1;
-
-    drawBinMax = tbGetBinMaxOn() && dwnSmp > 1;
+    if( K.dwnSmp < 1 )
+        K.dwnSmp = 1;
 
-// -----------
-// Size graphs
-// -----------
-
-    if( xpos >= dfCount )
+    if( K.pos >= dfCount )
         return;
 
-    qint64  ntpts   = qMin( num2Read, dfCount - xpos ),
-            dtpts   = (ntpts + dwnSmp - 1) / dwnSmp,
-            gtpts   = (ntpts - xflt + dwnSmp - 1) / dwnSmp,
-            xoff    = dtpts - gtpts;
-
-    for( int iv = 0; iv < nVis; ++iv )
-        grfY[iv2ig[iv]].resize( gtpts );
-
-    mscroll->theX->initVerts( gtpts );
-
-// -----------------
-// Pick a chunk size
-// -----------------
-
-// nominally 1 second's worth, but a multiple of dwnSmp
-
-    qint64  chunk = int(srate/dwnSmp) * dwnSmp;
-
-// ------------
-// Filter setup
-// ------------
-
-    hipass->clearMem();
-
-    dc.init( nG, nNeurChans );
-
-// --------------
-// Process chunks
-// --------------
-
-    qint64  nRem = num2Read;
-
-    for(;;) {
-
-        if( nRem <= 0 )
-            break;
-
-        // ---------------
-        // Read this block
-        // ---------------
-
-        vec_i16 data;
-        qint64  nthis = qMin( chunk, nRem );
-
-        ntpts = df->readScans( data, xpos, nthis, QBitArray() );
+    if( tbGetBinMaxOn() && K.dwnSmp > 1 )
+        K.flags |= FVWinKey::fBinMax;
 
-        if( ntpts <= 0 )
-            break;
-
-        // advance for next block
-
-        xpos    += ntpts;
-        nRem    -= ntpts;
-
-        // ------
-        // Filter
-        // ------
-
-        if( tbGet300HzOn() ) {
-            hipass->applyBlockwiseMem(
-                    &data[0], maxInt, ntpts, nG, 0, nSpikeChans );
-        }
-
-        if( tbGetDCChkOn() )
-            dc.updateLvl( &data[0], ntpts, dwnSmp );
-
-        // -------------
-        // Result buffer
-        // -------------
-
-        dtpts = (ntpts + dwnSmp - 1) / dwnSmp;
-
-        QVector<float>  ybuf( dtpts ),
-                        ybuf2( drawBinMax ? dtpts : 0 );
+    if( tbGet300HzOn() )
+        K.flags |= FVWinKey::f300Hz;
 
-        // -------------------------
-        // For each shown channel...
-        // -------------------------
+    if( tbGetDCChkOn() )
+        K.flags |= FVWinKey::fDCChk;
 
-        for( int iv = 0; iv < nVis; ++iv ) {
+    K.refGen    = refGen;
+    P.ref       = ref;
 
-            int     ig      = iv2ig[iv],
-                    dstep   = dwnSmp * nG,
-                    ny      = 0;
-            qint16  *d      = &data[ig];
+// -----------------------------
+// Neighbors in scroll direction
+// -----------------------------
 
-            if( grfY[ig].usrType == 0 ) {
+// Arrow and page key steps, then a whole span; positions
+// computed exactly as eventFilter() and FVScanGrp do.
 
-                // ---------------
-                // Neural channels
-                // ---------------
+    QVector<qint64> next;
+    double          span    = nScansPerGraph(),
+                    step[3] = {sav.all.fArrowKey, sav.all.fPageKey, 1.0};
+    qint64          maxPos  = scanGrp->maxPos();
+    int             dir     = (K.pos < curWin.pos ? -1 : 1);
 
-                // -------------------
-                // Neural downsampling
-                // -------------------
+    for( int i = 0; i < 3; ++i ) {
 
-                // Within each bin, report both max and min
-                // values. This ensures spikes aren't missed.
-                // Max in ybuf, min in ybuf2.
+        qint64  p = qBound(
+                        0LL, qint64(K.pos + dir * step[i] * span), maxPos );
 
-                if( drawBinMax ) {
-
-                    int ndRem = ntpts;
-
-                    grfY[ig].drawBinMax = true;
-
-                    for( int it = 0; it < ntpts; it += dwnSmp ) {
-
-                        qint16  *Dmax   = d,
-                                *Dmin   = d;
-                        int     vmax    = *d,
-                                vmin    = vmax,
-                                binWid  = dwnSmp;
-
-                        d += nG;
-
-                        if( ndRem < binWid )
-                            binWid = ndRem;
-
-                        for( int ib = 1; ib < binWid; ++ib, d += nG ) {
-
-                            if( *d > vmax ) {
-                                vmax    = *d;
-                                Dmax    = d;
-                            }
-                            else if( *d < vmin ) {
-                                vmin    = *d;
-                                Dmin    = d;
-                            }
-                        }
+        if( p != K.pos && !next.contains( p ) )
+            next.push_back( p );
+    }
 
-                        ndRem -= binWid;
+// -------
+// Request
+// -------
 
-                        if( tbGetSAveRad() ) {
-                            ybuf[ny]  = s_t_Ave( Dmax, ig ) * ysc;
-                            ybuf2[ny] = s_t_Ave( Dmin, ig ) * ysc;
-                        }
-                        else {
-                            ybuf[ny]  = (*Dmax - dc.lvl[ig]) * ysc;
-                            ybuf2[ny] = (*Dmin - dc.lvl[ig]) * ysc;
-                        }
+    curWin      = K;
+    shownWin    = FVWinKey();
 
-                        ++ny;
-                    }
+    prefetch->request( P, next );
+    prefetchReady();
+}
 
-                    grfY[ig].yval2.putData( &ybuf2[xoff], dtpts - xoff );
-                }
-                else if( tbGetSAveRad() ) {
 
-                    grfY[ig].drawBinMax = false;
+// Compose graphs from prepared window, if it's the one wanted.
+//
+void FileViewerWindow::prefetchReady()
+{
+    if( !prefetch || curWin == shownWin )
+        return;
 
-                    for( int it = 0; it < ntpts; it += dwnSmp, d += dstep )
-                        ybuf[ny++] = s_t_Ave( d, ig ) * ysc;
-                }
-                else {
+    const FVWindow  *W = prefetch->lockWindow( curWin );
 
-                    grfY[ig].drawBinMax = false;
+    if( !W )
+        return;
 
-                    for( int it = 0; it < ntpts; it += dwnSmp, d += dstep )
-                        ybuf[ny++] = (*d - dc.lvl[ig]) * ysc;
-                }
-            }
-            else if( grfY[ig].usrType == 1 ) {
+    QVector<uint>   iv2ig;
+    int             nPts = W->nPts;
 
-                if( fType == 1 ) {
+    Subset::bits2Vec( iv2ig, grfVisBits );
 
-                    // -----------
-                    // LF channels
-                    // -----------
+    for( int iv = 0, nVis = iv2ig.size(); iv < nVis; ++iv ) {
 
-                    for( int it = 0; it < ntpts; it += dwnSmp, d += dstep )
-                        ybuf[ny++] = (*d - dc.lvl[ig]) * ysc;
-                }
-                else {
+        int     ig  = iv2ig[iv];
+        MGraphY &Y  = grfY[ig];
 
-                    // ------------
-                    // Aux channels
-                    // ------------
+        Y.resize( nPts );
 
-                    for( int it = 0; it < ntpts; it += dwnSmp, d += dstep )
-                        ybuf[ny++] = *d * ysc;
-                }
-            }
-            else {
+        if( Y.usrType == 0 ) {
 
-                // -------
-                // Digital
-                // -------
+            Y.drawBinMax = W->binMax;
 
-                for( int it = 0; it < ntpts; it += dwnSmp, d += dstep )
-                    ybuf[ny++] = *d;
-            }
+            if( W->binMax )
+                Y.yval2.putData( &W->y2[ig * nPts], nPts );
+        }
 
-            // -------------
-            // Copy to graph
-            // -------------
+        Y.yval.putData( &W->y[ig * nPts], nPts );
+    }
 
-            grfY[ig].yval.putData( &ybuf[xoff], dtpts - xoff );
-        }
+    prefetch->unlockWindow();
 
-        xoff = 0;   // only first chunk includes offset
+    mscroll->theX->initVerts( nPts );
 
-    }   // end chunks
+    shownWin = curWin;
 
 // -----------------
 // Select and redraw
@@ -1,6 +1,8 @@
 #ifndef FILEVIEWERWINDOW_H
 #define FILEVIEWERWINDOW_H
 
+#include "FVPrefetch.h"
+
 #include <QMainWindow>
 #include <QBitArray>
 
@@ -12,7 +14,6 @@ struct ShankMap;
 struct ChanMap;
 class MGraphY;
 class MGScroll;
-class Biquad;
 class ExportCtl;
 class TaggableLabel;
 
@@ -57,7 +58,8 @@ private:
     struct SaveIm {
         double  ySclAp,
                 ySclLf;
-        int     sAveRad;
+        int     sAveSel,
+                sAveRad;
         bool    dcChkOnAp,
                 dcChkOnLf,
                 binMaxOn;
@@ -65,7 +67,8 @@ private:
 
     struct SaveNi {
         double  ySclNeu;
-        int     sAveRad;
+        int     sAveSel,
+                sAveRad;
         bool    bp300Hz,
                 dcChkOn,
                 binMaxOn;
@@ -84,26 +87,9 @@ private:
         GraphParams() : gain(1.0)   {}
     };
 
-    class DCAve {
-    private:
-        QVector<float>  sum;
-        int             nC,
-                        nN;
-        bool            lvlOk;
-    public:
-        QVector<int>    lvl;
-    public:
-        void init( int nChannels, int nNeural );
-        void updateLvl(
-            const qint16    *d,
-            int             ntpts,
-            int             dwnSmp );
-    };
-
     FVToolbar               *tbar;
     FVScanGrp               *scanGrp;
     SaveSet                 sav;
-    DCAve                   dc;
     QString                 cmChanStr;
     double                  tMouseOver,
                             yMouseOver;
@@ -116,7 +102,9 @@ private:
     DataFile                *df;
     ShankMap                *shankMap;
     ChanMap                 *chanMap;
-    Biquad                  *hipass;
+    FVPrefetch              *prefetch;
+    FVWinKey                curWin,             // requested
+                            shownWin;           // composed
     ExportCtl               *exportCtl;
     QMenu                   *channelsMenu;
     MGScroll                *mscroll;
@@ -131,13 +119,14 @@ private:
     QVector<int>            order2ig,           // sort order
                             ig2AcqChan;
     QBitArray               grfVisBits;
-    QVector<QVector<int> >  TSM;
+    Referencer              ref;
     int                     fType,              // {0=imap, 1=imlf, 2=ni}
                             igSelected,         // if >= 0
                             igMaximized,        // if >= 0
                             igMouseOver,        // if >= 0
                             nSpikeChans,
-                            nNeurChans;
+                            nNeurChans,
+                            refGen;             // bumps w/ ref plan
     bool                    didLayout,
                             selDrag,
                             zoomDrag;
@@ -166,6 +155,14 @@ public:
         }
     int     tbGetyPix() const       {return sav.all.yPix;}
     int     tbGetNDivs() const      {return sav.all.nDivs;}
+    int     tbGetSAveSel() const
+        {
+            switch( fType ) {
+                case 0:  return sav.im.sAveSel;
+                case 1:  return 0;
+                default: return sav.ni.sAveSel;
+            }
+        }
     int     tbGetSAveRad() const
         {
             switch( fType ) {
@@ -213,6 +210,7 @@ public slots:
     void tbSetMuxGain( double d );
     void tbSetNDivs( int n );
     void tbHipassClicked( bool b );
+    void tbSAveSelChanged( int sel );
     void tbSAveRadChanged( int radius );
     void tbDcClicked( bool b );
     void tbBinMaxClicked( bool b );
@@ -257,6 +255,9 @@ private slots:
 // Timer targets
     void layoutGraphs();
 
+// Prefetch
+    void prefetchReady();
+
 // Stream linking
     void linkRecvPos( double t0, double tSpan, int fChanged );
     void linkRecvSel( double tL, double tR );
@@ -277,7 +278,7 @@ private:
 
 // Data-dependent inits
     bool openFile( const QString &fname, QString *errMsg );
-    void initHipass();
+    void initPrefetch();
     void killActions();
     void initGraphs();
 
@@ -294,8 +295,7 @@ private:
     void showGraph( int ig );
     void selectGraph( int ig, bool updateGraph = true );
     void toggleMaximized();
-    void sAveTable( int radius );
-    int s_t_Ave( const qint16 *d_ig, int ig );
+    void sAveTable();
     void updateXSel();
     void zoomTime();
     void updateGraphs();
@@ -4,56 +4,157 @@
 #include "AIQ.h"
 #include "SVGrafsM.h"
 
+#include <QGuiApplication>
+#include <QScreen>
 #include <QThread>
 
+#include <algorithm>
+
 
 /* ---------------------------------------------------------------- */
 /* GFWorker ------------------------------------------------------- */
 /* ---------------------------------------------------------------- */
 
-void GFWorker::run()
+// Loop period bounds (secs).
+#define PACE_MAX_SECS   0.25
+#define PACE_IDLE_SECS  0.25
+
+
+// Pool order: most channels first.
+//
+void GFWorker::setStreams( const QVector<GFStream> &gfs )
 {
-    Debug() << "Graph fetching started.";
+    QMutexLocker    ml( &gfsMtx );
 
-    const double    oldestSecs      = 0.1;
-    const int       loopPeriod_us   = 1000 * 100;
+    QVector<QPair<int,int> >    cost;
 
-    while( !isStopped() ) {
+    for( int is = 0, ns = gfs.size(); is < ns; ++is )
+        cost.push_back( QPair<int,int>( -gfs[is].W->chanCount(), is ) );
+
+    std::stable_sort( cost.begin(), cost.end() );
 
-        double  loopT = getTime();
+    order.clear();
 
-        if( !isPaused() ) {
+    for( int is = 0, ns = cost.size(); is < ns; ++is )
+        order.push_back( cost[is].second );
 
-            gfsMtx.lock();
+// Pool threads index gfs concurrently; unshare it now.
+
+    this->gfs = gfs;
+    this->gfs.detach();
+}
 
-            for( int is = 0, ns = gfs.size(); is < ns; ++is )
-                fetch( gfs[is], loopT, oldestSecs );
 
-            gfsMtx.unlock();
+void GFWorker::run()
+{
+    Debug() << "Graph fetching started.";
+
+    while( !isStopped() ) {
+
+        loopT = getTime();
+
+        if( isPaused() ) {
+            usleep( 1e6 * PACE_IDLE_SECS );
+            continue;
         }
 
-        // Fetch no more often than every loopPeriod_us.
+        gfsMtx.lock();
+            fetchAll();
+        gfsMtx.unlock();
 
-        loopT = 1e6*(getTime() - loopT);    // microsec
+        double  dt      = getTime() - loopT,
+                period  = pace( dt );
 
-        if( loopT < loopPeriod_us )
-            usleep( loopPeriod_us - loopT );
+        if( dt < period )
+            usleep( 1e6 * (period - dt) );
         else
             usleep( 1000 * 10 );
     }
 
+    if( pool ) {
+        delete pool;
+        pool = 0;
+    }
+
     Debug() << "Graph fetching stopped.";
 
     emit finished();
 }
 
 
-void GFWorker::fetch( GFStream &S, double loopT, double oldestSecs )
+// Return next loop period, given this fetchAll took (dt) secs.
+//
+double GFWorker::pace( double dt )
+{
+    double  lag = 0,
+            frm;
+
+    busyT = (busyT > 0 ? 0.8*busyT + 0.2*dt : dt);
+
+    gfsMtx.lock();
+        for( int is = 0, ns = gfs.size(); is < ns; ++is )
+            lag = qMax( lag, gfs[is].W->getTheM()->paintLag() );
+    gfsMtx.unlock();
+
+    lagT = lag;
+
+    runMtx.lock();
+        frm = frameSecs;
+    runMtx.unlock();
+
+    return qBound( frm, qMax( 2*busyT, lagT ), PACE_MAX_SECS );
+}
+
+
+// Pool thread: one stream.
+//
+bool GFWorker::poolTask( int is )
+{
+    fetch( gfs[is] );
+    return true;
+}
+
+
+// Caller holds gfsMtx. The pool is (re)sized to the
+// stream count here, on the fetcher thread.
+//
+void GFWorker::fetchAll()
+{
+    int ns = gfs.size();
+
+    if( ns < 2 ) {
+
+        if( ns )
+            fetch( gfs[0] );
+
+        return;
+    }
+
+    if( !pool || poolSize != ns ) {
+
+        if( pool )
+            delete pool;
+
+        pool        = new TrigPool( ns );
+        poolSize    = ns;
+    }
+
+    pool->post( this, order );
+    pool->wait();
+}
+
+
+void GFWorker::fetch( GFStream &S )
 {
     std::vector<AIQ::AIQBlock>  vB;
     double                      testT;
     int                         nb;
 
+    // GUI behind: coalesce into next fetch
+
+    if( S.W->getTheM()->updatePending() )
+        return;
+
     // mapCt2Time fails if nextCt >= curCount
 
     if( S.nextCt && S.nextCt >= S.aiQ->curCount() )
@@ -70,6 +171,10 @@ void GFWorker::fetch( GFStream &S, double loopT, double oldestSecs )
             return;
     }
 
+    // History for graphs drawn again
+
+    backfill( S );
+
     // Fetch from last count
 
     nb = S.aiQ->getAllScansFromCt( vB, S.nextCt );
@@ -97,6 +202,37 @@ void GFWorker::fetch( GFStream &S, double loopT, double oldestSecs )
     S.nextCt = S.aiQ->nextCt( data, vB );
 }
 
+
+
+// If graphs want backfill, hand them what the queue still holds
+// of the span ending at nextCt (possibly nothing, which just
+// clears their request).
+//
+void GFWorker::backfill( GFStream &S )
+{
+    int nbf = S.W->backfillTpts();
+
+    if( !nbf )
+        return;
+
+    std::vector<AIQ::AIQBlock>  vB;
+    vec_i16                     cat;
+    vec_i16                     *data   = &cat;
+    quint64                     fromCt  = S.aiQ->qHeadCt();
+
+    if( S.nextCt > fromCt + nbf )
+        fromCt = S.nextCt - nbf;
+
+    if( S.nextCt > fromCt
+        && S.aiQ->getNScansFromCt( vB, fromCt, S.nextCt - fromCt ) ) {
+
+        if( !S.aiQ->catBlocks( data, cat, vB ) )
+            data = &cat;
+    }
+
+    S.W->putBackfill( *data );
+}
+
 /* ---------------------------------------------------------------- */
 /* GraphFetcher --------------------------------------------------- */
 /* ---------------------------------------------------------------- */
@@ -106,6 +242,11 @@ GraphFetcher::GraphFetcher()
     thread  = new QThread;
     worker  = new GFWorker();
 
+    QScreen *scr = QGuiApplication::primaryScreen();
+
+    if( scr && scr->refreshRate() >= 10 )
+        worker->setFrameSecs( 1.0 / scr->refreshRate() );
+
     worker->moveToThread( thread );
 
     Connect( thread, SIGNAL(started()), worker, SLOT(run()) );
@@ -1,6 +1,8 @@
 #ifndef GRAPHFETCHER_H
 #define GRAPHFETCHER_H
 
+#include "TrigPool.h"
+
 #include <QObject>
 #include <QMutex>
 #include <QVector>
@@ -24,27 +26,48 @@ struct GFStream {
         :   stream(stream), W(W), aiQ(0), nextCt(0) {}
 };
 
-class GFWorker : public QObject
+// Each stream's fetch and putScans() is an independent task on
+// a TrigPool, largest streams first; the fetch loop just waits
+// for all to finish. Streams draw into separate SVGrafsM, so the
+// refresh rate holds as probes are added (up to core count).
+//
+// Pacing: the loop period tracks the display, from one frame up,
+// lengthened to keep fetching under half the thread's time and
+// to match how long the GUI takes to paint what it was given. A
+// stream whose graph hasn't yet painted its last block is skipped;
+// its data coalesce into the next fetch. Paused, the loop idles.
+//
+class GFWorker : public QObject, public TrigPoolTask
 {
     Q_OBJECT
 
 private:
     QVector<GFStream>   gfs;
+    QVector<int>        order;
+    TrigPool            *pool;
     mutable QMutex      gfsMtx,
                         runMtx;
+    double              loopT,
+                        oldestSecs,
+                        frameSecs,
+                        busyT,      // avg fetchAll secs
+                        lagT;       // avg graph paint lag
+    int                 poolSize;
     volatile bool       hardPaused, // Pause button
                         softPaused, // Window state
                         pleaseStop;
 
 public:
     GFWorker()
-    :   QObject(0),
+    :   QObject(0), pool(0), loopT(0), oldestSecs(0.1),
+        frameSecs(1.0/60), busyT(0), lagT(0), poolSize(0),
         hardPaused(false), softPaused(false),
         pleaseStop(false)                   {}
     virtual ~GFWorker()                     {}
 
-    void setStreams( const QVector<GFStream> &gfs )
-        {QMutexLocker ml( &gfsMtx ); this->gfs = gfs;}
+    void setStreams( const QVector<GFStream> &gfs );
+    void setFrameSecs( double secs )
+        {QMutexLocker ml( &runMtx ); frameSecs = secs;}
 
     void hardPause( bool pause )
         {QMutexLocker ml( &runMtx ); hardPaused = pause;}
@@ -56,6 +79,8 @@ public:
     void stop()             {QMutexLocker ml( &runMtx ); pleaseStop = true;}
     bool isStopped() const  {QMutexLocker ml( &runMtx ); return pleaseStop;}
 
+    virtual bool poolTask( int is );
+
 signals:
     void finished();
 
@@ -63,7 +88,10 @@ public slots:
     void run();
 
 private:
-    void fetch( GFStream &S, double loopT, double oldestSecs );
+    double pace( double dt );
+    void fetchAll();
+    void fetch( GFStream &S );
+    void backfill( GFStream &S );
 };
 
 
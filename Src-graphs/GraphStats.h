@@ -18,6 +18,10 @@ public:
     GraphStats()                {clear();}
     void clear()                {s1 = s2 = num = 0;}
     inline void add( double v ) {s1 += v, s2 += v*v, ++num;}
+    inline void addSums( double S1, double S2, uint n )
+        {s1 += S1, s2 += S2, num += n;}
+    double sum() const  {return s1;}
+    uint count() const  {return num;}
     double mean() const {return (num > 1 ? s1/num : s1);}
     double rms() const;
     double stdDev() const;
@@ -9,6 +9,7 @@
 #include "SView.h"
 #include "SVGrafsM_Im.h"
 #include "SVGrafsM_Ni.h"
+#include "SpikeRaster.h"
 #include "ColorTTLCtl.h"
 #include "ConfigCtl.h"
 
@@ -56,7 +57,7 @@ static void visibleGrabHandle( QSplitter *sp )
 
 
 GraphsWindow::GraphsWindow( const DAQ::Params &p )
-    :   QMainWindow(0), p(p), imW(0), niW(0), TTLCC(0)
+    :   QMainWindow(0), p(p), imW(0), niW(0), rasW(0), TTLCC(0)
 {
 // Install widgets
 
@@ -77,7 +78,21 @@ GraphsWindow::GraphsWindow( const DAQ::Params &p )
     visibleGrabHandle( sp );
 #endif
 
-    setCentralWidget( sp );
+// Spike raster for all probes below streams
+
+    if( p.im.enabled ) {
+
+        QSplitter   *vs = new QSplitter;
+        vs->setOrientation( Qt::Vertical );
+        vs->addWidget( sp );
+        vs->addWidget( rasW = new SpikeRaster( this, p ) );
+        vs->setStretchFactor( 0, 3 );
+        vs->setStretchFactor( 1, 1 );
+
+        setCentralWidget( vs );
+    }
+    else
+        setCentralWidget( sp );
 
 // Equal size above and below
 
@@ -125,7 +140,21 @@ void GraphsWindow::initGFStreams()
     if( niW )
         gfs.push_back( GFStream( "nidq", niW ) );
 
-    mainApp()->getRun()->grfSetStreams( gfs );
+    Run *run = mainApp()->getRun();
+
+    run->grfSetStreams( gfs );
+
+    if( rasW )
+        rasW->start( run->getProbeAct() );
+}
+
+
+// Raster takes from the run's ProbeActivity: detach before it goes.
+//
+void GraphsWindow::stopRaster()
+{
+    if( rasW )
+        rasW->stop();
 }
 
 
@@ -276,6 +305,20 @@ void GraphsWindow::tbSetRecordingEnabled( bool checked )
     run->dfSetRecordingEnabled( checked );
 }
 
+
+void GraphsWindow::tbSetRasterPaused( bool paused )
+{
+    if( rasW )
+        rasW->hardPause( paused );
+}
+
+
+void GraphsWindow::tbShowRaster( bool show )
+{
+    if( rasW )
+        rasW->setVisible( show );
+}
+
 /* ---------------------------------------------------------------- */
 /* Protected ------------------------------------------------------ */
 /* ---------------------------------------------------------------- */
@@ -364,12 +407,22 @@ void GraphsWindow::changeEvent( QEvent *e )
 
         if( wsce->oldState() & Qt::WindowMinimized ) {
 
-            if( !(windowState() & Qt::WindowMinimized) )
+            if( !(windowState() & Qt::WindowMinimized) ) {
+
                 mainApp()->getRun()->grfSoftPause( false );
+
+                if( rasW )
+                    rasW->softPause( false );
+            }
         }
         else {
-            if( windowState() & Qt::WindowMinimized )
+            if( windowState() & Qt::WindowMinimized ) {
+
                 mainApp()->getRun()->grfSoftPause( true );
+
+                if( rasW )
+                    rasW->softPause( true );
+            }
         }
     }
 
@@ -401,6 +454,9 @@ void GraphsWindow::saveScreenState()
 
     settings.setValue( "WinLayout_Graphs/geometry", saveGeometry() );
     settings.setValue( "WinLayout_Graphs/windowState", saveState() );
+
+    if( rasW )
+        settings.setValue( "WinLayout_Graphs/raster", !rasW->isHidden() );
 }
 
 
@@ -416,6 +472,14 @@ void GraphsWindow::restoreScreenState()
 
         resize( 1280, 768 );
     }
+
+    if( rasW ) {
+
+        bool    on = settings.value( "WinLayout_Graphs/raster" ).toBool();
+
+        rasW->setHidden( !on );
+        tbar->setRasterShown( on );
+    }
 }
 
 
@@ -11,6 +11,7 @@ class RunToolbar;
 class GWLEDWidget;
 class SVGrafsM_Im;
 class SVGrafsM_Ni;
+class SpikeRaster;
 class ColorTTLCtl;
 
 /* ---------------------------------------------------------------- */
@@ -36,6 +37,7 @@ private:
     GWLEDWidget         *LED;
     SVGrafsM_Im         *imW;
     SVGrafsM_Ni         *niW;
+    SpikeRaster         *rasW;
     ColorTTLCtl         *TTLCC;
 
 public:
@@ -46,6 +48,7 @@ public:
 
 // Run
     void initGFStreams();
+    void stopRaster();
     void eraseGraphs();
 
 public slots:
@@ -68,6 +71,8 @@ public slots:
 
 // Toolbar
     void tbSetRecordingEnabled( bool checked );
+    void tbSetRasterPaused( bool paused );
+    void tbShowRaster( bool show );
 
 protected:
     virtual bool eventFilter( QObject *watched, QEvent *event );
@@ -0,0 +1,292 @@
+
+#include "MGTraceGL.h"
+#include "MGraph.h"
+#include "Util.h"
+
+#include <QOpenGLBuffer>
+#include <QOpenGLContext>
+#include <QOpenGLShaderProgram>
+#include <QVector4D>
+
+#ifndef QT_OPENGL_ES_2
+#include <QOpenGLFunctions_3_0>
+#endif
+
+
+#define STR( s )    #s
+#define XSTR( s )   STR( s )
+
+// uGeom: {y0, scl, binMax, 0}.
+//
+static const char *vsrc =
+    "#version 130\n"
+    "#define BATCH " XSTR( MGTRACE_BATCH ) "\n"
+    "in float   aY;\n"
+    "uniform int    uStride;\n"
+    "uniform int    uBase;\n"
+    "uniform vec4   uGeom[BATCH];\n"
+    "uniform vec4   uClr[BATCH];\n"
+    "out vec4   vClr;\n"
+    "void main()\n"
+    "{\n"
+    "    int    s = gl_VertexID / uStride,\n"
+    "           k = gl_VertexID - s * uStride;\n"
+    "    vec4   G = uGeom[s - uBase];\n"
+    "    float  x = (G.z > 0.5 ? float(k / 2) : float(k));\n"
+    "    vClr        = uClr[s - uBase];\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix\n"
+    "                    * vec4( x, G.x + G.y * aY, 0.0, 1.0 );\n"
+    "}\n";
+
+static const char *fsrc =
+    "#version 130\n"
+    "in vec4    vClr;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_FragColor = vClr;\n"
+    "}\n";
+
+/* ---------------------------------------------------------------- */
+/* MGTraceGL ------------------------------------------------------ */
+/* ---------------------------------------------------------------- */
+
+MGTraceGL::MGTraceGL()
+    :   f(0), prog(0), vbo(0), stride(0),
+        locY(-1), locStride(-1), locBase(-1), locGeom(-1), locClr(-1),
+        ok(false)
+{
+#ifndef QT_OPENGL_ES_2
+    QOpenGLContext  *ctx = QOpenGLContext::currentContext();
+
+    if( !ctx )
+        return;
+
+    f = ctx->versionFunctions<QOpenGLFunctions_3_0>();
+
+    if( !f || !f->initializeOpenGLFunctions() ) {
+        Log() << "MGraph: GL 3.0 unavailable; using client arrays.";
+        return;
+    }
+
+    // aY at generic attribute 0 (aliases gl_Vertex); MGraph's
+    // client vertex array is off while the shader draws.
+
+    prog = new QOpenGLShaderProgram;
+    prog->bindAttributeLocation( "aY", 0 );
+
+    if( !prog->addShaderFromSourceCode( QOpenGLShader::Vertex, vsrc )
+        || !prog->addShaderFromSourceCode( QOpenGLShader::Fragment, fsrc )
+        || !prog->link() ) {
+
+        Warning() << "MGraph shader failed: " << prog->log();
+        return;
+    }
+
+    locY        = 0;
+    locStride   = prog->uniformLocation( "uStride" );
+    locBase     = prog->uniformLocation( "uBase" );
+    locGeom     = prog->uniformLocation( "uGeom" );
+    locClr      = prog->uniformLocation( "uClr" );
+
+    vbo = new QOpenGLBuffer( QOpenGLBuffer::VertexBuffer );
+    vbo->setUsagePattern( QOpenGLBuffer::DynamicDraw );
+
+    ok = vbo->create();
+#endif
+}
+
+
+MGTraceGL::~MGTraceGL()
+{
+    if( vbo )
+        delete vbo;
+
+    if( prog )
+        delete prog;
+}
+
+
+void MGTraceGL::draw( const MGraphX &X, const QVector<Trace> &vT )
+{
+#ifndef QT_OPENGL_ES_2
+    int nT = vT.size();
+
+    if( !ok || !nT )
+        return;
+
+// ------
+// Upload
+// ------
+
+    uint    cap = 0;
+
+    for( int it = 0; it < nT; ++it )
+        cap = qMax( cap, X.Y[vT[it].iy]->yval.capacity() );
+
+    if( !cap )
+        return;
+
+    layout( X.Y.size(), cap );
+
+    vbo->bind();
+
+    for( int it = 0; it < nT; ++it )
+        upload( vT[it].iy, X.Y[vT[it].iy] );
+
+// ----
+// Draw
+// ----
+
+    QVector4D   geom[MGTRACE_BATCH],
+                clr[MGTRACE_BATCH];
+    GLint       first[MGTRACE_BATCH];
+    GLsizei     count[MGTRACE_BATCH];
+
+    prog->bind();
+    prog->setUniformValue( locStride, stride );
+
+    f->glDisableClientState( GL_VERTEX_ARRAY );
+    f->glEnableVertexAttribArray( locY );
+    f->glVertexAttribPointer( locY, 1, GL_FLOAT, GL_FALSE, 0, 0 );
+
+    for( int it = 0; it < nT; ) {
+
+        int b   = vT[it].iy / MGTRACE_BATCH,
+            n   = 0;
+
+        for( ; it < nT && vT[it].iy / MGTRACE_BATCH == b; ++it, ++n ) {
+
+            const Trace     &T  = vT[it];
+            const MGraphY   *Y  = X.Y[T.iy];
+            const QColor    &C  = X.yColor[Y->iclr];
+            int             j   = T.iy - b * MGTRACE_BATCH;
+
+            geom[j] = QVector4D( T.y0, T.scl, Y->drawBinMax, 0 );
+            clr[j]  = QVector4D( C.redF(), C.greenF(), C.blueF(), C.alphaF() );
+
+            first[n] = T.iy * stride;
+            count[n] = (Y->drawBinMax ? 2 : 1) * Y->yval.capacity();
+        }
+
+        prog->setUniformValue( locBase, b * MGTRACE_BATCH );
+        prog->setUniformValueArray( locGeom, geom, MGTRACE_BATCH );
+        prog->setUniformValueArray( locClr, clr, MGTRACE_BATCH );
+
+        f->glMultiDrawArrays( GL_LINE_STRIP, first, count, n );
+    }
+
+// -------
+// Restore
+// -------
+
+    f->glDisableVertexAttribArray( locY );
+    f->glEnableClientState( GL_VERTEX_ARRAY );
+    prog->release();
+    vbo->release();
+#else
+    Q_UNUSED( X )
+    Q_UNUSED( vT )
+#endif
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Size buffer for (nY) slots of (cap) binMax pairs.
+// Any change discards all slot contents.
+//
+void MGTraceGL::layout( int nY, int cap )
+{
+    if( slot.size() == nY && stride == 2*cap )
+        return;
+
+    slot.clear();
+    slot.resize( nY );
+    stride = 2*cap;
+
+    vbo->bind();
+    vbo->allocate( nY * stride * sizeof(float) );
+    vbo->release();
+}
+
+
+void MGTraceGL::upload( int iy, const MGraphY *Y )
+{
+    Slot        &S      = slot[iy];
+    const float *y,
+                *y2     = 0;
+    quint64     tot     = Y->yval.putTotal();
+    uint        cap     = Y->yval.all( (float* &)y ),
+                gen     = Y->yval.generation(),
+                gen2    = Y->yval2.generation();
+    bool        binMax  = Y->drawBinMax;
+
+    if( binMax )
+        Y->yval2.all( (float* &)y2 );
+
+    if( S.Y != Y
+        || S.cap != cap
+        || S.binMax != binMax
+        || S.gen != gen
+        || (binMax && S.gen2 != gen2)
+        || tot - S.tot >= cap ) {
+
+        put( iy, binMax, y, y2, 0, cap );
+    }
+    else if( tot != S.tot ) {
+
+        // New samples end at cursor, may wrap
+
+        uint    n   = tot - S.tot,
+                i0  = (Y->yval.cursor() + cap - n) % cap,
+                n1  = qMin( n, cap - i0 );
+
+        put( iy, binMax, y, y2, i0, n1 );
+
+        if( n -= n1 )
+            put( iy, binMax, y, y2, 0, n );
+    }
+
+    S.Y         = Y;
+    S.tot       = tot;
+    S.cap       = cap;
+    S.gen       = gen;
+    S.gen2      = gen2;
+    S.binMax    = binMax;
+}
+
+
+// Write points [i0,i0+n) of graph iy; vbo bound.
+//
+void MGTraceGL::put(
+    int         iy,
+    bool        binMax,
+    const float *y,
+    const float *y2,
+    uint        i0,
+    uint        n )
+{
+    if( !n )
+        return;
+
+    if( !binMax ) {
+        vbo->write(
+            (iy * stride + i0) * sizeof(float),
+            y + i0, n * sizeof(float) );
+        return;
+    }
+
+    ilv.resize( 2*n );
+
+    for( uint i = 0; i < n; ++i ) {
+        ilv[2*i]    = y[i0 + i];
+        ilv[2*i+1]  = y2[i0 + i];
+    }
+
+    vbo->write(
+        (iy * stride + 2*i0) * sizeof(float),
+        &ilv[0], 2*n * sizeof(float) );
+}
+
+
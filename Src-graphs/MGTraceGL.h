@@ -0,0 +1,97 @@
+#ifndef MGTRACEGL_H
+#define MGTRACEGL_H
+
+#include <QVector>
+
+#include <vector>
+
+class MGraphX;
+class MGraphY;
+class QOpenGLBuffer;
+class QOpenGLFunctions_3_0;
+class QOpenGLShaderProgram;
+
+#define MGTRACE_BATCH   64
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Shader trace renderer for MGraph analog and binMax graphs.
+//
+// Graph iy of MGraphX::Y owns slot iy of one vertex buffer, holding
+// its yval in WrapBuffer physical order (which is also x order for
+// the wipe display, so no remapping is needed). Each paint uploads
+// only the samples put since the last (WrapBuffer::putTotal); a slot
+// is rewritten whole if its graph, capacity or mode changed, or its
+// data were rewritten in place (WrapBuffer::generation).
+//
+// BinMax slots hold (max,min) pairs interleaved, a strip of 2N
+// vertices; analog slots use the first N. The vertex shader gets
+// slot and x from gl_VertexID and applies the graph's offset, scale
+// and color from uniform arrays, so each run of MGTRACE_BATCH slots
+// draws in one glMultiDrawArrays.
+//
+// Needs a GL 3.0 (GLSL 1.30) compatibility context: else isValid()
+// is false and MGraph keeps its client-array path.
+//
+class MGTraceGL
+{
+public:
+    struct Trace {
+        int     iy;
+        float   y0,
+                scl;
+        Trace() : iy(0), y0(0), scl(0)  {}
+        Trace( int iy, float y0, float scl ) : iy(iy), y0(y0), scl(scl)  {}
+    };
+
+private:
+    struct Slot {
+        const MGraphY   *Y;
+        quint64         tot;
+        uint            cap,
+                        gen,
+                        gen2;
+        bool            binMax;
+        Slot() : Y(0), tot(0), cap(0), gen(0), gen2(0), binMax(false)  {}
+    };
+
+    QOpenGLFunctions_3_0    *f;
+    QOpenGLShaderProgram    *prog;
+    QOpenGLBuffer           *vbo;
+    QVector<Slot>           slot;
+    std::vector<float>      ilv;    // binMax interleave
+    int                     stride, // floats per slot
+                            locY,
+                            locStride,
+                            locBase,
+                            locGeom,
+                            locClr;
+    bool                    ok;
+
+public:
+    // GL context must be current for ctor and dtor.
+    MGTraceGL();
+    virtual ~MGTraceGL();
+
+    bool isValid() const    {return ok;}
+
+    // Under X.dataMtx, in MGraph::paintGL. (vT) sorted by iy.
+    void draw( const MGraphX &X, const QVector<Trace> &vT );
+
+private:
+    void layout( int nY, int cap );
+    void upload( int iy, const MGraphY *Y );
+    void put(
+        int         iy,
+        bool        binMax,
+        const float *y,
+        const float *y2,
+        uint        i0,
+        uint        n );
+};
+
+#endif  // MGTRACEGL_H
+
+
@@ -1,11 +1,13 @@
 
 #include "MGraph.h"
+#include "MGTraceGL.h"
 #include "Util.h"
 #include "MainApp.h"
 
 #include <QDesktopWidget>
 #include <QPoint>
 #include <QMouseEvent>
+#include <QOpenGLContext>
 #include <QPainter>
 #include <QScrollBar>
 #include <QVBoxLayout>
@@ -380,7 +382,7 @@ MGraph::MGraph( const QString &usr, QWidget *parent, MGraphX *X )
 #else
     :   QGLWidget(shr.fmt, parent), usr(usr),
 #endif
-        X(X), ownsX(false)
+        X(X), trGL(0), pendT(0), lagT(0), ownsX(false)
 {
 #ifdef OPENGL54
     Q_UNUSED( usr )
@@ -399,6 +401,13 @@ MGraph::MGraph( const QString &usr, QWidget *parent, MGraphX *X )
 
 MGraph::~MGraph()
 {
+    QOpenGLContext  *ctx = glContext();
+
+    if( ctx )
+        ctx->disconnect( this );
+
+    releaseGL();
+
     if( X && ownsX )
         delete X;
 
@@ -443,6 +452,36 @@ void MGraph::detach()
 }
 
 
+// Paced clients (GraphFetcher) post updates here rather than
+// invoking update() per data block, so requests never queue up
+// behind a busy GUI thread. A request pending this long is
+// presumed lost (e.g., widget hidden) and may be reposted.
+//
+#define PACE_STALE_SECS 0.5
+
+void MGraph::postUpdate()
+{
+    QMutexLocker    ml( &paceMtx );
+
+    double  t = getTime();
+
+    if( pendT > 0 && t - pendT < PACE_STALE_SECS )
+        return;
+
+    pendT = t;
+
+    QMetaObject::invokeMethod( this, "update", Qt::QueuedConnection );
+}
+
+
+bool MGraph::updatePending() const
+{
+    QMutexLocker    ml( &paceMtx );
+
+    return pendT > 0 && getTime() - pendT < PACE_STALE_SECS;
+}
+
+
 // Note: makeCurrent() called automatically.
 //
 void MGraph::initializeGL()
@@ -458,6 +497,52 @@ void MGraph::initializeGL()
     //glEnable( GL_LINE_SMOOTH );
     //glEnable( GL_POINT_SMOOTH );
     glEnableClientState( GL_VERTEX_ARRAY );
+
+// New context (first show or reparented): new trace buffers.
+// The old ones went with the old context (releaseGL).
+
+    QOpenGLContext  *ctx = glContext();
+
+    if( ctx ) {
+        Connect(
+            ctx, SIGNAL(aboutToBeDestroyed()),
+            this, SLOT(releaseGL()),
+            Qt::DirectConnection );
+    }
+
+    trGL = new MGTraceGL;
+}
+
+
+QOpenGLContext *MGraph::glContext() const
+{
+#ifdef OPENGL54
+    return context();
+#else
+    return (context() ? context()->contextHandle() : 0);
+#endif
+}
+
+
+// Trace buffers belong to the context that made them; free them
+// with it current. Called from the dtor, and from the context's
+// aboutToBeDestroyed() (direct), so a reparent has freed them
+// before initializeGL() runs under the new context.
+//
+void MGraph::releaseGL()
+{
+    if( !trGL )
+        return;
+
+    QOpenGLContext  *ctx = qobject_cast<QOpenGLContext*>( sender() );
+
+    if( ctx && ctx != glContext() && ctx->surface() )
+        ctx->makeCurrent( ctx->surface() );
+    else
+        makeCurrent();
+
+    delete trGL;
+    trGL = 0;
 }
 
 
@@ -519,6 +604,22 @@ void MGraph::paintGL()
 
     need_update = false;
 
+// ------
+// Pacing
+// ------
+
+    paceMtx.lock();
+
+    if( pendT > 0 ) {
+
+        double  lag = getTime() - pendT;
+
+        lagT    = (lagT > 0 ? 0.8*lagT + 0.2*lag : lag);
+        pendT   = 0;
+    }
+
+    paceMtx.unlock();
+
 // -------
 // Restore
 // -------
@@ -1092,19 +1193,30 @@ void MGraph::draw1Digital( int iy )
 // To scale that into the viewport, mult by 2/clipHgt.
 // Hence, scale = ypxPerGrf/clipHgt.
 //
+// Graph iy is drawn at (y0 + scl*yval).
+//
+void MGraph::traceGeom( int iy, float &y0, float &scl )
+{
+    int     clipHgt = height();
+    float   y0_px   = (iy+0.5F)*X->ypxPerGrf,
+            yscl    = 2.0F / clipHgt;
+
+    y0  = 1.0F - yscl*(y0_px - X->clipTop);
+    scl = X->Y[iy]->yscl * X->ypxPerGrf / clipHgt;
+}
+
+
 void MGraph::draw1BinMax( int iy )
 {
     QVector<Vec2f>  &V      = X->verts2x;
     MGraphY         *Y      = X->Y[iy];
     const float     *y,
                     *y2;
-    int             clipHgt = height();
+    float           y0,
+                    scl;
+    uint            len     = Y->yval.all( (float* &)y );
 
-    float   y0_px   = (iy+0.5F)*X->ypxPerGrf,
-            yscl    = 2.0F / clipHgt,
-            y0      = 1.0F - yscl*(y0_px - X->clipTop),
-            scl     = Y->yscl * X->ypxPerGrf / clipHgt;
-    uint    len     = Y->yval.all( (float* &)y );
+    traceGeom( iy, y0, scl );
 
     Y->yval2.all( (float* &)y2 );
 
@@ -1120,24 +1232,16 @@ void MGraph::draw1BinMax( int iy )
 }
 
 
-// The whole viewport logical span is [-1,1] and clipHgt pixel span.
-// yvals are in range [-1,1].
-// To scale yvals into pixels, mult by ypxPerGrf/2.
-// To scale that into the viewport, mult by 2/clipHgt.
-// Hence, scale = ypxPerGrf/clipHgt.
-//
 void MGraph::draw1Analog( int iy )
 {
     QVector<Vec2f>  &V      = X->verts;
     MGraphY         *Y      = X->Y[iy];
     const float     *y;
-    int             clipHgt = height();
+    float           y0,
+                    scl;
+    uint            len     = Y->yval.all( (float* &)y );
 
-    float   y0_px   = (iy+0.5F)*X->ypxPerGrf,
-            yscl    = 2.0F / clipHgt,
-            y0      = 1.0F - yscl*(y0_px - X->clipTop),
-            scl     = Y->yscl * X->ypxPerGrf / clipHgt;
-    uint    len     = Y->yval.all( (float* &)y );
+    traceGeom( iy, y0, scl );
 
     X->applyGLTraceClr( iy );
 
@@ -1173,8 +1277,12 @@ void MGraph::drawPointsMain()
 // Loop
 // ----
 
-    int ny      = X->Y.size(),
-        clipHgt = height();
+// Analog and binMax go to the shader renderer if available.
+
+    QVector<MGTraceGL::Trace>   vT;
+    int                         ny      = X->Y.size(),
+                                clipHgt = height();
+    bool                        useGL   = trGL && trGL->isValid();
 
     for( int iy = 0; iy < ny; ++iy ) {
 
@@ -1189,12 +1297,22 @@ void MGraph::drawPointsMain()
 
         if( X->Y[iy]->isDigType )
             draw1Digital( iy );
+        else if( useGL ) {
+
+            float   y0, scl;
+
+            traceGeom( iy, y0, scl );
+            vT.push_back( MGTraceGL::Trace( iy, y0, scl ) );
+        }
         else if( X->Y[iy]->drawBinMax )
             draw1BinMax( iy );
         else
             draw1Analog( iy );
     }
 
+    if( vT.size() )
+        trGL->draw( *X, vT );
+
 // ------
 // Cursor
 // ------
@@ -18,6 +18,8 @@
 
 class MGraph;
 class MGScroll;
+class MGTraceGL;
+class QOpenGLContext;
 
 #undef max  // inherited from WinDef.h via QGLWidget
 
@@ -159,11 +161,15 @@ private:
 private:
     static QMap<QString,shrRef>  usr2Ref;
 
-    QString     usr;
-    MGraphX     *X;
-    bool        ownsX,
-                immed_update,
-                need_update;
+    QString         usr;
+    MGraphX         *X;
+    MGTraceGL       *trGL;
+    mutable QMutex  paceMtx;
+    double          pendT,      // update() posted, not painted
+                    lagT;       // avg post-to-painted secs
+    bool            ownsX,
+                    immed_update,
+                    need_update;
 
 public:
     MGraph( const QString &usr, QWidget *parent = 0, MGraphX *X = 0 );
@@ -177,6 +183,11 @@ public:
     void setImmedUpdate( bool b ) {immed_update = b;}
     bool needsUpdateGL() const {return need_update;}
 
+    // Any thread: queue update() unless one is pending.
+    void postUpdate();
+    bool updatePending() const;
+    double paintLag() const {QMutexLocker ml( &paceMtx ); return lagT;}
+
 signals:
     // For these:
     // x  is a time value,
@@ -206,6 +217,9 @@ public slots:
     void updateNow()    {updateGL();}
 #endif
 
+private slots:
+    void releaseGL();
+
 protected:
     void initializeGL();
     void resizeGL( int w, int h );
@@ -217,6 +231,7 @@ protected:
     void mouseDoubleClickEvent( QMouseEvent *evt );
 
 private:
+    QOpenGLContext *glContext() const;
     const MGraph *getShr( const QString &usr );
     void win2LogicalCoords( double &x, double &y, int iy );
     void drawBaselines();
@@ -225,6 +240,7 @@ private:
     void drawYSel();
     void drawXSel();
     void drawEvents();
+    void traceGeom( int iy, float &y0, float &scl );
     void draw1Digital( int iy );
     void draw1BinMax( int iy );
     void draw1Analog( int iy );
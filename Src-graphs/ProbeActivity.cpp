@@ -0,0 +1,410 @@
+
+#include "Util.h"
+#include "ProbeActivity.h"
+#include "DAQ.h"
+#include "AIQ.h"
+
+#include <QSettings>
+#include <QThread>
+
+
+// Fetch loop period (secs); shorter while the raster scrolls.
+#define PA_FETCH_SECS   0.1
+#define PA_RASTER_SECS  0.05
+#define PA_IDLE_SECS    0.25
+
+// Spikes held per probe if raster not taking them.
+#define PA_MAX_PEND     (1 << 20)
+
+
+/* ---------------------------------------------------------------- */
+/* PAWorker ------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+PAWorker::PAWorker( const DAQ::Params &p, const QVector<AIQ*> &imQ )
+    :   QObject(0), pool(0), loopT(0), intvT(0), updtSecs(1.0),
+        thresh(-100), inarow(5), newSet(true), resync(true),
+        posted(false), logOn(false), ovOn(false), rasOn(false),
+        pleaseStop(false)
+{
+    for( int ip = 0, np = imQ.size(); ip < np; ++ip ) {
+
+        PAProbe P;
+
+        P.act       = new ShankActivity( p );
+        P.aiQ       = imQ[ip];
+        P.nextCt    = 0;
+
+        P.act->init( ip );
+
+        prb.push_back( P );
+        order.push_back( ip );
+    }
+}
+
+
+PAWorker::~PAWorker()
+{
+    if( pool ) {
+        delete pool;
+        pool = 0;
+    }
+
+    for( int ip = 0, np = prb.size(); ip < np; ++ip )
+        delete prb[ip].act;
+}
+
+
+void PAWorker::setUpdtSecs( double updtSecs )
+{
+    QMutexLocker    ml( &runMtx );
+
+    this->updtSecs  = updtSecs;
+    newSet          = true;
+}
+
+
+void PAWorker::setSpikeParams( int thresh, int inarow )
+{
+    QMutexLocker    ml( &runMtx );
+
+    this->thresh    = thresh;
+    this->inarow    = inarow;
+    newSet          = true;
+}
+
+
+void PAWorker::getVals( QVector<double> &val, int ip, int m ) const
+{
+    QMutexLocker    ml( &valMtx );
+
+    val = prb[ip].act->val[m];
+}
+
+
+void PAWorker::takeSpikes(
+    QVector<std::vector<ShankActivity::Spike> > &spk,
+    QVector<quint64>                            &endCt )
+{
+    QMutexLocker    ml( &spkMtx );
+
+    int np = prb.size();
+
+    spk.resize( np );
+    endCt.resize( np );
+
+    for( int ip = 0; ip < np; ++ip ) {
+
+        PAProbe &P = prb[ip];
+
+        spk[ip].clear();
+        spk[ip].swap( P.spk );
+        endCt[ip] = P.nextCt;
+    }
+
+    posted = false;
+}
+
+
+void PAWorker::run()
+{
+    Debug() << "Probe activity started.";
+
+    while( !isStopped() ) {
+
+        loopT = getTime();
+
+        if( isIdle() ) {
+            usleep( 1e6 * PA_IDLE_SECS );
+            continue;
+        }
+
+        applyParams();
+
+        // Fetch and tally all probes
+
+        int np = prb.size();
+
+        if( np > 1 ) {
+
+            if( !pool )
+                pool = new TrigPool( np );
+
+            pool->post( this, order );
+            pool->wait();
+        }
+        else if( np )
+            fetch( prb[0] );
+
+        // Overview: publish each interval
+
+        runMtx.lock();
+            double  intv    = updtSecs;
+            bool    ov      = ovOn;
+        runMtx.unlock();
+
+        if( loopT - intvT >= intv ) {
+
+            bool    any = false;
+
+            valMtx.lock();
+                for( int ip = 0; ip < np; ++ip )
+                    any |= prb[ip].act->finish();
+            valMtx.unlock();
+
+            intvT = loopT;
+
+            if( any && ov )
+                emit tallied();
+        }
+
+        // Raster: tell unless it hasn't taken the last
+
+        if( logOn ) {
+
+            spkMtx.lock();
+                bool    post = !posted;
+                posted = true;
+            spkMtx.unlock();
+
+            if( post )
+                emit spiked();
+        }
+
+        double  dt      = getTime() - loopT,
+                period  = (logOn ? PA_RASTER_SECS : PA_FETCH_SECS);
+
+        if( dt < period )
+            usleep( 1e6 * (period - dt) );
+        else
+            usleep( 1000 * 10 );
+    }
+
+    if( pool ) {
+        delete pool;
+        pool = 0;
+    }
+
+    Debug() << "Probe activity stopped.";
+
+    emit finished();
+}
+
+
+// Pool thread: one probe.
+//
+bool PAWorker::poolTask( int ip )
+{
+    fetch( prb[ip] );
+    return true;
+}
+
+
+// Going from idle to active restarts every probe
+// at the current time.
+//
+void PAWorker::setFlag( volatile bool &flag, bool on )
+{
+    QMutexLocker    ml( &runMtx );
+
+    bool    was = ovOn || rasOn;
+
+    flag = on;
+
+    if( !was && (ovOn || rasOn) )
+        resync = true;
+}
+
+
+// Fetcher thread, pool idle.
+//
+void PAWorker::applyParams()
+{
+    QMutexLocker    ml( &runMtx );
+
+    int np = prb.size();
+
+    if( resync ) {
+
+        spkMtx.lock();
+            for( int ip = 0; ip < np; ++ip ) {
+                prb[ip].nextCt = 0;
+                prb[ip].spk.clear();
+                prb[ip].act->reset();
+            }
+        spkMtx.unlock();
+
+        intvT   = loopT;
+        resync  = false;
+    }
+
+    if( newSet ) {
+
+        for( int ip = 0; ip < np; ++ip ) {
+            prb[ip].act->setThresh( thresh, inarow );
+            prb[ip].act->zeroData();
+        }
+
+        intvT   = loopT;
+        newSet  = false;
+    }
+
+    // Log spikes only while the raster takes them
+
+    if( logOn != rasOn ) {
+
+        logOn = rasOn;
+
+        spkMtx.lock();
+            for( int ip = 0; ip < np; ++ip ) {
+                prb[ip].spk.clear();
+                prb[ip].act->logSpikes( logOn );
+            }
+
+            posted = false;
+        spkMtx.unlock();
+    }
+}
+
+
+void PAWorker::fetch( PAProbe &P )
+{
+    std::vector<AIQ::AIQBlock>  vB;
+    double                      testT;
+    int                         nb;
+
+    // mapCt2Time fails if nextCt >= curCount
+
+    if( P.nextCt && P.nextCt >= P.aiQ->curCount() )
+        return;
+
+    // Restart (and refilter) if not set or lagging 1.0 secs
+
+    if( !P.nextCt
+        || !P.aiQ->mapCt2Time( testT, P.nextCt )
+        || testT < loopT - 1.0 ) {
+
+        quint64 ct;
+
+        if( !P.aiQ->mapTime2Ct( ct, loopT - PA_FETCH_SECS ) )
+            return;
+
+        spkMtx.lock();
+            P.nextCt = ct;
+        spkMtx.unlock();
+
+        P.act->reset();
+    }
+
+    nb = P.aiQ->getAllScansFromCt( vB, P.nextCt );
+
+    if( !nb )
+        return;
+
+    vec_i16 cat;
+    vec_i16 *data;
+
+    if( !P.aiQ->catBlocks( data, cat, vB ) ) {
+        Warning() << "Probe activity mem failure; dropped scans.";
+        return;
+    }
+
+    P.act->putScans( *data, vB[0].headCt );
+
+    QMutexLocker    ml( &spkMtx );
+
+    if( logOn ) {
+
+        if( P.spk.size() > (size_t)PA_MAX_PEND )
+            P.spk.clear();
+
+        P.act->takeSpikes( P.spk );
+    }
+
+    P.nextCt = P.aiQ->nextCt( vB );
+}
+
+/* ---------------------------------------------------------------- */
+/* ProbeActivity -------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+ProbeActivity::ProbeActivity(
+    const DAQ::Params   &p,
+    const QVector<AIQ*> &imQ )
+    :   QObject(0), thread(0), worker(0)
+{
+    loadSettings();
+
+    thread  = new QThread;
+    worker  = new PAWorker( p, imQ );
+
+    worker->setSpikeParams( thresh, inarow );
+    worker->moveToThread( thread );
+
+    Connect( thread, SIGNAL(started()), worker, SLOT(run()) );
+    Connect( worker, SIGNAL(tallied()), this, SIGNAL(tallied()) );
+    Connect( worker, SIGNAL(spiked()), this, SIGNAL(spiked()) );
+    Connect( worker, SIGNAL(finished()), worker, SLOT(deleteLater()) );
+    Connect( worker, SIGNAL(destroyed()), thread, SLOT(quit()), Qt::DirectConnection );
+
+    thread->start();
+}
+
+
+ProbeActivity::~ProbeActivity()
+{
+// worker object auto-deleted asynchronously
+// thread object manually deleted synchronously (so we can call wait())
+
+    if( thread->isRunning() ) {
+
+        worker->stop();
+        thread->wait();
+    }
+
+    delete thread;
+}
+
+
+// Tell every view, so all show the same settings.
+//
+void ProbeActivity::setSpikeParams( int thresh, int inarow )
+{
+    if( thresh == this->thresh && inarow == this->inarow )
+        return;
+
+    this->thresh = thresh;
+    this->inarow = inarow;
+
+    worker->setSpikeParams( thresh, inarow );
+    saveSettings();
+
+    emit spikeParamsChanged();
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+void ProbeActivity::loadSettings()
+{
+    STDSETTINGS( settings, "probeactivity" );
+
+    settings.beginGroup( "ProbeActivity" );
+    thresh  = settings.value( "thresh", -100 ).toInt();
+    inarow  = settings.value( "staylow", 5 ).toInt();
+    settings.endGroup();
+}
+
+
+void ProbeActivity::saveSettings() const
+{
+    STDSETTINGS( settings, "probeactivity" );
+
+    settings.beginGroup( "ProbeActivity" );
+    settings.setValue( "thresh", thresh );
+    settings.setValue( "staylow", inarow );
+    settings.endGroup();
+}
+
+
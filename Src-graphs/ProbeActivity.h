@@ -0,0 +1,152 @@
+#ifndef PROBEACTIVITY_H
+#define PROBEACTIVITY_H
+
+#include "ShankActivity.h"
+#include "TrigPool.h"
+
+#include <QObject>
+#include <QMutex>
+#include <QVector>
+
+namespace DAQ {
+struct Params;
+}
+
+class AIQ;
+
+class QThread;
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Fetches every imec probe at a fixed cadence, independent of the
+// graphs. Each probe's fetch and ShankActivity tally is a task on
+// a TrigPool. For the overview, every (updtSecs) the tallies are
+// finished and tallied() is sent; for the raster, spikes are logged
+// and pile up until taken, with one spiked() outstanding at a time.
+// With neither consumer on, the loop idles.
+//
+class PAWorker : public QObject, public TrigPoolTask
+{
+    Q_OBJECT
+
+private:
+    struct PAProbe {
+        ShankActivity                       *act;
+        const AIQ                           *aiQ;
+        std::vector<ShankActivity::Spike>   spk;
+        quint64                             nextCt;
+    };
+
+private:
+    QVector<PAProbe>    prb;
+    QVector<int>        order;
+    TrigPool            *pool;
+    mutable QMutex      valMtx,
+                        spkMtx,
+                        runMtx;
+    double              loopT,
+                        intvT,
+                        updtSecs;
+    int                 thresh,
+                        inarow;
+    bool                newSet,
+                        resync,
+                        posted,
+                        logOn;      // fetcher's logging state
+    volatile bool       ovOn,       // overview shown
+                        rasOn,      // raster shown, running
+                        pleaseStop;
+
+public:
+    PAWorker( const DAQ::Params &p, const QVector<AIQ*> &imQ );
+    virtual ~PAWorker();
+
+    void setUpdtSecs( double updtSecs );
+    void setSpikeParams( int thresh, int inarow );
+
+    void ovEnable( bool on )    {setFlag( ovOn, on );}
+    void rasEnable( bool on )   {setFlag( rasOn, on );}
+    bool isIdle() const
+        {QMutexLocker ml( &runMtx ); return !ovOn && !rasOn;}
+
+    void stop()             {QMutexLocker ml( &runMtx ); pleaseStop = true;}
+    bool isStopped() const  {QMutexLocker ml( &runMtx ); return pleaseStop;}
+
+    // Copy probe's last finished ShankActivity::Measure (m).
+    void getVals( QVector<double> &val, int ip, int m ) const;
+
+    // Per probe: move new spikes to (spk[ip]); (endCt[ip]) is
+    // count fetched to, zero if not yet fetching.
+    void takeSpikes(
+        QVector<std::vector<ShankActivity::Spike> > &spk,
+        QVector<quint64>                            &endCt );
+
+    virtual bool poolTask( int ip );
+
+signals:
+    void tallied();
+    void spiked();
+    void finished();
+
+public slots:
+    void run();
+
+private:
+    void setFlag( volatile bool &flag, bool on );
+    void applyParams();
+    void fetch( PAProbe &P );
+};
+
+
+// Run-scoped activity source for the probe overview and the spike
+// raster: one ShankActivity per probe, fed by one PAWorker, so each
+// probe's AP band is fetched and filtered once however many views
+// are open. The views share the spike detection settings; each
+// switches its own consumer on while it is shown.
+//
+class ProbeActivity : public QObject
+{
+    Q_OBJECT
+
+private:
+    QThread     *thread;
+    PAWorker    *worker;
+    int         thresh, // uV
+                inarow;
+
+public:
+    ProbeActivity( const DAQ::Params &p, const QVector<AIQ*> &imQ );
+    virtual ~ProbeActivity();
+
+    int getThresh() const   {return thresh;}
+    int getInarow() const   {return inarow;}
+    void setSpikeParams( int thresh, int inarow );
+
+    void setUpdtSecs( double s )    {worker->setUpdtSecs( s );}
+
+    void ovEnable( bool on )        {worker->ovEnable( on );}
+    void rasEnable( bool on )       {worker->rasEnable( on );}
+
+    void getVals( QVector<double> &val, int ip, int m ) const
+        {worker->getVals( val, ip, m );}
+
+    void takeSpikes(
+        QVector<std::vector<ShankActivity::Spike> > &spk,
+        QVector<quint64>                            &endCt )
+        {worker->takeSpikes( spk, endCt );}
+
+signals:
+    void tallied();
+    void spiked();
+    void spikeParamsChanged();
+
+private:
+    void loadSettings();
+    void saveSettings() const;
+};
+
+#endif  // PROBEACTIVITY_H
+
+
@@ -148,6 +148,17 @@ RunToolbar::RunToolbar( GraphsWindow *gw, const DAQ::Params &p )
             this, SLOT(toggleFetcher()) );
     A->setObjectName( "pauseact" );
     A->setCheckable( true );
+
+// Raster
+
+    if( p.im.enabled ) {
+
+        A = addAction( "Raster" );
+        A->setObjectName( "rasteract" );
+        A->setToolTip( "Show/hide spike raster of all probes" );
+        A->setCheckable( true );
+        ConnectUI( A, SIGNAL(triggered(bool)), gw, SLOT(tbShowRaster(bool)) );
+    }
 }
 
 
@@ -210,6 +221,17 @@ void RunToolbar::enableRunLE( bool enabled )
 }
 
 
+void RunToolbar::setRasterShown( bool on )
+{
+    QAction *A = findChild<QAction*>( "rasteract" );
+
+    if( A ) {
+        SignalBlocker   b0(A);
+        A->setChecked( on );
+    }
+}
+
+
 void RunToolbar::update()
 {
     QAction *pause;
@@ -234,6 +256,7 @@ void RunToolbar::toggleFetcher()
 {
     paused = !paused;
     mainApp()->getRun()->grfHardPause( paused );
+    gw->tbSetRasterPaused( paused );
     update();
 }
 
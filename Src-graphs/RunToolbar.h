@@ -15,7 +15,7 @@ class GraphsWindow;
 
 // Main Graphs window toolbar:
 //
-// Stop T-on | Trg-enab runname <G T> T-rec | 'Graphs' pause
+// Stop T-on | Trg-enab runname <G T> T-rec | 'Graphs' pause Raster
 //
 class RunToolbar : public QToolBar
 {
@@ -36,6 +36,7 @@ public:
     QString getRunLE() const;
     void setRunLE( const QString &name );
     void enableRunLE( bool enabled );
+    void setRasterShown( bool on );
     void update();
 
 public slots:
@@ -13,84 +13,6 @@
 
 
 
-/* ---------------------------------------------------------------- */
-/* class DCAve ---------------------------------------------------- */
-/* ---------------------------------------------------------------- */
-
-void SVGrafsM::DCAve::init( int nChannels, int nNeural )
-{
-    nC = nChannels;
-    nN = nNeural;
-    lvl.fill( 0.0F, nN );
-    clock = 0.0;
-}
-
-
-void SVGrafsM::DCAve::setChecked( bool checked )
-{
-    sum.fill( 0.0F, nN );
-    cnt.fill( 0, nN );
-
-    if( !checked )
-        lvl.fill( 0.0F );
-    else
-        clock = 0.0;
-}
-
-
-// Every 5 seconds the level is updated, based
-// upon averaging over the preceding 1 second.
-//
-void SVGrafsM::DCAve::updateLvl(
-    const qint16    *d,
-    int             ntpts,
-    int             dwnSmp )
-{
-// -------------------
-// Time to update lvl?
-// -------------------
-
-    double  T = getTime();
-
-    if( !clock )
-        clock = T - 4.0;
-
-    if( T - clock >= 5.0 ) {
-
-        clock = T;
-
-        for( int ic = 0; ic < nN; ++ic ) {
-            lvl[ic] = (cnt[ic] ? sum[ic]/cnt[ic] : 0.0F);
-            sum[ic] = 0.0F;
-            cnt[ic] = 0;
-        }
-    }
-    else if( T - clock >= 4.0 )
-        updateSums( d, ntpts, dwnSmp );
-}
-
-
-// Accumulate data into sum and cnt.
-//
-void SVGrafsM::DCAve::updateSums(
-    const qint16    *d,
-    int             ntpts,
-    int             dwnSmp )
-{
-    float   *S      = &sum[0];
-    int     dStep   = nC * dwnSmp,
-            dtpts   = (ntpts + dwnSmp - 1) / dwnSmp;
-
-    for( int it = 0; it < ntpts; it += dwnSmp, d += dStep ) {
-
-        for( int ic = 0; ic < nN; ++ic )
-            S[ic] += d[ic];
-    }
-
-    for( int ic = 0; ic < nN; ++ic )
-        cnt[ic] += dtpts;
-}
-
 /* ---------------------------------------------------------------- */
 /* class SVGrafsM ------------------------------------------------- */
 /* ---------------------------------------------------------------- */
@@ -98,7 +20,8 @@ void SVGrafsM::DCAve::updateSums(
 SVGrafsM::SVGrafsM( GraphsWindow *gw, const DAQ::Params &p )
     :   gw(gw), shankCtl(0), p(p), drawMtx(QMutex::Recursive),
         timStatBar(250, this), lastMouseOverChan(-1),
-        selected(-1), maximized(-1), externUpdateTimes(true)
+        selected(-1), maximized(-1), externUpdateTimes(true),
+        bfPending(false)
 {
 }
 
@@ -139,7 +62,7 @@ void SVGrafsM::init( SVToolsM *tb )
 // ----------
 
     tb->init();
-    dc.init( n, neurChanCount() );
+    dc.init( neurChanCount(), mySampRate() );
     dcChkClicked( set.dcChkOn );
     binMaxChkClicked( set.binMaxOn );
     bandSelChanged( set.bandSel );
@@ -184,6 +107,20 @@ void SVGrafsM::eraseGraphs()
 }
 
 
+// Fetcher thread: timepoints of history wanted to backfill
+// graphs that are drawn again, or zero.
+//
+int SVGrafsM::backfillTpts() const
+{
+    QMutexLocker    ml( &drawMtx );
+
+    if( !bfPending || theX->Y.isEmpty() )
+        return 0;
+
+    return theX->Y[0]->yval.size() * theX->nDwnSmp();
+}
+
+
 void SVGrafsM::getSelScales( double &xSpn, double &yScl ) const
 {
     xSpn = theX->spanSecs();
@@ -351,7 +288,7 @@ void SVGrafsM::dcChkClicked( bool checked )
 {
     drawMtx.lock();
     set.dcChkOn = checked;
-    dc.setChecked( checked );
+    dc.reset();
     saveSettings();
     drawMtx.unlock();
 }
@@ -462,84 +399,102 @@ void SVGrafsM::ensureVisible()
 }
 
 
-// For each channel [c0,cLim), calculate an 8-way
-// neighborhood of indices into a timepoint's channels.
-// - The index list excludes the central channel.
-// - The list is sorted for cache friendliness.
+// Build referencing plan for channels [c0,cLim)
+// from current {sAveSel, sAveRadius}.
 //
-void SVGrafsM::sAveTable( const ShankMap &SM, int c0, int cLim, int radius )
+void SVGrafsM::sAveTable( const ShankMap &SM, int c0, int cLim )
 {
-    TSM.clear();
-    TSM.resize( cLim - c0 );
-
-    QMap<ShankMapDesc,uint> ISM;
-    SM.inverseMap( ISM );
-
-    for( int ic = c0; ic < cLim; ++ic ) {
+    ref.setSel( SM, c0, cLim, set.sAveSel, set.sAveRadius );
+}
 
-        const ShankMapDesc  &E = SM.e[ic];
 
-        if( !E.u )
-            continue;
+// Under drawMtx: flag channels drawn this block (on page and not
+// hidden by a maximized graph). Undrawn active channels just keep
+// their buffers in step (putIdle) and go stale; when drawn again,
+// they get one backfill of recent history (putBackfill) so the
+// trace is whole immediately.
+//
+void SVGrafsM::updateDrawn()
+{
+    int nC = chanCount();
 
-        QVector<int>    &V = TSM[ic];
+    if( (int)ic2draw.size() != nC ) {
+        ic2draw.assign( nC, 0 );
+        ic2stale.assign( nC, 0 );
+        ic2bf.assign( nC, 0 );
+    }
 
-        int xL  = qMax( int(E.c)  - radius, 0 ),
-            xH  = qMin( uint(E.c) + radius + 1, SM.nc ),
-            yL  = qMax( int(E.r)  - radius, 0 ),
-            yH  = qMin( uint(E.r) + radius + 1, SM.nr );
+    for( int ic = 0; ic < nC; ++ic ) {
 
-        for( int ix = xL; ix < xH; ++ix ) {
+        bool    act = ic2iy[ic] >= 0,
+                vis = act && (maximized < 0 || ic == maximized);
 
-            for( int iy = yL; iy < yH; ++iy ) {
+        ic2draw[ic] = vis;
 
-                QMap<ShankMapDesc,uint>::iterator   it;
+        if( !act )
+            ic2stale[ic] = 0;
+        else if( !vis )
+            ic2stale[ic] = 1;
+        else if( ic2stale[ic] )
+            bfPending = true;
+    }
+}
 
-                it = ISM.find( ShankMapDesc( E.s, ix, iy, 1 ) );
 
-                if( it == ISM.end() )
-                    continue;
+// Under drawMtx: move drawn stale channels to ic2bf.
+//
+bool SVGrafsM::takeBackfill()
+{
+    int     nC  = (int)ic2draw.size();
+    bool    any = false;
 
-                int i = it.value();
+    ic2bf.assign( nC, 0 );
 
-                // Exclude self
-                // Make zero-based
+    for( int ic = 0; ic < nC; ++ic ) {
 
-                if( i != ic )
-                    V.push_back( i - c0 );
-            }
+        if( ic2draw[ic] && ic2stale[ic] ) {
+            ic2bf[ic]       = 1;
+            ic2stale[ic]    = 0;
+            any             = true;
         }
-
-        qSort( V );
     }
+
+    bfPending = false;
+
+    return any;
 }
 
 
-// Space and time averaging for value: d_ic = &data[ic].
-//
-int SVGrafsM::s_t_Ave( const qint16 *d_ic, int ic )
+void SVGrafsM::putIdle( int ic, int n )
 {
-    const QVector<int>  &V = TSM[ic];
-    const float         *L = &dc.lvl[0];
+    if( (int)idle.size() < n )
+        idle.assign( n, 0.0F );
 
-    int sum = 0,
-        nv  = V.size();
+    MGraphY &Y = ic2Y[ic];
 
-    if( nv ) {
+    theX->dataMtx.lock();
 
-        const qint16    *d = d_ic - ic;
+    Y.yval.putData( &idle[0], n );
 
-        for( int iv = 0; iv < nv; ++iv ) {
+    if( Y.drawBinMax )
+        Y.yval2.putData( &idle[0], n );
 
-            int k = V[iv];
+    theX->dataMtx.unlock();
+}
 
-            sum += d[k] - L[k];
-        }
 
-        return *d_ic - sum/nv - L[ic];
-    }
+void SVGrafsM::putTail( int ic, const float *y, const float *y2, int n )
+{
+    MGraphY &Y = ic2Y[ic];
+
+    theX->dataMtx.lock();
+
+    Y.yval.overwriteTail( y, n );
 
-    return *d_ic - L[ic];
+    if( Y.drawBinMax )
+        Y.yval2.overwriteTail( y2, n );
+
+    theX->dataMtx.unlock();
 }
 
 
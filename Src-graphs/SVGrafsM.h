@@ -3,7 +3,10 @@
 
 #include "SGLTypes.h"
 #include "MGraph.h"
+#include "BinMinMax.h"
+#include "DCLevel.h"
 #include "GraphStats.h"
+#include "Referencer.h"
 #include "TimedTextUpdate.h"
 
 #include <QWidget>
@@ -46,6 +49,7 @@ protected:
                 clr2;
         int     navNChan,
                 bandSel,
+                sAveSel,    // {0=off,1=local,2=CAR,3=CMR}
                 sAveRadius;
         bool    filterChkOn,
                 dcChkOn,
@@ -53,29 +57,6 @@ protected:
                 usrOrder;
     };
 
-    class DCAve {
-    private:
-        QVector<float>  sum;
-        QVector<int>    cnt;
-        double          clock;
-        int             nC,
-                        nN;
-    public:
-        QVector<float>  lvl;
-    public:
-        void init( int nChannels, int nNeural );
-        void setChecked( bool checked );
-        void updateLvl(
-            const qint16    *d,
-            int             ntpts,
-            int             dwnSmp );
-    private:
-        void updateSums(
-            const qint16    *d,
-            int             ntpts,
-            int             dwnSmp );
-    };
-
 protected:
     GraphsWindow            *gw;
     SVToolsM                *tb;
@@ -93,16 +74,22 @@ protected:
     QVector<GraphStats>     ic2stat;
     QVector<int>            ic2iy,
                             ig2ic;
-    QVector<QVector<int> >  TSM;
+    std::vector<char>       ic2draw,    // drawn this block
+                            ic2stale,   // kept in step with zeros
+                            ic2bf;      // to backfill
+    std::vector<float>      idle;
+    Referencer              ref;
+    BinMinMax               bins;
     mutable QMutex          drawMtx;
     UsrSettings             set;
-    DCAve                   dc;
+    DCLevel                 dc;
     TimedTextUpdate         timStatBar;
     int                     digitalType,
                             lastMouseOverChan,
                             selected,
                             maximized;
-    bool                    externUpdateTimes;
+    bool                    externUpdateTimes,
+                            bfPending;
 
 public:
     SVGrafsM( GraphsWindow *gw, const DAQ::Params &p );
@@ -111,9 +98,12 @@ public:
 
     QWidget *getGWWidget()  {return (QWidget*)gw;}
     MGraphX *getTheX()      {return theX;}
+    MGraph *getTheM()       {return theM;}
 
     void eraseGraphs();
     virtual void putScans( vec_i16 &data, quint64 headCt ) = 0;
+    virtual void putBackfill( vec_i16 &data ) = 0;
+    int backfillTpts() const;
     virtual void updateRHSFlags() = 0;
 
     virtual int chanCount()     const = 0;
@@ -123,6 +113,7 @@ public:
     virtual bool isBandpass()           const = 0;
     virtual QString filterChkTitle()    const = 0;
     int  curBandSel()       const   {return set.bandSel;}
+    int  curSAveSel()       const   {return set.sAveSel;}
     int  curSAveRadius()    const   {return set.sAveRadius;}
     bool isFilterChkOn()    const   {return set.filterChkOn;}
     bool isDcChkOn()        const   {return set.dcChkOn;}
@@ -151,6 +142,7 @@ public slots:
     void binMaxChkClicked( bool checked );
     virtual void bandSelChanged( int sel ) = 0;
     virtual void filterChkClicked( bool checked ) = 0;
+    virtual void sAveSelChanged( int sel ) = 0;
     virtual void sAveRadChanged( int radius ) = 0;
 
 private slots:
@@ -180,8 +172,12 @@ protected:
     void selectChan( int ic );
     void ensureVisible();
 
-    void sAveTable( const ShankMap &SM, int c0, int cLim, int radius );
-    int s_t_Ave( const qint16 *d_ic, int ic );
+    void sAveTable( const ShankMap &SM, int c0, int cLim );
+
+    void updateDrawn();
+    bool takeBackfill();
+    void putIdle( int ic, int n );
+    void putTail( int ic, const float *y, const float *y2, int n );
 
 private:
     void initGraphs();
@@ -20,9 +20,6 @@
 #include <math.h>
 
 
-#define MAX10BIT    512
-
-
 /* ---------------------------------------------------------------- */
 /* class SVGrafsM_Im ---------------------------------------------- */
 /* ---------------------------------------------------------------- */
@@ -86,26 +83,14 @@ SVGrafsM_Im::~SVGrafsM_Im()
 #define V_T_FLT_ADJ( v, d )                                         \
     (V_FLT_ADJ( v, d ) - dc.lvl[ic])
 
-#define V_S_T_FLT_ADJ( d )                                          \
-    (set.sAveRadius > 0 ?                                           \
-    V_FLT_ADJ( s_t_Ave( d, ic ), d ) : V_T_FLT_ADJ( *d, d ))
-
 
 void SVGrafsM_Im::putScans( vec_i16 &data, quint64 headCt )
 {
-    const CimCfg::AttrEach  &E = p.im.each[ip];
-
 #if 0
     double  tProf = getTime();
 #endif
-    double      ysc     = 1.0 / MAX10BIT;
     const int   nC      = chanCount(),
-                nNu     = neurChanCount(),
-                nAP     = E.imCumTypCnt[CimCfg::imSumAP],
-                dwnSmp  = theX->nDwnSmp(),
-                dstep   = dwnSmp * nC;
-
-// BK: We should superpose traces to see AP & LF, not add.
+                dwnSmp  = theX->nDwnSmp();
 
 // ---------------
 // Trim data block
@@ -135,7 +120,7 @@ void SVGrafsM_Im::putScans( vec_i16 &data, quint64 headCt )
     drawMtx.lock();
 
     if( set.dcChkOn )
-        dc.updateLvl( &data[0], ntpts, dwnSmp );
+        dc.prime( &data[0], ntpts, nC, dwnSmp );
 
 // ------------
 // TTL coloring
@@ -144,11 +129,122 @@ void SVGrafsM_Im::putScans( vec_i16 &data, quint64 headCt )
     gw->getTTLColorCtl()->scanBlock( data, headCt, nC, ip );
 
 // ---------------------
-// Append data to graphs
+// Process drawn graphs
 // ---------------------
 
+    updateDrawn();
+    putChans( data, ntpts, false );
+
+// -----------------------
+// Update pseudo time axis
+// -----------------------
+
+    double  span        = theX->spanSecs(),
+            TabsCursor  = (headCt + ntpts) / p.im.all.srate,
+            TwinCursor  = span * theX->Y[0]->yval.cursor()
+                            / theX->Y[0]->yval.capacity();
+
+    theX->spanMtx.lock();
+    theX->min_x = qMax( TabsCursor - TwinCursor, 0.0 );
+    theX->max_x = theX->min_x + span;
+    theX->spanMtx.unlock();
+
+// ----
+// Draw
+// ----
+
+    theM->postUpdate();
+
+    drawMtx.unlock();
+
+// ---------
+// Profiling
+// ---------
+
+#if 0
+    tProf = getTime() - tProf;
+    Log() << "Graph milis " << 1000*tProf;
+#endif
+}
+
+
+// Backfill: history for graphs just drawn again (ic2bf), ending
+// where the next putScans() block begins. Referenced and binned as
+// live data against current DC levels; overwrites the idle zeros
+// most recently appended to those graphs.
+//
+void SVGrafsM_Im::putBackfill( vec_i16 &data )
+{
+    const int   nC      = chanCount(),
+                dwnSmp  = theX->nDwnSmp();
+
+// Trim leading timepoints: bins stay aligned to the end.
+
+    int ntpts = (int)data.size() / nC,
+        nTrim = ntpts % dwnSmp;
+
+    ntpts -= nTrim;
+
+    if( nTrim )
+        data.erase( data.begin(), data.begin() + nTrim * nC );
+
+    drawMtx.lock();
+
+    if( takeBackfill() && ntpts )
+        putChans( data, ntpts, true );
+
+    drawMtx.unlock();
+
+    theM->postUpdate();
+}
+
+
+// Under drawMtx: reference, bin and append (or, if backfill,
+// overwrite) wanted channels; others just idle.
+//
+void SVGrafsM_Im::putChans( vec_i16 &data, int ntpts, bool backfill )
+{
+    const CimCfg::AttrEach  &E = p.im.each[ip];
+
+    double              ysc     = 1.0 / MAX10BIT;
+    const int           nC      = chanCount(),
+                        nNu     = neurChanCount(),
+                        nAP     = E.imCumTypCnt[CimCfg::imSumAP],
+                        dwnSmp  = theX->nDwnSmp(),
+                        dstep   = dwnSmp * nC;
+    std::vector<char>   &want   = (backfill ? ic2bf : ic2draw);
+
+// BK: We should superpose traces to see AP & LF, not add.
+
+// -----------
+// Referencing
+// -----------
+
+// AP channels, in place. Only every dwnSmp'th timepoint
+// is drawn unless binning.
+
     bool    drawBinMax = set.binMaxOn && dwnSmp > 1;
 
+    ref.apply(
+        &data[0], &dc.lvl[0], ntpts, nC,
+        (drawBinMax ? 1 : dwnSmp), &want[0] );
+
+// -------
+// Binning
+// -------
+
+// AP bins in one pass over the block, unless superposing
+// LF (per-sample float mix of two channels).
+
+    bool    binKern = drawBinMax && !set.filterChkOn;
+
+    if( binKern )
+        bins.scan( &data[0], ntpts, nC, 0, nAP, dwnSmp, &want[0] );
+
+// ---------------------
+// Append data to graphs
+// ---------------------
+
     QVector<float>  ybuf( ntpts ),  // append en masse
                     ybuf2( drawBinMax ? ntpts : 0 );
 
@@ -161,6 +257,14 @@ void SVGrafsM_Im::putScans( vec_i16 &data, quint64 headCt )
         if( ic2iy[ic] < 0 )
             continue;
 
+        if( !want[ic] ) {
+
+            if( !backfill )
+                putIdle( ic, ntpts / dwnSmp );
+
+            continue;
+        }
+
         // ----------
         // Init stats
         // ----------
@@ -191,7 +295,20 @@ void SVGrafsM_Im::putScans( vec_i16 &data, quint64 headCt )
             // values. This ensures spikes aren't missed.
             // Max in ybuf, min in ybuf2.
 
-            if( drawBinMax ) {
+            if( binKern ) {
+
+                float   lvl = dc.lvl[ic];
+
+                ic2Y[ic].drawBinMax = true;
+
+                bins.addStats( stat, ic, lvl );
+
+                for( int nb = bins.nBins(); ny < nb; ++ny ) {
+                    ybuf[ny]  = (bins.binMax( ny, ic ) - lvl) * ysc;
+                    ybuf2[ny] = (bins.binMin( ny, ic ) - lvl) * ysc;
+                }
+            }
+            else if( drawBinMax ) {
 
                 int ndRem = ntpts;
 
@@ -201,7 +318,7 @@ void SVGrafsM_Im::putScans( vec_i16 &data, quint64 headCt )
 
                     qint16  *Dmax   = d,
                             *Dmin   = d;
-                    float   val     = V_S_T_FLT_ADJ( d ),
+                    float   val     = V_T_FLT_ADJ( *d, d ),
                             vmax    = val,
                             vmin    = val;
                     int     binWid  = dwnSmp;
@@ -215,7 +332,7 @@ void SVGrafsM_Im::putScans( vec_i16 &data, quint64 headCt )
 
                     for( int ib = 1; ib < binWid; ++ib, d += nC ) {
 
-                        val = V_S_T_FLT_ADJ( d );
+                        val = V_T_FLT_ADJ( *d, d );
 
                         stat.add( val );
 
@@ -231,23 +348,11 @@ void SVGrafsM_Im::putScans( vec_i16 &data, quint64 headCt )
 
                     ndRem -= binWid;
 
-                    ybuf[ny]  = V_S_T_FLT_ADJ( Dmax ) * ysc;
-                    ybuf2[ny] = V_S_T_FLT_ADJ( Dmin ) * ysc;
+                    ybuf[ny]  = V_T_FLT_ADJ( *Dmax, Dmax ) * ysc;
+                    ybuf2[ny] = V_T_FLT_ADJ( *Dmin, Dmin ) * ysc;
                     ++ny;
                 }
             }
-            else if( set.sAveRadius > 0 ) {
-
-                ic2Y[ic].drawBinMax = false;
-
-                for( int it = 0; it < ntpts; it += dwnSmp, d += dstep ) {
-
-                    float   val = V_FLT_ADJ( s_t_Ave( d, ic ), d );
-
-                    stat.add( val );
-                    ybuf[ny++] = val * ysc;
-                }
-            }
             else {
 
                 ic2Y[ic].drawBinMax = false;
@@ -285,9 +390,19 @@ void SVGrafsM_Im::putScans( vec_i16 &data, quint64 headCt )
                 ybuf[ny++] = *d;
         }
 
+        // DC level tracks the sums just taken
+
+        if( set.dcChkOn && !backfill && ic < nNu )
+            dc.add( ic, stat.sum(), stat.count(), ntpts );
+
         // Append points en masse
         // Renormalize x-coords -> consecutive indices.
 
+        if( backfill ) {
+            putTail( ic, ybuf.data(), ybuf2.data(), ny );
+            continue;
+        }
+
         theX->dataMtx.lock();
 
         ic2Y[ic].yval.putData( &ybuf[0], ny );
@@ -297,37 +412,6 @@ void SVGrafsM_Im::putScans( vec_i16 &data, quint64 headCt )
 
         theX->dataMtx.unlock();
     }
-
-// -----------------------
-// Update pseudo time axis
-// -----------------------
-
-    double  span        = theX->spanSecs(),
-            TabsCursor  = (headCt + ntpts) / p.im.all.srate,
-            TwinCursor  = span * theX->Y[0]->yval.cursor()
-                            / theX->Y[0]->yval.capacity();
-
-    theX->spanMtx.lock();
-    theX->min_x = qMax( TabsCursor - TwinCursor, 0.0 );
-    theX->max_x = theX->min_x + span;
-    theX->spanMtx.unlock();
-
-// ----
-// Draw
-// ----
-
-    QMetaObject::invokeMethod( theM, "update", Qt::QueuedConnection );
-
-    drawMtx.unlock();
-
-// ---------
-// Profiling
-// ---------
-
-#if 0
-    tProf = getTime() - tProf;
-    Log() << "Graph milis " << 1000*tProf;
-#endif
 }
 
 
@@ -409,16 +493,25 @@ void SVGrafsM_Im::filterChkClicked( bool checked )
 }
 
 
+void SVGrafsM_Im::sAveSelChanged( int sel )
+{
+    const CimCfg::AttrEach  &E = p.im.each[ip];
+
+    drawMtx.lock();
+    set.sAveSel = sel;
+    sAveTable( E.sns.shankMap, 0, E.imCumTypCnt[CimCfg::imSumAP] );
+    saveSettings();
+    drawMtx.unlock();
+}
+
+
 void SVGrafsM_Im::sAveRadChanged( int radius )
 {
     const CimCfg::AttrEach  &E = p.im.each[ip];
 
     drawMtx.lock();
     set.sAveRadius = radius;
-    sAveTable(
-        E.sns.shankMap,
-        0, E.imCumTypCnt[CimCfg::imSumAP],
-        radius );
+    sAveTable( E.sns.shankMap, 0, E.imCumTypCnt[CimCfg::imSumAP] );
     saveSettings();
     drawMtx.unlock();
 }
@@ -746,6 +839,8 @@ void SVGrafsM_Im::loadSettings()
     set.navNChan    = settings.value( "navNChan", 32 ).toInt();
     set.bandSel     = settings.value( "bandSel", 0 ).toInt();
     set.sAveRadius  = settings.value( "sAveRadius", 0 ).toInt();
+    set.sAveSel     = settings.value( "sAveSel", int(set.sAveRadius > 0) ).toInt();
+    set.sAveRadius  = qMax( set.sAveRadius, 1 );
     set.filterChkOn = settings.value( "filterChkOn", false ).toBool();
     set.dcChkOn     = settings.value( "dcChkOn", false ).toBool();
     set.binMaxOn    = settings.value( "binMaxOn", true ).toBool();
@@ -768,6 +863,7 @@ void SVGrafsM_Im::saveSettings() const
     settings.setValue( "clr2", clrToString( set.clr2 ) );
     settings.setValue( "navNChan", set.navNChan );
     settings.setValue( "bandSel", set.bandSel );
+    settings.setValue( "sAveSel", set.sAveSel );
     settings.setValue( "sAveRadius", set.sAveRadius );
     settings.setValue( "filterChkOn", set.filterChkOn );
     settings.setValue( "dcChkOn", set.dcChkOn );
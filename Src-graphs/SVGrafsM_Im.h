@@ -21,6 +21,7 @@ public:
     virtual ~SVGrafsM_Im();
 
     virtual void putScans( vec_i16 &data, quint64 headCt );
+    virtual void putBackfill( vec_i16 &data );
     virtual void updateRHSFlags();
 
     virtual int chanCount() const;
@@ -33,6 +34,7 @@ public:
 public slots:
     virtual void bandSelChanged( int )      {}
     virtual void filterChkClicked( bool checked );
+    virtual void sAveSelChanged( int sel );
     virtual void sAveRadChanged( int radius );
 
 private slots:
@@ -64,6 +66,7 @@ protected:
     virtual void saveSettings() const;
 
 private:
+    void putChans( vec_i16 &data, int ntpts, bool backfill );
     double scalePlotValue( double v, double gain ) const;
     void computeGraphMouseOverVars(
         int         ic,
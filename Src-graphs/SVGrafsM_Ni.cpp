@@ -10,7 +10,7 @@
 #include "ColorTTLCtl.h"
 #include "SVGrafsM_Ni.h"
 #include "ShankCtl_Ni.h"
-#include "Biquad.h"
+#include "BiquadMC.h"
 
 #include <QSettings>
 #include <QMessageBox>
@@ -18,15 +18,12 @@
 #include <math.h>
 
 
-#define MAX16BIT    32768
-
-
 /* ---------------------------------------------------------------- */
 /* class SVGrafsM_Ni ---------------------------------------------- */
 /* ---------------------------------------------------------------- */
 
 SVGrafsM_Ni::SVGrafsM_Ni( GraphsWindow *gw, const DAQ::Params &p )
-    :   SVGrafsM( gw, p ), hipass(0), lopass(0)
+    :   SVGrafsM( gw, p ), flt(0)
 {
     shankCtl = new ShankCtl_Ni( p );
     shankCtl->init( -1 );
@@ -58,11 +55,8 @@ SVGrafsM_Ni::~SVGrafsM_Ni()
 
     fltMtx.lock();
 
-    if( hipass )
-        delete hipass;
-
-    if( lopass )
-        delete lopass;
+    if( flt )
+        delete flt;
 
     fltMtx.unlock();
 }
@@ -82,20 +76,15 @@ SVGrafsM_Ni::~SVGrafsM_Ni()
 
 #define V_T_ADJ( v )    (v - dc.lvl[ic])
 
-#define V_S_T_ADJ( d )                                              \
-    (set.sAveRadius > 0 ? s_t_Ave( d, ic ) : V_T_ADJ( *d ))
-
 
 void SVGrafsM_Ni::putScans( vec_i16 &data, quint64 headCt )
 {
 #if 0
     double  tProf = getTime();
 #endif
-    double      ysc     = 1.0 / MAX16BIT;
     const int   nC      = chanCount(),
                 nNu     = neurChanCount(),
-                dwnSmp  = theX->nDwnSmp(),
-                dstep   = dwnSmp * nC;
+                dwnSmp  = theX->nDwnSmp();
 
 // ---------------
 // Trim data block
@@ -124,18 +113,15 @@ void SVGrafsM_Ni::putScans( vec_i16 &data, quint64 headCt )
 
     fltMtx.lock();
 
-    if( hipass )
-        hipass->applyBlockwiseMem( &data[0], MAX16BIT, ntpts, nC, 0, nNu );
-
-    if( lopass )
-        lopass->applyBlockwiseMem( &data[0], MAX16BIT, ntpts, nC, 0, nNu );
+    if( flt )
+        flt->applyBlockwiseMem( &data[0], MAX16BIT, ntpts, nC, 0, nNu );
 
     fltMtx.unlock();
 
     drawMtx.lock();
 
     if( set.dcChkOn )
-        dc.updateLvl( &data[0], ntpts, dwnSmp );
+        dc.prime( &data[0], ntpts, nC, dwnSmp );
 
 // ------------
 // TTL coloring
@@ -144,11 +130,134 @@ void SVGrafsM_Ni::putScans( vec_i16 &data, quint64 headCt )
     gw->getTTLColorCtl()->scanBlock( data, headCt, nC, -1 );
 
 // ---------------------
-// Append data to graphs
+// Process drawn graphs
 // ---------------------
 
+    updateDrawn();
+    putChans( data, ntpts, false );
+
+// -----------------------
+// Update pseudo time axis
+// -----------------------
+
+    double  span        = theX->spanSecs(),
+            TabsCursor  = (headCt + ntpts) / p.ni.srate,
+            TwinCursor  = span * theX->Y[0]->yval.cursor()
+                            / theX->Y[0]->yval.capacity();
+
+    theX->spanMtx.lock();
+    theX->min_x = qMax( TabsCursor - TwinCursor, 0.0 );
+    theX->max_x = theX->min_x + span;
+    theX->spanMtx.unlock();
+
+// ----
+// Draw
+// ----
+
+    theM->postUpdate();
+
+    drawMtx.unlock();
+
+// ---------
+// Profiling
+// ---------
+
+#if 0
+    tProf = getTime() - tProf;
+    Log() << "Graph milis " << 1000*tProf;
+#endif
+}
+
+
+// Backfill: history for graphs just drawn again (ic2bf), ending
+// where the next putScans() block begins. The filter runs over it
+// from rest, on a side copy of its state, so the live stream's
+// filter memory is untouched. Then referenced and binned as live
+// data against current DC levels; overwrites the idle zeros most
+// recently appended to those graphs.
+//
+void SVGrafsM_Ni::putBackfill( vec_i16 &data )
+{
+    const int   nC      = chanCount(),
+                nNu     = neurChanCount(),
+                dwnSmp  = theX->nDwnSmp();
+
+// Trim leading timepoints: bins stay aligned to the end.
+
+    int ntpts = (int)data.size() / nC,
+        nTrim = ntpts % dwnSmp;
+
+    ntpts -= nTrim;
+
+    if( nTrim )
+        data.erase( data.begin(), data.begin() + nTrim * nC );
+
+    if( ntpts ) {
+
+        fltMtx.lock();
+
+        if( flt ) {
+
+            BiquadMC::Mem   M;
+
+            flt->getMem( M );
+            flt->clearMem();
+            flt->applyBlockwiseMem( &data[0], MAX16BIT, ntpts, nC, 0, nNu );
+            flt->setMem( M );
+        }
+
+        fltMtx.unlock();
+    }
+
+    drawMtx.lock();
+
+    if( takeBackfill() && ntpts )
+        putChans( data, ntpts, true );
+
+    drawMtx.unlock();
+
+    theM->postUpdate();
+}
+
+
+// Under drawMtx: reference, bin and append (or, if backfill,
+// overwrite) wanted channels; others just idle.
+//
+void SVGrafsM_Ni::putChans( vec_i16 &data, int ntpts, bool backfill )
+{
+    double              ysc     = 1.0 / MAX16BIT;
+    const int           nC      = chanCount(),
+                        nNu     = neurChanCount(),
+                        dwnSmp  = theX->nDwnSmp(),
+                        dstep   = dwnSmp * nC;
+    std::vector<char>   &want   = (backfill ? ic2bf : ic2draw);
+
+// -----------
+// Referencing
+// -----------
+
+// Neural channels, in place. Only every dwnSmp'th timepoint
+// is drawn unless binning.
+
     bool    drawBinMax = set.binMaxOn && dwnSmp > 1 && set.bandSel != 2;
 
+    ref.apply(
+        &data[0], &dc.lvl[0], ntpts, nC,
+        (drawBinMax ? 1 : dwnSmp), &want[0] );
+
+// -------
+// Binning
+// -------
+
+// Neural bins in one pass over the block.
+
+    if( drawBinMax )
+        bins.scan( &data[0], ntpts, nC, 0, nNu, dwnSmp, &want[0] );
+
+// ---------------------
+// Append data to graphs
+// ---------------------
+
     QVector<float>  ybuf( ntpts ),  // append en masse
                     ybuf2( drawBinMax ? ntpts : 0 );
 
@@ -161,6 +270,14 @@ void SVGrafsM_Ni::putScans( vec_i16 &data, quint64 headCt )
         if( ic2iy[ic] < 0 )
             continue;
 
+        if( !want[ic] ) {
+
+            if( !backfill )
+                putIdle( ic, ntpts / dwnSmp );
+
+            continue;
+        }
+
         // ----------
         // Init stats
         // ----------
@@ -190,59 +307,15 @@ void SVGrafsM_Ni::putScans( vec_i16 &data, quint64 headCt )
 
             if( drawBinMax ) {
 
-                int ndRem = ntpts;
+                float   lvl = dc.lvl[ic];
 
                 ic2Y[ic].drawBinMax = true;
 
-                for( int it = 0; it < ntpts; it += dwnSmp ) {
-
-                    qint16  *Dmax   = d,
-                            *Dmin   = d;
-                    float   val     = V_S_T_ADJ( d ),
-                            vmax    = val,
-                            vmin    = val;
-                    int     binWid  = dwnSmp;
-
-                    stat.add( val );
-
-                    d += nC;
-
-                    if( ndRem < binWid )
-                        binWid = ndRem;
-
-                    for( int ib = 1; ib < binWid; ++ib, d += nC ) {
-
-                        val = V_S_T_ADJ( d );
-
-                        stat.add( val );
-
-                        if( val > vmax ) {
-                            vmax    = val;
-                            Dmax    = d;
-                        }
-                        else if( val < vmin ) {
-                            vmin    = val;
-                            Dmin    = d;
-                        }
-                    }
-
-                    ndRem -= binWid;
-
-                    ybuf[ny]  = V_S_T_ADJ( Dmax ) * ysc;
-                    ybuf2[ny] = V_S_T_ADJ( Dmin ) * ysc;
-                    ++ny;
-                }
-            }
-            else if( set.sAveRadius > 0 ) {
-
-                ic2Y[ic].drawBinMax = false;
-
-                for( int it = 0; it < ntpts; it += dwnSmp, d += dstep ) {
-
-                    float   val = s_t_Ave( d, ic );
+                bins.addStats( stat, ic, lvl );
 
-                    stat.add( val );
-                    ybuf[ny++] = val * ysc;
+                for( int nb = bins.nBins(); ny < nb; ++ny ) {
+                    ybuf[ny]  = (bins.binMax( ny, ic ) - lvl) * ysc;
+                    ybuf2[ny] = (bins.binMin( ny, ic ) - lvl) * ysc;
                 }
             }
             else {
@@ -282,9 +355,19 @@ void SVGrafsM_Ni::putScans( vec_i16 &data, quint64 headCt )
                 ybuf[ny++] = *d;
         }
 
+        // DC level tracks the sums just taken
+
+        if( set.dcChkOn && !backfill && ic < nNu )
+            dc.add( ic, stat.sum(), stat.count(), ntpts );
+
         // Append points en masse
         // Renormalize x-coords -> consecutive indices.
 
+        if( backfill ) {
+            putTail( ic, ybuf.data(), ybuf2.data(), ny );
+            continue;
+        }
+
         theX->dataMtx.lock();
 
         ic2Y[ic].yval.putData( &ybuf[0], ny );
@@ -294,37 +377,6 @@ void SVGrafsM_Ni::putScans( vec_i16 &data, quint64 headCt )
 
         theX->dataMtx.unlock();
     }
-
-// -----------------------
-// Update pseudo time axis
-// -----------------------
-
-    double  span        = theX->spanSecs(),
-            TabsCursor  = (headCt + ntpts) / p.ni.srate,
-            TwinCursor  = span * theX->Y[0]->yval.cursor()
-                            / theX->Y[0]->yval.capacity();
-
-    theX->spanMtx.lock();
-    theX->min_x = qMax( TabsCursor - TwinCursor, 0.0 );
-    theX->max_x = theX->min_x + span;
-    theX->spanMtx.unlock();
-
-// ----
-// Draw
-// ----
-
-    QMetaObject::invokeMethod( theM, "update", Qt::QueuedConnection );
-
-    drawMtx.unlock();
-
-// ---------
-// Profiling
-// ---------
-
-#if 0
-    tProf = getTime() - tProf;
-    Log() << "Graph milis " << 1000*tProf;
-#endif
 }
 
 
@@ -398,23 +450,24 @@ void SVGrafsM_Ni::bandSelChanged( int sel )
 {
     fltMtx.lock();
 
-    if( hipass ) {
-        delete hipass;
-        hipass = 0;
-    }
-
-    if( lopass ) {
-        delete lopass;
-        lopass = 0;
+    if( flt ) {
+        delete flt;
+        flt = 0;
     }
 
     if( !sel )
         ;
     else if( sel == 1 )
-        hipass = new Biquad( bq_type_highpass, 300/p.ni.srate );
+        flt = new BiquadMC( bq_type_highpass, 300/p.ni.srate );
     else {
-        hipass = new Biquad( bq_type_highpass, 0.1/p.ni.srate );
-        lopass = new Biquad( bq_type_lowpass,  300/p.ni.srate );
+
+        std::vector<SOSCoeffs>  S;
+
+        SOSDesign::bandpass(
+            S, sos_butterworth, 2, 0.1/p.ni.srate, 300/p.ni.srate );
+
+        flt = new BiquadMC;
+        flt->setSections( S, true );
     }
 
     fltMtx.unlock();
@@ -429,14 +482,21 @@ void SVGrafsM_Ni::bandSelChanged( int sel )
 }
 
 
+void SVGrafsM_Ni::sAveSelChanged( int sel )
+{
+    drawMtx.lock();
+    set.sAveSel = sel;
+    sAveTable( p.ni.sns.shankMap, 0, neurChanCount() );
+    saveSettings();
+    drawMtx.unlock();
+}
+
+
 void SVGrafsM_Ni::sAveRadChanged( int radius )
 {
     drawMtx.lock();
     set.sAveRadius = radius;
-    sAveTable(
-        p.ni.sns.shankMap,
-        0, neurChanCount(),
-        radius );
+    sAveTable( p.ni.sns.shankMap, 0, neurChanCount() );
     saveSettings();
     drawMtx.unlock();
 }
@@ -694,6 +754,8 @@ void SVGrafsM_Ni::loadSettings()
     set.navNChan    = settings.value( "navNChan", 32 ).toInt();
     set.bandSel     = settings.value( "bandSel", 0 ).toInt();
     set.sAveRadius  = settings.value( "sAveRadius", 0 ).toInt();
+    set.sAveSel     = settings.value( "sAveSel", int(set.sAveRadius > 0) ).toInt();
+    set.sAveRadius  = qMax( set.sAveRadius, 1 );
     set.filterChkOn = settings.value( "filterChkOn", false ).toBool();
     set.dcChkOn     = settings.value( "dcChkOn", false ).toBool();
     set.binMaxOn    = settings.value( "binMaxOn", true ).toBool();
@@ -716,6 +778,7 @@ void SVGrafsM_Ni::saveSettings() const
     settings.setValue( "clr2", clrToString( set.clr2 ) );
     settings.setValue( "navNChan", set.navNChan );
     settings.setValue( "bandSel", set.bandSel );
+    settings.setValue( "sAveSel", set.sAveSel );
     settings.setValue( "sAveRadius", set.sAveRadius );
     settings.setValue( "filterChkOn", set.filterChkOn );
     settings.setValue( "dcChkOn", set.dcChkOn );
@@ -3,7 +3,7 @@
 
 #include "SVGrafsM.h"
 
-class Biquad;
+class BiquadMC;
 
 /* ---------------------------------------------------------------- */
 /* Types ---------------------------------------------------------- */
@@ -14,8 +14,7 @@ class SVGrafsM_Ni : public SVGrafsM
     Q_OBJECT
 
 private:
-    Biquad          *hipass,
-                    *lopass;
+    BiquadMC        *flt;
     mutable QMutex  fltMtx;
 
 public:
@@ -23,6 +22,7 @@ public:
     virtual ~SVGrafsM_Ni();
 
     virtual void putScans( vec_i16 &data, quint64 headCt );
+    virtual void putBackfill( vec_i16 &data );
     virtual void updateRHSFlags();
 
     virtual int chanCount() const;
@@ -35,6 +35,7 @@ public:
 public slots:
     virtual void bandSelChanged( int sel );
     virtual void filterChkClicked( bool )       {}
+    virtual void sAveSelChanged( int sel );
     virtual void sAveRadChanged( int radius );
 
 private slots:
@@ -64,6 +65,7 @@ protected:
     virtual void saveSettings() const;
 
 private:
+    void putChans( vec_i16 &data, int ntpts, bool backfill );
     double scalePlotValue( double v, double gain ) const;
     void computeGraphMouseOverVars(
         int         ic,
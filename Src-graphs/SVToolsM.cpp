@@ -166,14 +166,26 @@ void SVToolsM::init()
     L = new QLabel( "-<S>", this );
     L->setTextFormat( Qt::PlainText );
     L->setAlignment( Qt::AlignCenter );
-    L->setToolTip( "Spatially average spike channels" );
+    L->setToolTip( "Spatially reference spike channels" );
     L->setStyleSheet( "padding-bottom: 1px" );
     addWidget( L );
 
+    CB = new QComboBox( this );
+    CB->setToolTip(
+        "Local: mean of sites within radius;"
+        " CAR: mean of all sites; CMR: median of all sites" );
+    CB->addItem( "Off" );
+    CB->addItem( "Local" );
+    CB->addItem( "CAR" );
+    CB->addItem( "CMR" );
+    CB->setCurrentIndex( gr->curSAveSel() );
+    ConnectUI( CB, SIGNAL(currentIndexChanged(int)), gr, SLOT(sAveSelChanged(int)) );
+    addWidget( CB );
+
     V = new QSpinBox( this );
-    V->setToolTip( "Averaging radius: {N electrodes, 0=OFF}" );
+    V->setToolTip( "Local averaging radius: {N electrodes}" );
     V->installEventFilter( gr->getGWWidget() );
-    V->setMinimum( 0 );
+    V->setMinimum( 1 );
     V->setMaximum( 400 );
     V->setValue( gr->curSAveRadius() );
     ConnectUI( V, SIGNAL(valueChanged(int)), gr, SLOT(sAveRadChanged(int)) );
@@ -0,0 +1,105 @@
+
+#include "ShankActivity.h"
+#include "Util.h"
+#include "DAQ.h"
+#include "BiquadMC.h"
+
+#include <math.h>
+
+
+/* ---------------------------------------------------------------- */
+/* ShankActivity -------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+ShankActivity::ShankActivity( const DAQ::Params &p )
+    :   p(p), flt(0), tly(p), srate(1),
+        ip(0), nchans(0), nAP(0), nzero(0)
+{
+}
+
+
+ShankActivity::~ShankActivity()
+{
+    if( flt )
+        delete flt;
+}
+
+
+void ShankActivity::init( int ip )
+{
+    const CimCfg::AttrEach  &E = p.im.each[ip];
+
+    this->ip    = ip;
+    srate       = p.im.all.srate;
+    nchans      = E.imCumTypCnt[CimCfg::imSumAll];
+    nAP         = E.imCumTypCnt[CimCfg::imSumAP];
+
+    double  ysc = 1e6 * p.im.all.range.rmax / MAX10BIT;
+
+    uV.resize( nAP );
+
+    for( int i = 0; i < nAP; ++i )
+        uV[i] = ysc / E.chanGain( i );
+
+    for( int m = 0; m < actNMeasures; ++m )
+        val[m].fill( 0, nAP );
+
+    tly.init( ip, nAP );
+    tly.sumSquares( true );
+
+    if( flt )
+        delete flt;
+
+    flt = new BiquadMC( bq_type_highpass, 300/srate );
+
+    reset();
+}
+
+
+// Restart filter (and its transient) and tallies.
+//
+void ShankActivity::reset()
+{
+    if( flt )
+        flt->clearMem();
+
+    nzero = BIQUAD_TRANS_WIDE;
+
+    tly.rearm();
+    tly.zeroData();
+}
+
+
+void ShankActivity::putScans( const vec_i16 &data, quint64 headCt )
+{
+    int ntpts = (nchans ? (int)data.size() / nchans : 0);
+
+    if( ntpts <= 0 || !nAP )
+        return;
+
+    tly.putBlock(
+        &data[0], ntpts, nchans, 0,
+        flt, MAX10BIT, nzero, headCt );
+}
+
+
+bool ShankActivity::finish()
+{
+    if( tly.nSamp <= 0 )
+        return false;
+
+    double  count2Rate = srate / tly.nSamp;
+
+    for( int i = 0; i < nAP; ++i ) {
+
+        val[actSpikes][i]   = tly.spk[i] * count2Rate;
+        val[actPkPk][i]     = tly.pkpk( i ) * uV[i];
+        val[actRMS][i]      = sqrt( tly.ss[i] / tly.nSamp ) * uV[i];
+    }
+
+    tly.zeroData();
+
+    return true;
+}
+
+
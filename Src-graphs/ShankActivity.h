@@ -0,0 +1,80 @@
+#ifndef SHANKACTIVITY_H
+#define SHANKACTIVITY_H
+
+#include "SGLTypes.h"
+#include "ShankTally.h"
+
+#include <QVector>
+
+namespace DAQ {
+struct Params;
+}
+
+class BiquadMC;
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Activity tally for one imec probe's AP channels, shared by all
+// views of the probe overview.
+//
+// Each block is read once by the ShankTally kernel: highpassed
+// (300 Hz) and scanned for spike runs, min/max and sums of squares.
+// So spike rate, pk-pk and RMS all come from one filter pass, and
+// a view switching measure needs no reprocessing.
+//
+// finish() converts the interval's tallies to (val), then zeroes
+// them (as does zeroData()); spike runs and filter state carry on.
+//
+// With logSpikes() on, each spike's stream count and channel are
+// also kept until takeSpikes(), for the spike raster.
+//
+class ShankActivity
+{
+public:
+    enum Measure {
+        actSpikes   = 0,    // Hz
+        actPkPk     = 1,    // uV
+        actRMS      = 2,    // uV
+        actNMeasures
+    };
+
+    typedef ShankTally::Spike   Spike;
+
+private:
+    const DAQ::Params   &p;
+    BiquadMC            *flt;
+    ShankTally          tly;
+    QVector<double>     uV;     // per chan: uV per count
+    double              srate;
+    int                 ip,
+                        nchans,
+                        nAP,
+                        nzero;
+
+public:
+    QVector<double>     val[actNMeasures];
+
+public:
+    ShankActivity( const DAQ::Params &p );
+    virtual ~ShankActivity();
+
+    void init( int ip );
+    void setThresh( int thresh, int inarow )    {tly.setThresh( thresh, inarow );}
+    void reset();
+    void zeroData()                             {tly.zeroData();}
+
+    void logSpikes( bool on )                   {tly.logSpikes( on );}
+    void takeSpikes( std::vector<Spike> &dst )  {tly.takeSpikes( dst );}
+
+    // Add whole probe rows; (headCt) is count of first.
+    void putScans( const vec_i16 &data, quint64 headCt = 0 );
+
+    // Return false if nothing tallied since last.
+    bool finish();
+};
+
+#endif  // SHANKACTIVITY_H
+
+
@@ -6,12 +6,13 @@
 #include "ShankCtl.h"
 #include "DAQ.h"
 #include "ShankMap.h"
-#include "Biquad.h"
+#include "BiquadMC.h"
 #include "SignalBlocker.h"
 #include "HelpWindow.h"
 
 #include <QCloseEvent>
 
+
 /* ---------------------------------------------------------------- */
 /* class Tally ---------------------------------------------------- */
 /* ---------------------------------------------------------------- */
@@ -25,6 +26,8 @@ void ShankCtl::Tally::init( double sUpdt, int ip )
     else
         nPads = p.ni.niCumTypCnt[CniCfg::niSumNeural];
 
+    K.init( ip, nPads );
+
     updtChanged( sUpdt );
 }
 
@@ -40,102 +43,56 @@ void ShankCtl::Tally::updtChanged( double s )
 
 void ShankCtl::Tally::zeroData()
 {
-    vmin.fill(  99000, nPads );
-    vmax.fill( -99000, nPads );
+    K.zeroData();
     sums.fill( 0, nPads );
-    sumSamps    = 0;
-    chunksDone  = 0;
+    chunksDone = 0;
 }
 
 
-bool ShankCtl::Tally::countSpikes(
+bool ShankCtl::Tally::putBlock(
     const short *data,
     int         ntpts,
     int         nchans,
     int         c0,
     int         cLim,
+    BiquadMC    *flt,
+    int         maxInt,
+    int         &nzero,
+    int         what,
     int         thresh,
     int         inarow )
 {
-    if( !ntpts )
-        return false;
-
-    sumSamps += ntpts;
-
-    for( int c = c0; c < cLim; ++c ) {
-
-        const short *d      = &data[c],
-                    *dlim   = &data[c + ntpts*nchans];
-        int i       = c - c0,
-            T       = (ip >= 0 ?
-                        p.im.vToInt10( thresh*1e-6, ip, i ) :
-                        p.ni.vToInt16( thresh*1e-6, i ));
-        int hiCnt   = (*d <= T ? inarow : 0),
-            spikes  = 0;
-
-        while( (d += nchans) < dlim ) {
-
-            if( *d <= T ) {
-
-                if( ++hiCnt == inarow )
-                    ++spikes;
-            }
-            else
-                hiCnt = 0;
-        }
+    int nc = cLim - c0;
 
-        sums[i] += spikes;
-    }
-
-    bool    done = ++chunksDone >= chunksReqd;
-
-    if( done ) {
-
-        double  count2Rate = (ip >= 0 ? p.im.all.srate : p.ni.srate)
-                                / sumSamps;
+    if( ntpts <= 0 || nc <= 0 )
+        return false;
 
-        for( int i = 0; i < nPads; ++i )
-            sums[i] *= count2Rate;
-    }
+    if( nc != K.nChans() )
+        K.init( ip, nc );
 
-    return done;
-}
+    K.setThresh( thresh, inarow );
+    K.putBlock( data, ntpts, nchans, c0, flt, maxInt, nzero );
 
-
-bool ShankCtl::Tally::accumPkPk(
-    const short *data,
-    int         ntpts,
-    int         nchans,
-    int         c0,
-    int         cLim )
-{
-    if( !ntpts )
+    if( ++chunksDone < chunksReqd )
         return false;
 
-    for( int it = 0; it < ntpts; ++it, data += nchans ) {
-
-        for( int c = c0; c < cLim; ++c ) {
+    int n = qMin( nc, nPads );
 
-            int v = data[c],
-                i = c - c0;
+    if( !what ) {
 
-            if( v < vmin[i] )
-                vmin[i] = v;
+        double  count2Rate = (ip >= 0 ? p.im.all.srate : p.ni.srate)
+                                / K.nSamp;
 
-            if( v > vmax[i] )
-                vmax[i] = v;
-        }
+        for( int i = 0; i < n; ++i )
+            sums[i] = K.spk[i] * count2Rate;
     }
+    else {
 
-    bool    done = ++chunksDone >= chunksReqd;
-
-    if( done ) {
-
-        for( int i = 0; i < nPads; ++i )
-            sums[i] = vmax[i] - vmin[i];
+        for( int i = 0; i < n; ++i )
+            sums[i] = K.pkpk( i );
     }
 
-    return done;
+    return true;
 }
 
 /* ---------------------------------------------------------------- */
@@ -144,7 +101,7 @@ bool ShankCtl::Tally::accumPkPk(
 
 ShankCtl::ShankCtl( const DAQ::Params &p, QWidget *parent )
     :   QWidget(parent), p(p), helpDlg(0),
-        tly(p), hipass(0), lopass(0)
+        tly(p), flt(0)
 {
 }
 
@@ -153,14 +110,9 @@ ShankCtl::~ShankCtl()
 {
     drawMtx.lock();
 
-        if( hipass ) {
-            delete hipass;
-            hipass = 0;
-        }
-
-        if( lopass ) {
-            delete lopass;
-            lopass = 0;
+        if( flt ) {
+            delete flt;
+            flt = 0;
         }
 
     drawMtx.unlock();
@@ -352,21 +304,6 @@ void ShankCtl::baseInit( int ip )
 }
 
 
-void ShankCtl::zeroFilterTransient( short *data, int ntpts, int nchans )
-{
-    if( nzero > 0 ) {
-
-        // overwrite with zeros
-
-        if( ntpts > nzero )
-            ntpts = nzero;
-
-        memset( data, 0, ntpts*nchans*sizeof(qint16) );
-        nzero -= ntpts;
-    }
-}
-
-
 void ShankCtl::dcAve(
     QVector<int>    &ave,
     short           *data,
@@ -2,10 +2,13 @@
 #define SHANKCTL_H
 
 #include "SGLTypes.h"
+#include "ShankTally.h"
 
 #include <QWidget>
 #include <QMutex>
 
+#include <vector>
+
 namespace Ui {
 class ShankWindow;
 }
@@ -14,7 +17,7 @@ namespace DAQ {
 struct Params;
 }
 
-class Biquad;
+class BiquadMC;
 
 class QDialog;
 
@@ -36,12 +39,13 @@ protected:
                 rng[3]; // {rate, uV, uV}
     };
 
+    // Interval timing and units over the ShankTally kernel:
+    // every (updtSecs) the tallies become spike rates or pk-pk
+    // in (sums).
     class Tally {
     private:
         const DAQ::Params   &p;
-        QVector<int>        vmin,
-                            vmax;
-        double              sumSamps;
+        ShankTally          K;
         int                 ip,
                             chunksDone,
                             chunksReqd,
@@ -49,24 +53,26 @@ protected:
     public:
         QVector<double>     sums;
     public:
-        Tally( const DAQ::Params &p ) : p(p) {}
+        Tally( const DAQ::Params &p ) : p(p), K(p) {}
         void init( double sUpdt, int ip );
         void updtChanged( double s );
         void zeroData();
-        bool countSpikes(
+        // Filter chans [c0,cLim) of (data) with (flt), zeroing
+        // the first (nzero) filtered rows, and count spikes
+        // (what = 0) or accumulate pk-pk (else).
+        // Return true if tally done.
+        bool putBlock(
             const short *data,
             int         ntpts,
             int         nchans,
             int         c0,
             int         cLim,
+            BiquadMC    *flt,
+            int         maxInt,
+            int         &nzero,
+            int         what,
             int         thresh,
             int         inarow );
-        bool accumPkPk(
-            const short *data,
-            int         ntpts,
-            int         nchans,
-            int         c0,
-            int         cLim );
     };
 
 protected:
@@ -75,8 +81,7 @@ protected:
     QDialog             *helpDlg;
     UsrSettings         set;
     Tally               tly;
-    Biquad              *hipass,
-                        *lopass;
+    BiquadMC            *flt;
     int                 nzero,
                         ip;
     mutable QMutex      drawMtx;
@@ -115,8 +120,6 @@ private slots:
 protected:
     void baseInit( int ip );
 
-    void zeroFilterTransient( short *data, int ntpts, int nchans );
-
     void dcAve(
         QVector<int>    &ave,
         short           *data,
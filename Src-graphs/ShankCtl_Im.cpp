@@ -4,15 +4,11 @@
 #include "Util.h"
 #include "ShankCtl_Im.h"
 #include "DAQ.h"
-#include "Subset.h"
-#include "Biquad.h"
+#include "BiquadMC.h"
 
 #include <QSettings>
 
 
-#define MAX10BIT    512
-
-
 /* ---------------------------------------------------------------- */
 /* ShankCtl_Im ---------------------------------------------------- */
 /* ---------------------------------------------------------------- */
@@ -52,40 +48,21 @@ void ShankCtl_Im::putScans( const vec_i16 &_data )
 
     drawMtx.lock();
 
-// -----------------------------
-// Make local copy we can filter
-// -----------------------------
-
-    vec_i16 data;
-
-    if( set.what < 2 )
-        Subset::subsetBlock( data, *(vec_i16*)&_data, 0, nAP, nC );
-    else
-        Subset::subsetBlock( data, *(vec_i16*)&_data, nAP, nNu, nC );
-
-    hipass->applyBlockwiseMem( &data[0], MAX10BIT, ntpts, nAP, 0, nAP );
+// -----------------------------------------
+// Filter and tally current chunk, tile-wise
+// -----------------------------------------
 
-    zeroFilterTransient( &data[0], ntpts, nAP );
+    int     c0      = (set.what < 2 ? 0 : nAP),
+            cLim    = (set.what < 2 ? nAP : nNu);
+    bool    done    = tly.putBlock(
+                        &_data[0], ntpts, nC, c0, cLim,
+                        flt, MAX10BIT, nzero,
+                        set.what, set.thresh, set.inarow );
 
-// --------------------------
-// Process current data chunk
-// --------------------------
-
-    bool    done = false;
-
-    if( set.what == 0 ) {
-
-        // Count spikes
-
-        done = tly.countSpikes( &data[0], ntpts, nAP, 0, nAP,
-                set.thresh, set.inarow );
-    }
-    else {
+    if( set.what != 0 ) {
 
         // Peak to peak
 
-        done = tly.accumPkPk( &data[0], ntpts, nAP, 0, nAP );
-
         if( done ) {
 
             if( set.what == 1 ) {
@@ -165,15 +142,15 @@ void ShankCtl_Im::updateFilter( bool lock )
     if( lock )
         drawMtx.lock();
 
-    if( hipass ) {
-        delete hipass;
-        hipass = 0;
+    if( flt ) {
+        delete flt;
+        flt = 0;
     }
 
     if( set.what < 2 )
-        hipass = new Biquad( bq_type_highpass, 300/p.im.all.srate );
+        flt = new BiquadMC( bq_type_highpass, 300/p.im.all.srate );
     else
-        hipass = new Biquad( bq_type_highpass, 0.2/p.im.all.srate );
+        flt = new BiquadMC( bq_type_highpass, 0.2/p.im.all.srate, 0, true );
 
     nzero = BIQUAD_TRANS_WIDE;
 
@@ -4,15 +4,11 @@
 #include "Util.h"
 #include "ShankCtl_Ni.h"
 #include "DAQ.h"
-#include "Subset.h"
-#include "Biquad.h"
+#include "BiquadMC.h"
 
 #include <QSettings>
 
 
-#define MAX16BIT    32768
-
-
 /* ---------------------------------------------------------------- */
 /* ShankCtl_Ni ---------------------------------------------------- */
 /* ---------------------------------------------------------------- */
@@ -48,39 +44,19 @@ void ShankCtl_Ni::putScans( const vec_i16 &_data )
 
     drawMtx.lock();
 
-// -----------------------------
-// Make local copy we can filter
-// -----------------------------
-
-    vec_i16 data;
-    Subset::subsetBlock( data, *(vec_i16*)&_data, 0, nNu, nC );
-
-    hipass->applyBlockwiseMem( &data[0], MAX16BIT, ntpts, nNu, 0, nNu );
-
-    if( lopass )
-        lopass->applyBlockwiseMem( &data[0], MAX16BIT, ntpts, nNu, 0, nNu );
-
-    zeroFilterTransient( &data[0], ntpts, nNu );
-
-// --------------------------
-// Process current data chunk
-// --------------------------
-
-    bool    done = false;
-
-    if( set.what == 0 ) {
+// -----------------------------------------
+// Filter and tally current chunk, tile-wise
+// -----------------------------------------
 
-        // Count spikes
+    bool    done = tly.putBlock(
+                    &_data[0], ntpts, nC, 0, nNu,
+                    flt, MAX16BIT, nzero,
+                    set.what, set.thresh, set.inarow );
 
-        done = tly.countSpikes( &data[0], ntpts, nNu, 0, nNu,
-                set.thresh, set.inarow );
-    }
-    else {
+    if( set.what != 0 ) {
 
         // Peak to peak
 
-        done = tly.accumPkPk( &data[0], ntpts, nNu, 0, nNu );
-
         if( done ) {
 
             for( int i = 0; i < nNu; ++i )
@@ -146,21 +122,24 @@ void ShankCtl_Ni::updateFilter( bool lock )
     if( lock )
         drawMtx.lock();
 
-    if( hipass ) {
-        delete hipass;
-        hipass = 0;
-    }
-
-    if( lopass ) {
-        delete lopass;
-        lopass = 0;
+    if( flt ) {
+        delete flt;
+        flt = 0;
     }
 
     if( set.what < 2 )
-        hipass = new Biquad( bq_type_highpass, 300/p.ni.srate );
+        flt = new BiquadMC( bq_type_highpass, 300/p.ni.srate );
     else {
-        hipass = new Biquad( bq_type_highpass, 0.2/p.ni.srate );
-        lopass = new Biquad( bq_type_lowpass,  300/p.ni.srate );
+
+        // LF band: 0.2 Hz hipass and 300 Hz lopass in one pass
+
+        std::vector<SOSCoeffs>  S;
+
+        SOSDesign::bandpass(
+            S, sos_butterworth, 2, 0.2/p.ni.srate, 300/p.ni.srate );
+
+        flt = new BiquadMC;
+        flt->setSections( S, true );
     }
 
     nzero = BIQUAD_TRANS_WIDE;
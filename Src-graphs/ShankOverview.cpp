@@ -0,0 +1,302 @@
+
+#include "ui_ShankOvWindow.h"
+
+#include "Util.h"
+#include "MainApp.h"
+#include "ShankOverview.h"
+#include "ProbeActivity.h"
+#include "ShankView.h"
+#include "DAQ.h"
+#include "SignalBlocker.h"
+
+#include <QBoxLayout>
+#include <QCloseEvent>
+#include <QLabel>
+#include <QSettings>
+
+
+/* ---------------------------------------------------------------- */
+/* ShankOverview -------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+ShankOverview::ShankOverview( const DAQ::Params &p, ProbeActivity *pa )
+    :   QWidget(0), p(p), svUI(0), pa(pa)
+{
+    loadSettings();
+
+    svUI = new Ui::ShankOvWindow;
+    svUI->setupUi( this );
+
+// ------------------
+// One view per probe
+// ------------------
+
+    QHBoxLayout *HL = new QHBoxLayout( svUI->probes );
+    HL->setContentsMargins( 0, 0, 0, 0 );
+
+    for( int ip = 0; ip < p.im.nProbes; ++ip ) {
+
+        QVBoxLayout *VL = new QVBoxLayout;
+        ShankScroll *S  = new ShankScroll( svUI->probes );
+
+        S->setMinimumWidth( 68 );
+        S->setSizePolicy( QSizePolicy::MinimumExpanding, QSizePolicy::Expanding );
+        S->theV->setShankMap( &p.im.each[ip].sns.shankMap );
+        S->setRowPix( set.yPix );
+
+        VL->addWidget(
+            new QLabel( QString("imec%1").arg( ip ), svUI->probes ),
+            0, Qt::AlignHCenter );
+        VL->addWidget( S, 1 );
+        HL->addLayout( VL );
+
+        ConnectUI( S->theV, SIGNAL(cursorOver(int,bool)), this, SLOT(cursorOver(int,bool)) );
+
+        vS.push_back( S );
+    }
+
+// --------
+// Controls
+// --------
+
+    svUI->ypixSB->setValue( set.yPix );
+    svUI->whatCB->setCurrentIndex( set.what );
+    svUI->TSB->setValue( -pa->getThresh() );
+    svUI->TSB->setEnabled( set.what == 0 );
+    svUI->inarowSB->setValue( pa->getInarow() );
+    svUI->inarowSB->setEnabled( set.what == 0 );
+    svUI->updtSB->setValue( set.updtSecs );
+    svUI->rngSB->setValue( set.rng[set.what] );
+
+    ConnectUI( svUI->ypixSB, SIGNAL(valueChanged(int)), this, SLOT(ypixChanged(int)) );
+    ConnectUI( svUI->whatCB, SIGNAL(currentIndexChanged(int)), this, SLOT(whatChanged(int)) );
+    ConnectUI( svUI->TSB, SIGNAL(valueChanged(int)), this, SLOT(threshChanged(int)) );
+    ConnectUI( svUI->inarowSB, SIGNAL(valueChanged(int)), this, SLOT(inarowChanged(int)) );
+    ConnectUI( svUI->updtSB, SIGNAL(valueChanged(double)), this, SLOT(updtChanged(double)) );
+    ConnectUI( svUI->rngSB, SIGNAL(valueChanged(int)), this, SLOT(rangeChanged(int)) );
+
+    setWindowTitle( "Imec Probe Overview" );
+    setAttribute( Qt::WA_DeleteOnClose, false );
+
+// ------
+// Source
+// ------
+
+    pa->setUpdtSecs( set.updtSecs );
+
+    Connect( pa, SIGNAL(tallied()), this, SLOT(refresh()) );
+    Connect( pa, SIGNAL(spikeParamsChanged()), this, SLOT(spikeParamsChanged()) );
+}
+
+
+ShankOverview::~ShankOverview()
+{
+    pa->ovEnable( false );
+
+    saveSettings();
+
+    if( svUI ) {
+        delete svUI;
+        svUI = 0;
+    }
+}
+
+
+void ShankOverview::showDialog()
+{
+    show();
+    activateWindow();
+    mainApp()->modelessOpened( this );
+}
+
+/* ---------------------------------------------------------------- */
+/* Slots ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+void ShankOverview::refresh()
+{
+    QVector<double> val;
+
+    for( int ip = 0, np = vS.size(); ip < np; ++ip ) {
+
+        pa->getVals( val, ip, set.what );
+
+        if( val.size() ) {
+            vS[ip]->theV->colorPads( val, set.rng[set.what] );
+            vS[ip]->theV->updateNow();
+        }
+    }
+}
+
+
+// Set from either view.
+//
+void ShankOverview::spikeParamsChanged()
+{
+    SignalBlocker   b0(svUI->TSB), b1(svUI->inarowSB);
+
+    svUI->TSB->setValue( -pa->getThresh() );
+    svUI->inarowSB->setValue( pa->getInarow() );
+}
+
+
+void ShankOverview::cursorOver( int ic, bool shift )
+{
+    Q_UNUSED( shift )
+
+    ShankView   *V  = dynamic_cast<ShankView*>(sender());
+    int         ip  = -1;
+
+    for( int is = 0, ns = vS.size(); is < ns; ++is ) {
+
+        if( vS[is]->theV == V ) {
+            ip = is;
+            break;
+        }
+    }
+
+    if( ic < 0 || ip < 0 ) {
+        svUI->statusLbl->setText( QString::null );
+        return;
+    }
+
+    const CimCfg::AttrEach  &E      = p.im.each[ip];
+    QString                 stream  = QString("imec%1").arg( ip );
+    int                     r       = V->getSmap()->e[ic].r;
+
+    svUI->statusLbl->setText(
+        QString("%1 row %2 %3")
+        .arg( stream )
+        .arg( r, 3, 10, QChar('0') )
+        .arg( E.sns.chanMap.name( ic, p.isTrigChan( stream, ic ) ) ) );
+}
+
+
+void ShankOverview::ypixChanged( int y )
+{
+    set.yPix = y;
+
+    for( int ip = 0, np = vS.size(); ip < np; ++ip )
+        vS[ip]->setRowPix( y );
+
+    saveSettings();
+}
+
+
+// All measures are tallied together: recolor now.
+//
+void ShankOverview::whatChanged( int i )
+{
+    set.what = i;
+
+    SignalBlocker   b0(svUI->rngSB);
+    svUI->TSB->setEnabled( !i );
+    svUI->inarowSB->setEnabled( !i );
+    svUI->rngSB->setValue( set.rng[i] );
+
+    refresh();
+    saveSettings();
+}
+
+
+void ShankOverview::threshChanged( int t )
+{
+    pa->setSpikeParams( -t, pa->getInarow() );
+}
+
+
+void ShankOverview::inarowChanged( int s )
+{
+    pa->setSpikeParams( pa->getThresh(), s );
+}
+
+
+void ShankOverview::updtChanged( double s )
+{
+    set.updtSecs = s;
+    pa->setUpdtSecs( s );
+    saveSettings();
+}
+
+
+void ShankOverview::rangeChanged( int r )
+{
+    set.rng[set.what] = r;
+    refresh();
+    saveSettings();
+}
+
+/* ---------------------------------------------------------------- */
+/* Protected ------------------------------------------------------ */
+/* ---------------------------------------------------------------- */
+
+void ShankOverview::keyPressEvent( QKeyEvent *e )
+{
+    if( e->key() == Qt::Key_Escape ) {
+
+        close();
+        e->accept();
+    }
+    else
+        QWidget::keyPressEvent( e );
+}
+
+
+// Fetch only while shown.
+//
+void ShankOverview::showEvent( QShowEvent *e )
+{
+    QWidget::showEvent( e );
+    pa->ovEnable( true );
+}
+
+
+void ShankOverview::hideEvent( QHideEvent *e )
+{
+    QWidget::hideEvent( e );
+    pa->ovEnable( false );
+}
+
+
+void ShankOverview::closeEvent( QCloseEvent *e )
+{
+    QWidget::closeEvent( e );
+
+    if( e->isAccepted() )
+        emit closed( this );
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+void ShankOverview::loadSettings()
+{
+    STDSETTINGS( settings, "shankoverview" );
+
+    settings.beginGroup( "ShankOverview" );
+    set.updtSecs    = settings.value( "updtSecs", 1.0 ).toDouble();
+    set.yPix        = settings.value( "yPix", 2 ).toInt();
+    set.what        = settings.value( "what", 0 ).toInt();
+    set.rng[0]      = settings.value( "rngSpk", 1000 ).toInt();
+    set.rng[1]      = settings.value( "rngAP", 100 ).toInt();
+    set.rng[2]      = settings.value( "rngRMS", 20 ).toInt();
+    settings.endGroup();
+}
+
+
+void ShankOverview::saveSettings() const
+{
+    STDSETTINGS( settings, "shankoverview" );
+
+    settings.beginGroup( "ShankOverview" );
+    settings.setValue( "updtSecs", set.updtSecs );
+    settings.setValue( "yPix", set.yPix );
+    settings.setValue( "what", set.what );
+    settings.setValue( "rngSpk", set.rng[0] );
+    settings.setValue( "rngAP", set.rng[1] );
+    settings.setValue( "rngRMS", set.rng[2] );
+    settings.endGroup();
+}
+
+
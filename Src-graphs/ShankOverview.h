@@ -0,0 +1,79 @@
+#ifndef SHANKOVERVIEW_H
+#define SHANKOVERVIEW_H
+
+#include <QWidget>
+#include <QVector>
+
+namespace Ui {
+class ShankOvWindow;
+}
+
+namespace DAQ {
+struct Params;
+}
+
+class ProbeActivity;
+class ShankScroll;
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// One window showing all imec probes' shank activity side by
+// side, from the run's shared tally per probe (ProbeActivity).
+// Changing the measure or range recolors from the last tallies
+// at once.
+//
+class ShankOverview : public QWidget
+{
+    Q_OBJECT
+
+private:
+    struct UsrSettings {
+        double  updtSecs;
+        int     yPix,
+                what,
+                rng[3]; // {rate, uV, uV}
+    };
+
+private:
+    const DAQ::Params       &p;
+    Ui::ShankOvWindow       *svUI;
+    QVector<ShankScroll*>   vS;
+    UsrSettings             set;
+    ProbeActivity           *pa;
+
+public:
+    ShankOverview( const DAQ::Params &p, ProbeActivity *pa );
+    virtual ~ShankOverview();
+
+    void showDialog();
+
+signals:
+    void closed( QWidget *w );
+
+private slots:
+    void refresh();
+    void spikeParamsChanged();
+    void cursorOver( int ic, bool shift );
+    void ypixChanged( int y );
+    void whatChanged( int i );
+    void threshChanged( int t );
+    void inarowChanged( int s );
+    void updtChanged( double s );
+    void rangeChanged( int r );
+
+protected:
+    virtual void keyPressEvent( QKeyEvent *e );
+    virtual void showEvent( QShowEvent *e );
+    virtual void hideEvent( QHideEvent *e );
+    virtual void closeEvent( QCloseEvent *e );
+
+private:
+    void loadSettings();
+    void saveSettings() const;
+};
+
+#endif  // SHANKOVERVIEW_H
+
+
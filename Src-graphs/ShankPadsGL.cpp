@@ -0,0 +1,284 @@
+
+#include "ShankPadsGL.h"
+#include "ShankMap.h"
+#include "Util.h"
+
+#include <QOpenGLBuffer>
+#include <QOpenGLContext>
+#include <QOpenGLShaderProgram>
+#include <QVector3D>
+
+#ifndef QT_OPENGL_ES_2
+#include <QOpenGLFunctions_3_0>
+#endif
+
+
+// Value to LUT index exactly as ShankView::colorPads().
+//
+static const char *vsrc =
+    "#version 130\n"
+    "in vec2    aPos;\n"
+    "in float   aPad;\n"
+    "uniform sampler1D  uVal;\n"
+    "uniform sampler1D  uLut;\n"
+    "uniform float      uRng;\n"
+    "uniform vec3       uOff;\n"
+    "out vec3   vClr;\n"
+    "void main()\n"
+    "{\n"
+    "    if( aPad < 0.0 )\n"
+    "        vClr = uOff;\n"
+    "    else {\n"
+    "        float  v = texelFetch( uVal, int(aPad), 0 ).r;\n"
+    "        int    i = 0;\n"
+    "        if( v > 0.0 )\n"
+    "            i = (v >= uRng ? 255 : int(255.0 * v / uRng));\n"
+    "        vClr = texelFetch( uLut, i, 0 ).rgb;\n"
+    "    }\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix\n"
+    "                    * vec4( aPos, 0.0, 1.0 );\n"
+    "}\n";
+
+static const char *fsrc =
+    "#version 130\n"
+    "in vec3    vClr;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_FragColor = vec4( vClr, 1.0 );\n"
+    "}\n";
+
+/* ---------------------------------------------------------------- */
+/* ShankPadsGL ---------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+ShankPadsGL::ShankPadsGL( const QVector<SColor> &lut )
+    :   f(0), prog(0), vbo(0), texVal(0), texLut(0),
+        nPads(0), maxPads(0),
+        locPos(-1), locPad(-1), locRng(-1), locOff(-1),
+        ok(false)
+{
+#ifndef QT_OPENGL_ES_2
+    QOpenGLContext  *ctx = QOpenGLContext::currentContext();
+
+    if( !ctx )
+        return;
+
+    f = ctx->versionFunctions<QOpenGLFunctions_3_0>();
+
+    if( !f || !f->initializeOpenGLFunctions() ) {
+        Log() << "ShankView: GL 3.0 unavailable; using client arrays.";
+        return;
+    }
+
+    // aPos at generic attribute 0 (aliases gl_Vertex); ShankView's
+    // client vertex array is off while the shader draws.
+
+    prog = new QOpenGLShaderProgram;
+    prog->bindAttributeLocation( "aPos", 0 );
+    prog->bindAttributeLocation( "aPad", 1 );
+
+    if( !prog->addShaderFromSourceCode( QOpenGLShader::Vertex, vsrc )
+        || !prog->addShaderFromSourceCode( QOpenGLShader::Fragment, fsrc )
+        || !prog->link() ) {
+
+        Warning() << "ShankView shader failed: " << prog->log();
+        return;
+    }
+
+    locPos  = 0;
+    locPad  = 1;
+    locRng  = prog->uniformLocation( "uRng" );
+    locOff  = prog->uniformLocation( "uOff" );
+
+    prog->bind();
+    prog->setUniformValue( "uVal", 0 );
+    prog->setUniformValue( "uLut", 1 );
+    prog->release();
+
+    f->glGetIntegerv( GL_MAX_TEXTURE_SIZE, &maxPads );
+
+// LUT: 256 RGB texels
+
+    QVector<SColor> L = lut;
+
+    if( L.size() != 256 )
+        L.fill( SColor(), 256 );
+
+    f->glGenTextures( 1, &texLut );
+    f->glBindTexture( GL_TEXTURE_1D, texLut );
+    f->glTexParameteri( GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    f->glTexParameteri( GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    f->glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+    f->glTexImage1D(
+        GL_TEXTURE_1D, 0, GL_RGB8, 256, 0,
+        GL_RGB, GL_UNSIGNED_BYTE, &L[0] );
+    f->glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+
+// Values: sized by setGeom()
+
+    f->glGenTextures( 1, &texVal );
+    f->glBindTexture( GL_TEXTURE_1D, texVal );
+    f->glTexParameteri( GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    f->glTexParameteri( GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    f->glBindTexture( GL_TEXTURE_1D, 0 );
+
+    vbo = new QOpenGLBuffer( QOpenGLBuffer::VertexBuffer );
+    vbo->setUsagePattern( QOpenGLBuffer::StaticDraw );
+
+    ok = vbo->create();
+#else
+    Q_UNUSED( lut )
+#endif
+}
+
+
+ShankPadsGL::~ShankPadsGL()
+{
+#ifndef QT_OPENGL_ES_2
+    if( f ) {
+
+        if( texVal )
+            f->glDeleteTextures( 1, &texVal );
+
+        if( texLut )
+            f->glDeleteTextures( 1, &texLut );
+    }
+#endif
+
+    if( vbo )
+        delete vbo;
+
+    if( prog )
+        delete prog;
+}
+
+
+// Values persist while the pad count is unchanged.
+//
+bool ShankPadsGL::setGeom( const QVector<float> &vR, const ShankMap *smap )
+{
+#ifndef QT_OPENGL_ES_2
+    if( !ok )
+        return false;
+
+    int ne = vR.size() / 8;
+
+    if( ne > maxPads ) {
+        ok = false;
+        return false;
+    }
+
+    geom.resize( 12*ne );
+
+    const float *R = vR.constData();
+    float       *G = geom.data();
+
+    for( int i = 0; i < ne; ++i ) {
+
+        float   pad = (smap->e[i].u ? i : -1);
+
+        for( int k = 0; k < 4; ++k, R += 2, G += 3 ) {
+            G[0] = R[0];
+            G[1] = R[1];
+            G[2] = pad;
+        }
+    }
+
+    vbo->bind();
+    vbo->allocate( geom.constData(), geom.size() * sizeof(float) );
+    vbo->release();
+
+    if( ne != nPads ) {
+
+        QVector<float>  zero( qMax( ne, 1 ), 0.0f );
+
+        f->glBindTexture( GL_TEXTURE_1D, texVal );
+        f->glTexImage1D(
+            GL_TEXTURE_1D, 0, GL_R32F, zero.size(), 0,
+            GL_RED, GL_FLOAT, zero.constData() );
+        f->glBindTexture( GL_TEXTURE_1D, 0 );
+
+        nPads = ne;
+    }
+
+    return true;
+#else
+    Q_UNUSED( vR )
+    Q_UNUSED( smap )
+    return false;
+#endif
+}
+
+
+void ShankPadsGL::setVals( const QVector<float> &val )
+{
+#ifndef QT_OPENGL_ES_2
+    int n = qMin( val.size(), nPads );
+
+    if( !ok || !n )
+        return;
+
+    f->glBindTexture( GL_TEXTURE_1D, texVal );
+    f->glTexSubImage1D(
+        GL_TEXTURE_1D, 0, 0, n,
+        GL_RED, GL_FLOAT, val.constData() );
+    f->glBindTexture( GL_TEXTURE_1D, 0 );
+#else
+    Q_UNUSED( val )
+#endif
+}
+
+
+void ShankPadsGL::draw( float rngMax, SColor unused )
+{
+#ifndef QT_OPENGL_ES_2
+    if( !ok || !nPads )
+        return;
+
+    prog->bind();
+    prog->setUniformValue( locRng, rngMax );
+    prog->setUniformValue( locOff,
+        QVector3D( unused.r/255.0f, unused.g/255.0f, unused.b/255.0f ) );
+
+    f->glActiveTexture( GL_TEXTURE1 );
+    f->glBindTexture( GL_TEXTURE_1D, texLut );
+    f->glActiveTexture( GL_TEXTURE0 );
+    f->glBindTexture( GL_TEXTURE_1D, texVal );
+
+    vbo->bind();
+
+    f->glDisableClientState( GL_VERTEX_ARRAY );
+    f->glEnableVertexAttribArray( locPos );
+    f->glEnableVertexAttribArray( locPad );
+    f->glVertexAttribPointer(
+        locPos, 2, GL_FLOAT, GL_FALSE, 3*sizeof(float), 0 );
+    f->glVertexAttribPointer(
+        locPad, 1, GL_FLOAT, GL_FALSE, 3*sizeof(float),
+        (const void*)(2*sizeof(float)) );
+
+    f->glPolygonMode( GL_FRONT, GL_FILL );
+    f->glDrawArrays( GL_QUADS, 0, 4*nPads );
+
+// -------
+// Restore
+// -------
+
+    f->glDisableVertexAttribArray( locPad );
+    f->glDisableVertexAttribArray( locPos );
+    f->glEnableClientState( GL_VERTEX_ARRAY );
+
+    vbo->release();
+
+    f->glActiveTexture( GL_TEXTURE1 );
+    f->glBindTexture( GL_TEXTURE_1D, 0 );
+    f->glActiveTexture( GL_TEXTURE0 );
+    f->glBindTexture( GL_TEXTURE_1D, 0 );
+
+    prog->release();
+#else
+    Q_UNUSED( rngMax )
+    Q_UNUSED( unused )
+#endif
+}
+
+
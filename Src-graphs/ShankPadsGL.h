@@ -0,0 +1,67 @@
+#ifndef SHANKPADSGL_H
+#define SHANKPADSGL_H
+
+#include "ShankViewUtils.h"
+
+#include <QVector>
+
+struct ShankMap;
+
+class QOpenGLBuffer;
+class QOpenGLFunctions_3_0;
+class QOpenGLShaderProgram;
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Shader heat-map renderer for ShankView pads.
+//
+// Pad quads are uploaded to a vertex buffer once per layout (map,
+// size or row height change), each vertex tagged with its pad index
+// (-1 if unused). Pad values go to a 1D float texture, the color
+// LUT to a 256-texel 1D texture, and the vertex shader maps value
+// to color with the same rule as ShankView::colorPads(). So a
+// repaint is a fixed handful of GL calls whatever the pad count;
+// new values cost one texture update, and a new range just one
+// uniform.
+//
+// Needs a GL 3.0 (GLSL 1.30) compatibility context: else isValid()
+// is false and ShankView keeps its per-vertex color path.
+//
+class ShankPadsGL
+{
+private:
+    QOpenGLFunctions_3_0    *f;
+    QOpenGLShaderProgram    *prog;
+    QOpenGLBuffer           *vbo;
+    QVector<float>          geom;   // {x,y,pad} per vertex
+    uint                    texVal,
+                            texLut;
+    int                     nPads,
+                            maxPads,
+                            locPos,
+                            locPad,
+                            locRng,
+                            locOff;
+    bool                    ok;
+
+public:
+    // GL context must be current for all calls.
+    ShankPadsGL( const QVector<SColor> &lut );
+    virtual ~ShankPadsGL();
+
+    bool isValid() const    {return ok;}
+
+    // (vR) holds 4 vertices {x,y} per entry of (smap).
+    // Return false if too many pads.
+    bool setGeom( const QVector<float> &vR, const ShankMap *smap );
+
+    void setVals( const QVector<float> &val );
+
+    void draw( float rngMax, SColor unused );
+};
+
+#endif  // SHANKPADSGL_H
+
+
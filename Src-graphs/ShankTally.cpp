@@ -0,0 +1,291 @@
+
+#include "ShankTally.h"
+#include "DAQ.h"
+#include "BiquadMC.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SHANKTALLY_SSE2
+#include <emmintrin.h>
+#endif
+
+
+// Tiles of about TLY_TILE_BYTES stay in L1/L2 from copy through
+// filter and scan, so the block is read from memory once. With
+// eight or more channels a tile is at most 2048 rows, so int32
+// sums of squares of 10-bit samples can't overflow within a tile.
+//
+#define TLY_TILE_BYTES  32768
+
+
+/* ---------------------------------------------------------------- */
+/* ShankTally ----------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+ShankTally::ShankTally( const DAQ::Params &p )
+    :   p(p), ip(0), nc(0), curThresh(0), curInarow(1),
+        logSpk(false), sumSq(false), nSamp(0)
+{
+}
+
+
+void ShankTally::init( int ip, int nc )
+{
+    this->ip    = ip;
+    this->nc    = nc;
+
+    thr.clear();
+    hiCnt.clear();
+    spikes.clear();
+
+    zeroData();
+}
+
+
+void ShankTally::setThresh( int thresh, int inarow )
+{
+    if( (int)thr.size() == nc
+        && curThresh == thresh && curInarow == inarow ) {
+
+        return;
+    }
+
+    thr.resize( nc );
+
+    for( int i = 0; i < nc; ++i ) {
+
+        int T = (ip >= 0 ?
+                    p.im.vToInt10( thresh*1e-6, ip, i ) :
+                    p.ni.vToInt16( thresh*1e-6, i ));
+
+        thr[i] = qBound( -32768, T, 32766 ) + 1;
+    }
+
+    curThresh = thresh;
+    curInarow = inarow;
+
+    rearm();
+}
+
+
+// As if mid-run, so a run already below threshold isn't counted.
+//
+void ShankTally::rearm()
+{
+    hiCnt.assign( nc, qMin( curInarow, 32767 ) );
+}
+
+
+void ShankTally::zeroData()
+{
+    vmin.assign( nc,  32767 );
+    vmax.assign( nc, -32768 );
+    spk.assign( nc, 0.0 );
+    ss.assign( nc, 0.0 );
+    nSamp = 0;
+}
+
+
+void ShankTally::logSpikes( bool on )
+{
+    logSpk = on;
+    spikes.clear();
+}
+
+
+// Appends to (dst).
+//
+void ShankTally::takeSpikes( std::vector<Spike> &dst )
+{
+    dst.insert( dst.end(), spikes.begin(), spikes.end() );
+    spikes.clear();
+}
+
+
+void ShankTally::putBlock(
+    const short *data,
+    int         ntpts,
+    int         nchans,
+    int         c0,
+    BiquadMC    *flt,
+    int         maxInt,
+    int         &nzero,
+    quint64     headCt )
+{
+    if( ntpts <= 0 || nc <= 0 || (int)thr.size() != nc )
+        return;
+
+    int nR = qMax( 8, TLY_TILE_BYTES / int(nc*sizeof(short)) );
+
+    tile.resize( nR * nc );
+
+    short   *W = &tile[0];
+
+    for( int t0 = 0; t0 < ntpts; t0 += nR ) {
+
+        int nt = qMin( nR, ntpts - t0 );
+
+        // copy
+
+        const short *src = data + t0*nchans + c0;
+
+        for( int it = 0; it < nt; ++it, src += nchans )
+            memcpy( W + it*nc, src, nc*sizeof(short) );
+
+        // filter
+
+        flt->applyBlockwiseMem( W, maxInt, nt, nc, 0, nc );
+
+        if( nzero > 0 ) {
+
+            int nz = qMin( nzero, nt );
+
+            memset( W, 0, nz*nc*sizeof(short) );
+            nzero -= nz;
+        }
+
+        // scan
+
+        scanTile( W, nt, headCt + t0 );
+    }
+
+    nSamp += ntpts;
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Per sample: hiCnt = (x <= T ? hiCnt + 1 : 0), saturating, and
+// a spike when a run reaches (inarow); min; max; sum of x*x.
+// Row 0 of tile is stream count (ct).
+//
+void ShankTally::scanTile( const short *d, int nt, quint64 ct )
+{
+    int c = 0;
+
+#ifdef SHANKTALLY_SSE2
+    const __m128i   z   = _mm_setzero_si128(),
+                    one = _mm_set1_epi16( 1 ),
+                    row = _mm_set1_epi16( short(qMin( curInarow, 32767 )) );
+    int             nV  = nc & ~7;
+
+    for( ; c < nV; c += 8 ) {
+
+        const short *D      = d + c;
+        __m128i     T       = _mm_loadu_si128( (const __m128i*)&thr[c] ),
+                    H       = _mm_loadu_si128( (const __m128i*)&hiCnt[c] ),
+                    vMin    = _mm_loadu_si128( (const __m128i*)&vmin[c] ),
+                    vMax    = _mm_loadu_si128( (const __m128i*)&vmax[c] ),
+                    N       = _mm_setzero_si128(),
+                    sqlo    = _mm_setzero_si128(),
+                    sqhi    = _mm_setzero_si128();
+
+        for( int it = 0; it < nt; ++it, D += nc ) {
+
+            __m128i x   = _mm_loadu_si128( (const __m128i*)D ),
+                    le  = _mm_cmpgt_epi16( T, x ),
+                    eq;
+
+            H       = _mm_and_si128( _mm_adds_epi16( H, one ), le );
+            eq      = _mm_cmpeq_epi16( H, row );
+            N       = _mm_sub_epi16( N, eq );
+
+            if( logSpk ) {
+
+                // 2 mask bits per 16-bit lane
+
+                int m = _mm_movemask_epi8( eq );
+
+                for( int k = 0; m; ++k, m >>= 2 ) {
+
+                    if( m & 1 )
+                        spikes.push_back( Spike( ct + it, c + k ) );
+                }
+            }
+
+            vMin    = _mm_min_epi16( vMin, x );
+            vMax    = _mm_max_epi16( vMax, x );
+
+            if( sumSq ) {
+
+                // madd of (x,0) pairs = x*x per int32 lane
+
+                __m128i lo = _mm_unpacklo_epi16( x, z ),
+                        hi = _mm_unpackhi_epi16( x, z );
+
+                sqlo = _mm_add_epi32( sqlo, _mm_madd_epi16( lo, lo ) );
+                sqhi = _mm_add_epi32( sqhi, _mm_madd_epi16( hi, hi ) );
+            }
+        }
+
+        _mm_storeu_si128( (__m128i*)&hiCnt[c], H );
+        _mm_storeu_si128( (__m128i*)&vmin[c], vMin );
+        _mm_storeu_si128( (__m128i*)&vmax[c], vMax );
+
+        // N <= nt spikes per lane
+
+        short   n[8];
+        qint32  q[8];
+
+        _mm_storeu_si128( (__m128i*)n, N );
+        _mm_storeu_si128( (__m128i*)&q[0], sqlo );
+        _mm_storeu_si128( (__m128i*)&q[4], sqhi );
+
+        for( int k = 0; k < 8; ++k ) {
+            spk[c + k]  += n[k];
+            ss[c + k]   += q[k];
+        }
+    }
+#endif
+
+// Scalar for remaining channels
+
+    for( ; c < nc; ++c ) {
+
+        const short *D      = d + c;
+        int         T       = thr[c],
+                    H       = hiCnt[c],
+                    N       = 0;
+        short       vMin    = vmin[c],
+                    vMax    = vmax[c];
+        double      sq      = 0;
+
+        for( int it = 0; it < nt; ++it, D += nc ) {
+
+            int x = *D;
+
+            if( x < T ) {
+
+                if( H < 32767 && ++H == curInarow ) {
+
+                    ++N;
+
+                    if( logSpk )
+                        spikes.push_back( Spike( ct + it, c ) );
+                }
+            }
+            else
+                H = 0;
+
+            if( x < vMin )
+                vMin = x;
+
+            if( x > vMax )
+                vMax = x;
+
+            if( sumSq )
+                sq += x*x;
+        }
+
+        hiCnt[c]    = H;
+        vmin[c]     = vMin;
+        vmax[c]     = vMax;
+        spk[c]     += N;
+        ss[c]      += sq;
+    }
+}
+
+
@@ -0,0 +1,99 @@
+#ifndef SHANKTALLY_H
+#define SHANKTALLY_H
+
+#include <qglobal.h>
+
+#include <vector>
+
+namespace DAQ {
+struct Params;
+}
+
+class BiquadMC;
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Per-block activity kernel for the shank views (ShankCtl and
+// ShankActivity): each tile of rows is copied from the block,
+// filtered and scanned while it is still in cache.
+//
+// Channels sit in SSE2 lanes, eight per vector: spike runs (hiCnt),
+// pk-pk extremes (vmin, vmax) and, if enabled, sums of squares are
+// lane state. Spike runs carry across tiles and blocks; the other
+// tallies accumulate until zeroData().
+//
+// With logSpikes() on, each spike's stream count and channel are
+// also kept until takeSpikes().
+//
+class ShankTally
+{
+public:
+    struct Spike {
+        quint64 ct;     // sample where run reaches inarow
+        int     c;      // chan, relative to c0
+        Spike( quint64 ct, int c ) : ct(ct), c(c)   {}
+    };
+
+private:
+    const DAQ::Params   &p;
+    std::vector<short>  tile,
+                        thr,    // per chan: T+1 (x < thr <=> x <= T)
+                        hiCnt,  // per chan: samples in run <= T
+                        vmin,
+                        vmax;
+    std::vector<Spike>  spikes;
+    int                 ip,
+                        nc,
+                        curThresh,
+                        curInarow;
+    bool                logSpk,
+                        sumSq;
+
+public:
+    std::vector<double> spk,    // per chan: spikes
+                        ss;     // per chan: sum of squares
+    double              nSamp;  // rows tallied
+
+public:
+    ShankTally( const DAQ::Params &p );
+
+    // Tally (nc) chans of probe (ip), or of nidq if (ip < 0).
+    void init( int ip, int nc );
+    int nChans() const  {return nc;}
+
+    // Thresholds are converted once per setting rather than per
+    // block. A new setting re-arms all channels, as does rearm().
+    void setThresh( int thresh, int inarow );
+    void rearm();
+    void zeroData();
+
+    void logSpikes( bool on );
+    void takeSpikes( std::vector<Spike> &dst );
+
+    // Sums of squares are exact for 10-bit data only.
+    void sumSquares( bool on )  {sumSq = on;}
+
+    int pkpk( int c ) const     {return vmax[c] - vmin[c];}
+
+    // Filter chans [c0,c0+nc) of (data) (nchans per row) with
+    // (flt), zeroing the first (nzero) filtered rows, and tally.
+    // (headCt) is count of first row.
+    void putBlock(
+        const short *data,
+        int         ntpts,
+        int         nchans,
+        int         c0,
+        BiquadMC    *flt,
+        int         maxInt,
+        int         &nzero,
+        quint64     headCt = 0 );
+
+private:
+    void scanTile( const short *d, int nt, quint64 ct );
+};
+
+#endif  // SHANKTALLY_H
+
+
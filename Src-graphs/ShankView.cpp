@@ -1,7 +1,10 @@
 
 #include "ShankView.h"
+#include "ShankPadsGL.h"
+#include "Util.h"
 
 #include <QMouseEvent>
+#include <QOpenGLContext>
 #include <QScrollBar>
 
 #ifdef Q_WS_MACX
@@ -48,7 +51,8 @@ ShankView::ShankView( QWidget *parent )
 #else
     :
 #endif
-        smap(0), rowPix(8), slidePos(0), sel(0)
+        smap(0), padGL(0), rng(1), rowPix(8), slidePos(0), sel(0),
+        gpuPads(false), geomNew(true), valsNew(false)
 {
 #ifndef OPENGL54
     QGLFormat   fmt;
@@ -63,6 +67,17 @@ ShankView::ShankView( QWidget *parent )
 }
 
 
+ShankView::~ShankView()
+{
+    QOpenGLContext  *ctx = glContext();
+
+    if( ctx )
+        ctx->disconnect( this );
+
+    releaseGL();
+}
+
+
 void ShankView::setShankMap( const ShankMap *map )
 {
     dataMtx.lock();
@@ -92,6 +107,9 @@ void ShankView::setSel( int ic )
 // Compare each val[i] to range [0..rngMax] and assign
 // appropriate lut color to the vC[{i}] for that pad.
 //
+// With padGL the values and range are just kept; the
+// shader does the mapping at paint time.
+//
 // Assumed: val.size() = smap->e.size().
 //
 void ShankView::colorPads( const QVector<double> &val, double rngMax )
@@ -103,6 +121,18 @@ void ShankView::colorPads( const QVector<double> &val, double rngMax )
 
     int ne = smap->e.size();
 
+    if( gpuPads ) {
+
+        vV.resize( ne );
+
+        for( int i = 0; i < ne; ++i )
+            vV[i] = val[i];
+
+        rng     = rngMax;
+        valsNew = true;
+        return;
+    }
+
     for( int i = 0; i < ne; ++i ) {
 
         if( !smap->e[i].u )
@@ -143,6 +173,58 @@ void ShankView::initializeGL()
     glEnable( GL_BLEND );
     glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
     glEnableClientState( GL_VERTEX_ARRAY );
+
+// New context (first show or reparented): new pad renderer.
+// The old one went with the old context (releaseGL).
+
+    QOpenGLContext  *ctx = glContext();
+
+    if( ctx ) {
+        Connect(
+            ctx, SIGNAL(aboutToBeDestroyed()),
+            this, SLOT(releaseGL()),
+            Qt::DirectConnection );
+    }
+
+    QMutexLocker    ml( &dataMtx );
+
+    padGL   = new ShankPadsGL( lut );
+    gpuPads = padGL->isValid();
+    geomNew = true;
+    valsNew = vV.size() > 0;
+}
+
+
+QOpenGLContext *ShankView::glContext() const
+{
+#ifdef OPENGL54
+    return context();
+#else
+    return (context() ? context()->contextHandle() : 0);
+#endif
+}
+
+
+// Like MGraph::releaseGL(): free the pad renderer with the
+// context that made it current.
+//
+void ShankView::releaseGL()
+{
+    QMutexLocker    ml( &dataMtx );
+
+    if( !padGL )
+        return;
+
+    QOpenGLContext  *ctx = qobject_cast<QOpenGLContext*>( sender() );
+
+    if( ctx && ctx != glContext() && ctx->surface() )
+        ctx->makeCurrent( ctx->surface() );
+    else
+        makeCurrent();
+
+    delete padGL;
+    padGL   = 0;
+    gpuPads = false;
 }
 
 
@@ -310,6 +392,8 @@ void ShankView::resizePads()
     if( vR.size() != 8*ne )
         vR.resize( 8*ne );      // 2 float/vtx, 4 vtx/rect
 
+    geomNew = true;
+
     vC.fill( SColor(), 4*ne );  // 1 color/vtx, 4 vtx/rect
 
     pmrg    = PADMRG*(VRGT-VLFT)/w;
@@ -421,6 +505,27 @@ void ShankView::drawPads()
     if( !vR.size() )
         return;
 
+    if( gpuPads && geomNew ) {
+
+        // Too many pads: CPU colors from next colorPads().
+
+        if( padGL->setGeom( vR, smap ) )
+            geomNew = false;
+        else
+            gpuPads = false;
+    }
+
+    if( gpuPads ) {
+
+        if( valsNew ) {
+            padGL->setVals( vV );
+            valsNew = false;
+        }
+
+        padGL->draw( rng, SColor( SHKCLR*255 ) );
+        return;
+    }
+
     glEnableClientState( GL_COLOR_ARRAY );
 
     glColorPointer( 3, GL_UNSIGNED_BYTE, 0, &vC[0] );
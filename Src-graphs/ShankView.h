@@ -7,6 +7,9 @@
 #include <QMutex>
 #include <QAbstractScrollArea>
 
+class ShankPadsGL;
+class QOpenGLContext;
+
 /* ---------------------------------------------------------------- */
 /* ShankView ------------------------------------------------------ */
 /* ---------------------------------------------------------------- */
@@ -32,8 +35,11 @@ private:
     QMap<ShankMapDesc,uint> ISM;
     QVector<float>          vR;
     QVector<SColor>         vC;
+    QVector<float>          vV;     // pad values for padGL
+    ShankPadsGL             *padGL;
     mutable QMutex          dataMtx;
-    float                   shkWid,
+    float                   rng,
+                            shkWid,
                             hlfWid,
                             pmrg,
                             colWid;
@@ -42,9 +48,13 @@ private:
                             vBot,
                             vTop,
                             sel;
+    bool                    gpuPads,
+                            geomNew,
+                            valsNew;
 
 public:
     ShankView( QWidget *parent = 0 );
+    virtual ~ShankView();
 
     void setRowPix( int y )     {QMutexLocker ml( &dataMtx ); rowPix = y;}
     void setSlider( int y )     {QMutexLocker ml( &dataMtx ); slidePos = y;}
@@ -67,6 +77,9 @@ public slots:
     void updateNow()    {updateGL();}
 #endif
 
+private slots:
+    void releaseGL();
+
 protected:
     void initializeGL();
     void resizeGL( int w, int h );
@@ -76,6 +89,7 @@ protected:
     void mousePressEvent( QMouseEvent *evt );
 
 private:
+    QOpenGLContext *glContext() const;
     float viewportPix();
     float spanPix();
     void setClipping();
@@ -0,0 +1,440 @@
+
+#include "Util.h"
+#include "SpikeRaster.h"
+#include "GraphsWindow.h"
+#include "ProbeActivity.h"
+#include "DAQ.h"
+#include "SignalBlocker.h"
+
+#include <QDoubleSpinBox>
+#include <QEvent>
+#include <QLabel>
+#include <QMap>
+#include <QPainter>
+#include <QSettings>
+#include <QSpinBox>
+#include <QToolBar>
+#include <QVBoxLayout>
+
+
+// Pixels between probe bands.
+#define SR_GAP          3
+
+static const QRgb   SRBkgClr = qRgb( 0x20, 0x3c, 0x3c ),
+                    SRSpkClr = qRgb( 0xff, 0xff, 0xff );
+
+
+/* ---------------------------------------------------------------- */
+/* SpikeRaster ---------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+SpikeRaster::SpikeRaster( GraphsWindow *gw, const DAQ::Params &p )
+    :   QWidget(0), p(p), gw(gw), pa(0),
+        hardPaused(false), softPaused(false)
+{
+    loadSettings();
+
+// -------
+// Toolbar
+// -------
+
+    QToolBar        *tb = new QToolBar( this );
+    QDoubleSpinBox  *S;
+    QLabel          *L;
+
+    L = new QLabel( "Spike Raster ", tb );
+    L->setFont( QFont( font().family(), 10, QFont::DemiBold ) );
+    tb->addWidget( L );
+
+    tb->addSeparator();
+
+    L = new QLabel( "Sec", tb );
+    tb->addWidget( L );
+
+    S = new QDoubleSpinBox( tb );
+    S->installEventFilter( gw );
+    S->setToolTip( "Time span of raster" );
+    S->setDecimals( 1 );
+    S->setRange( 0.5, 60.0 );
+    S->setSingleStep( 1.0 );
+    S->setValue( set.spanSecs );
+    ConnectUI( S, SIGNAL(valueChanged(double)), this, SLOT(spanChanged(double)) );
+    tb->addWidget( S );
+
+    tb->addSeparator();
+
+    L = new QLabel( "T (-uV)", tb );
+    tb->addWidget( L );
+
+    TSB = new QSpinBox( tb );
+    TSB->installEventFilter( gw );
+    TSB->setToolTip( "Spike detection threshold (shared with probe overview)" );
+    TSB->setRange( 0, 100000 );
+    TSB->setSingleStep( 10 );
+    TSB->setValue( 100 );
+    ConnectUI( TSB, SIGNAL(valueChanged(int)), this, SLOT(threshChanged(int)) );
+    tb->addWidget( TSB );
+
+    L = new QLabel( "Stay low", tb );
+    tb->addWidget( L );
+
+    inarowSB = new QSpinBox( tb );
+    inarowSB->installEventFilter( gw );
+    inarowSB->setToolTip( "Stay beyond threshold this many counts" );
+    inarowSB->setRange( 1, 100 );
+    inarowSB->setValue( 5 );
+    ConnectUI( inarowSB, SIGNAL(valueChanged(int)), this, SLOT(inarowChanged(int)) );
+    tb->addWidget( inarowSB );
+
+// ------
+// Raster
+// ------
+
+    ras = new QWidget( this );
+    ras->setAttribute( Qt::WA_OpaquePaintEvent );
+    ras->setMinimumHeight( 60 );
+    ras->installEventFilter( this );
+
+    QVBoxLayout *VL = new QVBoxLayout( this );
+    VL->setSpacing( 0 );
+    VL->setMargin( 0 );
+    VL->addWidget( tb );
+    VL->addWidget( ras, 1 );
+
+// -----
+// Bands
+// -----
+
+    if( !p.im.enabled )
+        return;
+
+    for( int ip = 0; ip < p.im.nProbes; ++ip ) {
+
+        const CimCfg::AttrEach  &E = p.im.each[ip];
+        const ShankMap          &M = E.sns.shankMap;
+        SRBand                  B;
+        int                     nAP = E.imCumTypCnt[CimCfg::imSumAP];
+
+        B.srate     = p.im.all.srate;
+        B.ctPerCol  = 1;
+        B.endCol    = 0;
+        B.nSites    = 0;
+        B.rank.fill( -1, nAP );
+
+        // Used sites in (s,r,c) order
+
+        QMap<ShankMapDesc,uint>                 ISM;
+        QMap<ShankMapDesc,uint>::const_iterator it;
+
+        M.inverseMap( ISM );
+
+        for( it = ISM.begin(); it != ISM.end(); ++it ) {
+
+            int ic = it.value();
+
+            if( ic < nAP && it.key().u )
+                B.rank[ic] = B.nSites++;
+        }
+
+        vB.push_back( B );
+    }
+}
+
+
+SpikeRaster::~SpikeRaster()
+{
+    stop();
+    saveSettings();
+}
+
+
+void SpikeRaster::start( ProbeActivity *pa )
+{
+    if( this->pa || !pa )
+        return;
+
+    this->pa = pa;
+
+    Connect( pa, SIGNAL(spiked()), this, SLOT(refresh()) );
+    Connect( pa, SIGNAL(spikeParamsChanged()), this, SLOT(spikeParamsChanged()) );
+
+    spikeParamsChanged();
+    updateSource();
+}
+
+
+void SpikeRaster::stop()
+{
+    if( !pa )
+        return;
+
+    pa->rasEnable( false );
+    pa->disconnect( this );
+    pa = 0;
+}
+
+
+void SpikeRaster::hardPause( bool pause )
+{
+    hardPaused = pause;
+    updateSource();
+}
+
+
+void SpikeRaster::softPause( bool pause )
+{
+    softPaused = pause;
+    updateSource();
+}
+
+/* ---------------------------------------------------------------- */
+/* Slots ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+void SpikeRaster::refresh()
+{
+    if( !pa )
+        return;
+
+    QVector<std::vector<ShankActivity::Spike> > spk;
+    QVector<quint64>                            endCt;
+
+    pa->takeSpikes( spk, endCt );
+
+    for( int ip = 0, np = qMin( vB.size(), spk.size() ); ip < np; ++ip )
+        plot( vB[ip], spk[ip], endCt[ip] );
+
+    ras->update();
+}
+
+
+// Set from either view.
+//
+void SpikeRaster::spikeParamsChanged()
+{
+    if( !pa )
+        return;
+
+    SignalBlocker   b0(TSB), b1(inarowSB);
+
+    TSB->setValue( -pa->getThresh() );
+    inarowSB->setValue( pa->getInarow() );
+}
+
+
+void SpikeRaster::spanChanged( double s )
+{
+    set.spanSecs = s;
+    resizeBands();
+    ras->update();
+    saveSettings();
+}
+
+
+void SpikeRaster::threshChanged( int t )
+{
+    if( pa )
+        pa->setSpikeParams( -t, pa->getInarow() );
+}
+
+
+void SpikeRaster::inarowChanged( int s )
+{
+    if( pa )
+        pa->setSpikeParams( pa->getThresh(), s );
+}
+
+/* ---------------------------------------------------------------- */
+/* Protected ------------------------------------------------------ */
+/* ---------------------------------------------------------------- */
+
+bool SpikeRaster::eventFilter( QObject *watched, QEvent *event )
+{
+    if( watched == ras ) {
+
+        if( event->type() == QEvent::Paint ) {
+            paintBands();
+            return true;
+        }
+
+        if( event->type() == QEvent::Resize )
+            resizeBands();
+    }
+
+    return QWidget::eventFilter( watched, event );
+}
+
+
+// Detect only while shown.
+//
+void SpikeRaster::showEvent( QShowEvent *e )
+{
+    QWidget::showEvent( e );
+    updateSource();
+}
+
+
+void SpikeRaster::hideEvent( QHideEvent *e )
+{
+    QWidget::hideEvent( e );
+    updateSource();
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+void SpikeRaster::updateSource()
+{
+    if( pa )
+        pa->rasEnable( isVisible() && !hardPaused && !softPaused );
+}
+
+
+// Bands split the raster height. New geometry or span
+// starts the images over.
+//
+void SpikeRaster::resizeBands()
+{
+    int np = vB.size();
+
+    if( !np )
+        return;
+
+    int w = ras->width(),
+        h = (ras->height() - (np - 1)*SR_GAP) / np;
+
+    if( w <= 0 || h <= 0 ) {
+
+        for( int ip = 0; ip < np; ++ip )
+            vB[ip].img = QImage();
+
+        return;
+    }
+
+    for( int ip = 0; ip < np; ++ip ) {
+
+        SRBand  &B = vB[ip];
+
+        B.r         = QRect( 0, ip*(h + SR_GAP), w, h );
+        B.ctPerCol  = B.srate * set.spanSecs / w;
+        B.endCol    = 0;
+
+        B.img = QImage( w, h, QImage::Format_RGB32 );
+        B.img.fill( SRBkgClr );
+
+        // Tip at bottom; sites sharing a row OR together
+
+        int nAP = B.rank.size();
+
+        B.chan2y.resize( nAP );
+
+        for( int ic = 0; ic < nAP; ++ic ) {
+
+            int r = B.rank[ic];
+
+            B.chan2y[ic] = (r >= 0 ? h - 1 - r * h / B.nSites : -1);
+        }
+    }
+}
+
+
+// Advance band to (endCt), blanking columns that scroll in,
+// then set a pixel per spike still in span.
+//
+void SpikeRaster::plot(
+    SRBand                                  &B,
+    const std::vector<ShankActivity::Spike> &spk,
+    quint64                                 endCt )
+{
+    if( !endCt || B.img.isNull() )
+        return;
+
+    int     w   = B.img.width(),
+            h   = B.img.height();
+    quint64 col = quint64((endCt - 1) / B.ctPerCol);
+
+    if( !B.endCol || col < B.endCol || col >= B.endCol + w )
+        B.img.fill( SRBkgClr );
+    else {
+
+        for( quint64 k = B.endCol + 1; k <= col; ++k ) {
+
+            int x = k % w;
+
+            for( int y = 0; y < h; ++y )
+                ((QRgb*)B.img.scanLine( y ))[x] = SRBkgClr;
+        }
+    }
+
+    B.endCol = col;
+
+    for( int is = 0, ns = spk.size(); is < ns; ++is ) {
+
+        const ShankActivity::Spike  &S = spk[is];
+        quint64                     sc = quint64(S.ct / B.ctPerCol);
+
+        if( sc > col || sc + w <= col )
+            continue;
+
+        int y = B.chan2y[S.c];
+
+        if( y >= 0 )
+            ((QRgb*)B.img.scanLine( y ))[sc % w] = SRSpkClr;
+    }
+}
+
+
+// Ring column after endCol is oldest: draw it at left.
+//
+void SpikeRaster::paintBands()
+{
+    QPainter    P( ras );
+
+    P.fillRect( ras->rect(), palette().window() );
+    P.setPen( Qt::white );
+
+    for( int ip = 0, np = vB.size(); ip < np; ++ip ) {
+
+        const SRBand    &B = vB[ip];
+
+        if( B.img.isNull() )
+            continue;
+
+        int w   = B.img.width(),
+            h   = B.img.height(),
+            x0  = (B.endCol + 1) % w;
+
+        P.drawImage( B.r.topLeft(), B.img, QRect( x0, 0, w - x0, h ) );
+
+        if( x0 )
+            P.drawImage( B.r.left() + w - x0, B.r.top(), B.img, 0, 0, x0, h );
+
+        P.drawText(
+            B.r.adjusted( 4, 2, 0, 0 ),
+            Qt::AlignLeft | Qt::AlignTop,
+            QString("imec%1").arg( ip ) );
+    }
+}
+
+
+void SpikeRaster::loadSettings()
+{
+    STDSETTINGS( settings, "spikeraster" );
+
+    settings.beginGroup( "SpikeRaster" );
+    set.spanSecs    = settings.value( "spanSecs", 5.0 ).toDouble();
+    settings.endGroup();
+}
+
+
+void SpikeRaster::saveSettings() const
+{
+    STDSETTINGS( settings, "spikeraster" );
+
+    settings.beginGroup( "SpikeRaster" );
+    settings.setValue( "spanSecs", set.spanSecs );
+    settings.endGroup();
+}
+
+
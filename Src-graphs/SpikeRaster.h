@@ -0,0 +1,102 @@
+#ifndef SPIKERASTER_H
+#define SPIKERASTER_H
+
+#include "ShankActivity.h"
+
+#include <QWidget>
+#include <QImage>
+#include <QVector>
+
+namespace DAQ {
+struct Params;
+}
+
+class GraphsWindow;
+class ProbeActivity;
+
+class QSpinBox;
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Scrolling raster of spikes for all imec probes, one band per
+// probe, sites in shank order (tip at bottom). A GraphsWindow
+// view costing only the new spikes per update: each band is an
+// image used as a ring of time columns, newest at right; spikes
+// set pixels, and paint is one blit per band. Spikes come from
+// the run's ProbeActivity, logged only while the raster is shown
+// and not paused.
+//
+class SpikeRaster : public QWidget
+{
+    Q_OBJECT
+
+private:
+    struct UsrSettings {
+        double  spanSecs;
+    };
+
+    struct SRBand {
+        QImage          img;
+        QRect           r;
+        QVector<int>    rank,       // AP chan -> shank order; -1 if unused
+                        chan2y;     // AP chan -> image row; -1 if unused
+        int             nSites;
+        double          srate,
+                        ctPerCol;
+        quint64         endCol;     // 0 = unset
+    };
+
+private:
+    const DAQ::Params   &p;
+    GraphsWindow        *gw;
+    QWidget             *ras;
+    QVector<SRBand>     vB;
+    QSpinBox            *TSB,
+                        *inarowSB;
+    UsrSettings         set;
+    ProbeActivity       *pa;
+    bool                hardPaused,
+                        softPaused;
+
+public:
+    SpikeRaster( GraphsWindow *gw, const DAQ::Params &p );
+    virtual ~SpikeRaster();
+
+    // Attach once the run's source exists; stop before it goes.
+    void start( ProbeActivity *pa );
+    void stop();
+
+    void hardPause( bool pause );
+    void softPause( bool pause );
+
+public slots:
+    void refresh();
+
+private slots:
+    void spikeParamsChanged();
+    void spanChanged( double s );
+    void threshChanged( int t );
+    void inarowChanged( int s );
+
+protected:
+    virtual bool eventFilter( QObject *watched, QEvent *event );
+    virtual void showEvent( QShowEvent *e );
+    virtual void hideEvent( QHideEvent *e );
+
+private:
+    void updateSource();
+    void resizeBands();
+    void plot(
+        SRBand                                  &B,
+        const std::vector<ShankActivity::Spike> &spk,
+        quint64                                 endCt );
+    void paintBands();
+    void loadSettings();
+    void saveSettings() const;
+};
+
+#endif  // SPIKERASTER_H
+
+
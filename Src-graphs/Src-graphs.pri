@@ -1,7 +1,11 @@
 
 HEADERS += \
+    $$PWD/BinMinMax.h \
     $$PWD/ColorTTLCtl.h \
+    $$PWD/DCLevel.h \
     $$PWD/FileViewerWindow.h \
+    $$PWD/FVFltCache.h \
+    $$PWD/FVPrefetch.h \
     $$PWD/FVScanGrp.h \
     $$PWD/FVToolbar.h \
     $$PWD/GraphFetcher.h \
@@ -9,14 +13,21 @@ HEADERS += \
     $$PWD/GraphsWindow.h \
     $$PWD/GWLEDWidget.h \
     $$PWD/MGraph.h \
+    $$PWD/MGTraceGL.h \
     $$PWD/MNavbar.h \
+    $$PWD/ProbeActivity.h \
     $$PWD/RunToolbar.h \
+    $$PWD/ShankActivity.h \
     $$PWD/ShankCtl.h \
     $$PWD/ShankCtl_Im.h \
     $$PWD/ShankCtl_Ni.h \
+    $$PWD/ShankOverview.h \
+    $$PWD/ShankPadsGL.h \
+    $$PWD/ShankTally.h \
     $$PWD/ShankView.h \
     $$PWD/ShankViewLut.h \
     $$PWD/ShankViewUtils.h \
+    $$PWD/SpikeRaster.h \
     $$PWD/SVGrafsM.h \
     $$PWD/SVGrafsM_Im.h \
     $$PWD/SVGrafsM_Ni.h \
@@ -26,8 +37,12 @@ HEADERS += \
     $$PWD/WrapBuffer.h
 
 SOURCES += \
+    $$PWD/BinMinMax.cpp \
     $$PWD/ColorTTLCtl.cpp \
+    $$PWD/DCLevel.cpp \
     $$PWD/FileViewerWindow.cpp \
+    $$PWD/FVFltCache.cpp \
+    $$PWD/FVPrefetch.cpp \
     $$PWD/FVScanGrp.cpp \
     $$PWD/FVToolbar.cpp \
     $$PWD/GraphFetcher.cpp \
@@ -35,14 +50,21 @@ SOURCES += \
     $$PWD/GraphsWindow.cpp \
     $$PWD/GWLEDWidget.cpp \
     $$PWD/MGraph.cpp \
+    $$PWD/MGTraceGL.cpp \
     $$PWD/MNavbar.cpp \
+    $$PWD/ProbeActivity.cpp \
     $$PWD/RunToolbar.cpp \
+    $$PWD/ShankActivity.cpp \
     $$PWD/ShankCtl.cpp \
     $$PWD/ShankCtl_Im.cpp \
     $$PWD/ShankCtl_Ni.cpp \
+    $$PWD/ShankOverview.cpp \
+    $$PWD/ShankPadsGL.cpp \
+    $$PWD/ShankTally.cpp \
     $$PWD/ShankView.cpp \
     $$PWD/ShankViewLut.cpp \
     $$PWD/ShankViewUtils.cpp \
+    $$PWD/SpikeRaster.cpp \
     $$PWD/SVGrafsM.cpp \
     $$PWD/SVGrafsM_Im.cpp \
     $$PWD/SVGrafsM_Ni.cpp \
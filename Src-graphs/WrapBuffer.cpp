@@ -15,6 +15,7 @@ WrapBuffer &WrapBuffer::operator=( const WrapBuffer &rhs )
 
     head    = rhs.head;
     len     = rhs.len;
+    ++gen;
 
     memcpy( buf, rhs.buf, bufsz );
 
@@ -34,12 +35,14 @@ void WrapBuffer::resizeAndErase( uint newSize )
     }
 
     len = head = 0;
+    ++gen;
 }
 
 
 void WrapBuffer::zeroFill()
 {
     memset( buf, 0, bufsz );
+    ++gen;
 }
 
 
@@ -81,6 +84,8 @@ void WrapBuffer::putData( const void *data, uint nBytes )
 {
     const char  *src = (const char*)data;
 
+    putTot += nBytes;
+
     if( nBytes >= bufsz ) {
         // Keep only newest bufsz-worth.
         head    = 0;
@@ -105,6 +110,33 @@ void WrapBuffer::putData( const void *data, uint nBytes )
 }
 
 
+// Replace the newest min(nBytes, size()) bytes with
+// the tail of (data).
+//
+void WrapBuffer::overwriteTail( const void *data, uint nBytes )
+{
+    const char  *src = (const char*)data;
+
+    if( nBytes > len ) {
+        src    += nBytes - len;
+        nBytes  = len;
+    }
+
+    if( !nBytes )
+        return;
+
+    ++gen;
+
+    uint    start   = (head + len - nBytes) % bufsz,
+            ncpy1   = std::min( nBytes, bufsz - start );
+
+    memcpy( &buf[start], src, ncpy1 );
+
+    if( nBytes -= ncpy1 )
+        memcpy( &buf[0], src + ncpy1, nBytes );
+}
+
+
 uint WrapBuffer::dataPtr1( void* &ptr ) const
 {
     ptr = (void*)&buf[head];
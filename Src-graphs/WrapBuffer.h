@@ -7,17 +7,25 @@
 /* Types ---------------------------------------------------------- */
 /* ---------------------------------------------------------------- */
 
+// Change tracking (for incremental GPU upload):
+// putTotal() counts bytes ever put; generation() changes
+// when contents change other than by putData().
+//
 class WrapBuffer
 {
 private:
     char    *buf;
+    quint64 putTot;
     uint    bufsz,
             head,
-            len;
+            len,
+            gen;
 
 public:
-    WrapBuffer( uint size = 0 ) : buf(0), bufsz(0) {resizeAndErase(size);}
-    WrapBuffer( const WrapBuffer &rhs ) : buf(0), bufsz(0) {*this=rhs;}
+    WrapBuffer( uint size = 0 )
+    :   buf(0), putTot(0), bufsz(0), gen(0)     {resizeAndErase(size);}
+    WrapBuffer( const WrapBuffer &rhs )
+    :   buf(0), putTot(0), bufsz(0), gen(0)     {*this=rhs;}
     virtual ~WrapBuffer()   {killbuf();}
 
     WrapBuffer &operator=( const WrapBuffer &rhs );
@@ -31,6 +39,8 @@ public:
     uint unusedCapacity() const     {return bufsz - len;}
     uint cursor() const             {return (head+len) % bufsz;}
     bool isBufferWrapped() const    {return head+len > bufsz;}
+    quint64 putTotal() const        {return putTot;}
+    uint generation() const         {return gen;}
 
     void rangesPutWillChange(
         uint    &r10,
@@ -41,6 +51,9 @@ public:
 
     void putData( const void *data, uint nBytes );
 
+    // Overwrite newest data in place; head and size unchanged.
+    void overwriteTail( const void *data, uint nBytes );
+
     // Start & length of unwrapped first part
     uint dataPtr1( void* &ptr ) const;
 
@@ -84,6 +97,12 @@ public:
     bool isBufferWrapped() const
         {return WrapBuffer::isBufferWrapped();}
 
+    quint64 putTotal() const
+        {return WrapBuffer::putTotal()/sizeof(T);}
+
+    uint generation() const
+        {return WrapBuffer::generation();}
+
     void rangesPutWillChange(
         uint    &r10,
         uint    &r1Lim,
@@ -103,6 +122,9 @@ public:
     void putData( const T *data, uint n )
         {WrapBuffer::putData((const void*)data, n*sizeof(T));}
 
+    void overwriteTail( const T *data, uint n )
+        {WrapBuffer::overwriteTail((const void*)data, n*sizeof(T));}
+
     // Start & length of unwrapped first part
     uint dataPtr1( T* &ptr ) const
     {
@@ -0,0 +1,335 @@
+
+#include "Benchmark.h"
+#include "Util.h"
+#include "SGLTypes.h"
+#include "Biquad.h"
+#include "BiquadMC.h"
+#include "Referencer.h"
+#include "EdgeScan.h"
+#include "ShankMap.h"
+
+#include <stdlib.h>
+
+
+/* ---------------------------------------------------------------- */
+/* Statics -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Fill block with noise and a few large negative spikes,
+// roughly like an imec AP band.
+//
+static void fillBlock( vec_i16 &data, int nchans, int ntpts, int maxInt )
+{
+    data.resize( nchans * ntpts );
+
+    for( int i = 0, n = nchans * ntpts; i < n; ++i ) {
+
+        int v = int(uniformDev( -0.05, 0.05 ) * maxInt);
+
+        if( !(rand() % 997) )
+            v -= maxInt / 4;
+
+        data[i] = v;
+    }
+}
+
+// The former per-sample edge loop (falling, analog), as used
+// by AIQ and ColorTTLCtl before EdgeScan.
+//
+static bool scalarFallingEdge(
+    int         &outCt,
+    const short *data,
+    int         ntpts,
+    int         nchans,
+    int         chan,
+    int         T,
+    int         inarow )
+{
+    const short *d      = &data[chan],
+                *dlim   = &data[chan + ntpts*nchans];
+    int         nlo     = 0;
+
+    while( d < dlim && *d < T )
+        d += nchans;
+
+    while( (d += nchans) < dlim ) {
+
+        if( *d < T ) {
+
+            outCt   = (d - &data[chan]) / nchans;
+            nlo     = 1;
+
+            if( nlo >= inarow )
+                return true;
+
+            while( (d += nchans) < dlim ) {
+
+                if( *d < T ) {
+                    if( ++nlo >= inarow )
+                        return true;
+                }
+                else
+                    break;
+            }
+        }
+    }
+
+    return false;
+}
+
+/* ---------------------------------------------------------------- */
+/* Benchmark ------------------------------------------------------ */
+/* ---------------------------------------------------------------- */
+
+void Benchmark::runAll()
+{
+    Log() << "Benchmarks started...";
+
+    biquadMC();
+    sosCascade();
+    referencer();
+    edgeScan();
+
+    Log() << "Benchmarks done.";
+}
+
+
+// Time Biquad::applyBlockwiseMem against BiquadMC for a
+// 385-channel imec block (384 AP filtered, 1 sync skipped),
+// at several block lengths.
+//
+void Benchmark::biquadMC()
+{
+    const int   nchans  = 385,
+                nflt    = 384,
+                maxInt  = 512,
+                nreps   = 20;
+    const int   vtpts[] = {100, 1000, 3000, 30000};
+
+    for( int k = 0; k < 4; ++k ) {
+
+        int         ntpts = vtpts[k];
+        vec_i16     src, d1, d2;
+        Biquad      bq( bq_type_highpass, 300/30000.0 );
+        BiquadMC    mc( bq_type_highpass, 300/30000.0 );
+        double      t1, t2;
+        int         maxDif = 0;
+
+        fillBlock( src, nchans, ntpts, maxInt );
+
+        t1 = getTime();
+        for( int ir = 0; ir < nreps; ++ir ) {
+            d1 = src;
+            bq.applyBlockwiseMem( &d1[0], maxInt, ntpts, nchans, 0, nflt );
+        }
+        t1 = (getTime() - t1) / nreps;
+
+        t2 = getTime();
+        for( int ir = 0; ir < nreps; ++ir ) {
+            d2 = src;
+            mc.applyBlockwiseMem( &d2[0], maxInt, ntpts, nchans, 0, nflt );
+        }
+        t2 = (getTime() - t2) / nreps;
+
+        for( int i = 0, n = (int)src.size(); i < n; ++i )
+            maxDif = qMax( maxDif, qAbs( d1[i] - d2[i] ) );
+
+        Log() <<
+            QString("Biquad vs BiquadMC: %1 x %2: %3 ms vs %4 ms (x%5),"
+                    " max diff %6")
+            .arg( nchans )
+            .arg( ntpts )
+            .arg( 1000*t1, 0, 'f', 3 )
+            .arg( 1000*t2, 0, 'f', 3 )
+            .arg( t1 / qMax( t2, 1e-9 ), 0, 'f', 1 )
+            .arg( maxDif );
+    }
+}
+
+
+// Time the pre-cascade bandpass (BiquadMC hipass pass, then a
+// lopass pass) against one fused BiquadMC cascade holding both,
+// and Butterworth bandpass orders 2..8 in fused form.
+//
+void Benchmark::sosCascade()
+{
+    const int   nchans  = 385,
+                nflt    = 384,
+                ntpts   = 3000,
+                maxInt  = 512,
+                nreps   = 20;
+    const double
+                fLo     = 300/30000.0,
+                fHi     = 6000/30000.0;
+
+    vec_i16     src, d1, d2;
+
+    fillBlock( src, nchans, ntpts, maxInt );
+
+// Two passes vs one
+
+    std::vector<SOSCoeffs>  S;
+    BiquadMC                hp( bq_type_highpass, fLo ),
+                            lp( bq_type_lowpass, fHi ),
+                            bp;
+    double                  t1, t2;
+    int                     maxDif = 0;
+
+    SOSDesign::bandpass( S, sos_butterworth, 2, fLo, fHi );
+    bp.setSections( S );
+
+    t1 = getTime();
+    for( int ir = 0; ir < nreps; ++ir ) {
+        d1 = src;
+        hp.applyBlockwiseMem( &d1[0], maxInt, ntpts, nchans, 0, nflt );
+        lp.applyBlockwiseMem( &d1[0], maxInt, ntpts, nchans, 0, nflt );
+    }
+    t1 = (getTime() - t1) / nreps;
+
+    t2 = getTime();
+    for( int ir = 0; ir < nreps; ++ir ) {
+        d2 = src;
+        bp.applyBlockwiseMem( &d2[0], maxInt, ntpts, nchans, 0, nflt );
+    }
+    t2 = (getTime() - t2) / nreps;
+
+    for( int i = 0, n = (int)src.size(); i < n; ++i )
+        maxDif = qMax( maxDif, qAbs( d1[i] - d2[i] ) );
+
+    Log() <<
+        QString("hipass+lopass vs fused SOS: %1 x %2: %3 ms vs %4 ms"
+                " (x%5), max diff %6")
+        .arg( nchans )
+        .arg( ntpts )
+        .arg( 1000*t1, 0, 'f', 3 )
+        .arg( 1000*t2, 0, 'f', 3 )
+        .arg( t1 / qMax( t2, 1e-9 ), 0, 'f', 1 )
+        .arg( maxDif );
+
+// Cost by order
+
+    for( int order = 2; order <= 8; order += 2 ) {
+
+        SOSDesign::bandpass( S, sos_butterworth, order, fLo, fHi );
+        bp.setSections( S );
+
+        t1 = getTime();
+        for( int ir = 0; ir < nreps; ++ir ) {
+            d1 = src;
+            bp.applyBlockwiseMem( &d1[0], maxInt, ntpts, nchans, 0, nflt );
+        }
+        t1 = (getTime() - t1) / nreps;
+
+        Log() <<
+            QString("SOS bandpass order %1 (%2 sections): %3 x %4: %5 ms")
+            .arg( order )
+            .arg( (int)S.size() )
+            .arg( nchans )
+            .arg( ntpts )
+            .arg( 1000*t1, 0, 'f', 3 );
+    }
+}
+
+
+// Time Referencer modes on a 385-channel block laid out like
+// a 2-column, 192-row probe (384 sites referenced).
+//
+void Benchmark::referencer()
+{
+    const int   nchans  = 385,
+                nref    = 384,
+                ntpts   = 3000,
+                maxInt  = 512,
+                nreps   = 20;
+    const char  *name[] = {"", "local r=2", "CAR", "CMR"};
+
+    ShankMap        SM;
+    vec_i16         src, d;
+    QVector<float>  lvl( nchans, 0.0F );
+
+    SM.fillDefaultNi( 1, 2, nref / 2, nref );
+
+    fillBlock( src, nchans, ntpts, maxInt );
+
+    for( int sel = 1; sel <= 3; ++sel ) {
+
+        Referencer  ref;
+        double      t;
+
+        ref.setSel( SM, 0, nref, sel, 2 );
+
+        t = getTime();
+        for( int ir = 0; ir < nreps; ++ir ) {
+            d = src;
+            ref.apply( &d[0], &lvl[0], ntpts, nchans );
+        }
+        t = (getTime() - t) / nreps;
+
+        Log() <<
+            QString("Referencer %1: %2 x %3: %4 ms")
+            .arg( name[sel] )
+            .arg( nchans )
+            .arg( ntpts )
+            .arg( 1000*t, 0, 'f', 3 );
+    }
+}
+
+
+// Time the former scalar edge loop against EdgeScan, analog
+// falling edge, inarow 3, on one channel of a 385-channel block
+// (strided) and of a mono stream (contiguous). The threshold is
+// below the spikes, so both scan the whole block: the usual case
+// while waiting for a trigger.
+//
+void Benchmark::edgeScan()
+{
+    const int   nchans  = 385,
+                chan    = 10,
+                maxInt  = 512,
+                T       = -maxInt/2,
+                inarow  = 3,
+                nreps   = 200;
+    const int   vtpts[] = {100, 1000, 3000, 30000};
+
+    for( int k = 0; k < 4; ++k ) {
+
+        int     ntpts = vtpts[k];
+        vec_i16 src;
+
+        fillBlock( src, nchans, ntpts, maxInt );
+
+        for( int stride = 1; stride <= nchans; stride += nchans - 1 ) {
+
+            EdgeScan    E;
+            double      t1, t2;
+            int         row, n1 = 0, n2 = 0;
+
+            E.setAnalog( T, false, inarow );
+
+            t1 = getTime();
+            for( int ir = 0; ir < nreps; ++ir )
+                n1 += scalarFallingEdge( row, &src[0], ntpts, stride, chan, T, inarow );
+            t1 = (getTime() - t1) / nreps;
+
+            t2 = getTime();
+            for( int ir = 0; ir < nreps; ++ir ) {
+                E.reset();
+                n2 += E.scan( row, &src[chan], ntpts, stride );
+            }
+            t2 = (getTime() - t2) / nreps;
+
+            Log() <<
+                QString("Edge scan vs EdgeScan: stride %1 x %2: %3 us vs"
+                        " %4 us (x%5), found %6/%7")
+                .arg( stride )
+                .arg( ntpts )
+                .arg( 1e6*t1, 0, 'f', 2 )
+                .arg( 1e6*t2, 0, 'f', 2 )
+                .arg( t1 / qMax( t2, 1e-12 ), 0, 'f', 1 )
+                .arg( n1 )
+                .arg( n2 );
+        }
+    }
+}
+
+
@@ -0,0 +1,24 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Developer timings of the block-processing kernels against the
+// implementations they replace. Results go to the console log.
+//
+class Benchmark
+{
+public:
+    static void runAll();
+
+    static void biquadMC();
+    static void sosCascade();
+    static void referencer();
+    static void edgeScan();
+};
+
+#endif  // BENCHMARK_H
+
+
@@ -15,6 +15,7 @@
 #include "IMBISTCtl.h"
 #include "Sha1Verifier.h"
 #include "Par2Window.h"
+#include "Benchmark.h"
 #include "HelpWindow.h"
 #include "Version.h"
 
@@ -553,6 +554,21 @@ void MainApp::tools_ShowPar2Win()
 }
 
 
+void MainApp::tools_Benchmarks()
+{
+    if( run->isRunning() ) {
+
+        QMessageBox::critical(
+            consoleWindow,
+            "Run in Progress",
+            "Stop the current run before running benchmarks." );
+        return;
+    }
+
+    Benchmark::runAll();
+}
+
+
 void MainApp::tools_ToggleDebug()
 {
     appData.debug = !appData.debug;
@@ -618,6 +634,12 @@ void MainApp::window_ShowHideGraphs()
 }
 
 
+void MainApp::window_ShankOverview()
+{
+    run->shankOvShow();
+}
+
+
 void MainApp::help_HelpDlg()
 {
     if( !helpWindow ) {
@@ -856,6 +878,7 @@ void MainApp::runStopped()
 
     act.stopAcqAct->setEnabled( false );
     act.shwHidGrfsAct->setEnabled( false );
+    act.shankOvAct->setEnabled( false );
 }
 
 
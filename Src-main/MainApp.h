@@ -144,6 +144,7 @@ public slots:
     void tools_ImBist();
     void tools_VerifySha1();
     void tools_ShowPar2Win();
+    void tools_Benchmarks();
     void tools_ToggleDebug();
     void tools_ToggleEditLog();
     void tools_SaveLogFile();
@@ -151,6 +152,7 @@ public slots:
 // Window
     void window_ShowHideConsole();
     void window_ShowHideGraphs();
+    void window_ShankOverview();
 
 // Help
     void help_HelpDlg();
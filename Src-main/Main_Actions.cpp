@@ -77,6 +77,9 @@ void Main_Actions::initActions()
     par2Act = new QAction( "&PAR2 Redundancy Tool...", this );
     ConnectUI( par2Act, SIGNAL(triggered()), app, SLOT(tools_ShowPar2Win()) );
 
+    benchAct = new QAction( "Run &Benchmarks", this );
+    ConnectUI( benchAct, SIGNAL(triggered()), app, SLOT(tools_Benchmarks()) );
+
     togDebugAct = new QAction( "Debug &Mode", this );
     togDebugAct->setShortcut( QKeySequence( tr("Ctrl+D") ) );
     togDebugAct->setShortcutContext( Qt::ApplicationShortcut );
@@ -110,6 +113,10 @@ void Main_Actions::initActions()
     shwHidGrfsAct->setEnabled( false );
     ConnectUI( shwHidGrfsAct, SIGNAL(triggered()), app, SLOT(window_ShowHideGraphs()) );
 
+    shankOvAct = new QAction( "Imec Probe &Overview...", this );
+    shankOvAct->setEnabled( false );
+    ConnectUI( shankOvAct, SIGNAL(triggered()), app, SLOT(window_ShankOverview()) );
+
 // ----
 // Help
 // ----
@@ -162,6 +169,7 @@ void Main_Actions::initMenus( QMainWindow *w )
     m->addAction( sha1Act );
     m->addAction( par2Act );
     m->addSeparator();
+    m->addAction( benchAct );
     m->addAction( togDebugAct );
     m->addAction( editLogAct );
     m->addAction( logFileAct );
@@ -171,6 +179,7 @@ void Main_Actions::initMenus( QMainWindow *w )
     m->addSeparator();
     m->addAction( shwHidConsAct );
     m->addAction( shwHidGrfsAct );
+    m->addAction( shankOvAct );
     m->addSeparator();
     windowMenu = m;
 
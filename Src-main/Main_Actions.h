@@ -34,6 +34,7 @@ public:
         *imBistAct,
         *sha1Act,
         *par2Act,
+        *benchAct,
         *togDebugAct,
         *editLogAct,
         *logFileAct,
@@ -41,6 +42,7 @@ public:
         *bringFrontAct,
         *shwHidConsAct,
         *shwHidGrfsAct,
+        *shankOvAct,
     // Help
         *helpAct,
         *exploreAppAct,
@@ -1,5 +1,6 @@
 
 HEADERS += \
+    $$PWD/Benchmark.h \
     $$PWD/ConsoleWindow.h \
     $$PWD/Main_Actions.h \
     $$PWD/Main_Msg.h \
@@ -9,6 +10,7 @@ HEADERS += \
     $$PWD/Version.h
 
 SOURCES += \
+    $$PWD/Benchmark.cpp \
     $$PWD/ConsoleWindow.cpp \
     $$PWD/main.cpp \
     $$PWD/Main_Actions.cpp \
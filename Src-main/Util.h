@@ -17,6 +17,9 @@ class MainApp;
 
 #define EPSILON 0.0000001
 
+#define MAX10BIT    512
+#define MAX16BIT    32768
+
 #ifndef MIN
 #define MIN( a, b ) ((a) <= (b) ? (a) : (b))
 #endif
@@ -1720,15 +1720,26 @@ void ConfigCtl::diskButClicked()
 
             int     ch  = q.im.each[ip].apSaveChanCount();
             double  bps = ch * q.im.all.srate * 2;
+            QString s;
 
-            BPS += bps;
+            if( q.sns.spkEvtEnab && q.sns.spkSnipOnly ) {
 
-            QString s =
-                QString("AP %1: %2 chn @ %3 Hz = %4 MB/s")
-                .arg( ip )
-                .arg( ch )
-                .arg( (int)q.im.all.srate )
-                .arg( bps / (1024*1024), 0, 'f', 2 );
+                // Snippet volume depends on spike rate
+
+                s = QString("AP %1: %2 chn snippets only")
+                    .arg( ip )
+                    .arg( ch );
+            }
+            else {
+
+                BPS += bps;
+
+                s = QString("AP %1: %2 chn @ %3 Hz = %4 MB/s")
+                    .arg( ip )
+                    .arg( ch )
+                    .arg( (int)q.im.all.srate )
+                    .arg( bps / (1024*1024), 0, 'f', 2 );
+            }
 
             diskWrite( s );
 
@@ -2701,6 +2712,8 @@ void ConfigCtl::setupTrigTab( const DAQ::Params &p )
     trigSpkPanelUI->periSB->setValue( p.trgSpike.periEvtSecs );
     trigSpkPanelUI->refracSB->setValue( p.trgSpike.refractSecs );
     trigSpkPanelUI->chanSB->setValue( p.trgSpike.aiChan );
+    trigSpkPanelUI->chansLE->setText( p.trgSpike.chanStr );
+    trigSpkPanelUI->nofmSB->setValue( p.trgSpike.nOfM );
     trigSpkPanelUI->inarowSB->setValue( p.trgSpike.inarow );
     trigSpkPanelUI->NSB->setValue( p.trgSpike.nS );
     trigSpkPanelUI->NInfChk->setChecked( p.trgSpike.isNInf );
@@ -2780,6 +2793,12 @@ void ConfigCtl::setupSnsTab( const DAQ::Params &p )
 // Imec
 
     snsTabUI->imSaveChansLE->setEnabled( imecOK );
+    snsTabUI->spkEvtChk->setChecked( p.sns.spkEvtEnab );
+    snsTabUI->spkEvtChk->setEnabled( imecOK );
+    snsTabUI->spkEvtTSB->setValue( 1e6 * p.sns.spkEvtT );
+    snsTabUI->spkEvtTSB->setEnabled( imecOK );
+    snsTabUI->spkSnipChk->setChecked( p.sns.spkSnipOnly );
+    snsTabUI->spkSnipChk->setEnabled( imecOK );
 
 // Nidq
 
@@ -3095,6 +3114,8 @@ void ConfigCtl::paramsFromDialog(
     q.trgSpike.refractSecs  = trigSpkPanelUI->refracSB->value();
     q.trgSpike.stream       = trigSpkPanelUI->streamCB->currentText();
     q.trgSpike.aiChan       = trigSpkPanelUI->chanSB->value();
+    q.trgSpike.chanStr      = trigSpkPanelUI->chansLE->text().trimmed();
+    q.trgSpike.nOfM         = trigSpkPanelUI->nofmSB->value();
     q.trgSpike.inarow       = trigSpkPanelUI->inarowSB->value();
     q.trgSpike.nS           = trigSpkPanelUI->NSB->value();
     q.trgSpike.isNInf       = trigSpkPanelUI->NInfChk->isChecked();
@@ -3123,6 +3144,9 @@ void ConfigCtl::paramsFromDialog(
     q.sns.notes             = snsTabUI->notesTE->toPlainText().trimmed();
     q.sns.runName           = snsTabUI->runNameLE->text().trimmed();
     q.sns.reqMins           = snsTabUI->diskSB->value();
+    q.sns.spkEvtT           = snsTabUI->spkEvtTSB->value() / 1e6;
+    q.sns.spkEvtEnab        = snsTabUI->spkEvtChk->isChecked();
+    q.sns.spkSnipOnly       = snsTabUI->spkSnipChk->isChecked();
 }
 
 
@@ -3552,6 +3576,12 @@ bool ConfigCtl::validImTriggering( QString &err, DAQ::Params &q ) const
             return false;
         }
 
+        if( q.mode.mTrig == DAQ::eTrigSpike
+            && !validSpikeChans( err, q, nLegal ) ) {
+
+            return false;
+        }
+
         double  Tmin = q.im.int10ToV( -512, ip, trgChan ),
                 Tmax = q.im.int10ToV(  511, ip, trgChan );
 
@@ -3595,6 +3625,53 @@ bool ConfigCtl::validImTriggering( QString &err, DAQ::Params &q ) const
 }
 
 
+// Multichannel spike trigger: set must parse, lie within
+// the analog channels, and hold at least nOfM channels.
+// The threshold is scaled using the single trigger channel.
+//
+bool ConfigCtl::validSpikeChans(
+    QString         &err,
+    DAQ::Params     &q,
+    int             nLegal ) const
+{
+    if( !q.trgSpike.isMultiChan() )
+        return true;
+
+    QVector<uint>   vc;
+
+    if( !Subset::rngStr2Vec( vc, q.trgSpike.chanStr ) || !vc.size() ) {
+
+        err =
+        QString(
+        "Spike trigger channel set '%1' has a format error.")
+        .arg( q.trgSpike.chanStr );
+        return false;
+    }
+
+    if( vc.last() >= (uint)nLegal ) {
+
+        err =
+        QString(
+        "Spike trigger channels must be in range [0..%1].")
+        .arg( nLegal - 1 );
+        return false;
+    }
+
+    if( q.trgSpike.nOfM < 1 || q.trgSpike.nOfM > (uint)vc.size() ) {
+
+        err =
+        QString(
+        "Spike trigger needs [1..%1] coincident channels.")
+        .arg( vc.size() );
+        return false;
+    }
+
+    q.trgSpike.chanStr = Subset::vec2RngStr( vc );
+
+    return true;
+}
+
+
 bool ConfigCtl::validNiTriggering( QString &err, DAQ::Params &q ) const
 {
     if( !doingNidq() ) {
@@ -3625,6 +3702,12 @@ bool ConfigCtl::validNiTriggering( QString &err, DAQ::Params &q ) const
             return false;
         }
 
+        if( q.mode.mTrig == DAQ::eTrigSpike
+            && !validSpikeChans( err, q, nLegal ) ) {
+
+            return false;
+        }
+
         double  Tmin = q.ni.int16ToV( -32768, trgChan ),
                 Tmax = q.ni.int16ToV(  32767, trgChan );
 
@@ -203,6 +203,7 @@ private:
         QString         &uiStr2Err ) const;
     bool validImTriggering( QString &err, DAQ::Params &q ) const;
     bool validNiTriggering( QString &err, DAQ::Params &q ) const;
+    bool validSpikeChans( QString &err, DAQ::Params &q, int nLegal ) const;
     bool validImShankMap( QString &err, DAQ::Params &q, int ip ) const;
     bool validNiShankMap( QString &err, DAQ::Params &q ) const;
     bool validImChanMap( QString &err, DAQ::Params &q, int ip ) const;
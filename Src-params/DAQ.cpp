@@ -58,6 +58,29 @@ int Params::streamID( const QString &stream )
 }
 
 
+// Strict form for remote input: "nidq" (js = -1) if enabled,
+// or "imec<N>" (js = N) with N a probe of this run.
+//
+// Return false if neither.
+//
+bool Params::streamIDChecked( int &js, const QString &stream ) const
+{
+    if( stream == "nidq" ) {
+        js = -1;
+        return ni.enabled;
+    }
+
+    if( !stream.startsWith( "imec" ) || stream.size() == 4 )
+        return false;
+
+    bool    ok;
+
+    js = stream.midRef( 4 ).toInt( &ok );
+
+    return ok && im.enabled && js >= 0 && js < im.nProbes;
+}
+
+
 // Return trigger stream or null.
 //
 QString Params::trigStream() const
@@ -194,6 +217,12 @@ void Params::loadSettings( bool remote )
     trgSpike.aiChan =
     settings.value( "trgSpikeAIChan", 4 ).toInt();
 
+    trgSpike.chanStr =
+    settings.value( "trgSpikeChans", QString() ).toString();
+
+    trgSpike.nOfM =
+    settings.value( "trgSpikeNOfM", 1 ).toUInt();
+
     trgSpike.inarow =
     settings.value( "trgSpikeInarow", 5 ).toUInt();
 
@@ -235,6 +264,15 @@ void Params::loadSettings( bool remote )
     sns.reqMins =
     settings.value( "snsReqMins", 10 ).toInt();
 
+    sns.spkEvtT =
+    settings.value( "snsSpkEvtThresh", -75e-6 ).toDouble();
+
+    sns.spkEvtEnab =
+    settings.value( "snsSpkEvtEnable", false ).toBool();
+
+    sns.spkSnipOnly =
+    settings.value( "snsSpkSnipOnly", false ).toBool();
+
     settings.endGroup();
 
 // ----
@@ -299,6 +337,8 @@ void Params::saveSettings( bool remote ) const
     settings.setValue( "trgSpikeRefractS", trgSpike.refractSecs );
     settings.setValue( "trgSpikeStream", trgSpike.stream );
     settings.setValue( "trgSpikeAIChan", trgSpike.aiChan );
+    settings.setValue( "trgSpikeChans", trgSpike.chanStr );
+    settings.setValue( "trgSpikeNOfM", trgSpike.nOfM );
     settings.setValue( "trgSpikeInarow", trgSpike.inarow );
     settings.setValue( "trgSpikeNS", trgSpike.nS );
     settings.setValue( "trgSpikeIsNInf", trgSpike.isNInf );
@@ -323,6 +363,9 @@ void Params::saveSettings( bool remote ) const
     settings.setValue( "snsNotes", sns.notes );
     settings.setValue( "snsRunName", sns.runName );
     settings.setValue( "snsReqMins", sns.reqMins );
+    settings.setValue( "snsSpkEvtThresh", sns.spkEvtT );
+    settings.setValue( "snsSpkEvtEnable", sns.spkEvtEnab );
+    settings.setValue( "snsSpkSnipOnly", sns.spkSnipOnly );
 
     settings.endGroup();
 
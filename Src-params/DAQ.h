@@ -73,11 +73,15 @@ struct TrgSpikeParams {
     double          T,
                     periEvtSecs,
                     refractSecs;
-    QString         stream;
+    QString         stream,
+                    chanStr;    // multichan set; empty = aiChan only
     int             aiChan;
     uint            inarow,
+                    nOfM,       // min chans crossing together
                     nS;
     bool            isNInf;
+
+    bool isMultiChan() const    {return !chanStr.isEmpty();}
 };
 
 struct ModeParams {
@@ -90,7 +94,10 @@ struct ModeParams {
 struct SeeNSave {
     QString         notes,
                     runName;
+    double          spkEvtT;    // imec AP spike-event threshold (V)
     int             reqMins;
+    bool            spkEvtEnab,
+                    spkSnipOnly;    // AP as snippets only
 };
 
 struct Params {
@@ -104,6 +111,7 @@ struct Params {
     SeeNSave        sns;
 
     static int streamID( const QString &stream );
+    bool streamIDChecked( int &js, const QString &stream ) const;
 
     QString trigStream() const;
     int trigChan() const;
@@ -7,6 +7,7 @@
 #include "AOCtl.h"
 #include "AIQ.h"
 #include "Run.h"
+#include "Referencer.h"
 #include "Subset.h"
 #include "Sha1Verifier.h"
 #include "Par2Window.h"
@@ -568,6 +569,11 @@ void CmdWorker::setDigOut( const QStringList &toks )
 // 2) scan count
 // 3) <channel subset pattern "id1#id2#...">
 // 4) <integer downsample factor>
+// 5) <referencing {0=none,1=local,2=CAR,3=CMR}>
+// 6) <local referencing radius>
+//
+// Referencing applies to AP channels and is done before
+// subsetting and downsampling.
 //
 // Send( 'BINARY_DATA %d %d uint64(%ld)'\n", nChans, nScans, headCt ).
 // Write binary data stream.
@@ -584,9 +590,9 @@ void CmdWorker::fetchIm( const QStringList &toks )
             Warning() << (errMsg = "Not running.");
         else {
 
-            const QBitArray &allBits =
-                    mainApp()->cfgCtl()->
-                    acceptedParams.im.each[ip].sns.saveBits;
+            const CimCfg::AttrEach  &E =
+                    mainApp()->cfgCtl()->acceptedParams.im.each[ip];
+            const QBitArray         &allBits = E.sns.saveBits;
 
             QBitArray   chanBits;
             int         nChans  = aiQ->nChans();
@@ -618,6 +624,21 @@ void CmdWorker::fetchIm( const QStringList &toks )
             if( toks.size() >= 5 )
                 dnsmp = toks.at( 4 ).toUInt();
 
+            // -----------
+            // Referencing
+            // -----------
+
+            Referencer  ref;
+
+            if( toks.size() >= 6 ) {
+
+                ref.setSel(
+                    E.sns.shankMap,
+                    0, E.imCumTypCnt[CimCfg::imSumAP],
+                    toks.at( 5 ).toInt(),
+                    (toks.size() >= 7 ? toks.at( 6 ).toInt() : 1) );
+            }
+
             // ---------------------------------
             // Fetch whole timepoints from queue
             // ---------------------------------
@@ -631,6 +652,22 @@ void CmdWorker::fetchIm( const QStringList &toks )
 
             if( nb ) {
 
+                // -----------
+                // Referencing
+                // -----------
+
+                if( ref.isActive() ) {
+
+                    for( int i = 0; i < nb; ++i ) {
+
+                        vec_i16 &D = vB[i].data;
+
+                        ref.apply(
+                            &D[0], (const float*)0,
+                            (int)D.size() / nChans, nChans );
+                    }
+                }
+
                 // ----------------
                 // Requested subset
                 // ----------------
@@ -703,6 +740,11 @@ void CmdWorker::fetchIm( const QStringList &toks )
 // 1) scan count
 // 2) <channel subset pattern "id1#id2#...">
 // 3) <integer downsample factor>
+// 4) <referencing {0=none,1=local,2=CAR,3=CMR}>
+// 5) <local referencing radius>
+//
+// Referencing applies to neural channels and is done before
+// subsetting and downsampling.
 //
 // Send( 'BINARY_DATA %d %d uint64(%ld)'\n", nChans, nScans, headCt ).
 // Write binary data stream.
@@ -715,8 +757,8 @@ void CmdWorker::fetchNi( const QStringList &toks )
         Warning() << (errMsg = "Not running.");
     else if( toks.size() >= 2 ) {
 
-        const QBitArray &allBits =
-                mainApp()->cfgCtl()->acceptedParams.ni.sns.saveBits;
+        const CniCfg    &ni         = mainApp()->cfgCtl()->acceptedParams.ni;
+        const QBitArray &allBits    = ni.sns.saveBits;
 
         QBitArray   chanBits;
         int         nChans  = aiQ->nChans();
@@ -748,6 +790,21 @@ void CmdWorker::fetchNi( const QStringList &toks )
         if( toks.size() >= 4 )
             dnsmp = toks.at( 3 ).toUInt();
 
+        // -----------
+        // Referencing
+        // -----------
+
+        Referencer  ref;
+
+        if( toks.size() >= 5 ) {
+
+            ref.setSel(
+                ni.sns.shankMap,
+                0, ni.niCumTypCnt[CniCfg::niSumNeural],
+                toks.at( 4 ).toInt(),
+                (toks.size() >= 6 ? toks.at( 5 ).toInt() : 1) );
+        }
+
         // ---------------------------------
         // Fetch whole timepoints from queue
         // ---------------------------------
@@ -761,6 +818,22 @@ void CmdWorker::fetchNi( const QStringList &toks )
 
         if( nb ) {
 
+            // -----------
+            // Referencing
+            // -----------
+
+            if( ref.isActive() ) {
+
+                for( int i = 0; i < nb; ++i ) {
+
+                    vec_i16 &D = vB[i].data;
+
+                    ref.apply(
+                        &D[0], (const float*)0,
+                        (int)D.size() / nChans, nChans );
+                }
+            }
+
             // ----------------
             // Requested subset
             // ----------------
@@ -1017,6 +1090,8 @@ bool CmdWorker::doQuery( const QString &cmd, const QStringList &toks )
     }
     else if( cmd == "GETFILESTARTNI" )
         resp = QString("%1\n").arg( mainApp()->getRun()->dfGetNiFileStart() );
+    else if( cmd == "GETTRIGLATENCY" )
+        resp = mainApp()->getRun()->dfGetTrigLatency();
     else if( cmd == "GETSCANCOUNTIM" ) {
         resp = QString("%1\n").arg( mainApp()->getRun()->
                 getImScanCount( toks.front().toUInt() ) );
@@ -1,6 +1,8 @@
 
 #include "RgtServer.h"
 #include "Util.h"
+#include "MainApp.h"
+#include "ConfigCtl.h"
 #include "SockUtil.h"
 
 #include <QHostAddress>
@@ -11,6 +13,7 @@
 #define SETGATELO   "SETGATE 0"
 #define SETTRIGHI   "SETTRIG 1"
 #define SETTRIGLO   "SETTRIG 0"
+#define SETTRIGCT   "SETTRIGCT"
 #define SETMETA     "SETMETA"
 #define METAEND     "METAEND"
 #define OK          "OK"
@@ -161,6 +164,29 @@ bool rgtSetTrig(
 }
 
 
+// Command: "SETTRIGCT hi stream ct".
+//
+bool rgtSetTrigCt(
+    bool            hi,
+    const QString   &stream,
+    quint64         ct,
+    const QString   &host,
+    ushort          port,
+    int             timeout_msecs,
+    QString         *err )
+{
+    QString     cmd = QString(SETTRIGCT " %1 %2 %3")
+                        .arg( hi ).arg( stream ).arg( ct );
+    QTcpSocket  sock;
+    SockUtil    SU( &sock, timeout_msecs, "RemoteApp", err );
+
+    if( !prologue( cmd, err, SU, host, port ) )
+        return false;
+
+    return epilogue( cmd, err, SU );
+}
+
+
 bool rgtSetMetaData(
     const KeyValMap &kvm,
     const QString   &host,
@@ -286,6 +312,34 @@ void RgtServer::processConnection( QTcpSocket &sock )
 
     if( cmd.startsWith( "SETGATE" ) )
         emit rgtSetGate( cmd.startsWith( SETGATEHI ) );
+    else if( cmd.startsWith( SETTRIGCT ) ) {
+
+        QStringList sl = cmd.split(
+                            QRegExp("\\s+"),
+                            QString::SkipEmptyParts );
+        bool        ok = (sl.size() == 4);
+        quint64     ct = 0;
+
+        if( ok )
+            ct = sl[3].toULongLong( &ok );
+
+        if( !ok ) {
+            Error() << QString("RgtSrv bad cmd err %1%2 [%3]")
+                        .arg( SU.tag() ).arg( SU.addr() ).arg( cmd );
+            return;
+        }
+
+        int js;
+
+        if( !mainApp()->cfgCtl()->acceptedParams.streamIDChecked( js, sl[2] ) ) {
+            Error() << QString("RgtSrv bad stream err %1%2 [%3]")
+                        .arg( SU.tag() ).arg( SU.addr() ).arg( cmd );
+            SU.send( QString("ERROR No such stream [%1]\n").arg( sl[2] ) );
+            return;
+        }
+
+        emit rgtSetTrigCt( sl[1] == "1", sl[2], ct );
+    }
     else if( cmd.startsWith( "SETTRIG" ) )
         emit rgtSetTrig( cmd.startsWith( SETTRIGHI ) );
     else if( cmd.startsWith( "SETMETA" ) ) {
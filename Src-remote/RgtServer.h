@@ -41,6 +41,22 @@ bool rgtSetTrig(
     int             timeout_msecs = RGT_TOUT_MS,
     QString         *err = 0 );
 
+// Remote app commands trigger high or low at sample count
+// (ct) of (stream) {"nidq", "imec0", ...}, rather than when
+// the command arrives. (ct) may be in the future. A stream
+// not in the current run is refused with an error reply.
+// Blocks until transaction complete or timeout.
+// Returns true if success.
+//
+bool rgtSetTrigCt(
+    bool            hi,
+    const QString   &stream,
+    quint64         ct,
+    const QString   &host = "127.0.0.1",
+    ushort          port = RGT_DEF_PORT,
+    int             timeout_msecs = RGT_TOUT_MS,
+    QString         *err = 0 );
+
 // Remote app sends supplementary ini-style metadata.
 // Blocks until transaction complete or timeout.
 // Returns true if success.
@@ -74,6 +90,7 @@ public:
 signals:
     void rgtSetGate( bool hi );
     void rgtSetTrig( bool hi );
+    void rgtSetTrigCt( bool hi, const QString &stream, quint64 ct );
     void rgtSetMetaData( const KeyValMap &kvm );
 
 protected:
@@ -85,6 +85,7 @@ bool RgtSrvDlg::startServer( bool isAppStrtup )
 
     Connect( rgtServer, SIGNAL(rgtSetGate(bool)), run, SLOT(rgtSetGate(bool)) );
     Connect( rgtServer, SIGNAL(rgtSetTrig(bool)), run, SLOT(rgtSetTrig(bool)) );
+    Connect( rgtServer, SIGNAL(rgtSetTrigCt(bool,QString,quint64)), run, SLOT(rgtSetTrigCt(bool,QString,quint64)) );
     Connect( rgtServer, SIGNAL(rgtSetMetaData(KeyValMap)), run, SLOT(rgtSetMetaData(KeyValMap)) );
 
     return true;
@@ -1,6 +1,7 @@
 
 #include "AIQ.h"
 #include "Util.h"
+#include "EdgeScan.h"
 
 
 /* ---------------------------------------------------------------- */
@@ -8,7 +9,7 @@
 /* ---------------------------------------------------------------- */
 
 AIQ::AIQBlock::AIQBlock( vec_i16 &src, int len, quint64 headCt, double tailT )
-    :   headCt(headCt), tailT(tailT)
+    :   headCt(headCt), tailT(tailT), enqT(tailT)
 {
     data.insert( data.begin(), src.begin(), src.begin() + len );
 }
@@ -19,8 +20,9 @@ AIQ::AIQBlock::AIQBlock(
     int     offset,
     int     len,
     quint64 headCt,
-    double  tailT )
-    :   headCt(headCt), tailT(tailT)
+    double  tailT,
+    double  enqT )
+    :   headCt(headCt), tailT(tailT), enqT(enqT)
 {
     data.insert(
         data.begin(),
@@ -28,175 +30,6 @@ AIQ::AIQBlock::AIQBlock(
         src.begin() + offset + len );
 }
 
-/* ---------------------------------------------------------------- */
-/* VBWalker ------------------------------------------------------- */
-/* ---------------------------------------------------------------- */
-
-// Utility class assists edge detection across block boundaries.
-
-class VBWalker {
-private:
-    std::deque<AIQ::AIQBlock>::const_iterator
-                    it,
-                    end;
-    const qint16    *lim;
-    int             nchans,
-                    chan,
-                    siz;
-public:
-    const qint16    *cur;
-public:
-    VBWalker( const std::deque<AIQ::AIQBlock> &Q, int nchans, int chan )
-    :   it(Q.begin()), end(Q.end()), lim(0),
-        nchans(nchans), chan(chan) {}
-
-    bool SetStart( quint64 fromCt );
-    bool next();
-    quint64 curCt() {return it->headCt + (cur - &it->data[0])/nchans;}
-    quint64 endCt() {return (lim ? (--end)->headCt + siz/nchans : 0);}
-private:
-    void nextBlock();
-};
-
-
-bool VBWalker::SetStart( quint64 fromCt )
-{
-    for( ; it != end; ++it ) {
-
-        siz = (int)it->data.size();
-
-        if( it->headCt + siz/nchans > fromCt ) {
-
-            if( fromCt > it->headCt )
-                cur = &it->data[chan + (fromCt - it->headCt)*nchans];
-            else
-                cur = &it->data[chan];
-
-            lim = &it->data[0] + siz;
-
-            return true;
-        }
-    }
-
-    return false;
-}
-
-
-bool VBWalker::next()
-{
-    if( (cur += nchans) >= lim ) {
-
-        if( ++it != end )
-            nextBlock();
-        else {
-            --it;
-            return false;
-        }
-    }
-
-    return true;
-}
-
-
-void VBWalker::nextBlock()
-{
-    siz = (int)it->data.size();
-    cur = &it->data[chan];
-    lim = &it->data[0] + siz;
-}
-
-
-/* ---------------------------------------------------------------- */
-/* VBFltWalker ---------------------------------------------------- */
-/* ---------------------------------------------------------------- */
-
-// Utility class assists edge detection across block boundaries;
-// filters data via callback usrFlt.
-
-class VBFltWalker {
-private:
-    std::deque<AIQ::AIQBlock>::const_iterator
-                    it,
-                    end;
-    AIQ::T_AIQBlockFilter
-                    &usrFlt;
-    vec_i16         data;
-    const qint16    *lim;
-    int             nchans,
-                    chan,
-                    siz;
-public:
-    const qint16    *cur;
-public:
-    VBFltWalker(
-        const std::deque<AIQ::AIQBlock> &Q,
-        AIQ::T_AIQBlockFilter           &usrFlt,
-        int                             nchans,
-        int                             chan )
-    :   it(Q.begin()), end(Q.end()), usrFlt(usrFlt),
-        lim(0), nchans(nchans), chan(chan) {}
-
-    bool SetStart( quint64 fromCt );
-    bool next();
-    quint64 curCt() {return it->headCt + (cur - &data[0])/nchans;}
-    quint64 endCt() {return (lim ? (--end)->headCt + siz/nchans : 0);}
-private:
-    void nextBlock();
-};
-
-
-bool VBFltWalker::SetStart( quint64 fromCt )
-{
-    for( ; it != end; ++it ) {
-
-        siz = (int)it->data.size();
-
-        if( it->headCt + siz/nchans > fromCt ) {
-
-            data = it->data;
-            usrFlt( data );
-
-            if( fromCt > it->headCt )
-                cur = &data[chan + (fromCt - it->headCt)*nchans];
-            else
-                cur = &data[chan];
-
-            lim = &data[0] + siz;
-
-            return true;
-        }
-    }
-
-    return false;
-}
-
-
-bool VBFltWalker::next()
-{
-    if( (cur += nchans) >= lim ) {
-
-        if( ++it != end )
-            nextBlock();
-        else {
-            --it;
-            return false;
-        }
-    }
-
-    return true;
-}
-
-
-void VBFltWalker::nextBlock()
-{
-    data    = it->data;
-    siz     = (int)it->data.size();
-    cur     = &data[chan];
-    lim     = &data[0] + siz;
-
-    usrFlt( data );
-}
-
 /* ---------------------------------------------------------------- */
 /* AIQ ------------------------------------------------------------ */
 /* ---------------------------------------------------------------- */
@@ -205,11 +38,19 @@ AIQ::AIQ( double srate, int nchans, int capacitySecs )
     :   srate(srate),
         maxCts(capacitySecs * srate),
         nchans(nchans),
-        curCts(0)
+        curCts(0),
+        drvEndCt(0)
 {
 }
 
 
+AIQ::~AIQ()
+{
+    for( int id = 0, nd = drv.size(); id < nd; ++id )
+        delete drv[id].flt;
+}
+
+
 void AIQ::enqueue( vec_i16 &src, double nowT, quint64 headCt, int nWhole )
 {
     const int   maxScansPerBlk = 100;
@@ -218,6 +59,9 @@ void AIQ::enqueue( vec_i16 &src, double nowT, quint64 headCt, int nWhole )
 
     updateQCts( nWhole );
 
+    if( drv.size() && nWhole > 0 )
+        updateDerived( src, headCt, nWhole );
+
     if( nWhole <= maxScansPerBlk )
         Q.push_back( AIQBlock( src, nWhole * nchans, headCt, nowT ) );
     else {
@@ -248,7 +92,8 @@ void AIQ::enqueue( vec_i16 &src, double nowT, quint64 headCt, int nWhole )
                     offset * nchans,
                     maxScansPerBlk * nchans,
                     headCt,
-                    tailT += maxScansPerBlk * delT ) );
+                    tailT += maxScansPerBlk * delT,
+                    nowT ) );
 
             offset += maxScansPerBlk;
             headCt += maxScansPerBlk;
@@ -267,7 +112,8 @@ void AIQ::enqueue( vec_i16 &src, double nowT, quint64 headCt, int nWhole )
                 offset * nchans,
                 nhalf * nchans,
                 headCt,
-                tailT += nhalf * delT ) );
+                tailT += nhalf * delT,
+                nowT ) );
 
         offset += nhalf;
         headCt += nhalf;
@@ -281,8 +127,41 @@ void AIQ::enqueue( vec_i16 &src, double nowT, quint64 headCt, int nWhole )
                 offset * nchans,
                 nWhole * nchans,
                 headCt,
-                tailT + nWhole * delT ) );
+                tailT + nWhole * delT,
+                nowT ) );
+    }
+}
+
+
+// A derived channel holds a filtered copy of one channel, made
+// once as data arrive, for edge searches that would otherwise
+// copy and refilter whole blocks on every call.
+//
+void AIQ::addDerivedChan( int chan, T_AIQMonoFilter *flt )
+{
+    QMutexLocker    ml( &QMtx );
+
+    Derived D;
+
+    D.flt   = flt;
+    D.chan  = chan;
+    D.ring.assign( qMax( maxCts, quint64(1) ), 0 );
+
+    drv.push_back( D );
+}
+
+
+bool AIQ::hasDerivedChan( int chan ) const
+{
+    QMutexLocker    ml( &QMtx );
+
+    for( int id = 0, nd = drv.size(); id < nd; ++id ) {
+
+        if( drv[id].chan == chan )
+            return true;
     }
+
+    return false;
 }
 
 
@@ -399,6 +278,30 @@ bool AIQ::mapCt2Time( double &t, quint64 ct ) const
 }
 
 
+// Return time that the block holding ct was enqueued,
+// that is, when sample ct became available to consumers.
+//
+bool AIQ::mapCt2EnqT( double &t, quint64 ct ) const
+{
+    QMutexLocker    ml( &QMtx );
+
+    t = 0;
+
+    std::deque<AIQBlock>::const_reverse_iterator
+        it = Q.rbegin(), end = Q.rend();
+
+    for( ; it != end; ++it ) {
+
+        if( it->headCt <= ct ) {
+            t = it->enqT;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
 // If vB.size() > 1 then the data are concatenated into cat,
 // and a reference to cat is returned in output param dst.
 //
@@ -1155,83 +1058,11 @@ bool AIQ::findRisingEdge(
     qint16                  T,
     int                     inarow ) const
 {
-    int     nhi     = 0;
-    bool    found   = false;
-
-    QMtx.lock();
-
-    VBWalker    W( Q, nchans, chan );
-
-    if( !W.SetStart( fromCt ) )
-        goto exit;
-
-// -------------------
-// Must start on a low
-// -------------------
-
-    if( *W.cur >= T ) {
-
-        while( W.next() ) {
-
-            if( *W.cur < T )
-                goto seek_edge;
-        }
+    EdgeScan    E;
 
-        goto exit;
-    }
-
-// -------------------
-// Seek edge candidate
-// -------------------
-
-seek_edge:
-    while( W.next() ) {
+    E.setAnalog( T, true, inarow );
 
-        if( *W.cur >= T ) {
-
-            // Mark edge start
-            outCt   = W.curCt();
-            nhi     = 1;
-
-            if( inarow == 1 ) {
-                found = true;
-                goto exit;
-            }
-
-            // Check extended run length
-            while( W.next() ) {
-
-                if( *W.cur >= T ) {
-
-                    if( ++nhi >= inarow ) {
-                        found = true;
-                        goto exit;
-                    }
-                }
-                else {
-                    nhi = 0;
-                    break;
-                }
-            }
-        }
-    }
-
-// ----
-// Exit
-// ----
-
-exit:
-    if( !found ) {
-
-        if( nhi )
-            --outCt;    // review last candidate again
-        else
-            outCt = qMax( fromCt, W.endCt() );
-    }
-
-    QMtx.unlock();
-
-    return found;
+    return findEdge( outCt, fromCt, chan, E, 0 );
 }
 
 
@@ -1253,83 +1084,11 @@ bool AIQ::findFltRisingEdge(
     int                     inarow,
     T_AIQBlockFilter        &usrFlt ) const
 {
-    int     nhi     = 0;
-    bool    found   = false;
-
-    QMtx.lock();
-
-    VBFltWalker    W( Q, usrFlt, nchans, chan );
-
-    if( !W.SetStart( fromCt ) )
-        goto exit;
-
-// -------------------
-// Must start on a low
-// -------------------
-
-    if( *W.cur >= T ) {
-
-        while( W.next() ) {
-
-            if( *W.cur < T )
-                goto seek_edge;
-        }
+    EdgeScan    E;
 
-        goto exit;
-    }
-
-// -------------------
-// Seek edge candidate
-// -------------------
-
-seek_edge:
-    while( W.next() ) {
-
-        if( *W.cur >= T ) {
-
-            // Mark edge start
-            outCt   = W.curCt();
-            nhi     = 1;
-
-            if( inarow == 1 ) {
-                found = true;
-                goto exit;
-            }
-
-            // Check extended run length
-            while( W.next() ) {
-
-                if( *W.cur >= T ) {
-
-                    if( ++nhi >= inarow ) {
-                        found = true;
-                        goto exit;
-                    }
-                }
-                else {
-                    nhi = 0;
-                    break;
-                }
-            }
-        }
-    }
-
-// ----
-// Exit
-// ----
-
-exit:
-    if( !found ) {
-
-        if( nhi )
-            --outCt;    // review last candidate again
-        else
-            outCt = qMax( fromCt, W.endCt() );
-    }
+    E.setAnalog( T, true, inarow );
 
-    QMtx.unlock();
-
-    return found;
+    return findEdge( outCt, fromCt, chan, E, &usrFlt );
 }
 
 
@@ -1350,83 +1109,11 @@ bool AIQ::findBitRisingEdge(
     int                     bit,
     int                     inarow ) const
 {
-    int     nhi     = 0;
-    bool    found   = false;
-
-    QMtx.lock();
-
-    VBWalker    W( Q, nchans, chan );
-
-    if( !W.SetStart( fromCt ) )
-        goto exit;
-
-// -------------------
-// Must start on a low
-// -------------------
-
-    if( (*W.cur >> bit) & 1 ) {
-
-        while( W.next() ) {
-
-            if( !((*W.cur >> bit) & 1) )
-                goto seek_edge;
-        }
-
-        goto exit;
-    }
-
-// -------------------
-// Seek edge candidate
-// -------------------
-
-seek_edge:
-    while( W.next() ) {
-
-        if( (*W.cur >> bit) & 1 ) {
-
-            // Mark edge start
-            outCt   = W.curCt();
-            nhi     = 1;
-
-            if( inarow == 1 ) {
-                found = true;
-                goto exit;
-            }
-
-            // Check extended run length
-            while( W.next() ) {
-
-                if( (*W.cur >> bit) & 1 ) {
+    EdgeScan    E;
 
-                    if( ++nhi >= inarow ) {
-                        found = true;
-                        goto exit;
-                    }
-                }
-                else {
-                    nhi = 0;
-                    break;
-                }
-            }
-        }
-    }
-
-// ----
-// Exit
-// ----
-
-exit:
-    if( !found ) {
-
-        if( nhi )
-            --outCt;    // review last candidate again
-        else
-            outCt = qMax( fromCt, W.endCt() );
-    }
+    E.setBit( bit, true, inarow );
 
-    QMtx.unlock();
-
-    return found;
+    return findEdge( outCt, fromCt, chan, E, 0 );
 }
 
 
@@ -1445,83 +1132,11 @@ bool AIQ::findFallingEdge(
     qint16                  T,
     int                     inarow ) const
 {
-    int     nlo     = 0;
-    bool    found   = false;
-
-    QMtx.lock();
-
-    VBWalker    W( Q, nchans, chan );
+    EdgeScan    E;
 
-    if( !W.SetStart( fromCt ) )
-        goto exit;
-
-// --------------------
-// Must start on a high
-// --------------------
-
-    if( *W.cur < T ) {
-
-        while( W.next() ) {
-
-            if( *W.cur >= T )
-                goto seek_edge;
-        }
+    E.setAnalog( T, false, inarow );
 
-        goto exit;
-    }
-
-// -------------------
-// Seek edge candidate
-// -------------------
-
-seek_edge:
-    while( W.next() ) {
-
-        if( *W.cur < T ) {
-
-            // Mark edge start
-            outCt   = W.curCt();
-            nlo     = 1;
-
-            if( inarow == 1 ) {
-                found = true;
-                goto exit;
-            }
-
-            // Check extended run length
-            while( W.next() ) {
-
-                if( *W.cur < T ) {
-
-                    if( ++nlo >= inarow ) {
-                        found = true;
-                        goto exit;
-                    }
-                }
-                else {
-                    nlo = 0;
-                    break;
-                }
-            }
-        }
-    }
-
-// ----
-// Exit
-// ----
-
-exit:
-    if( !found ) {
-
-        if( nlo )
-            --outCt;    // review last candidate again
-        else
-            outCt = qMax( fromCt, W.endCt() );
-    }
-
-    QMtx.unlock();
-
-    return found;
+    return findEdge( outCt, fromCt, chan, E, 0 );
 }
 
 
@@ -1543,83 +1158,11 @@ bool AIQ::findFltFallingEdge(
     int                     inarow,
     T_AIQBlockFilter        &usrFlt ) const
 {
-    int     nlo     = 0;
-    bool    found   = false;
-
-    QMtx.lock();
-
-    VBFltWalker    W( Q, usrFlt, nchans, chan );
-
-    if( !W.SetStart( fromCt ) )
-        goto exit;
-
-// --------------------
-// Must start on a high
-// --------------------
-
-    if( *W.cur < T ) {
-
-        while( W.next() ) {
-
-            if( *W.cur >= T )
-                goto seek_edge;
-        }
-
-        goto exit;
-    }
-
-// -------------------
-// Seek edge candidate
-// -------------------
-
-seek_edge:
-    while( W.next() ) {
-
-        if( *W.cur < T ) {
-
-            // Mark edge start
-            outCt   = W.curCt();
-            nlo     = 1;
-
-            if( inarow == 1 ) {
-                found = true;
-                goto exit;
-            }
-
-            // Check extended run length
-            while( W.next() ) {
+    EdgeScan    E;
 
-                if( *W.cur < T ) {
+    E.setAnalog( T, false, inarow );
 
-                    if( ++nlo >= inarow ) {
-                        found = true;
-                        goto exit;
-                    }
-                }
-                else {
-                    nlo = 0;
-                    break;
-                }
-            }
-        }
-    }
-
-// ----
-// Exit
-// ----
-
-exit:
-    if( !found ) {
-
-        if( nlo )
-            --outCt;    // review last candidate again
-        else
-            outCt = qMax( fromCt, W.endCt() );
-    }
-
-    QMtx.unlock();
-
-    return found;
+    return findEdge( outCt, fromCt, chan, E, &usrFlt );
 }
 
 
@@ -1640,83 +1183,72 @@ bool AIQ::findBitFallingEdge(
     int                     bit,
     int                     inarow ) const
 {
-    int     nlo     = 0;
-    bool    found   = false;
-
-    QMtx.lock();
+    EdgeScan    E;
 
-    VBWalker    W( Q, nchans, chan );
+    E.setBit( bit, false, inarow );
 
-    if( !W.SetStart( fromCt ) )
-        goto exit;
+    return findEdge( outCt, fromCt, chan, E, 0 );
+}
 
-// --------------------
-// Must start on a high
-// --------------------
+// Using derived (prefiltered) copy of chan...
+//
+// Same rules and return values as findFltFallingEdge(), but
+// walks the contiguous mono ring; nothing is copied or filtered.
+//
+bool AIQ::findDrvFallingEdge(
+    quint64                 &outCt,
+    quint64                 fromCt,
+    int                     chan,
+    qint16                  T,
+    int                     inarow ) const
+{
+    const Derived   *D = 0;
 
-    if( !((*W.cur >> bit) & 1) ) {
+    QMutexLocker    ml( &QMtx );
 
-        while( W.next() ) {
+    for( int id = 0, nd = drv.size(); id < nd; ++id ) {
 
-            if( (*W.cur >> bit) & 1 )
-                goto seek_edge;
+        if( drv[id].chan == chan ) {
+            D = &drv[id];
+            break;
         }
-
-        goto exit;
     }
 
-// -------------------
-// Seek edge candidate
-// -------------------
+    if( !D || Q.empty() ) {
+        outCt = fromCt;
+        return false;
+    }
 
-seek_edge:
-    while( W.next() ) {
+// Ring may reach back past Q.front; don't find what can't be fetched.
 
-        if( !((*W.cur >> bit) & 1) ) {
+    EdgeScan    E;
+    quint64     ct  = qMax( fromCt, Q.front().headCt );
+    int         N   = D->ring.size();
 
-            // Mark edge start
-            outCt   = W.curCt();
-            nlo     = 1;
+    E.setAnalog( T, false, inarow );
 
-            if( inarow == 1 ) {
-                found = true;
-                goto exit;
-            }
+// At most two contiguous pieces: to end of ring, then from start.
 
-            // Check extended run length
-            while( W.next() ) {
+    while( ct < drvEndCt ) {
 
-                if( !((*W.cur >> bit) & 1) ) {
+        int i       = ct % N,
+            n       = qMin( quint64(N - i), drvEndCt - ct ),
+            edgeRow;
 
-                    if( ++nlo >= inarow ) {
-                        found = true;
-                        goto exit;
-                    }
-                }
-                else {
-                    nlo = 0;
-                    break;
-                }
-            }
+        if( E.scan( edgeRow, &D->ring[i], n, 1 ) ) {
+            outCt = ct + edgeRow;
+            return true;
         }
-    }
-
-// ----
-// Exit
-// ----
-
-exit:
-    if( !found ) {
 
-        if( nlo )
-            --outCt;    // review last candidate again
-        else
-            outCt = qMax( fromCt, W.endCt() );
+        ct += n;
     }
 
-    QMtx.unlock();
+    if( E.runLen() )
+        outCt = drvEndCt - E.runLen() - 1;  // review last candidate again
+    else
+        outCt = qMax( fromCt, drvEndCt );
 
-    return found;
+    return false;
 }
 
 /* ---------------------------------------------------------------- */
@@ -1740,3 +1272,96 @@ void AIQ::updateQCts( int nWhole )
 }
 
 
+// Common walk for the edge finders: feed chan of each block from
+// fromCt to scanner (E), which carries run state across blocks.
+// If (usrFlt), each visited block is copied and filtered first.
+//
+bool AIQ::findEdge(
+    quint64                 &outCt,
+    quint64                 fromCt,
+    int                     chan,
+    EdgeScan                &E,
+    T_AIQBlockFilter        *usrFlt ) const
+{
+    QMutexLocker    ml( &QMtx );
+
+    std::deque<AIQBlock>::const_iterator    it  = Q.begin(),
+                                            end = Q.end();
+    vec_i16 flt;
+    quint64 endCt = 0;
+
+    for( ; it != end; ++it ) {
+
+        if( it->headCt + it->data.size()/nchans > fromCt )
+            break;
+    }
+
+    for( ; it != end; ++it ) {
+
+        const qint16    *d;
+        int             ntpts   = (int)it->data.size() / nchans,
+                        r0      = 0,
+                        edgeRow;
+
+        if( fromCt > it->headCt )
+            r0 = fromCt - it->headCt;
+
+        if( usrFlt ) {
+            flt = it->data;
+            (*usrFlt)( flt );
+            d = &flt[0];
+        }
+        else
+            d = &it->data[0];
+
+        if( E.scan( edgeRow, d + chan + r0*nchans, ntpts - r0, nchans ) ) {
+            outCt = it->headCt + r0 + edgeRow;
+            return true;
+        }
+
+        endCt = it->headCt + ntpts;
+    }
+
+    if( E.runLen() )
+        outCt = endCt - E.runLen() - 1;     // review last candidate again
+    else
+        outCt = qMax( fromCt, endCt );
+
+    return false;
+}
+
+
+// Caller holds QMtx. Blocks are contiguous in count, so
+// headCt continues the ring where the last enqueue left off.
+//
+void AIQ::updateDerived( const vec_i16 &src, quint64 headCt, int nWhole )
+{
+    drvTmp.resize( nWhole );
+
+    for( int id = 0, nd = drv.size(); id < nd; ++id ) {
+
+        Derived         &D  = drv[id];
+        const qint16    *S  = &src[D.chan];
+        qint16          *M  = &drvTmp[0];
+        int             N   = D.ring.size(),
+                        i   = headCt % N;
+
+        for( int it = 0; it < nWhole; ++it, S += nchans )
+            M[it] = *S;
+
+        if( D.flt )
+            (*D.flt)( M, nWhole );
+
+        for( int it = 0; it < nWhole; ++it ) {
+
+            D.ring[i] = M[it];
+
+            if( ++i == N )
+                i = 0;
+        }
+    }
+
+    drvEndCt = headCt + nWhole;
+}
+
+
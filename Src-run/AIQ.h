@@ -10,6 +10,8 @@
 #include <QMutex>
 #include <deque>
 
+class EdgeScan;
+
 /* ---------------------------------------------------------------- */
 /* Types ---------------------------------------------------------- */
 /* ---------------------------------------------------------------- */
@@ -24,7 +26,8 @@ public:
     struct AIQBlock {
         vec_i16 data;
         quint64 headCt;
-        double  tailT;
+        double  tailT,
+                enqT;   // when enqueued
 
         AIQBlock(
             vec_i16 &src,
@@ -37,7 +40,8 @@ public:
             int     offset,
             int     len,
             quint64 headCt,
-            double  tailT );
+            double  tailT,
+            double  enqT );
     };
 
     // callback functor
@@ -45,6 +49,23 @@ public:
         virtual void operator()( vec_i16 &data ) = 0;
     };
 
+    // callback functor, derived channel: filter (n) contiguous
+    // samples in place, continuing from the previous call.
+    struct T_AIQMonoFilter {
+        virtual ~T_AIQMonoFilter()  {}
+        virtual void operator()( qint16 *data, int n ) = 0;
+    };
+
+private:
+    // Derived channel: one source channel, filtered once at
+    // enqueue time, kept as a mono ring of maxCts samples.
+    // Sample for count ct is at ring[ct % ring.size()].
+    struct Derived {
+        vec_i16         ring;
+        T_AIQMonoFilter *flt;
+        int             chan;
+    };
+
 /* ---- */
 /* Data */
 /* ---- */
@@ -54,8 +75,11 @@ private:
     const quint64           maxCts;
     const int               nchans;
     std::deque<AIQBlock>    Q;
+    std::vector<Derived>    drv;
+    vec_i16                 drvTmp;
     mutable QMutex          QMtx;
-    quint64                 curCts;
+    quint64                 curCts,
+                            drvEndCt;
 
 /* ------- */
 /* Methods */
@@ -63,16 +87,22 @@ private:
 
 public:
     AIQ( double srate, int nchans, int capacitySecs );
+    virtual ~AIQ();
 
     double sRate() const    {return srate;}
     int nChans() const      {return nchans;}
 
     void enqueue( vec_i16 &src, double nowT, quint64 headCt, int nWhole );
 
+    // Register before first enqueue(). Takes ownership of (flt).
+    void addDerivedChan( int chan, T_AIQMonoFilter *flt );
+    bool hasDerivedChan( int chan ) const;
+
     quint64 qHeadCt() const;
     quint64 curCount() const;
     bool mapTime2Ct( quint64 &ct, double t ) const;
     bool mapCt2Time( double &t, quint64 ct ) const;
+    bool mapCt2EnqT( double &t, quint64 ct ) const;
 
     bool catBlocks(
         vec_i16*                &dst,
@@ -177,8 +207,22 @@ public:
         int                     bit,
         int                     inarow ) const;
 
+    bool findDrvFallingEdge(
+        quint64                 &outCt,
+        quint64                 fromCt,
+        int                     chan,
+        qint16                  T,
+        int                     inarow ) const;
+
 private:
     void updateQCts( int nWhole );
+    bool findEdge(
+        quint64                 &outCt,
+        quint64                 fromCt,
+        int                     chan,
+        EdgeScan                &E,
+        T_AIQBlockFilter        *usrFlt ) const;
+    void updateDerived( const vec_i16 &src, quint64 headCt, int nWhole );
 };
 
 #endif  // AIQ_H
@@ -10,7 +10,6 @@
 #define M_PI		3.14159265358979323846
 #endif
 
-#define MAX10BIT    512
 //#define PROFILE
 
 
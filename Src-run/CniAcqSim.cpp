@@ -9,7 +9,6 @@
 #endif
 
 
-#define MAX16BIT    32768
 //#define PROFILE
 
 
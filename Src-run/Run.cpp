@@ -7,9 +7,12 @@
 #include "IMReader.h"
 #include "NIReader.h"
 #include "GateTCP.h"
+#include "TrigSpike.h"
 #include "TrigTCP.h"
 #include "GraphsWindow.h"
 #include "GraphFetcher.h"
+#include "ProbeActivity.h"
+#include "ShankOverview.h"
 #include "AOCtl.h"
 #include "Version.h"
 
@@ -25,7 +28,7 @@
 
 Run::Run( MainApp *app )
     :   QObject(0), app(app), niQ(0),
-        graphsWindow(0), graphFetcher(0),
+        graphsWindow(0), graphFetcher(0), probeAct(0), shankOv(0),
         imReader(0), niReader(0),
         gate(0), trg(0), running(false)
 {
@@ -187,6 +190,28 @@ void Run::grfUpdateWindowTitles()
     }
 }
 
+/* ---------------------------------------------------------------- */
+/* Owned ShankOverview ops ---------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Created on first request; lives until run stops.
+//
+void Run::shankOvShow()
+{
+    QMutexLocker    ml( &runMtx );
+
+    if( !running || !probeAct )
+        return;
+
+    if( !shankOv ) {
+
+        shankOv = new ShankOverview( app->cfgCtl()->acceptedParams, probeAct );
+        ConnectUI( shankOv, SIGNAL(closed(QWidget*)), app, SLOT(modelessClosed(QWidget*)) );
+    }
+
+    shankOv->showDialog();
+}
+
 /* ---------------------------------------------------------------- */
 /* Owned AIStream ops --------------------------------------------- */
 /* ---------------------------------------------------------------- */
@@ -231,6 +256,14 @@ const AIQ* Run::getNiQ() const
     return niQ;
 }
 
+
+ProbeActivity* Run::getProbeAct() const
+{
+    QMutexLocker    ml( &runMtx );
+
+    return probeAct;
+}
+
 /* ---------------------------------------------------------------- */
 /* Run control ---------------------------------------------------- */
 /* ---------------------------------------------------------------- */
@@ -282,6 +315,8 @@ bool Run::startRun( QString &errTitle, QString &errMsg )
 
         imReader = new IMReader( p, imQ );
         ConnectUI( imReader->worker, SIGNAL(daqError(QString)), app, SLOT(runDaqError(QString)) );
+
+        probeAct = new ProbeActivity( p, imQ );
     }
 
 // -----------
@@ -304,6 +339,9 @@ bool Run::startRun( QString &errTitle, QString &errMsg )
 // Trigger
 // -------
 
+    if( p.mode.mTrig == DAQ::eTrigSpike )
+        TrigSpike::addDerivedChan( p, imQ, niQ );
+
     trg = new Trigger( p, graphsWindow, imQ, niQ );
     ConnectUI( trg->worker, SIGNAL(finished()), this, SLOT(workerStopsRun()) );
 
@@ -348,6 +386,20 @@ void Run::stopRun()
         graphFetcher = 0;
     }
 
+    if( graphsWindow )
+        graphsWindow->stopRaster();
+
+    if( shankOv ) {
+        app->modelessClosed( shankOv );
+        delete shankOv;
+        shankOv = 0;
+    }
+
+    if( probeAct ) {
+        delete probeAct;
+        probeAct = 0;
+    }
+
 // Note: gate sends messages to trg, so must delete gate before trg.
 
     if( gate ) {
@@ -559,6 +611,19 @@ quint64 Run::dfGetNiFileStart() const
     return 0;
 }
 
+
+// Called by remote process.
+//
+QString Run::dfGetTrigLatency() const
+{
+    QMutexLocker    ml( &runMtx );
+
+    if( trg )
+        return trg->worker->latencyStr();
+
+    return TrigLatency().remoteStr();
+}
+
 /* ---------------------------------------------------------------- */
 /* Owned gate and trigger ops ------------------------------------- */
 /* ---------------------------------------------------------------- */
@@ -591,6 +656,30 @@ void Run::rgtSetTrig( bool hi )
 }
 
 
+void Run::rgtSetTrigCt( bool hi, const QString &stream, quint64 ct )
+{
+    QMutexLocker    ml( &runMtx );
+
+    if( trg ) {
+
+        DAQ::Params &p = app->cfgCtl()->acceptedParams;
+
+        if( p.mode.mTrig == DAQ::eTrigTCP ) {
+
+            int js;
+
+            if( !p.streamIDChecked( js, stream ) ) {
+                Error() << QString("SetTrigCt: No such stream (%1)...ignoring.")
+                            .arg( stream );
+                return;
+            }
+
+            dynamic_cast<TrigTCP*>(trg->worker)->rgtSetTrigCt( hi, js, ct );
+        }
+    }
+}
+
+
 void Run::rgtSetMetaData( const KeyValMap &kvm )
 {
     QMutexLocker    ml( &runMtx );
@@ -687,6 +776,7 @@ void Run::createGraphsWindow( const DAQ::Params &p )
     graphsWindow->setAttribute( Qt::WA_DeleteOnClose, false );
 
     app->act.shwHidGrfsAct->setEnabled( true );
+    app->act.shankOvAct->setEnabled( p.im.enabled );
     graphsWindow->show();
 
     app->modelessOpened( graphsWindow, false );
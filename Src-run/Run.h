@@ -15,6 +15,8 @@ class MainApp;
 class GraphsWindow;
 class GraphFetcher;
 class GFStream;
+class ProbeActivity;
+class ShankOverview;
 class IMReader;
 class NIReader;
 class Gate;
@@ -37,6 +39,8 @@ private:
     AIQ*            niQ;            // guarded by runMtx
     GraphsWindow    *graphsWindow;  // guarded by runMtx
     GraphFetcher    *graphFetcher;  // guarded by runMtx
+    ProbeActivity   *probeAct;      // guarded by runMtx
+    ShankOverview   *shankOv;       // guarded by runMtx
     IMReader        *imReader;      // guarded by runMtx
     NIReader        *niReader;      // guarded by runMtx
     Gate            *gate;          // guarded by runMtx
@@ -59,11 +63,15 @@ public:
     void grfUpdateRHSFlags();
     void grfUpdateWindowTitles();
 
+// Owned ShankOverview ops
+    void shankOvShow();
+
 // Owned AIStream ops
     quint64 getImScanCount( uint ip ) const;
     quint64 getNiScanCount() const;
     const AIQ* getImQ( uint ip ) const;
     const AIQ* getNiQ() const;
+    ProbeActivity* getProbeAct() const;
 
 // Run control
     bool isRunning() const
@@ -87,10 +95,12 @@ public slots:
     QString dfGetCurNiName() const;
     quint64 dfGetImFileStart( uint ip ) const;
     quint64 dfGetNiFileStart() const;
+    QString dfGetTrigLatency() const;
 
 // Owned gate and trigger ops
     void rgtSetGate( bool hi );
     void rgtSetTrig( bool hi );
+    void rgtSetTrigCt( bool hi, const QString &stream, quint64 ct );
     void rgtSetMetaData( const KeyValMap &kvm );
 
 // Audio ops
@@ -0,0 +1,164 @@
+
+#include "SpikeScanMC.h"
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPIKESCANMC_SSE2
+#include <emmintrin.h>
+#endif
+
+
+/* ---------------------------------------------------------------- */
+/* SpikeScanMC ---------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+SpikeScanMC::SpikeScanMC()
+    :   nchans(0), c0(0), cLim(0), nLanes(0),
+        T(0), inarow(1), nOfM(1)
+{
+}
+
+
+// (chans) must be sorted ascending, as from Subset::rngStr2Vec().
+//
+void SpikeScanMC::init(
+    const QVector<uint> &chans,
+    int                 nchans,
+    int                 T,
+    int                 inarow,
+    int                 nOfM )
+{
+    this->nchans    = nchans;
+    this->T         = T;
+    this->inarow    = qBound( 1, inarow, 32767 );
+    this->nOfM      = qMax( nOfM, 1 );
+
+    if( chans.isEmpty() ) {
+        c0      = 0;
+        cLim    = 0;
+        nLanes  = 0;
+        run.clear();
+        armed.clear();
+        sel.clear();
+        return;
+    }
+
+    c0      = chans.first();
+    cLim    = chans.last() + 1;
+    nLanes  = cLim - c0;
+
+    sel.assign( nLanes, 0 );
+
+    for( int i = 0, n = chans.size(); i < n; ++i )
+        sel[chans[i] - c0] = -1;
+
+    reset();
+}
+
+
+void SpikeScanMC::reset()
+{
+    run.assign( nLanes, 0 );
+    armed.assign( nLanes, 0 );
+}
+
+
+// Per lane, per timepoint (branch-free):
+//
+//   lt    = (x < T)
+//   armed |= !lt & sel
+//   run   = (lt & armed) ? sat(run + 1) : 0
+//
+// A lane newly qualifies when run == inarow. Only then is the
+// coincidence count taken, so N-of-M costs nothing extra on
+// quiet data.
+//
+bool SpikeScanMC::scan( int &edgeRow, const short *data, int ntpts )
+{
+    if( !nLanes )
+        return false;
+
+    short       *R  = &run[0],
+                *A  = &armed[0];
+    const short *S  = &sel[0];
+
+#ifdef SPIKESCANMC_SSE2
+    const __m128i   vT  = _mm_set1_epi16( T ),
+                    v1  = _mm_set1_epi16( 1 ),
+                    vN  = _mm_set1_epi16( inarow );
+    int             nV  = nLanes & ~7;
+#endif
+
+    data += c0;
+
+    for( int it = 0; it < ntpts; ++it, data += nchans ) {
+
+        int newQ    = 0,
+            c       = 0;
+
+#ifdef SPIKESCANMC_SSE2
+        __m128i Q = _mm_setzero_si128();
+
+        for( ; c < nV; c += 8 ) {
+
+            __m128i x   = _mm_loadu_si128( (const __m128i*)&data[c] ),
+                    s   = _mm_loadu_si128( (const __m128i*)&S[c] ),
+                    a   = _mm_loadu_si128( (const __m128i*)&A[c] ),
+                    r   = _mm_loadu_si128( (const __m128i*)&R[c] ),
+                    lt  = _mm_cmplt_epi16( x, vT );
+
+            a = _mm_or_si128( a, _mm_andnot_si128( lt, s ) );
+            r = _mm_and_si128(
+                    _mm_adds_epi16( r, v1 ),
+                    _mm_and_si128( lt, a ) );
+
+            Q = _mm_or_si128( Q, _mm_cmpeq_epi16( r, vN ) );
+
+            _mm_storeu_si128( (__m128i*)&A[c], a );
+            _mm_storeu_si128( (__m128i*)&R[c], r );
+        }
+
+        newQ = _mm_movemask_epi8( Q );
+#endif
+
+        for( ; c < nLanes; ++c ) {
+
+            if( data[c] < T ) {
+
+                if( A[c] ) {
+                    if( R[c] < 32767 )
+                        ++R[c];
+                    newQ |= (R[c] == inarow);
+                }
+            }
+            else {
+                A[c] |= S[c];
+                R[c] = 0;
+            }
+        }
+
+        if( newQ && (nOfM == 1 || countQualified() >= nOfM) ) {
+            edgeRow = it - inarow + 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+int SpikeScanMC::countQualified() const
+{
+    const short *R  = &run[0];
+    int         n   = 0;
+
+    for( int c = 0; c < nLanes; ++c )
+        n += (R[c] >= inarow);
+
+    return n;
+}
+
+
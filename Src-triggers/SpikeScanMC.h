@@ -0,0 +1,71 @@
+#ifndef SPIKESCANMC_H
+#define SPIKESCANMC_H
+
+#include <QVector>
+
+#include <vector>
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Multichannel threshold scanner for the spike trigger.
+//
+// Works on whole blocks of interleaved int16 data (timepoint-major,
+// nchans per timepoint), already filtered. The watched channels are
+// an arbitrary set; they are scanned as the span [c0,cLim) covering
+// the set, eight adjacent channels per SIMD op, with non-members
+// masked off.
+//
+// Per channel, same rule as AIQ::findFltFallingEdge(): the signal
+// must first be seen >= T (armed), then a run of (inarow) samples
+// < T qualifies, the edge being the run's first sample. The trigger
+// fires at the first timepoint where at least (nOfM) channels are
+// qualified at once; the edge reported is that of the channel that
+// completed the count.
+//
+// Run lengths and arming persist across scan() calls, so blocks
+// are never revisited; call reset() whenever the search position
+// jumps (same occasions as resetting the filter).
+//
+class SpikeScanMC
+{
+private:
+    std::vector<short>  run,    // per span lane, saturating
+                        armed,  // 0 or -1
+                        sel;    // -1 if lane in set
+    int                 nchans,
+                        c0,
+                        cLim,
+                        nLanes,
+                        T,
+                        inarow,
+                        nOfM;
+
+public:
+    SpikeScanMC();
+
+    void init(
+        const QVector<uint> &chans,
+        int                 nchans,
+        int                 T,
+        int                 inarow,
+        int                 nOfM );
+
+    void reset();
+
+    int spanC0() const      {return c0;}
+    int spanLim() const     {return cLim;}
+
+    // Scan (ntpts) timepoints at (data). If fired, return true and
+    // set (edgeRow), the edge relative to (data); negative if the
+    // run began in an earlier block.
+    bool scan( int &edgeRow, const short *data, int ntpts );
+
+private:
+    int countQualified() const;
+};
+
+#endif  // SPIKESCANMC_H
+
+
@@ -1,15 +1,21 @@
 
 HEADERS += \
+    $$PWD/SpikeScanMC.h \
     $$PWD/TrigBase.h \
     $$PWD/TrigImmed.h \
+    $$PWD/TrigLatency.h \
+    $$PWD/TrigPool.h \
     $$PWD/TrigSpike.h \
     $$PWD/TrigTCP.h \
     $$PWD/TrigTimed.h \
     $$PWD/TrigTTL.h
 
 SOURCES += \
+    $$PWD/SpikeScanMC.cpp \
     $$PWD/TrigBase.cpp \
     $$PWD/TrigImmed.cpp \
+    $$PWD/TrigLatency.cpp \
+    $$PWD/TrigPool.cpp \
     $$PWD/TrigSpike.cpp \
     $$PWD/TrigTCP.cpp \
     $$PWD/TrigTimed.cpp \
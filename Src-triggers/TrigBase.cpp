@@ -11,6 +11,45 @@
 #include <QThread>
 
 
+#define MAX_EPOCHS  8
+
+/* ---------------------------------------------------------------- */
+/* FileSet, Epoch ------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+bool TrigBase::FileSet::uses( const QFileInfo &fi ) const
+{
+    for( int ip = 0, np = firstCtIm.size(); ip < np; ++ip ) {
+
+        if( dfImAp[ip] && fi == QFileInfo( dfImAp[ip]->binFileName() ) )
+            return true;
+
+        if( dfImLf[ip] && fi == QFileInfo( dfImLf[ip]->binFileName() ) )
+            return true;
+
+        if( dfImSpk[ip] && fi == QFileInfo( dfImSpk[ip]->fileName() ) )
+            return true;
+    }
+
+    if( dfNi && fi == QFileInfo( dfNi->binFileName() ) )
+        return true;
+
+    return false;
+}
+
+
+bool TrigBase::Epoch::isDone() const
+{
+    for( int ip = 0, np = imRemCt.size(); ip < np; ++ip ) {
+
+        if( imRemCt[ip] > 0 )
+            return false;
+    }
+
+    return niRemCt <= 0;
+}
+
+
 /* ---------------------------------------------------------------- */
 /* TrigBase ------------------------------------------------------- */
 /* ---------------------------------------------------------------- */
@@ -20,9 +59,9 @@ TrigBase::TrigBase(
     GraphsWindow        *gw,
     const QVector<AIQ*> &imQ,
     const AIQ           *niQ )
-    :   QObject(0), dfNi(0),
+    :   QObject(0), epochTask(*this),
         ovr(p), startT(-1), gateHiT(-1), gateLoT(-1), trigHiT(-1),
-        firstCtNi(0), iGate(-1), iTrig(-1), gateHi(false),
+        pool(0), iGate(-1), iTrig(-1), gateHi(false),
         pleaseStop(false), p(p), gw(gw), imQ(imQ), niQ(niQ), statusT(-1),
         nImQ(imQ.size())
 {
@@ -33,7 +72,7 @@ bool TrigBase::allFilesClosed() const
 {
     QMutexLocker    ml( &dfMtx );
 
-    return !dfNi && !firstCtIm.size();
+    return !fs.dfNi && !fs.firstCtIm.size() && !epochs.size();
 }
 
 
@@ -41,18 +80,15 @@ bool TrigBase::isInUse( const QFileInfo &fi ) const
 {
     QMutexLocker    ml( &dfMtx );
 
-    for( int ip = 0, np = firstCtIm.size(); ip < np; ++ip ) {
+    if( fs.uses( fi ) )
+        return true;
 
-        if( dfImAp[ip] && fi == QFileInfo( dfImAp[ip]->binFileName() ) )
-            return true;
+    for( int ie = 0, ne = epochs.size(); ie < ne; ++ie ) {
 
-        if( dfImLf[ip] && fi == QFileInfo( dfImLf[ip]->binFileName() ) )
+        if( epochs[ie]->fs.uses( fi ) )
             return true;
     }
 
-    if( dfNi && fi == QFileInfo( dfNi->binFileName() ) )
-        return true;
-
     return false;
 }
 
@@ -63,7 +99,7 @@ QString TrigBase::curNiFilename() const
 {
     QMutexLocker    ml( &dfMtx );
 
-    return (dfNi ? dfNi->binFileName() : QString::null);
+    return (fs.dfNi ? fs.dfNi->binFileName() : QString::null);
 }
 
 
@@ -71,8 +107,8 @@ quint64 TrigBase::curImFileStart( uint ip ) const
 {
     QMutexLocker    ml( &dfMtx );
 
-    if( ip < (uint)firstCtIm.size() )
-        return firstCtIm[ip];
+    if( ip < (uint)fs.firstCtIm.size() )
+        return fs.firstCtIm[ip];
 
     return 0;
 }
@@ -82,7 +118,7 @@ quint64 TrigBase::curNiFileStart() const
 {
     QMutexLocker    ml( &dfMtx );
 
-    return firstCtNi;
+    return fs.firstCtNi;
 }
 
 
@@ -175,21 +211,7 @@ void TrigBase::baseResetGTCounters()
 void TrigBase::endTrig()
 {
     dfMtx.lock();
-        for( int ip = 0, np = firstCtIm.size(); ip < np; ++ip ) {
-
-            if( dfImAp[ip] )
-                dfImAp[ip]->closeAsync( kvmRmt );
-
-            if( dfImLf[ip] )
-                dfImLf[ip]->closeAsync( kvmRmt );
-        }
-        dfImAp.clear();
-        dfImLf.clear();
-        firstCtIm.clear();
-
-        if( dfNi )
-            dfNi = (DataFileNI*)dfNi->closeAsync( kvmRmt );
-        firstCtNi = 0;
+        closeAsync( fs );
     dfMtx.unlock();
 
     trigHiT = -1;
@@ -201,6 +223,101 @@ void TrigBase::endTrig()
 }
 
 
+// Epochs let a trigger whose remaining spans are fully known
+// (e.g. a spike window, a TTL post-margin) hand its files off
+// and go on seeking edges, so triggers can overlap. Each epoch
+// is drained from the queues by epochXfer(), probes on the pool,
+// and closed when complete. The number in flight is capped; if
+// full, callers fall back to writing in their own state machine.
+//
+bool TrigBase::epochCanDetach() const
+{
+    return epochs.size() < MAX_EPOCHS;
+}
+
+
+// Move the current file set to a new epoch that will write
+// (imCts) samples per probe from imFromCt[ip], and (niCts)
+// samples from niFromCt. The current set is left empty, as
+// after endTrig(), so caller may newTrig() at once.
+//
+void TrigBase::epochDetach(
+    const QVector<quint64>  &imFromCt,
+    quint64                 niFromCt,
+    qint64                  imCts,
+    qint64                  niCts )
+{
+    Epoch   *E = new Epoch;
+
+    E->imNextCt.assign( imFromCt.begin(), imFromCt.end() );
+    E->imRemCt.assign( imFromCt.size(), imCts );
+    E->niNextCt = niFromCt;
+    E->niRemCt  = (niQ ? niCts : 0);
+
+    dfMtx.lock();
+        E->fs   = fs;
+        fs      = FileSet();
+        epochs.push_back( E );
+    dfMtx.unlock();
+}
+
+
+// Trigger thread: call every loop, whatever the state.
+// Return true if no errors.
+//
+bool TrigBase::epochXfer()
+{
+    if( !epochs.size() )
+        return true;
+
+    pool->post( &epochTask, imOrder );
+
+    bool    ok = true;
+
+    for( int ie = 0, ne = epochs.size(); ie < ne; ++ie )
+        ok = epochWriteNi( epochs[ie] ) && ok;
+
+    ok = pool->wait() && ok;
+
+    dfMtx.lock();
+        for( int ie = epochs.size() - 1; ie >= 0; --ie ) {
+
+            Epoch   *E = epochs[ie];
+
+            if( E->isDone() ) {
+                closeAsync( E->fs );
+                delete E;
+                epochs.remove( ie );
+            }
+        }
+    dfMtx.unlock();
+
+    return ok;
+}
+
+
+// Edge-seeking triggers call this once per edge found,
+// starting the latency clocks for that edge.
+//
+void TrigBase::latEdge( const AIQ *qA, quint64 edgeCt )
+{
+    double  enqT;
+
+    if( qA->mapCt2EnqT( enqT, edgeCt ) )
+        lat.setEdge( enqT );
+}
+
+
+// Any writer thread: only the first caller for file set (F)
+// records, so the common case costs one atomic op.
+//
+void TrigBase::latWrite( FileSet &F )
+{
+    if( F.wrPend.testAndSetOrdered( 1, 0 ) )
+        lat.stageWrite( F.edgeEnqT );
+}
+
+
 bool TrigBase::newTrig( int &ig, int &it, bool trigLED )
 {
     endTrig();
@@ -213,20 +330,25 @@ bool TrigBase::newTrig( int &ig, int &it, bool trigLED )
         if( nImQ ) {
             for( int ip = 0; ip < nImQ; ++ip ) {
 
-                firstCtIm.push_back( 0 );
+                fs.firstCtIm.push_back( 0 );
+                fs.wrCtIm.push_back( 0 );
 
-                dfImAp.push_back(
+                fs.dfImAp.push_back(
                     p.im.each[ip].apSaveChanCount() ?
                     new DataFileIMAP( ip ) : 0 );
 
-                dfImLf.push_back(
+                fs.dfImLf.push_back(
                     p.im.each[ip].lfSaveChanCount() ?
                     new DataFileIMLF( ip ) : 0 );
+
+                fs.dfImSpk.push_back(
+                    p.sns.spkEvtEnab && fs.dfImAp[ip] ?
+                    new SpikeEvtFile( &spkStats ) : 0 );
             }
         }
         if( niQ ) {
-            firstCtNi   = 0;
-            dfNi        = new DataFileNI();
+            fs.firstCtNi   = 0;
+            fs.dfNi        = new DataFileNI();
         }
     dfMtx.unlock();
 
@@ -234,16 +356,30 @@ bool TrigBase::newTrig( int &ig, int &it, bool trigLED )
 
     for( int ip = 0; ip < nImQ; ++ip ) {
 
-        if( dfImAp[ip] && !openFile( dfImAp[ip], ig, it ) )
+        if( fs.dfImAp[ip] && !openFile( fs.dfImAp[ip], ig, it ) )
             return false;
 
-        if( dfImLf[ip] && !openFile( dfImLf[ip], ig, it ) )
+        if( fs.dfImLf[ip] && !openFile( fs.dfImLf[ip], ig, it ) )
             return false;
+
+        if( fs.dfImSpk[ip] ) {
+
+            if( !fs.dfImSpk[ip]->openForWrite(
+                    p, ip, fs.dfImAp[ip]->binFileName() ) ) {
+
+                return false;
+            }
+
+            fs.dfImSpk[ip]->setMeta( fs.dfImAp[ip] );
+        }
     }
 
-    if( !openFile( dfNi, ig, it ) )
+    if( !openFile( fs.dfNi, ig, it ) )
         return false;
 
+    fs.edgeEnqT = lat.stageOpen();
+    fs.wrPend.storeRelease( fs.edgeEnqT >= 0 );
+
 // Reset state tracking
 
     trigHiT = getTime();
@@ -268,17 +404,17 @@ bool TrigBase::newTrig( int &ig, int &it, bool trigLED )
 
 void TrigBase::setSyncWriteMode()
 {
-    for( int ip = 0, np = firstCtIm.size(); ip < np; ++ip ) {
+    for( int ip = 0, np = fs.firstCtIm.size(); ip < np; ++ip ) {
 
-        if( dfImAp[ip] )
-            dfImAp[ip]->setAsyncWriting( false );
+        if( fs.dfImAp[ip] )
+            fs.dfImAp[ip]->setAsyncWriting( false );
 
-        if( dfImLf[ip] )
-            dfImLf[ip]->setAsyncWriting( false );
+        if( fs.dfImLf[ip] )
+            fs.dfImLf[ip]->setAsyncWriting( false );
     }
 
-    if( dfNi )
-        dfNi->setAsyncWriting( false );
+    if( fs.dfNi )
+        fs.dfNi->setAsyncWriting( false );
 }
 
 
@@ -290,7 +426,7 @@ void TrigBase::setSyncWriteMode()
 //
 void TrigBase::alignX12( quint64 &imCt, quint64 &niCt, bool testFile )
 {
-    if( testFile && !dfImLf.size() )
+    if( testFile && !fs.dfImLf.size() )
         return;
 
     int del = imCt % 12;
@@ -317,9 +453,9 @@ void TrigBase::alignX12( const AIQ *qA, quint64 &cA, quint64 &cB )
 {
 // Nothing to do if no LFP recording
 
-    for( int ip = 0, np = dfImLf.size(); ip < np; ++ip ) {
+    for( int ip = 0, np = fs.dfImLf.size(); ip < np; ++ip ) {
 
-        if( dfImLf[ip] )
+        if( fs.dfImLf[ip] )
             goto align;
     }
 
@@ -341,70 +477,81 @@ bool TrigBase::writeAndInvalVB(
     int                         ip,
     std::vector<AIQ::AIQBlock>  &vB )
 {
+    if( vB.size() )
+        latWrite( fs );
+
     if( dst == DstImec )
-        return writeVBIM( vB, ip );
+        return writeVBIM( fs, vB, ip );
     else
-        return writeVBNI( vB );
+        return writeVBNI( fs, vB );
 }
 
 
-quint64 TrigBase::scanCount( DstStream dst )
+// Imec count is AP samples written for probe (ip), whether
+// or not the AP file gets them (snippet-only mode).
+//
+quint64 TrigBase::scanCount( DstStream dst, int ip )
 {
     QMutexLocker    ml( &dfMtx );
-    DataFile        *df = 0;
 
-    if( dst == DstImec ) {
+    if( dst == DstImec )
+        return (ip < fs.wrCtIm.size() ? fs.wrCtIm[ip] : 0);
 
-        for( int ip = 0, np = firstCtIm.size(); ip < np; ++ip ) {
+    return (fs.dfNi ? fs.dfNi->scanCount() : 0);
+}
 
-            if( (df = dfImAp[ip]) )
-                goto count;
 
-            if( (df = dfImLf[ip]) )
-                goto count;
-        }
+// Create the per-probe task pool for this run. Probes are
+// ordered costliest first (saved bytes/s) for the deal in
+// TrigPool::post(); LF runs at 1/12 the AP rate.
+//
+void TrigBase::poolStart()
+{
+    QVector<QPair<int,int> >    cost;
+
+    for( int ip = 0; ip < nImQ; ++ip ) {
+
+        const CimCfg::AttrEach  &E = p.im.each[ip];
+
+        cost.push_back(
+            QPair<int,int>(
+                -(12 * E.apSaveChanCount() + E.lfSaveChanCount()), ip ) );
     }
-    else
-        df = dfNi;
 
-count:
-    return (df ? df->scanCount() : 0);
+    qStableSort( cost.begin(), cost.end() );
+
+    imOrder.clear();
+
+    for( int i = 0; i < nImQ; ++i )
+        imOrder.push_back( cost[i].second );
+
+    if( pool )
+        delete pool;
+
+    pool = new TrigPool( nImQ );
 }
 
 
 void TrigBase::endRun()
 {
+    if( pool ) {
+        delete pool;
+        pool = 0;
+    }
+
     QMetaObject::invokeMethod(
         gw, "setTriggerLED",
         Qt::QueuedConnection,
         Q_ARG(bool, false) );
 
     dfMtx.lock();
-        for( int ip = 0, np = firstCtIm.size(); ip < np; ++ip ) {
-
-            if( dfImAp[ip] ) {
-                dfImAp[ip]->setRemoteParams( kvmRmt );
-                dfImAp[ip]->closeAndFinalize();
-                delete dfImAp[ip];
-            }
+        closeAndFinalize( fs );
 
-            if( dfImLf[ip] ) {
-                dfImLf[ip]->setRemoteParams( kvmRmt );
-                dfImLf[ip]->closeAndFinalize();
-                delete dfImLf[ip];
-            }
-        }
-        dfImAp.clear();
-        dfImLf.clear();
-        firstCtIm.clear();
-
-        if( dfNi ) {
-            dfNi->setRemoteParams( kvmRmt );
-            dfNi->closeAndFinalize();
-            delete dfNi;
-            dfNi        = 0;
-            firstCtNi   = 0;
+        for( int ie = 0, ne = epochs.size(); ie < ne; ++ie ) {
+            closeAndFinalize( epochs[ie]->fs );
+            delete epochs[ie];
         }
+        epochs.clear();
     dfMtx.unlock();
 }
 
@@ -505,9 +652,9 @@ void TrigBase::statusOnSince( QString &s, double nowT, int ig, int it )
 
 void TrigBase::statusWrPerf( QString &s )
 {
-    int np = firstCtIm.size();
+    int ne = epochs.size();
 
-    if( dfNi || np ) {
+    if( fs.dfNi || fs.firstCtIm.size() || ne ) {
 
         // report worst case values
 
@@ -516,35 +663,25 @@ void TrigBase::statusWrPerf( QString &s )
                 wbps    = 0.0,
                 rbps    = 0.0;
 
-        for( int ip = 0; ip < np; ++ip ) {
+        addWrPerf( fs, imFull, niFull, wbps, rbps );
 
-            if( dfImAp[ip] ) {
-                imFull   = qMax( imFull, dfImAp[ip]->percentFull() );
-                wbps    += dfImAp[ip]->writeSpeedBps();
-                rbps    += dfImAp[ip]->requiredBps();
-            }
-
-            if( dfImLf[ip] ) {
-                imFull  = qMax( imFull, dfImLf[ip]->percentFull() );
-                wbps   += dfImLf[ip]->writeSpeedBps();
-                rbps   += dfImLf[ip]->requiredBps();
-            }
-        }
-
-        if( dfNi ) {
-            niFull  = dfNi->percentFull();
-            wbps   += dfNi->writeSpeedBps();
-            rbps   += dfNi->requiredBps();
-        }
+        for( int ie = 0; ie < ne; ++ie )
+            addWrPerf( epochs[ie]->fs, imFull, niFull, wbps, rbps );
 
         s = QString(" FileQFill%=(%1,%2) MB/s=%3 (%4 req)")
             .arg( imFull, 0, 'f', 1 )
             .arg( niFull, 0, 'f', 1 )
             .arg( wbps/(1024*1024), 0, 'f', 1 )
             .arg( rbps/(1024*1024), 0, 'f', 1 );
+
+        if( ne )
+            s += QString(" Epochs=%1").arg( ne );
     }
     else
         s = QString::null;
+
+    s += spkStats.statusStr();
+    s += lat.statusStr();
 }
 
 
@@ -568,6 +705,180 @@ void TrigBase::yield( double loopT )
 }
 
 
+// All callers must manage dfMtx around this.
+//
+void TrigBase::closeAsync( FileSet &F )
+{
+    for( int ip = 0, np = F.firstCtIm.size(); ip < np; ++ip ) {
+
+        if( F.dfImAp[ip] ) {
+            setSnipTime( F, ip );
+            F.dfImAp[ip]->closeAsync( kvmRmt );
+        }
+
+        if( F.dfImLf[ip] )
+            F.dfImLf[ip]->closeAsync( kvmRmt );
+
+        if( F.dfImSpk[ip] )
+            delete F.dfImSpk[ip];
+    }
+    F.dfImAp.clear();
+    F.dfImLf.clear();
+    F.dfImSpk.clear();
+    F.firstCtIm.clear();
+    F.wrCtIm.clear();
+
+    if( F.dfNi )
+        F.dfNi = (DataFileNI*)F.dfNi->closeAsync( kvmRmt );
+    F.firstCtNi = 0;
+}
+
+
+// All callers must manage dfMtx around this.
+//
+void TrigBase::closeAndFinalize( FileSet &F )
+{
+    for( int ip = 0, np = F.firstCtIm.size(); ip < np; ++ip ) {
+
+        if( F.dfImAp[ip] ) {
+            setSnipTime( F, ip );
+            F.dfImAp[ip]->setRemoteParams( kvmRmt );
+            F.dfImAp[ip]->closeAndFinalize();
+            delete F.dfImAp[ip];
+        }
+
+        if( F.dfImLf[ip] ) {
+            F.dfImLf[ip]->setRemoteParams( kvmRmt );
+            F.dfImLf[ip]->closeAndFinalize();
+            delete F.dfImLf[ip];
+        }
+
+        if( F.dfImSpk[ip] )
+            delete F.dfImSpk[ip];
+    }
+    F.dfImAp.clear();
+    F.dfImLf.clear();
+    F.dfImSpk.clear();
+    F.firstCtIm.clear();
+    F.wrCtIm.clear();
+
+    if( F.dfNi ) {
+        F.dfNi->setRemoteParams( kvmRmt );
+        F.dfNi->closeAndFinalize();
+        delete F.dfNi;
+        F.dfNi      = 0;
+        F.firstCtNi = 0;
+    }
+}
+
+
+// A snippet-only AP file holds no samples, so its fileTimeSecs
+// is zero; snpTimeSecs gives the span the snippets cover.
+//
+void TrigBase::setSnipTime( FileSet &F, int ip ) const
+{
+    if( F.dfImSpk[ip] && F.dfImSpk[ip]->snipOnly() ) {
+
+        F.dfImAp[ip]->setParam(
+            "snpTimeSecs", F.wrCtIm[ip] / p.im.all.srate );
+    }
+}
+
+
+void TrigBase::addWrPerf(
+    const FileSet   &F,
+    double          &imFull,
+    double          &niFull,
+    double          &wbps,
+    double          &rbps ) const
+{
+    for( int ip = 0, np = F.firstCtIm.size(); ip < np; ++ip ) {
+
+        if( F.dfImAp[ip]
+            && !(F.dfImSpk[ip] && F.dfImSpk[ip]->snipOnly()) ) {
+
+            imFull  = qMax( imFull, F.dfImAp[ip]->percentFull() );
+            wbps   += F.dfImAp[ip]->writeSpeedBps();
+            rbps   += F.dfImAp[ip]->requiredBps();
+        }
+
+        if( F.dfImLf[ip] ) {
+            imFull  = qMax( imFull, F.dfImLf[ip]->percentFull() );
+            wbps   += F.dfImLf[ip]->writeSpeedBps();
+            rbps   += F.dfImLf[ip]->requiredBps();
+        }
+    }
+
+    if( F.dfNi ) {
+        niFull  = qMax( niFull, F.dfNi->percentFull() );
+        wbps   += F.dfNi->writeSpeedBps();
+        rbps   += F.dfNi->requiredBps();
+    }
+}
+
+
+// Pool thread: write what is available of each epoch's
+// remaining span for probe (ip). Epochs touch disjoint
+// per-probe elements, so probes run concurrently.
+//
+bool TrigBase::epochWriteIm( int ip )
+{
+    AIQ *aiQ = imQ[ip];
+
+    for( int ie = 0, ne = epochs.size(); ie < ne; ++ie ) {
+
+        Epoch   *E = epochs.at( ie );
+
+        if( E->imRemCt[ip] <= 0 )
+            continue;
+
+        std::vector<AIQ::AIQBlock>  vB;
+        int                         nb;
+
+        nb = aiQ->getNScansFromCt( vB, E->imNextCt[ip], E->imRemCt[ip] );
+
+        if( !nb )
+            continue;
+
+        quint64 headCt = vB[0].headCt;
+
+        E->imNextCt[ip]  = aiQ->nextCt( vB );
+        E->imRemCt[ip]  -= E->imNextCt[ip] - headCt;
+
+        latWrite( E->fs );
+
+        if( !writeVBIM( E->fs, vB, ip ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+bool TrigBase::epochWriteNi( Epoch *E )
+{
+    if( E->niRemCt <= 0 )
+        return true;
+
+    std::vector<AIQ::AIQBlock>  vB;
+    int                         nb;
+
+    nb = niQ->getNScansFromCt( vB, E->niNextCt, E->niRemCt );
+
+    if( !nb )
+        return true;
+
+    quint64 headCt = vB[0].headCt;
+
+    E->niNextCt  = niQ->nextCt( vB );
+    E->niRemCt  -= E->niNextCt - headCt;
+
+    latWrite( E->fs );
+
+    return writeVBNI( E->fs, vB );
+}
+
+
 bool TrigBase::openFile( DataFile *df, int ig, int it )
 {
     if( !df )
@@ -601,38 +912,53 @@ bool TrigBase::openFile( DataFile *df, int ig, int it )
 // Here, all AP data are written, but only LF samples
 // on X12-boundary (sample%12==0) are written.
 //
-bool TrigBase::writeVBIM( std::vector<AIQ::AIQBlock> &vB, int ip )
+bool TrigBase::writeVBIM(
+    FileSet                     &F,
+    std::vector<AIQ::AIQBlock>  &vB,
+    int                         ip )
 {
-    int     np      = firstCtIm.size();
-    bool    isAP    = (ip < np && dfImAp[ip]),
-            isLF    = (ip < np && dfImLf[ip]);
+    int     np      = F.firstCtIm.size();
+    bool    isAP    = (ip < np && F.dfImAp[ip]),
+            isLF    = (ip < np && F.dfImLf[ip]),
+            isSpk   = (ip < np && F.dfImSpk[ip]),
+            wrAP    = isAP && !(isSpk && F.dfImSpk[ip]->snipOnly());
 
     if( !(isAP || isLF) )
         return true;
 
     int nb = (int)vB.size();
 
-    if( nb && !firstCtIm[ip] ) {
+    if( nb && !F.firstCtIm[ip] ) {
 
-        firstCtIm[ip] = vB[0].headCt;
+        F.firstCtIm[ip] = vB[0].headCt;
 
         if( isAP )
-            dfImAp[ip]->setFirstSample( firstCtIm[ip] );
+            F.dfImAp[ip]->setFirstSample( F.firstCtIm[ip] );
 
         if( isLF )
-            dfImLf[ip]->setFirstSample( firstCtIm[ip] / 12 );
+            F.dfImLf[ip]->setFirstSample( F.firstCtIm[ip] / 12 );
     }
 
+    int nCh = p.im.each[ip].imCumTypCnt[CimCfg::imSumAll];
+
     for( int i = 0; i < nb; ++i ) {
 
+        F.wrCtIm[ip] += vB[i].data.size() / nCh;
+
+        // Spike events see the whole block before
+        // any subset write invalidates it.
+
+        if( isSpk && !F.dfImSpk[ip]->write( vB[i].data, vB[i].headCt ) )
+            return false;
+
         if( !isLF ) {
 
             // Just save (AP+SY)
 
-            if( !dfImAp[ip]->writeAndInvalSubset( p, vB[i].data ) )
+            if( wrAP && !F.dfImAp[ip]->writeAndInvalSubset( p, vB[i].data ) )
                 return false;
         }
-        else if( !isAP ) {
+        else if( !wrAP ) {
 
             // Just save (LF+SY)
             // Downsample X12 in place
@@ -640,7 +966,6 @@ bool TrigBase::writeVBIM( std::vector<AIQ::AIQBlock> &vB, int ip )
 writeLF:
             vec_i16 &data   = vB[i].data;
             int     R       = vB[i].headCt % 12,
-                    nCh     = p.im.each[ip].imCumTypCnt[CimCfg::imSumAll],
                     nTp     = (int)data.size() / nCh;
             qint16  *D, *S;
 
@@ -662,7 +987,7 @@ writeLF:
 
             data.resize( D - &data[0] );
 
-            if( data.size() && !dfImLf[ip]->writeAndInvalSubset( p, data ) )
+            if( data.size() && !F.dfImLf[ip]->writeAndInvalSubset( p, data ) )
                 return false;
         }
         else {
@@ -673,7 +998,7 @@ writeLF:
 
             vec_i16 cpy = vB[i].data;
 
-            if( !dfImAp[ip]->writeAndInvalSubset( p, cpy ) )
+            if( !F.dfImAp[ip]->writeAndInvalSubset( p, cpy ) )
                 return false;
 
             goto writeLF;
@@ -684,21 +1009,21 @@ writeLF:
 }
 
 
-bool TrigBase::writeVBNI( std::vector<AIQ::AIQBlock> &vB )
+bool TrigBase::writeVBNI( FileSet &F, std::vector<AIQ::AIQBlock> &vB )
 {
-    if( !dfNi )
+    if( !F.dfNi )
         return true;
 
     int nb = (int)vB.size();
 
-    if( nb && !firstCtNi ) {
-        firstCtNi = vB[0].headCt;
-        dfNi->setFirstSample( firstCtNi );
+    if( nb && !F.firstCtNi ) {
+        F.firstCtNi = vB[0].headCt;
+        F.dfNi->setFirstSample( F.firstCtNi );
     }
 
     for( int i = 0; i < nb; ++i ) {
 
-        if( !dfNi->writeAndInvalSubset( p, vB[i].data ) )
+        if( !F.dfNi->writeAndInvalSubset( p, vB[i].data ) )
             return false;
     }
 
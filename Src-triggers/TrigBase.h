@@ -2,9 +2,14 @@
 #define TRIGBASE_H
 
 #include "AIQ.h"
+#include "TrigLatency.h"
+#include "TrigPool.h"
 #include "DataFileIMAP.h"
 #include "DataFileIMLF.h"
 #include "DataFileNI.h"
+#include "SpikeEvtFile.h"
+
+#include <QAtomicInt>
 
 namespace DAQ {
 struct Params;
@@ -18,7 +23,7 @@ class QFileInfo;
 /* Types ---------------------------------------------------------- */
 /* ---------------------------------------------------------------- */
 
-class TrigBase : public QObject
+class TrigBase : public QObject, public TrigPoolTask
 {
     Q_OBJECT
 
@@ -37,20 +42,62 @@ private:
         void get( int &g, int &t )  {g=usrG,  t=usrT-1, reset();}
     };
 
+    // One trigger's files, and for latency, its edge's enqT
+    // with wrPend set until the set's first block is written.
+    struct FileSet {
+        QVector<DataFileIMAP*>  dfImAp;
+        QVector<DataFileIMLF*>  dfImLf;
+        QVector<SpikeEvtFile*>  dfImSpk;
+        DataFileNI              *dfNi;
+        QVector<quint64>        firstCtIm,
+                                wrCtIm;     // AP samples written
+        quint64                 firstCtNi;
+        double                  edgeEnqT;
+        QAtomicInt              wrPend;
+
+        FileSet()
+        :   dfNi(0), firstCtNi(0), edgeEnqT(-1), wrPend(0)  {}
+        bool uses( const QFileInfo &fi ) const;
+    };
+
+    // A trigger detached from the state machine: its files, and
+    // per stream, the next count and count still to write.
+    struct Epoch {
+        FileSet                 fs;
+        std::vector<quint64>    imNextCt;
+        std::vector<qint64>     imRemCt;
+        quint64                 niNextCt;
+        qint64                  niRemCt;
+
+        bool isDone() const;
+    };
+
+    // Runs epochWriteIm() on the pool.
+    class EpochTask : public TrigPoolTask
+    {
+    private:
+        TrigBase    &T;
+    public:
+        EpochTask( TrigBase &T ) : T(T)     {}
+        virtual bool poolTask( int ip )     {return T.epochWriteIm( ip );}
+    };
+
 private:
-    QVector<DataFileIMAP*>  dfImAp;
-    QVector<DataFileIMLF*>  dfImLf;
-    DataFileNI              *dfNi;
+    FileSet                 fs;
+    QVector<Epoch*>         epochs;
+    EpochTask               epochTask;
     ManOvr                  ovr;
     mutable QMutex          dfMtx;
     mutable QMutex          startTMtx;
     KeyValMap               kvmRmt;
+    TrigLatency             lat;
+    SpikeEvtStats           spkStats;
     double                  startT,
                             gateHiT,
                             gateLoT,
                             trigHiT;
-    QVector<quint64>        firstCtIm;
-    quint64                 firstCtNi;
+    QVector<int>            imOrder;
+    TrigPool                *pool;
     int                     iGate,
                             iTrig,
                             loopPeriod_us;
@@ -78,7 +125,7 @@ public:
         GraphsWindow        *gw,
         const QVector<AIQ*> &imQ,
         const AIQ           *niQ );
-    virtual ~TrigBase() {}
+    virtual ~TrigBase()     {if( pool ) delete pool;}
 
     bool allFilesClosed() const;
     bool isInUse( const QFileInfo &fi ) const;
@@ -87,6 +134,7 @@ public:
     QString curNiFilename() const;
     quint64 curImFileStart( uint ip ) const;
     quint64 curNiFileStart() const;
+    QString latencyStr() const  {return lat.remoteStr();}
 
     void setStartT();
     void setGateEnabled( bool enabled );
@@ -128,6 +176,14 @@ protected:
         }
 
     void endTrig();
+    bool epochCanDetach() const;
+    void epochDetach(
+        const QVector<quint64>  &imFromCt,
+        quint64                 niFromCt,
+        qint64                  imCts,
+        qint64                  niCts );
+    bool epochXfer();
+    void latEdge( const AIQ *qA, quint64 edgeCt );
     bool newTrig( int &ig, int &it, bool trigLED = true );
     void setSyncWriteMode();
     void alignX12( quint64 &imCt, quint64 &niCt, bool testFile = true );
@@ -136,7 +192,10 @@ protected:
         DstStream                   dst,
         int                         ip,
         std::vector<AIQ::AIQBlock>  &vB );
-    quint64 scanCount( DstStream dst );
+    quint64 scanCount( DstStream dst, int ip = 0 );
+    void poolStart();
+    void poolPost()         {pool->post( this, imOrder );}
+    bool poolWait()         {return pool->wait();}
     void endRun();
     void statusOnSince( QString &s, double nowT, int ig, int it );
     void statusWrPerf( QString &s );
@@ -144,9 +203,21 @@ protected:
     void yield( double loopT );
 
 private:
+    void closeAsync( FileSet &F );
+    void closeAndFinalize( FileSet &F );
+    void setSnipTime( FileSet &F, int ip ) const;
+    void addWrPerf(
+        const FileSet   &F,
+        double          &imFull,
+        double          &niFull,
+        double          &wbps,
+        double          &rbps ) const;
+    bool epochWriteIm( int ip );
+    bool epochWriteNi( Epoch *E );
+    void latWrite( FileSet &F );
     bool openFile( DataFile *df, int ig, int it );
-    bool writeVBIM( std::vector<AIQ::AIQBlock> &vB, int ip );
-    bool writeVBNI( std::vector<AIQ::AIQBlock> &vB );
+    bool writeVBIM( FileSet &F, std::vector<AIQ::AIQBlock> &vB, int ip );
+    bool writeVBNI( FileSet &F, std::vector<AIQ::AIQBlock> &vB );
 };
 
 
@@ -3,88 +3,10 @@
 #include "Util.h"
 #include "DataFile.h"
 
-#include <QThread>
-
 
 #define LOOP_MS     100
 
 
-static TrigImmed    *ME;
-
-
-/* ---------------------------------------------------------------- */
-/* TrImmWorker ---------------------------------------------------- */
-/* ---------------------------------------------------------------- */
-
-void TrImmWorker::run()
-{
-    const int   nID = vID.size();
-    bool        ok  = true;
-
-    for(;;) {
-
-        if( !shr.wake( ok ) )
-            break;
-
-        for( int iID = 0; iID < nID; ++iID ) {
-
-            if( !(ok = writeSomeIM( vID[iID] )) )
-                break;
-        }
-    }
-
-    emit finished();
-}
-
-
-bool TrImmWorker::writeSomeIM( int ip )
-{
-    std::vector<AIQ::AIQBlock>  vB;
-    int                         nb;
-
-    nb = imQ[ip]->getAllScansFromCt( vB, shr.imNextCt[ip] );
-
-    if( !nb )
-        return true;
-
-    shr.imNextCt[ip] = imQ[ip]->nextCt( vB );
-
-    return ME->writeAndInvalVB( ME->DstImec, ip, vB );
-}
-
-/* ---------------------------------------------------------------- */
-/* TrImmThread ---------------------------------------------------- */
-/* ---------------------------------------------------------------- */
-
-TrImmThread::TrImmThread(
-    TrImmShared         &shr,
-    const QVector<AIQ*> &imQ,
-    QVector<int>        &vID )
-{
-    thread  = new QThread;
-    worker  = new TrImmWorker( shr, imQ, vID );
-
-    worker->moveToThread( thread );
-
-    Connect( thread, SIGNAL(started()), worker, SLOT(run()) );
-    Connect( worker, SIGNAL(finished()), worker, SLOT(deleteLater()) );
-    Connect( worker, SIGNAL(destroyed()), thread, SLOT(quit()), Qt::DirectConnection );
-
-    thread->start();
-}
-
-
-TrImmThread::~TrImmThread()
-{
-// worker object auto-deleted asynchronously
-// thread object manually deleted synchronously (so we can call wait())
-
-    if( thread->isRunning() )
-        thread->wait();
-
-    delete thread;
-}
-
 /* ---------------------------------------------------------------- */
 /* TrigImmed ------------------------------------------------------ */
 /* ---------------------------------------------------------------- */
@@ -105,6 +27,15 @@ void TrigImmed::resetGTCounters()
 }
 
 
+// Pool task: per-probe work for xferAll().
+// Return true if no errors.
+//
+bool TrigImmed::poolTask( int ip )
+{
+    return writeSomeIM( ip );
+}
+
+
 // Immediate mode triggering simply follows the gate. When the
 // gate is high we are saving; when the gate is low we aren't.
 //
@@ -116,44 +47,11 @@ void TrigImmed::run()
 // Configure
 // ---------
 
-    ME = this;
-
     quint64 niNextCt = 0;
 
-// Create worker threads
-
-    const int               nPrbPerThd = 2;
-
-    QVector<TrImmThread*>   trT;
-    TrImmShared             shr( p );
+// Per-probe task pool
 
-    nThd = 0;
-
-    for( int ip0 = 0; ip0 < nImQ; ip0 += nPrbPerThd ) {
-
-        QVector<int>    vID;
-
-        for( int id = 0; id < nPrbPerThd; ++id ) {
-
-            if( ip0 + id < nImQ )
-                vID.push_back( ip0 + id );
-            else
-                break;
-        }
-
-        trT.push_back( new TrImmThread( shr, imQ, vID ) );
-        ++nThd;
-    }
-
-// Wait for threads to reach ready (sleep) state
-
-    shr.runMtx.lock();
-        while( shr.asleep < nThd ) {
-            shr.runMtx.unlock();
-                usleep( 10 );
-            shr.runMtx.lock();
-        }
-    shr.runMtx.unlock();
+    poolStart();
 
 // -----
 // Start
@@ -175,7 +73,7 @@ void TrigImmed::run()
             goto next_loop;
         }
 
-        if( !allWriteSome( shr, niNextCt ) )
+        if( !allWriteSome( niNextCt ) )
             break;
 
         // ------
@@ -204,13 +102,6 @@ next_loop:
         yield( loopT );
     }
 
-// Kill all threads
-
-    shr.kill();
-
-    for( int iThd = 0; iThd < nThd; ++iThd )
-        delete trT[iThd];
-
 // Done
 
     endRun();
@@ -260,6 +151,24 @@ bool TrigImmed::alignFiles(
 }
 
 
+// Return true if no errors.
+//
+bool TrigImmed::writeSomeIM( int ip )
+{
+    std::vector<AIQ::AIQBlock>  vB;
+    int                         nb;
+
+    nb = imQ[ip]->getAllScansFromCt( vB, imNextCt[ip] );
+
+    if( !nb )
+        return true;
+
+    imNextCt[ip] = imQ[ip]->nextCt( vB );
+
+    return writeAndInvalVB( DstImec, ip, vB );
+}
+
+
 // Return true if no errors.
 //
 bool TrigImmed::writeSomeNI( quint64 &nextCt )
@@ -283,41 +192,27 @@ bool TrigImmed::writeSomeNI( quint64 &nextCt )
 
 // Return true if no errors.
 //
-bool TrigImmed::xferAll( TrImmShared &shr, quint64 &niNextCt )
+bool TrigImmed::xferAll( quint64 &niNextCt )
 {
     int niOK;
 
-    shr.awake   = 0;
-    shr.asleep  = 0;
-    shr.errors  = 0;
-
-// Wake all imec threads
+// Post imec tasks to pool
 
-    shr.condWake.wakeAll();
+    poolPost();
 
 // Do nidq locally
 
     niOK = writeSomeNI( niNextCt );
 
-// Wait all threads started, and all done
-
-    shr.runMtx.lock();
-        while( shr.awake  < nThd
-            || shr.asleep < nThd ) {
-
-            shr.runMtx.unlock();
-                msleep( LOOP_MS/8 );
-            shr.runMtx.lock();
-        }
-    shr.runMtx.unlock();
+// Help with, then wait for, imec tasks
 
-    return niOK && !shr.errors;
+    return poolWait() && niOK;
 }
 
 
 // Return true if no errors.
 //
-bool TrigImmed::allWriteSome( TrImmShared &shr, quint64 &niNextCt )
+bool TrigImmed::allWriteSome( quint64 &niNextCt )
 {
 // -------------------
 // Open files together
@@ -328,7 +223,7 @@ bool TrigImmed::allWriteSome( TrImmShared &shr, quint64 &niNextCt )
         int ig, it;
 
         // reset tracking
-        shr.imNextCt.clear();
+        imNextCt.clear();
         niNextCt = 0;
 
         if( !newTrig( ig, it ) )
@@ -339,14 +234,14 @@ bool TrigImmed::allWriteSome( TrImmShared &shr, quint64 &niNextCt )
 // Seek common sync time
 // ---------------------
 
-    if( !alignFiles( shr.imNextCt, niNextCt ) )
+    if( !alignFiles( imNextCt, niNextCt ) )
         return true;    // too early
 
 // ----------------------
 // Fetch from all streams
 // ----------------------
 
-    return xferAll( shr, niNextCt );
+    return xferAll( niNextCt );
 }
 
 
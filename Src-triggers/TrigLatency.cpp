@@ -0,0 +1,173 @@
+
+#include "TrigLatency.h"
+#include "Util.h"
+
+#include <math.h>
+
+
+#define LAT_T0      1e-5
+
+
+/* ---------------------------------------------------------------- */
+/* TrigLatency::Hist ---------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+void TrigLatency::Hist::reset()
+{
+    memset( bin, 0, sizeof(bin) );
+    n   = 0;
+    max = 0;
+}
+
+
+void TrigLatency::Hist::add( double secs )
+{
+    int k = 0;
+
+    if( secs > LAT_T0 )
+        k = qMin( int(10 * log10( secs / LAT_T0 )), nBins - 1 );
+
+    ++bin[k];
+    ++n;
+
+    if( secs > max )
+        max = secs;
+}
+
+
+// Upper edge of bin holding the pct'th percentile,
+// clipped to max.
+//
+double TrigLatency::Hist::pctile( double pct ) const
+{
+    if( !n )
+        return 0;
+
+    quint32 need = quint32(ceil( 0.01 * pct * n )),
+            sum  = 0;
+
+    for( int k = 0; k < nBins - 1; ++k ) {
+
+        if( (sum += bin[k]) >= need )
+            return qMin( LAT_T0 * pow( 10.0, 0.1 * (k + 1) ), max );
+    }
+
+    return max;
+}
+
+/* ---------------------------------------------------------------- */
+/* TrigLatency ---------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+void TrigLatency::reset()
+{
+    QMutexLocker    ml( &mtx );
+
+    for( int is = 0; is < lat_nStages; ++is )
+        H[is].reset();
+
+    edgeEnqT = -1;
+}
+
+
+// Trigger thread: edge found, sample (enqT) was enqueued then.
+// Arms the open stage.
+//
+void TrigLatency::setEdge( double enqT )
+{
+    QMutexLocker    ml( &mtx );
+
+    H[lat_edge].add( getTime() - enqT );
+    edgeEnqT = enqT;
+}
+
+
+// Trigger thread: files opened. Records and disarms the pending
+// edge, returning its enqT for the new file set, or -1 if none.
+//
+double TrigLatency::stageOpen()
+{
+    QMutexLocker    ml( &mtx );
+
+    double  enqT = edgeEnqT;
+
+    if( enqT >= 0 ) {
+        H[lat_open].add( getTime() - enqT );
+        edgeEnqT = -1;
+    }
+
+    return enqT;
+}
+
+
+// Any writer thread: first block of the file set opened for
+// the edge enqueued at (edgeEnqT).
+//
+void TrigLatency::stageWrite( double edgeEnqT )
+{
+    double  t = getTime();
+
+    QMutexLocker    ml( &mtx );
+
+    H[lat_write].add( t - edgeEnqT );
+}
+
+
+// Status bar form, milliseconds, only stages with data:
+// " Lat(ms) edge=p50/p99/max open=... wr=..."
+//
+QString TrigLatency::statusStr() const
+{
+    QMutexLocker    ml( &mtx );
+
+    const char  *name[lat_nStages] = {"edge", "open", "wr"};
+    QString     s;
+
+    for( int is = 0; is < lat_nStages; ++is ) {
+
+        const Hist  &h = H[is];
+
+        if( !h.n )
+            continue;
+
+        s += QString(" %1=%2/%3/%4")
+                .arg( name[is] )
+                .arg( 1000*h.pctile( 50 ), 0, 'f', 1 )
+                .arg( 1000*h.pctile( 99 ), 0, 'f', 1 )
+                .arg( 1000*h.max, 0, 'f', 1 );
+    }
+
+    if( !s.isEmpty() )
+        s = " Lat(ms)" + s;
+
+    return s;
+}
+
+
+// Remote form, one line, per stage in order {edge,open,write}:
+// "count p50 p99 max", times in milliseconds.
+//
+QString TrigLatency::remoteStr() const
+{
+    QMutexLocker    ml( &mtx );
+
+    QString s;
+
+    for( int is = 0; is < lat_nStages; ++is ) {
+
+        const Hist  &h = H[is];
+
+        if( is )
+            s += " ";
+
+        s += QString("%1 %2 %3 %4")
+                .arg( h.n )
+                .arg( 1000*h.pctile( 50 ), 0, 'f', 3 )
+                .arg( 1000*h.pctile( 99 ), 0, 'f', 3 )
+                .arg( 1000*h.max, 0, 'f', 3 );
+    }
+
+    return s + "\n";
+}
+
+
@@ -0,0 +1,72 @@
+#ifndef TRIGLATENCY_H
+#define TRIGLATENCY_H
+
+#include <QMutex>
+#include <QString>
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Per-run trigger latency histograms.
+//
+// Each stage records the seconds from the moment the edge sample
+// was enqueued into its AIQ until:
+// - lat_edge:  the trigger's edge search found it,
+// - lat_open:  newTrig() had the files open,
+// - lat_write: the first block of that edge's own files was written.
+//
+// The edge time passes from setEdge() to the file set opened for
+// it (stageOpen() returns it), and that file set reports its own
+// first write, so a draining epoch can't be credited to a newer
+// edge.
+//
+// Bins are log-spaced, 10 per decade, from 10 us up; percentiles
+// are reported as bin upper bounds, max is exact.
+//
+class TrigLatency
+{
+public:
+    enum Stage {
+        lat_edge    = 0,
+        lat_open    = 1,
+        lat_write   = 2,
+        lat_nStages = 3
+    };
+
+private:
+    enum {
+        nBins   = 71    // 7 decades + overflow
+    };
+
+    struct Hist {
+        quint32 bin[nBins];
+        quint32 n;
+        double  max;
+
+        void reset();
+        void add( double secs );
+        double pctile( double pct ) const;
+    };
+
+private:
+    Hist            H[lat_nStages];
+    mutable QMutex  mtx;
+    double          edgeEnqT;
+
+public:
+    TrigLatency()   {reset();}
+
+    void reset();
+
+    void setEdge( double enqT );
+    double stageOpen();
+    void stageWrite( double edgeEnqT );
+
+    QString statusStr() const;
+    QString remoteStr() const;
+};
+
+#endif  // TRIGLATENCY_H
+
+
@@ -0,0 +1,225 @@
+
+#include "TrigPool.h"
+#include "Util.h"
+
+#include <QThread>
+
+
+/* ---------------------------------------------------------------- */
+/* TrPoolWorker --------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+void TrPoolWorker::run()
+{
+    quint64 seen = 0;
+
+    while( pool.awaitWork( seen ) )
+        pool.doneWork( pool.drain( self ) );
+
+    emit finished();
+}
+
+/* ---------------------------------------------------------------- */
+/* TrPoolThread --------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+TrPoolThread::TrPoolThread( TrigPool &pool, int self )
+{
+    thread  = new QThread;
+    worker  = new TrPoolWorker( pool, self );
+
+    worker->moveToThread( thread );
+
+    Connect( thread, SIGNAL(started()), worker, SLOT(run()) );
+    Connect( worker, SIGNAL(finished()), worker, SLOT(deleteLater()) );
+    Connect( worker, SIGNAL(destroyed()), thread, SLOT(quit()), Qt::DirectConnection );
+
+    thread->start();
+}
+
+
+TrPoolThread::~TrPoolThread()
+{
+// worker object auto-deleted asynchronously
+// thread object manually deleted synchronously (so we can call wait())
+
+    if( thread->isRunning() )
+        thread->wait();
+
+    delete thread;
+}
+
+/* ---------------------------------------------------------------- */
+/* TrigPool::Deque ------------------------------------------------ */
+/* ---------------------------------------------------------------- */
+
+// Owner takes from front.
+//
+bool TrigPool::Deque::pop( int &ip )
+{
+    QMutexLocker    ml( &mtx );
+
+    if( q.empty() )
+        return false;
+
+    ip = q.front();
+    q.pop_front();
+    return true;
+}
+
+
+// Thieves take from back.
+//
+bool TrigPool::Deque::steal( int &ip )
+{
+    QMutexLocker    ml( &mtx );
+
+    if( q.empty() )
+        return false;
+
+    ip = q.back();
+    q.pop_back();
+    return true;
+}
+
+/* ---------------------------------------------------------------- */
+/* TrigPool ------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// One core is left for the posting (trigger) thread, which
+// does nidq and then helps out. At most one worker per task.
+//
+TrigPool::TrigPool( int nTasks )
+    :   task(0), epoch(0), nBusy(0), errors(0), stop(false)
+{
+    int nThd = qMin( nTasks, qMax( QThread::idealThreadCount() - 1, 1 ) );
+
+    for( int i = 0; i < nThd; ++i )
+        dq.push_back( new Deque );
+
+    for( int i = 0; i < nThd; ++i )
+        thd.push_back( new TrPoolThread( *this, i ) );
+}
+
+
+TrigPool::~TrigPool()
+{
+    runMtx.lock();
+        stop = true;
+    runMtx.unlock();
+    condWake.wakeAll();
+
+    for( int i = 0, n = thd.size(); i < n; ++i )
+        delete thd[i];
+
+    for( int i = 0, n = dq.size(); i < n; ++i )
+        delete dq[i];
+}
+
+
+// Deal one task per entry of (order), round-robin, so each
+// deque starts with a share of the costliest. Returns at once;
+// caller must wait() before the next post().
+//
+void TrigPool::post( TrigPoolTask *T, const QVector<int> &order )
+{
+    int nThd = thd.size();
+
+    if( !nThd )
+        return;
+
+    for( int k = 0, n = order.size(); k < n; ++k ) {
+
+        Deque   *D = dq[k % nThd];
+
+        D->mtx.lock();
+        D->q.push_back( order[k] );
+        D->mtx.unlock();
+    }
+
+    runMtx.lock();
+        task    = T;
+        errors  = 0;
+        nBusy   = nThd;
+        ++epoch;
+    runMtx.unlock();
+    condWake.wakeAll();
+}
+
+
+// Steal remaining tasks, then block until all workers idle.
+// Return true if no errors.
+//
+bool TrigPool::wait()
+{
+    if( !thd.size() )
+        return true;
+
+    int nErr = drain( -1 );
+
+    QMutexLocker    ml( &runMtx );
+
+    errors += nErr;
+
+    while( nBusy )
+        condDone.wait( &runMtx );
+
+    return !errors;
+}
+
+/* ---------------------------------------------------------------- */
+/* Private -------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Sleep until next post(). Return false if stopping.
+//
+bool TrigPool::awaitWork( quint64 &seen )
+{
+    QMutexLocker    ml( &runMtx );
+
+    while( !stop && seen == epoch )
+        condWake.wait( &runMtx );
+
+    seen = epoch;
+
+    return !stop;
+}
+
+
+// Run tasks until every deque is empty: own first (self >= 0),
+// then others', starting with the next neighbor.
+// Return error count.
+//
+int TrigPool::drain( int self )
+{
+    int nDq     = dq.size(),
+        nErr    = 0,
+        ip;
+
+    for(;;) {
+
+        bool    got = self >= 0 && dq[self]->pop( ip );
+
+        for( int k = 1; !got && k <= nDq; ++k )
+            got = dq[(self + k + nDq) % nDq]->steal( ip );
+
+        if( !got )
+            break;
+
+        nErr += !task->poolTask( ip );
+    }
+
+    return nErr;
+}
+
+
+void TrigPool::doneWork( int nErr )
+{
+    runMtx.lock();
+        errors += nErr;
+        --nBusy;
+    runMtx.unlock();
+    condDone.wakeAll();
+}
+
+
@@ -0,0 +1,115 @@
+#ifndef TRIGPOOL_H
+#define TRIGPOOL_H
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+
+#include <deque>
+
+class QThread;
+class TrigPool;
+
+/* ---------------------------------------------------------------- */
+/* Types ---------------------------------------------------------- */
+/* ---------------------------------------------------------------- */
+
+// Interface for per-probe work run by a TrigPool.
+// poolTask() is called at most once per probe per post(),
+// concurrently for different probes. Return true if no errors.
+//
+class TrigPoolTask
+{
+public:
+    virtual ~TrigPoolTask() {}
+    virtual bool poolTask( int ip ) = 0;
+};
+
+
+class TrPoolWorker : public QObject
+{
+    Q_OBJECT
+
+private:
+    TrigPool    &pool;
+    int         self;
+
+public:
+    TrPoolWorker( TrigPool &pool, int self )
+    :   pool(pool), self(self)  {}
+    virtual ~TrPoolWorker()     {}
+
+signals:
+    void finished();
+
+public slots:
+    void run();
+};
+
+
+class TrPoolThread
+{
+public:
+    QThread         *thread;
+    TrPoolWorker    *worker;
+
+public:
+    TrPoolThread( TrigPool &pool, int self );
+    virtual ~TrPoolThread();
+};
+
+
+// Run-scoped pool shared by all trigger modes; GraphFetcher
+// keeps its own, one task per stream.
+//
+// Each post() deals one task per probe over the workers' deques,
+// costliest first (caller supplies the order). A worker pops from
+// the front of its own deque; when empty, it steals from the back
+// of others'. The posting thread steals too, once it has done its
+// own (nidq) work and calls wait(). Uneven probes thereby balance
+// automatically, and thread count follows core count rather than
+// probe count.
+//
+class TrigPool
+{
+    friend class TrPoolWorker;
+
+private:
+    struct Deque {
+        QMutex          mtx;
+        std::deque<int> q;
+        bool pop( int &ip );
+        bool steal( int &ip );
+    };
+
+private:
+    QVector<Deque*>         dq;
+    QVector<TrPoolThread*>  thd;
+    TrigPoolTask            *task;
+    QMutex                  runMtx;
+    QWaitCondition          condWake,
+                            condDone;
+    quint64                 epoch;
+    int                     nBusy,
+                            errors;
+    bool                    stop;
+
+public:
+    TrigPool( int nTasks );
+    virtual ~TrigPool();
+
+    int nThreads() const    {return thd.size();}
+
+    void post( TrigPoolTask *T, const QVector<int> &order );
+    bool wait();
+
+private:
+    bool awaitWork( quint64 &seen );
+    int drain( int self );
+    void doneWork( int nErr );
+};
+
+#endif  // TRIGPOOL_H
+
+
@@ -1,113 +1,36 @@
 
 #include "TrigSpike.h"
 #include "Util.h"
-#include "Biquad.h"
+#include "BiquadMC.h"
 #include "MainApp.h"
 #include "Run.h"
 #include "GraphsWindow.h"
+#include "Subset.h"
 
 #include <QTimer>
-#include <QThread>
 
 
 #define LOOP_MS     100
 
 
-static TrigSpike    *ME;
-
-
 /* ---------------------------------------------------------------- */
-/* TrSpkWorker ---------------------------------------------------- */
+/* Statics -------------------------------------------------------- */
 /* ---------------------------------------------------------------- */
 
-void TrSpkWorker::run()
-{
-    const int   nID = vID.size();
-    bool        ok  = true;
-
-    for(;;) {
-
-        if( !shr.wake( ok ) )
-            break;
-
-        for( int iID = 0; iID < nID; ++iID ) {
-
-            if( !(ok = writeSomeIM( vID[iID] )) )
-                break;
-        }
-    }
-
-    emit finished();
-}
-
-
-bool TrSpkWorker::writeSomeIM( int ip )
+// Watched channels, ascending: the multichannel set if
+// given, else just aiChan.
+//
+static void spikeChans( QVector<uint> &vc, const DAQ::Params &p )
 {
-    TrigSpike::CountsIm         &C = ME->imCnt;
-    std::vector<AIQ::AIQBlock>  vB;
-    int                         nb;
+    if( !p.trgSpike.isMultiChan()
+        || !Subset::rngStr2Vec( vc, p.trgSpike.chanStr )
+        || vc.isEmpty() ) {
 
-// ---------------------------------------
-// Fetch immediately (don't miss old data)
-// ---------------------------------------
-
-    if( C.remCt[ip] == -1 ) {
-        C.nextCt[ip]  = C.edgeCt[ip] - C.periEvtCt;
-        C.remCt[ip]   = 2 * C.periEvtCt + 1;
+        vc.fill( p.trgSpike.aiChan, 1 );
     }
-
-    nb = imQ[ip]->getNScansFromCt( vB, C.nextCt[ip], C.remCt[ip] );
-
-// ---------------
-// Update tracking
-// ---------------
-
-    if( !nb )
-        return true;
-
-    C.nextCt[ip] = imQ[ip]->nextCt( vB );
-    C.remCt[ip] -= C.nextCt[ip] - vB[0].headCt;
-
-// -----
-// Write
-// -----
-
-    return ME->writeAndInvalVB( ME->DstImec, ip, vB );
-}
-
-/* ---------------------------------------------------------------- */
-/* TrSpkThread ---------------------------------------------------- */
-/* ---------------------------------------------------------------- */
-
-TrSpkThread::TrSpkThread(
-    TrSpkShared         &shr,
-    const QVector<AIQ*> &imQ,
-    QVector<int>        &vID )
-{
-    thread  = new QThread;
-    worker  = new TrSpkWorker( shr, imQ, vID );
-
-    worker->moveToThread( thread );
-
-    Connect( thread, SIGNAL(started()), worker, SLOT(run()) );
-    Connect( worker, SIGNAL(finished()), worker, SLOT(deleteLater()) );
-    Connect( worker, SIGNAL(destroyed()), thread, SLOT(quit()), Qt::DirectConnection );
-
-    thread->start();
 }
 
 
-TrSpkThread::~TrSpkThread()
-{
-// worker object auto-deleted asynchronously
-// thread object manually deleted synchronously (so we can call wait())
-
-    if( thread->isRunning() )
-        thread->wait();
-
-    delete thread;
-}
-
 /* ---------------------------------------------------------------- */
 /* struct HiPassFnctr --------------------------------------------- */
 /* ---------------------------------------------------------------- */
@@ -119,17 +42,35 @@ TrSpkThread::~TrSpkThread()
 // position 'edgeCt'. Every time we modify edgeCt we will tell the
 // filter to reset its 'zero' counter to BIQUAD_TRANS_WIDE. We'll
 // have the filter zero that many leading data points.
+//
+// With a multichannel set, the whole span [c0,cLim) covering the
+// set is filtered in one pass (clipped to the filterable types).
+//
+// Single channel: an instance is instead handed to the AIQ as a
+// derived-channel filter. It then runs once per sample as data
+// arrive, so it never jumps and zeros only at run start.
 
 TrigSpike::HiPassFnctr::HiPassFnctr( const DAQ::Params &p )
-    :   flt(0), nchans(0), ichan(p.trgSpike.aiChan)
+    :   flt(0), nchans(0), c0(0), cLim(0)
 {
+    QVector<uint>   vc;
+
+    spikeChans( vc, p );
+
+    int ichan   = vc.first(),
+        lim     = vc.last() + 1;
+
     if( p.trgSpike.stream == "nidq" ) {
 
-        if( ichan < p.ni.niCumTypCnt[CniCfg::niSumNeural] ) {
+        int nFlt = p.ni.niCumTypCnt[CniCfg::niSumNeural];
 
-            flt     = new Biquad( bq_type_highpass, 300/p.ni.srate );
+        if( ichan < nFlt ) {
+
+            flt     = new BiquadMC( bq_type_highpass, 300/p.ni.srate );
             nchans  = p.ni.niCumTypCnt[CniCfg::niSumAll];
             maxInt  = 32768;
+            c0      = ichan;
+            cLim    = qMin( lim, nFlt );
         }
     }
     else {
@@ -140,11 +81,15 @@ TrigSpike::HiPassFnctr::HiPassFnctr( const DAQ::Params &p )
         const CimCfg::AttrEach  &E =
                 p.im.each[p.streamID( p.trgSpike.stream )];
 
-        if( ichan < E.imCumTypCnt[CimCfg::imSumAP] ) {
+        int nFlt = E.imCumTypCnt[CimCfg::imSumAP];
+
+        if( ichan < nFlt ) {
 
-            flt     = new Biquad( bq_type_highpass, 300/p.im.all.srate );
+            flt     = new BiquadMC( bq_type_highpass, 300/p.im.all.srate );
             nchans  = E.imCumTypCnt[CimCfg::imSumAll];
             maxInt  = 512;
+            c0      = ichan;
+            cLim    = qMin( lim, nFlt );
         }
     }
 
@@ -171,7 +116,8 @@ void TrigSpike::HiPassFnctr::operator()( vec_i16 &data )
 
         int ntpts = (int)data.size() / nchans;
 
-        flt->apply1BlockwiseMem1( &data[0], maxInt, ntpts, nchans, ichan );
+        flt->applyBlockwiseMem(
+            &data[0], maxInt, ntpts, nchans, c0, cLim );
 
         if( nzero > 0 ) {
 
@@ -180,17 +126,42 @@ void TrigSpike::HiPassFnctr::operator()( vec_i16 &data )
             if( ntpts > nzero )
                 ntpts = nzero;
 
-            short   *d      = &data[ichan],
-                    *dlim   = &data[ichan + ntpts*nchans];
+            short   *d      = &data[c0],
+                    *dlim   = &data[c0 + ntpts*nchans];
+            int     nC      = cLim - c0;
+
+            for( ; d < dlim; d += nchans ) {
 
-            for( ; d < dlim; d += nchans )
-                *d = 0;
+                for( int ic = 0; ic < nC; ++ic )
+                    d[ic] = 0;
+            }
 
             nzero -= ntpts;
         }
     }
 }
 
+
+// Derived-channel (mono) form: (data) holds only chan c0.
+//
+void TrigSpike::HiPassFnctr::operator()( qint16 *data, int n )
+{
+    if( flt ) {
+
+        flt->applyBlockwiseMem( data, maxInt, n, 1, 0, 1 );
+
+        if( nzero > 0 ) {
+
+            if( n > nzero )
+                n = nzero;
+
+            memset( data, 0, n * sizeof(qint16) );
+
+            nzero -= n;
+        }
+    }
+}
+
 /* ---------------------------------------------------------------- */
 /* TrigSpike ------------------------------------------------------ */
 /* ---------------------------------------------------------------- */
@@ -202,6 +173,7 @@ TrigSpike::TrigSpike(
     const AIQ           *niQ )
     :   TrigBase( p, gw, imQ, niQ ),
         usrFlt(new HiPassFnctr( p )),
+        mcScan(0),
         imCnt( p, p.im.all.srate ),
         niCnt( p, p.ni.srate ),
         nCycMax(
@@ -215,6 +187,60 @@ TrigSpike::TrigSpike(
             : p.im.vToInt10( p.trgSpike.T, p.streamID( p.trgSpike.stream ),
                 p.trgSpike.aiChan ))
 {
+    if( p.trgSpike.isMultiChan() ) {
+
+        QVector<uint>   vc;
+        int             nC;
+
+        spikeChans( vc, p );
+
+        if( p.trgSpike.stream == "nidq" )
+            nC = p.ni.niCumTypCnt[CniCfg::niSumAll];
+        else {
+            nC = p.im.each[p.streamID( p.trgSpike.stream )]
+                    .imCumTypCnt[CimCfg::imSumAll];
+        }
+
+        mcScan = new SpikeScanMC;
+        mcScan->init( vc, nC, thresh, p.trgSpike.inarow, p.trgSpike.nOfM );
+    }
+}
+
+
+TrigSpike::~TrigSpike()
+{
+    if( mcScan )
+        delete mcScan;
+
+    delete usrFlt;
+}
+
+
+// Register trigger channel as derived channel of its AIQ,
+// which then owns the filter. Call before acquisition starts.
+// Multichannel sets are scanned from whole blocks instead.
+//
+void TrigSpike::addDerivedChan(
+    const DAQ::Params   &p,
+    const QVector<AIQ*> &imQ,
+    AIQ                 *niQ )
+{
+    if( p.trgSpike.isMultiChan() )
+        return;
+
+    AIQ *aQ;
+
+    if( p.trgSpike.stream == "nidq" )
+        aQ = niQ;
+    else {
+
+        int ip = p.streamID( p.trgSpike.stream );
+
+        aQ = (ip >= 0 && ip < imQ.size() ? imQ[ip] : 0);
+    }
+
+    if( aQ )
+        aQ->addDerivedChan( p.trgSpike.aiChan, new HiPassFnctr( p ) );
 }
 
 
@@ -236,6 +262,15 @@ void TrigSpike::resetGTCounters()
 }
 
 
+// Pool task: per-probe work for xferAll().
+// Return true if no errors.
+//
+bool TrigSpike::poolTask( int ip )
+{
+    return writeSomeIM( ip );
+}
+
+
 #define SETSTATE_GetEdge    (state = 0)
 
 #define ISSTATE_GetEdge     (state == 0)
@@ -255,42 +290,9 @@ void TrigSpike::run()
 // Configure
 // ---------
 
-    ME = this;
-
-// Create worker threads
-
-    const int               nPrbPerThd = 2;
-
-    QVector<TrSpkThread*>   trT;
-    TrSpkShared             shr( p );
-
-    nThd = 0;
-
-    for( int ip0 = 0; ip0 < nImQ; ip0 += nPrbPerThd ) {
+// Per-probe task pool
 
-        QVector<int>    vID;
-
-        for( int id = 0; id < nPrbPerThd; ++id ) {
-
-            if( ip0 + id < nImQ )
-                vID.push_back( ip0 + id );
-            else
-                break;
-        }
-
-        trT.push_back( new TrSpkThread( shr, imQ, vID ) );
-        ++nThd;
-    }
-
-// Wait for threads to reach ready (sleep) state
-
-    shr.runMtx.lock();
-        while( shr.asleep < nThd ) {
-            shr.runMtx.unlock();
-                usleep( 10 );
-            shr.runMtx.lock();
-        }
-    shr.runMtx.unlock();
+    poolStart();
 
 // -----
 // Start
@@ -305,6 +307,13 @@ void TrigSpike::run()
         double  loopT = getTime();
         bool    inactive;
 
+        // ------------
+        // Drain epochs
+        // ------------
+
+        if( !epochXfer() )
+            goto endrun;
+
         // -------
         // Active?
         // -------
@@ -323,7 +332,7 @@ void TrigSpike::run()
 
         if( !imCnt.edgeCt.size() || !niCnt.edgeCt ) {
 
-            usrFlt->reset();
+            resetSearch();
 
             double  gateT = getGateHiT();
 
@@ -383,7 +392,26 @@ void TrigSpike::run()
                 setSyncWriteMode();
             }
 
-            SETSTATE_Write();
+            // The whole window is known now: if there's room,
+            // hand it to an epoch and seek the next edge at once.
+
+            if( epochCanDetach() ) {
+
+                QVector<quint64>    imFromCt( nImQ );
+
+                for( int ip = 0; ip < nImQ; ++ip )
+                    imFromCt[ip] = imCnt.edgeCt[ip] - imCnt.periEvtCt;
+
+                epochDetach(
+                    imFromCt,
+                    niCnt.edgeCt - niCnt.periEvtCt,
+                    2 * imCnt.periEvtCt + 1,
+                    2 * niCnt.periEvtCt + 1 );
+
+                doneEdge();
+            }
+            else
+                SETSTATE_Write();
         }
 
         // ----------------
@@ -392,26 +420,15 @@ void TrigSpike::run()
 
         if( ISSTATE_Write ) {
 
-            if( !xferAll( shr ) )
+            if( !xferAll() )
                 goto endrun;
 
             // -----
             // Done?
             // -----
 
-            if( niCnt.remCt <= 0 && imCnt.remCtDone() ) {
-
-                endTrig();
-
-                usrFlt->reset();
-                imCnt.advanceEdgeByRefrac();
-                niCnt.edgeCt += niCnt.refracCt;
-
-                if( ++nS >= nCycMax )
-                    SETSTATE_Done();
-                else
-                    SETSTATE_GetEdge;
-            }
+            if( niCnt.remCt <= 0 && imCnt.remCtDone() )
+                doneEdge();
         }
 
         // ------
@@ -441,13 +458,6 @@ next_loop:
     }
 
 endrun:
-// Kill all threads
-
-    shr.kill();
-
-    for( int iThd = 0; iThd < nThd; ++iThd )
-        delete trT[iThd];
-
 // Done
 
     endRun();
@@ -472,9 +482,27 @@ void TrigSpike::SETSTATE_Done()
 }
 
 
+// Current edge finished or handed off: close files,
+// move past refractory period, count it.
+//
+void TrigSpike::doneEdge()
+{
+    endTrig();
+
+    resetSearch();
+    imCnt.advanceEdgeByRefrac();
+    niCnt.edgeCt += niCnt.refracCt;
+
+    if( ++nS >= nCycMax )
+        SETSTATE_Done();
+    else
+        SETSTATE_GetEdge;
+}
+
+
 void TrigSpike::initState()
 {
-    usrFlt->reset();
+    resetSearch();
     imCnt.edgeCt.clear();
     niCnt.edgeCt    = 0;
     nS              = 0;
@@ -501,7 +529,7 @@ bool TrigSpike::getEdge(
 
     if( aEdgeCt < minCt ) {
 
-        usrFlt->reset();
+        resetSearch();
         aEdgeCt = minCt;
     }
 
@@ -512,13 +540,25 @@ bool TrigSpike::getEdge(
     if( aEdgeCtNext )
         found = true;
     else {
-        found = qA->findFltFallingEdge(
-                    aEdgeCtNext,
-                    aEdgeCt,
-                    p.trgSpike.aiChan,
-                    thresh,
-                    p.trgSpike.inarow,
-                    *usrFlt );
+        if( mcScan )
+            found = findMultiEdge( aEdgeCtNext, aEdgeCt, qA );
+        else if( qA->hasDerivedChan( p.trgSpike.aiChan ) ) {
+            found = qA->findDrvFallingEdge(
+                        aEdgeCtNext,
+                        aEdgeCt,
+                        p.trgSpike.aiChan,
+                        thresh,
+                        p.trgSpike.inarow );
+        }
+        else {
+            found = qA->findFltFallingEdge(
+                        aEdgeCtNext,
+                        aEdgeCt,
+                        p.trgSpike.aiChan,
+                        thresh,
+                        p.trgSpike.inarow,
+                        *usrFlt );
+        }
 
         if( !found ) {
             aEdgeCt     = aEdgeCtNext;  // pick up search here
@@ -537,6 +577,7 @@ bool TrigSpike::getEdge(
     if( found ) {
 
         alignX12( qA, aEdgeCtNext, bEdgeCt );
+        latEdge( qA, aEdgeCtNext );
 
         aEdgeCt     = aEdgeCtNext;
         aEdgeCtNext = 0;
@@ -546,6 +587,89 @@ bool TrigSpike::getEdge(
 }
 
 
+// Multichannel counterpart of AIQ::findFltFallingEdge().
+//
+// Blocks from fromCt are filtered across the whole channel span
+// and handed to mcScan. The scanner carries its state between
+// calls, so on failure the search resumes at the end of data,
+// without revisiting any samples.
+//
+// Return:
+// false = no edge; resume looking from outCt.
+// true  = edge @ outCt.
+//
+bool TrigSpike::findMultiEdge(
+    quint64     &outCt,
+    quint64     fromCt,
+    const AIQ   *qA )
+{
+    outCt = fromCt;
+
+    if( fromCt >= qA->curCount() )
+        return false;
+
+    std::vector<AIQ::AIQBlock>  vB;
+    int                         nb      = qA->getAllScansFromCt( vB, fromCt ),
+                                nC      = qA->nChans();
+
+    for( int ib = 0; ib < nb; ++ib ) {
+
+        AIQ::AIQBlock   &B      = vB[ib];
+        int             ntpts   = (int)B.data.size() / nC,
+                        row;
+
+        if( !ntpts )
+            continue;
+
+        (*usrFlt)( B.data );
+
+        if( mcScan->scan( row, &B.data[0], ntpts ) ) {
+            outCt = B.headCt + row;
+            return true;
+        }
+
+        outCt = B.headCt + ntpts;
+    }
+
+    return false;
+}
+
+
+bool TrigSpike::writeSomeIM( int ip )
+{
+    CountsIm                    &C = imCnt;
+    std::vector<AIQ::AIQBlock>  vB;
+    int                         nb;
+
+// ---------------------------------------
+// Fetch immediately (don't miss old data)
+// ---------------------------------------
+
+    if( C.remCt[ip] == -1 ) {
+        C.nextCt[ip]  = C.edgeCt[ip] - C.periEvtCt;
+        C.remCt[ip]   = 2 * C.periEvtCt + 1;
+    }
+
+    nb = imQ[ip]->getNScansFromCt( vB, C.nextCt[ip], C.remCt[ip] );
+
+// ---------------
+// Update tracking
+// ---------------
+
+    if( !nb )
+        return true;
+
+    C.nextCt[ip] = imQ[ip]->nextCt( vB );
+    C.remCt[ip] -= C.nextCt[ip] - vB[0].headCt;
+
+// -----
+// Write
+// -----
+
+    return writeAndInvalVB( DstImec, ip, vB );
+}
+
+
 bool TrigSpike::writeSomeNI()
 {
     if( !niQ )
@@ -586,35 +710,21 @@ bool TrigSpike::writeSomeNI()
 
 // Return true if no errors.
 //
-bool TrigSpike::xferAll( TrSpkShared &shr )
+bool TrigSpike::xferAll()
 {
     int niOK;
 
-    shr.awake   = 0;
-    shr.asleep  = 0;
-    shr.errors  = 0;
-
-// Wake all imec threads
+// Post imec tasks to pool
 
-    shr.condWake.wakeAll();
+    poolPost();
 
 // Do nidq locally
 
     niOK = writeSomeNI();
 
-// Wait all threads started, and all done
-
-    shr.runMtx.lock();
-        while( shr.awake  < nThd
-            || shr.asleep < nThd ) {
-
-            shr.runMtx.unlock();
-                msleep( LOOP_MS/8 );
-            shr.runMtx.lock();
-        }
-    shr.runMtx.unlock();
+// Help with, then wait for, imec tasks
 
-    return niOK && !shr.errors;
+    return poolWait() && niOK;
 }
 
 
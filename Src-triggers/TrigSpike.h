@@ -2,110 +2,32 @@
 #define TRIGSPIKE_H
 
 #include "TrigBase.h"
+#include "SpikeScanMC.h"
 
-#include <QWaitCondition>
-
-class Biquad;
+class BiquadMC;
 
 /* ---------------------------------------------------------------- */
 /* Types ---------------------------------------------------------- */
 /* ---------------------------------------------------------------- */
 
-struct TrSpkShared {
-    const DAQ::Params   &p;
-    QMutex              runMtx;
-    QWaitCondition      condWake;
-    int                 awake,
-                        asleep,
-                        errors;
-    bool                stop;
-
-    TrSpkShared( const DAQ::Params &p )
-    :   p(p), awake(0), asleep(0), stop(false)  {}
-
-    bool wake( bool ok )
-    {
-        bool    run;
-        runMtx.lock();
-            errors += !ok;
-            ++asleep;
-            condWake.wait( &runMtx );
-            ++awake;
-            run = !stop;
-        runMtx.unlock();
-        return run;
-    }
-
-    void kill()
-    {
-        runMtx.lock();
-            stop = true;
-        runMtx.unlock();
-        condWake.wakeAll();
-    }
-};
-
-
-class TrSpkWorker : public QObject
-{
-    Q_OBJECT
-
-private:
-    TrSpkShared         &shr;
-    const QVector<AIQ*> &imQ;
-    QVector<int>        vID;
-
-public:
-    TrSpkWorker(
-        TrSpkShared         &shr,
-        const QVector<AIQ*> &imQ,
-        QVector<int>        &vID )
-    :   shr(shr), imQ(imQ), vID(vID)    {}
-    virtual ~TrSpkWorker()              {}
-
-signals:
-    void finished();
-
-public slots:
-    void run();
-
-private:
-    bool writeSomeIM( int ip );
-};
-
-
-class TrSpkThread
-{
-public:
-    QThread     *thread;
-    TrSpkWorker *worker;
-
-public:
-    TrSpkThread(
-        TrSpkShared         &shr,
-        const QVector<AIQ*> &imQ,
-        QVector<int>        &vID );
-    virtual ~TrSpkThread();
-};
-
-
 class TrigSpike : public TrigBase
 {
     Q_OBJECT
 
-    friend class TrSpkWorker;
-
 private:
-    struct HiPassFnctr : public AIQ::T_AIQBlockFilter {
-        Biquad  *flt;
+    struct HiPassFnctr
+        : public AIQ::T_AIQBlockFilter, public AIQ::T_AIQMonoFilter {
+        BiquadMC    *flt;
         int     nchans,
-                ichan,
+                c0,
+                cLim,
                 maxInt,
                 nzero;
         HiPassFnctr( const DAQ::Params &p );
         virtual ~HiPassFnctr();
         void reset();
         void operator()( vec_i16 &data );
+        void operator()( qint16 *data, int n );
     };
 
     struct Counts {
@@ -152,13 +74,13 @@ private:
 
 private:
     HiPassFnctr     *usrFlt;
+    SpikeScanMC     *mcScan;
     CountsIm        imCnt;
     CountsNi        niCnt;
     const qint64    nCycMax;
     quint64         aEdgeCtNext;
     const int       thresh;
-    int             nThd,
-                    nS,
+    int             nS,
                     state;
 
 public:
@@ -167,18 +89,28 @@ public:
         GraphsWindow        *gw,
         const QVector<AIQ*> &imQ,
         const AIQ           *niQ );
-    virtual ~TrigSpike()    {delete usrFlt;}
+    virtual ~TrigSpike();
+
+    static void addDerivedChan(
+        const DAQ::Params   &p,
+        const QVector<AIQ*> &imQ,
+        AIQ                 *niQ );
 
     virtual void setGate( bool hi );
     virtual void resetGTCounters();
 
+    virtual bool poolTask( int ip );
+
 public slots:
     virtual void run();
 
 private:
     void SETSTATE_Write();
     void SETSTATE_Done();
+    void doneEdge();
     void initState();
+    void resetSearch()
+        {usrFlt->reset(); if( mcScan ) mcScan->reset();}
 
     bool getEdge(
         quint64         &aEdgeCt,
@@ -187,9 +119,15 @@ private:
         quint64         &bEdgeCt,
         const AIQ       *qB );
 
+    bool findMultiEdge(
+        quint64         &outCt,
+        quint64         fromCt,
+        const AIQ       *qA );
+
+    bool writeSomeIM( int ip );
     bool writeSomeNI();
 
-    bool xferAll( TrSpkShared &shr );
+    bool xferAll();
 };
 
 #endif  // TRIGSPIKE_H
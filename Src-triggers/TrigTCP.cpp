@@ -2,137 +2,73 @@
 #include "TrigTCP.h"
 #include "Util.h"
 
-#include <QThread>
-
 
 #define LOOP_MS     100
 
 
-static TrigTCP      *ME;
-
-
 /* ---------------------------------------------------------------- */
-/* TrTCPWorker ---------------------------------------------------- */
+/* TrigTCP -------------------------------------------------------- */
 /* ---------------------------------------------------------------- */
 
-void TrTCPWorker::run()
+void TrigTCP::rgtSetTrig( bool hi )
 {
-    const int   nID = vID.size();
-    bool        ok  = true;
-
-    for(;;) {
-
-        if( !shr.wake( ok ) )
-            break;
-
-        for( int iID = 0; iID < nID; ++iID ) {
+    runMtx.lock();
 
-            if( shr.tRem > 0 )
-                ok = writeRemIM( vID[iID], shr.tRem );
-            else
-                ok = writeSomeIM( vID[iID] );
+    if( hi ) {
 
-            if( !ok )
-                break;
+        if( trigHi )
+            Error() << "SetTrig(HI) twice in a row...ignoring second.";
+        else {
+            trigHiT     = getTime();
+            trigHiJS    = -2;
         }
     }
+    else {
+        trigLoT     = getTime();
+        trigLoJS    = -2;
 
-    emit finished();
-}
-
-
-// Return true if no errors.
-//
-bool TrTCPWorker::writeSomeIM( int ip )
-{
-    std::vector<AIQ::AIQBlock>  vB;
-    int                         nb;
-
-    nb = imQ[ip]->getAllScansFromCt( vB, shr.imNextCt[ip] );
-
-    if( !nb )
-        return true;
+        if( !trigHi )
+            Warning() << "SetTrig(LO) twice in a row.";
+    }
 
-    shr.imNextCt[ip] = imQ[ip]->nextCt( vB );
+    trigHi = hi;
 
-    return ME->writeAndInvalVB( ME->DstImec, ip, vB );
+    runMtx.unlock();
 }
 
 
-// Return true if no errors.
+// Like rgtSetTrig(), but the file edge is sample count (ct)
+// of stream (js) {-1=nidq, else imec probe}: exact in that
+// stream, mapped to the others. Counts may be in the future;
+// the files then begin or end when the stream gets there.
 //
-bool TrTCPWorker::writeRemIM( int ip, double tlo )
-{
-    quint64     spnCt = tlo * imQ[ip]->sRate(),
-                curCt = ME->scanCount( ME->DstImec );
-
-    if( curCt >= spnCt )
-        return true;
-
-    std::vector<AIQ::AIQBlock>  vB;
-    int                         nb;
-
-    nb = imQ[ip]->getNScansFromCt( vB, shr.imNextCt[ip], spnCt - curCt );
-
-    if( !nb )
-        return true;
-
-    return ME->writeAndInvalVB( ME->DstImec, ip, vB );
-}
-
-/* ---------------------------------------------------------------- */
-/* TrTCPThread ---------------------------------------------------- */
-/* ---------------------------------------------------------------- */
-
-TrTCPThread::TrTCPThread(
-    TrTCPShared         &shr,
-    const QVector<AIQ*> &imQ,
-    QVector<int>        &vID )
-{
-    thread  = new QThread;
-    worker  = new TrTCPWorker( shr, imQ, vID );
-
-    worker->moveToThread( thread );
-
-    Connect( thread, SIGNAL(started()), worker, SLOT(run()) );
-    Connect( worker, SIGNAL(finished()), worker, SLOT(deleteLater()) );
-    Connect( worker, SIGNAL(destroyed()), thread, SLOT(quit()), Qt::DirectConnection );
-
-    thread->start();
-}
-
-
-TrTCPThread::~TrTCPThread()
+void TrigTCP::rgtSetTrigCt( bool hi, int js, quint64 ct )
 {
-// worker object auto-deleted asynchronously
-// thread object manually deleted synchronously (so we can call wait())
-
-    if( thread->isRunning() )
-        thread->wait();
-
-    delete thread;
-}
-
-/* ---------------------------------------------------------------- */
-/* TrigTCP -------------------------------------------------------- */
-/* ---------------------------------------------------------------- */
+    if( js >= nImQ || (js == -1 && !niQ) || js < -1 ) {
+        Error() << QString("SetTrigCt: No such stream (%1)...ignoring.")
+                    .arg( js );
+        return;
+    }
 
-void TrigTCP::rgtSetTrig( bool hi )
-{
     runMtx.lock();
 
     if( hi ) {
 
         if( trigHi )
-            Error() << "SetTrig(HI) twice in a row...ignoring second.";
-        else
-            trigHiT = getTime();
+            Error() << "SetTrigCt(HI) twice in a row...ignoring second.";
+        else {
+            trigHiT     = getTime();
+            trigHiCt    = ct;
+            trigHiJS    = js;
+        }
     }
     else {
-        trigLoT = getTime();
+        trigLoT     = getTime();
+        trigLoCt    = ct;
+        trigLoJS    = js;
 
         if( !trigHi )
-            Warning() << "SetTrig(LO) twice in a row.";
+            Warning() << "SetTrigCt(LO) twice in a row.";
     }
 
     trigHi = hi;
@@ -157,6 +93,19 @@ void TrigTCP::resetGTCounters()
 }
 
 
+// Pool task: per-probe work for xferAll(),
+// remainder if finalWrite.
+// Return true if no errors.
+//
+bool TrigTCP::poolTask( int ip )
+{
+    if( finalWrite )
+        return writeRemIM( ip );
+    else
+        return writeSomeIM( ip );
+}
+
+
 // Remote mode triggering is turned on/off by remote app.
 //
 void TrigTCP::run()
@@ -167,44 +116,11 @@ void TrigTCP::run()
 // Configure
 // ---------
 
-    ME = this;
-
     quint64 niNextCt = 0;
 
-// Create worker threads
-
-    const int               nPrbPerThd = 2;
-
-    QVector<TrTCPThread*>   trT;
-    TrTCPShared             shr( p );
-
-    nThd = 0;
-
-    for( int ip0 = 0; ip0 < nImQ; ip0 += nPrbPerThd ) {
-
-        QVector<int>    vID;
+// Per-probe task pool
 
-        for( int id = 0; id < nPrbPerThd; ++id ) {
-
-            if( ip0 + id < nImQ )
-                vID.push_back( ip0 + id );
-            else
-                break;
-        }
-
-        trT.push_back( new TrTCPThread( shr, imQ, vID ) );
-        ++nThd;
-    }
-
-// Wait for threads to reach ready (sleep) state
-
-    shr.runMtx.lock();
-        while( shr.asleep < nThd ) {
-            shr.runMtx.unlock();
-                usleep( 10 );
-            shr.runMtx.lock();
-        }
-    shr.runMtx.unlock();
+    poolStart();
 
 // -----
 // Start
@@ -225,9 +141,14 @@ void TrigTCP::run()
             if( allFilesClosed() )
                 goto next_loop;
 
-            if( !allFinalWrite( shr, niNextCt ) )
+            bool    done;
+
+            if( !allFinalWrite( niNextCt, done ) )
                 break;
 
+            if( !done )
+                goto next_loop;
+
             endTrig();
             goto next_loop;
         }
@@ -236,7 +157,7 @@ void TrigTCP::run()
         // If trigger ON
         // -------------
 
-        if( !allWriteSome( shr, niNextCt ) )
+        if( !allWriteSome( niNextCt ) )
             break;
 
         // ------
@@ -265,13 +186,6 @@ next_loop:
         yield( loopT );
     }
 
-// Kill all threads
-
-    shr.kill();
-
-    for( int iThd = 0; iThd < nThd; ++iThd )
-        delete trT[iThd];
-
 // Done
 
     endRun();
@@ -291,6 +205,10 @@ next_loop:
 // target time might be newer than any sample tag, which
 // is fixed by retrying on another loop iteration.
 //
+// If started by count, that stream starts exactly there
+// (no X12 bump), others at the count's time. We wait
+// until the count has been acquired.
+//
 bool TrigTCP::alignFiles(
     QVector<quint64>    &imNextCt,
     quint64             &niNextCt )
@@ -299,27 +217,104 @@ bool TrigTCP::alignFiles(
     if( (nImQ && !imNextCt.size()) || (niQ && !niNextCt) ) {
 
         double  trigT = getTrigHiT();
-        quint64 imNext, niNext;
+        quint64 imNext, niNext, hiCt;
+        int     js;
 
-        if( niQ && !niQ->mapTime2Ct( niNext, trigT ) )
-            return false;
+        getTrigHiCt( js, hiCt );
+
+        if( js >= -1 ) {
+
+            const AIQ   *qA = jsQ( js );
+
+            if( qA->curCount() <= hiCt )
+                return false;
+
+            if( !qA->mapCt2Time( trigT, hiCt ) ) {
+
+                Warning()
+                    <<  "SetTrigCt(HI) count no longer in stream;"
+                        " starting at command time.";
+
+                runMtx.lock();
+                trigHiJS = -2;
+                runMtx.unlock();
+
+                trigT   = getTrigHiT();
+                js      = -2;
+            }
+        }
+
+        if( niQ ) {
+
+            if( js == -1 )
+                niNext = hiCt;
+            else if( !niQ->mapTime2Ct( niNext, trigT ) )
+                return false;
+        }
 
         if( nImQ ) {
 
-            if( !imQ[0]->mapTime2Ct( imNext, trigT ) )
+            if( js >= 0 )
+                imNext = hiCt;
+            else if( !imQ[0]->mapTime2Ct( imNext, trigT ) )
                 return false;
 
-            alignX12( imNext, niNext );
+            if( js < -1 )
+                alignX12( imNext, niNext );
+
             imNextCt.fill( imNext, nImQ );
         }
 
         niNextCt = niNext;
+
+        imStartCt   = imNextCt;
+        niStartCt   = niNextCt;
     }
 
     return true;
 }
 
 
+// Return true if no errors.
+//
+bool TrigTCP::writeSomeIM( int ip )
+{
+    std::vector<AIQ::AIQBlock>  vB;
+    int                         nb;
+
+    nb = imQ[ip]->getAllScansFromCt( vB, imNextCt[ip] );
+
+    if( !nb )
+        return true;
+
+    imNextCt[ip] = imQ[ip]->nextCt( vB );
+
+    return writeAndInvalVB( DstImec, ip, vB );
+}
+
+
+// Return true if no errors.
+//
+bool TrigTCP::writeRemIM( int ip )
+{
+    quint64     spnCt = imSpnCt[ip],
+                curCt = scanCount( DstImec, ip );
+
+    if( curCt >= spnCt )
+        return true;
+
+    std::vector<AIQ::AIQBlock>  vB;
+    int                         nb;
+
+    nb = imQ[ip]->getNScansFromCt( vB, imNextCt[ip], spnCt - curCt );
+
+    if( !nb )
+        return true;
+
+    return writeAndInvalVB( DstImec, ip, vB );
+}
+
+
 // Return true if no errors.
 //
 bool TrigTCP::writeSomeNI( quint64 &nextCt )
@@ -343,12 +338,12 @@ bool TrigTCP::writeSomeNI( quint64 &nextCt )
 
 // Return true if no errors.
 //
-bool TrigTCP::writeRemNI( quint64 &nextCt, double tlo )
+bool TrigTCP::writeRemNI( quint64 &nextCt )
 {
     if( !niQ )
         return true;
 
-    quint64 spnCt = tlo * niQ->sRate(),
+    quint64 spnCt = niSpnCt,
             curCt = scanCount( DstNidq );
 
     if( curCt >= spnCt )
@@ -366,47 +361,81 @@ bool TrigTCP::writeRemNI( quint64 &nextCt, double tlo )
 }
 
 
+// Set per-stream file spans (counts from file start) for
+// the final write: (tlo) secs, or if (js) >= -1, to count
+// (loCt) of that stream exactly, scaled by sample rate in
+// the others; whichever is shorter.
+//
+void TrigTCP::setSpans( double tlo, int js, quint64 loCt )
+{
+    quint64 refSpn  = 0;
+    double  refRate = 0;
+
+    if( js >= -1 ) {
+
+        quint64 refStart = (js >= 0 ? imStartCt[js] : niStartCt);
+
+        refSpn  = (loCt > refStart ? loCt - refStart : 0);
+        refRate = jsQ( js )->sRate();
+    }
+
+    imSpnCt.resize( nImQ );
+
+    for( int ip = 0; ip < nImQ; ++ip ) {
+
+        double  rate = imQ[ip]->sRate();
+        quint64 spn  = tlo * rate;
+
+        if( js == ip )
+            spn = qMin( spn, refSpn );
+        else if( js >= -1 )
+            spn = qMin( spn, quint64(refSpn * rate / refRate) );
+
+        imSpnCt[ip] = spn;
+    }
+
+    if( niQ ) {
+
+        double  rate = niQ->sRate();
+
+        niSpnCt = tlo * rate;
+
+        if( js == -1 )
+            niSpnCt = qMin( niSpnCt, refSpn );
+        else if( js >= 0 )
+            niSpnCt = qMin( niSpnCt, quint64(refSpn * rate / refRate) );
+    }
+}
+
+
 // Return true if no errors.
 //
-bool TrigTCP::xferAll( TrTCPShared &shr, quint64 &niNextCt, double tRem )
+bool TrigTCP::xferAll( quint64 &niNextCt, bool final )
 {
     int niOK;
 
-    shr.tRem    = tRem;
-    shr.awake   = 0;
-    shr.asleep  = 0;
-    shr.errors  = 0;
+    finalWrite = final;
 
-// Wake all imec threads
+// Post imec tasks to pool
 
-    shr.condWake.wakeAll();
+    poolPost();
 
 // Do nidq locally
 
-    if( tRem > 0 )
-        niOK = writeRemNI( niNextCt, tRem );
+    if( final )
+        niOK = writeRemNI( niNextCt );
     else
         niOK = writeSomeNI( niNextCt );
 
-// Wait all threads started, and all done
-
-    shr.runMtx.lock();
-        while( shr.awake  < nThd
-            || shr.asleep < nThd ) {
+// Help with, then wait for, imec tasks
 
-            shr.runMtx.unlock();
-                msleep( LOOP_MS/8 );
-            shr.runMtx.lock();
-        }
-    shr.runMtx.unlock();
-
-    return niOK && !shr.errors;
+    return poolWait() && niOK;
 }
 
 
 // Return true if no errors.
 //
-bool TrigTCP::allWriteSome( TrTCPShared &shr, quint64 &niNextCt )
+bool TrigTCP::allWriteSome( quint64 &niNextCt )
 {
 // -------------------
 // Open files together
@@ -417,7 +446,7 @@ bool TrigTCP::allWriteSome( TrTCPShared &shr, quint64 &niNextCt )
         int ig, it;
 
         // reset tracking
-        shr.imNextCt.clear();
+        imNextCt.clear();
         niNextCt = 0;
 
         if( !newTrig( ig, it ) )
@@ -428,44 +457,93 @@ bool TrigTCP::allWriteSome( TrTCPShared &shr, quint64 &niNextCt )
 // Seek common sync time
 // ---------------------
 
-    if( !alignFiles( shr.imNextCt, niNextCt ) )
+    if( !alignFiles( imNextCt, niNextCt ) )
         return true;    // too early
 
 // ----------------------
 // Fetch from all streams
 // ----------------------
 
-    return xferAll( shr, niNextCt, -1 );
+    return xferAll( niNextCt, false );
 }
 
 
 // Return true if no errors.
+// Set (done) false if must retry on a later loop.
 //
-bool TrigTCP::allFinalWrite( TrTCPShared &shr, quint64 &niNextCt )
+bool TrigTCP::allFinalWrite( quint64 &niNextCt, bool &done )
 {
+    done = false;
+
+// Files must have a start, which by count may be pending.
+
+    if( !alignFiles( imNextCt, niNextCt ) )
+        return true;
+
 // Stopping due to gate or trigger going low.
 // Set tlo to the shorter time span from thi.
 
     double  glo = getGateLoT(),
             tlo = getTrigLoT(),
             thi = getTrigHiT();
+    quint64 loCt;
+    int     js;
+    bool    gateLo = (glo > thi);
+
+    getTrigLoCt( js, loCt );
 
-    if( glo > thi )
+    if( gateLo )
         glo -= thi;
     else
         glo = 48*3600;  // arb time (48 hrs) > AIQ capacity
 
     if( tlo > thi )
         tlo -= thi;
-    else
+    else {
         tlo = 48*3600;  // arb time (48 hrs) > AIQ capacity
+        js  = -2;
+    }
+
+// Stopping by count: wait for it unless gate went low.
+
+    if( js >= -1 ) {
+
+        if( !gateLo && jsQ( js )->curCount() < loCt )
+            return true;
+
+        tlo = 48*3600;
+    }
 
     if( tlo > glo )
         tlo = glo;
 
+    setSpans( tlo, js, loCt );
+
+// A count already written past can't be honored.
+
+    if( js >= -1 ) {
+
+        quint64 start   = (js >= 0 ? imStartCt[js] : niStartCt),
+                curCt   = (js >= 0 ?
+                            scanCount( DstImec, js ) :
+                            scanCount( DstNidq ));
+
+        if( start + curCt > loCt ) {
+
+            Warning()
+                <<  QString(
+                    "SetTrigCt(LO) count %1 already written;"
+                    " file ends at count %2.")
+                    .arg( loCt )
+                    .arg( start + curCt - 1 );
+        }
+    }
+
 // If our current count is short, fetch remainder.
 
-    return xferAll( shr, niNextCt, tlo );
+    done = true;
+
+    return xferAll( niNextCt, true );
 }
 
 
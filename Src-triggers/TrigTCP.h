@@ -3,104 +3,28 @@
 
 #include "TrigBase.h"
 
-#include <QWaitCondition>
-
 /* ---------------------------------------------------------------- */
 /* Types ---------------------------------------------------------- */
 /* ---------------------------------------------------------------- */
 
-struct TrTCPShared {
-    const DAQ::Params   &p;
-    QVector<quint64>    imNextCt;
-    double              tRem;
-    QMutex              runMtx;
-    QWaitCondition      condWake;
-    int                 awake,
-                        asleep,
-                        errors;
-    bool                stop;
-
-    TrTCPShared( const DAQ::Params &p )
-    :   p(p), tRem(-1), awake(0), asleep(0), stop(false)    {}
-
-    bool wake( bool ok )
-    {
-        bool    run;
-        runMtx.lock();
-            errors += !ok;
-            ++asleep;
-            condWake.wait( &runMtx );
-            ++awake;
-            run = !stop;
-        runMtx.unlock();
-        return run;
-    }
-
-    void kill()
-    {
-        runMtx.lock();
-            stop = true;
-        runMtx.unlock();
-        condWake.wakeAll();
-    }
-};
-
-
-class TrTCPWorker : public QObject
-{
-    Q_OBJECT
-
-private:
-    TrTCPShared         &shr;
-    const QVector<AIQ*> &imQ;
-    QVector<int>        vID;
-
-public:
-    TrTCPWorker(
-        TrTCPShared         &shr,
-        const QVector<AIQ*> &imQ,
-        QVector<int>        &vID )
-    :   shr(shr), imQ(imQ), vID(vID)    {}
-    virtual ~TrTCPWorker()              {}
-
-signals:
-    void finished();
-
-public slots:
-    void run();
-
-private:
-    bool writeSomeIM( int ip );
-    bool writeRemIM( int ip, double tlo );
-};
-
-
-class TrTCPThread
-{
-public:
-    QThread     *thread;
-    TrTCPWorker *worker;
-
-public:
-    TrTCPThread(
-        TrTCPShared         &shr,
-        const QVector<AIQ*> &imQ,
-        QVector<int>        &vID );
-    virtual ~TrTCPThread();
-};
-
-
 class TrigTCP : public TrigBase
 {
     Q_OBJECT
 
-    friend class TrTCPWorker;
-
 private:
-    double          trigHiT,
-                    trigLoT;
-    volatile bool   trigHi;
-    int             nThd;
+    double              trigHiT,
+                        trigLoT;
+    QVector<quint64>    imNextCt,
+                        imStartCt,
+                        imSpnCt;
+    quint64             niStartCt,
+                        niSpnCt,
+                        trigHiCt,
+                        trigLoCt;
+    int                 trigHiJS,   // {-2=wall time, -1=nidq, else imec}
+                        trigLoJS;
+    bool                finalWrite;
+    volatile bool       trigHi;
 
 public:
     TrigTCP(
@@ -108,13 +32,19 @@ public:
         GraphsWindow        *gw,
         const QVector<AIQ*> &imQ,
         const AIQ           *niQ )
-    :   TrigBase( p, gw, imQ, niQ ), trigHiT(-1), trigHi(false) {}
+    :   TrigBase( p, gw, imQ, niQ ),
+        trigHiT(-1), trigLoT(-1), niStartCt(0), niSpnCt(0),
+        trigHiCt(0), trigLoCt(0), trigHiJS(-2), trigLoJS(-2),
+        finalWrite(false), trigHi(false)    {}
 
     void rgtSetTrig( bool hi );
+    void rgtSetTrigCt( bool hi, int js, quint64 ct );
 
     virtual void setGate( bool hi );
     virtual void resetGTCounters();
 
+    virtual bool poolTask( int ip );
+
 public slots:
     virtual void run();
 
@@ -123,16 +53,27 @@ private:
     double getTrigHiT() const   {QMutexLocker ml( &runMtx ); return trigHiT;}
     double getTrigLoT() const   {QMutexLocker ml( &runMtx ); return trigLoT;}
 
+    void getTrigHiCt( int &js, quint64 &ct ) const
+        {QMutexLocker ml( &runMtx ); js = trigHiJS; ct = trigHiCt;}
+    void getTrigLoCt( int &js, quint64 &ct ) const
+        {QMutexLocker ml( &runMtx ); js = trigLoJS; ct = trigLoCt;}
+
+    const AIQ *jsQ( int js ) const  {return (js >= 0 ? imQ[js] : niQ);}
+
     bool alignFiles(
         QVector<quint64>    &imNextCt,
         quint64             &niNextCt );
 
+    bool writeSomeIM( int ip );
+    bool writeRemIM( int ip );
     bool writeSomeNI( quint64 &nextCt );
-    bool writeRemNI( quint64 &nextCt, double tlo );
+    bool writeRemNI( quint64 &nextCt );
+
+    void setSpans( double tlo, int js, quint64 loCt );
 
-    bool xferAll( TrTCPShared &shr, quint64 &niNextCt, double tRem );
-    bool allWriteSome( TrTCPShared &shr, quint64 &niNextCt );
-    bool allFinalWrite( TrTCPShared &shr, quint64 &niNextCt );
+    bool xferAll( quint64 &niNextCt, bool final );
+    bool allWriteSome( quint64 &niNextCt );
+    bool allFinalWrite( quint64 &niNextCt, bool &done );
 };
 
 #endif  // TRIGTCP_H
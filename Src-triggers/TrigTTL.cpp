@@ -4,220 +4,10 @@
 #include "MainApp.h"
 #include "Run.h"
 
-#include <QThread>
-
 
 #define LOOP_MS     100
 
 
-static TrigTTL      *ME;
-
-
-/* ---------------------------------------------------------------- */
-/* TrTTLWorker ---------------------------------------------------- */
-/* ---------------------------------------------------------------- */
-
-void TrTTLWorker::run()
-{
-    const int   nID = vID.size();
-    bool        ok  = true;
-
-    for(;;) {
-
-        if( !shr.wake( ok ) )
-            break;
-
-        for( int iID = 0; iID < nID; ++iID ) {
-
-            if( shr.preMidPost == -1 )
-                ok = writePreMarginIm( vID[iID] );
-            else if( !shr.preMidPost )
-                ok = doSomeHIm( vID[iID] );
-           else
-                ok = writePostMarginIm( vID[iID] );
-
-            if( !ok )
-                break;
-        }
-    }
-
-    emit finished();
-}
-
-
-// Write margin up to but not including rising edge.
-//
-// Decrement remCt...
-// remCt must previously be inited to marginCt.
-//
-// Return true if no errors.
-//
-bool TrTTLWorker::writePreMarginIm( int ip )
-{
-    TrigTTL::CountsIm   &C = ME->imCnt;
-
-    if( C.remCt[ip] <= 0 )
-        return true;
-
-    std::vector<AIQ::AIQBlock>  vB;
-    int                         nb;
-
-    nb = imQ[ip]->getNScansFromCt(
-            vB,
-            C.edgeCt[ip] - C.remCt[ip],
-            (C.remCt[ip] <= C.maxFetch ? C.remCt[ip] : C.maxFetch) );
-
-    if( !nb )
-        return true;
-
-// Status in this state should be what's done: +(margin - rem).
-// If next = edge - rem, then status = +(next - edge + margin).
-//
-// When rem falls to zero, (next = edge) sets us up for state H.
-
-    C.remCt[ip] -= imQ[ip]->sumCt( vB );
-    C.nextCt[ip] = C.edgeCt[ip] - C.remCt[ip];
-
-    return ME->writeAndInvalVB( ME->DstImec, ip, vB );
-}
-
-
-// Write margin, including falling edge.
-//
-// Decrement remCt...
-// remCt must previously be inited to marginCt.
-//
-// Return true if no errors.
-//
-bool TrTTLWorker::writePostMarginIm( int ip )
-{
-    TrigTTL::CountsIm   &C = ME->imCnt;
-
-    if( C.remCt[ip] <= 0 )
-        return true;
-
-    std::vector<AIQ::AIQBlock>  vB;
-    int                         nb;
-
-    nb = imQ[ip]->getNScansFromCt(
-            vB,
-            C.fallCt[ip] + C.marginCt - C.remCt[ip],
-            (C.remCt[ip] <= C.maxFetch ? C.remCt[ip] : C.maxFetch) );
-
-    if( !nb )
-        return true;
-
-// Status in this state should be: +(margin + H + margin - rem).
-// With next defined as below, status = +(next - edge + margin)
-// = margin + (fall-edge) + margin - rem = correct.
-
-    C.remCt[ip] -= imQ[ip]->sumCt( vB );
-    C.nextCt[ip] = C.fallCt[ip] + C.marginCt - C.remCt[ip];
-
-    return ME->writeAndInvalVB( ME->DstImec, ip, vB );
-}
-
-
-// Write from rising edge up to but not including falling edge.
-//
-// Return true if no errors.
-//
-bool TrTTLWorker::doSomeHIm( int ip )
-{
-    TrigTTL::CountsIm   &C = ME->imCnt;
-
-    if( shr.p.trgTTL.mode != DAQ::TrgTTLFollowAI && !C.remCt[ip] )
-        return true;
-
-    std::vector<AIQ::AIQBlock>  vB;
-    int                         nb;
-
-// ---------------
-// Fetch a la mode
-// ---------------
-
-    if( shr.p.trgTTL.mode == DAQ::TrgTTLLatch ) {
-
-        // Latched case
-        // Get all since last fetch
-
-        nb = imQ[ip]->getAllScansFromCt( vB, C.nextCt[ip] );
-    }
-    else if( shr.p.trgTTL.mode == DAQ::TrgTTLTimed ) {
-
-        // Timed case
-        // In-progress H fetch using counts
-
-        C.fallCt[ip]  = C.edgeCt[ip] + C.hiCtMax;
-        C.remCt[ip]   = C.hiCtMax - (C.nextCt[ip] - C.edgeCt[ip]);
-
-        nb = imQ[ip]->getNScansFromCt(
-                vB,
-                C.nextCt[ip],
-                (C.remCt[ip] <= C.maxFetch ? C.remCt[ip] : C.maxFetch) );
-    }
-    else {
-
-        // Follower case
-        // Fetch up to falling edge
-
-        if( !C.fallCt[ip] )
-            ME->getFallEdge();
-        else
-            C.remCt[ip] = C.fallCt[ip] - C.nextCt[ip];
-
-        nb = imQ[ip]->getNScansFromCt(
-                vB,
-                C.nextCt[ip],
-                (C.remCt[ip] <= C.maxFetch ? C.remCt[ip] : C.maxFetch) );
-    }
-
-// ------------------------
-// Write/update all H cases
-// ------------------------
-
-    if( !nb )
-        return true;
-
-    C.nextCt[ip] = imQ[ip]->nextCt( vB );
-    C.remCt[ip] -= C.nextCt[ip] - vB[0].headCt;
-
-    return ME->writeAndInvalVB( ME->DstImec, ip, vB );
-}
-
-/* ---------------------------------------------------------------- */
-/* TrTTLThread ---------------------------------------------------- */
-/* ---------------------------------------------------------------- */
-
-TrTTLThread::TrTTLThread(
-    TrTTLShared         &shr,
-    const QVector<AIQ*> &imQ,
-    QVector<int>        &vID )
-{
-    thread  = new QThread;
-    worker  = new TrTTLWorker( shr, imQ, vID );
-
-    worker->moveToThread( thread );
-
-    Connect( thread, SIGNAL(started()), worker, SLOT(run()) );
-    Connect( worker, SIGNAL(finished()), worker, SLOT(deleteLater()) );
-    Connect( worker, SIGNAL(destroyed()), thread, SLOT(quit()), Qt::DirectConnection );
-
-    thread->start();
-}
-
-
-TrTTLThread::~TrTTLThread()
-{
-// worker object auto-deleted asynchronously
-// thread object manually deleted synchronously (so we can call wait())
-
-    if( thread->isRunning() )
-        thread->wait();
-
-    delete thread;
-}
-
 /* ---------------------------------------------------------------- */
 /* TrigTTL -------------------------------------------------------- */
 /* ---------------------------------------------------------------- */
@@ -269,6 +59,21 @@ void TrigTTL::resetGTCounters()
 }
 
 
+// Pool task: per-probe work for xferAll(),
+// selected by preMidPost.
+// Return true if no errors.
+//
+bool TrigTTL::poolTask( int ip )
+{
+    if( preMidPost == -1 )
+        return writePreMarginIm( ip );
+    else if( !preMidPost )
+        return doSomeHIm( ip );
+    else
+        return writePostMarginIm( ip );
+}
+
+
 #define SETSTATE_PreMarg    (state = 1)
 #define SETSTATE_PostMarg   (state = 3)
 
@@ -296,42 +101,9 @@ void TrigTTL::run()
 // Configure
 // ---------
 
-    ME = this;
-
-// Create worker threads
-
-    const int               nPrbPerThd = 2;
-
-    QVector<TrTTLThread*>   trT;
-    TrTTLShared             shr( p );
-
-    nThd = 0;
-
-    for( int ip0 = 0; ip0 < nImQ; ip0 += nPrbPerThd ) {
+// Per-probe task pool
 
-        QVector<int>    vID;
-
-        for( int id = 0; id < nPrbPerThd; ++id ) {
-
-            if( ip0 + id < nImQ )
-                vID.push_back( ip0 + id );
-            else
-                break;
-        }
-
-        trT.push_back( new TrTTLThread( shr, imQ, vID ) );
-        ++nThd;
-    }
-
-// Wait for threads to reach ready (sleep) state
-
-    shr.runMtx.lock();
-        while( shr.asleep < nThd ) {
-            shr.runMtx.unlock();
-                usleep( 10 );
-            shr.runMtx.lock();
-        }
-    shr.runMtx.unlock();
+    poolStart();
 
 // -----
 // Start
@@ -346,6 +118,13 @@ void TrigTTL::run()
         double  loopT = getTime();
         bool    inactive;
 
+        // ------------
+        // Drain epochs
+        // ------------
+
+        if( !epochXfer() )
+            goto endrun;
+
         // -------
         // Active?
         // -------
@@ -395,7 +174,7 @@ void TrigTTL::run()
 
         if( ISSTATE_PreMarg ) {
 
-            if( !xferAll( shr, -1 ) )
+            if( !xferAll( -1 ) )
                 goto endrun;
 
             if( (!niQ || niCnt.remCt <= 0) && imCnt.remCtDone() )
@@ -408,7 +187,7 @@ void TrigTTL::run()
 
         if( ISSTATE_H ) {
 
-            if( !xferAll( shr, 0 ) )
+            if( !xferAll( 0 ) )
                 goto endrun;
 
             // Done?
@@ -438,6 +217,17 @@ void TrigTTL::run()
 
                 if( !niCnt.marginCt )
                     goto check_done;
+                else if( epochCanDetach() ) {
+
+                    // Post-margin span is known: let an epoch
+                    // write it while we seek the next edge.
+
+                    epochDetach(
+                        imCnt.fallCt, niCnt.fallCt,
+                        imCnt.marginCt, niCnt.marginCt );
+
+                    goto check_done;
+                }
                 else {
                     imCnt.remCt.fill( imCnt.marginCt, nImQ );
                     niCnt.remCt = niCnt.marginCt;
@@ -452,7 +242,7 @@ void TrigTTL::run()
 
         if( ISSTATE_PostMarg ) {
 
-            if( !xferAll( shr, 1 ) )
+            if( !xferAll( 1 ) )
                 goto endrun;
 
             // Done?
@@ -513,13 +303,6 @@ next_loop:
     }
 
 endrun:
-// Kill all threads
-
-    shr.kill();
-
-    for( int iThd = 0; iThd < nThd; ++iThd )
-        delete trT[iThd];
-
 // Done
 
     endRun();
@@ -632,6 +415,7 @@ bool TrigTTL::_getRiseEdge(
     if( found ) {
 
         alignX12( qA, aEdgeCtNext, bOutCt );
+        latEdge( qA, aEdgeCtNext );
 
         aNextCt     = aEdgeCtNext;
         aFallCtNext = aEdgeCtNext;
@@ -819,6 +603,147 @@ void TrigTTL::getFallEdge()
 }
 
 
+// Write margin up to but not including rising edge.
+//
+// Decrement remCt...
+// remCt must previously be inited to marginCt.
+//
+// Return true if no errors.
+//
+bool TrigTTL::writePreMarginIm( int ip )
+{
+    CountsIm    &C = imCnt;
+
+    if( C.remCt[ip] <= 0 )
+        return true;
+
+    std::vector<AIQ::AIQBlock>  vB;
+    int                         nb;
+
+    nb = imQ[ip]->getNScansFromCt(
+            vB,
+            C.edgeCt[ip] - C.remCt[ip],
+            (C.remCt[ip] <= C.maxFetch ? C.remCt[ip] : C.maxFetch) );
+
+    if( !nb )
+        return true;
+
+// Status in this state should be what's done: +(margin - rem).
+// If next = edge - rem, then status = +(next - edge + margin).
+//
+// When rem falls to zero, (next = edge) sets us up for state H.
+
+    C.remCt[ip] -= imQ[ip]->sumCt( vB );
+    C.nextCt[ip] = C.edgeCt[ip] - C.remCt[ip];
+
+    return writeAndInvalVB( DstImec, ip, vB );
+}
+
+
+// Write margin, including falling edge.
+//
+// Decrement remCt...
+// remCt must previously be inited to marginCt.
+//
+// Return true if no errors.
+//
+bool TrigTTL::writePostMarginIm( int ip )
+{
+    CountsIm    &C = imCnt;
+
+    if( C.remCt[ip] <= 0 )
+        return true;
+
+    std::vector<AIQ::AIQBlock>  vB;
+    int                         nb;
+
+    nb = imQ[ip]->getNScansFromCt(
+            vB,
+            C.fallCt[ip] + C.marginCt - C.remCt[ip],
+            (C.remCt[ip] <= C.maxFetch ? C.remCt[ip] : C.maxFetch) );
+
+    if( !nb )
+        return true;
+
+// Status in this state should be: +(margin + H + margin - rem).
+// With next defined as below, status = +(next - edge + margin)
+// = margin + (fall-edge) + margin - rem = correct.
+
+    C.remCt[ip] -= imQ[ip]->sumCt( vB );
+    C.nextCt[ip] = C.fallCt[ip] + C.marginCt - C.remCt[ip];
+
+    return writeAndInvalVB( DstImec, ip, vB );
+}
+
+
+// Write from rising edge up to but not including falling edge.
+//
+// Return true if no errors.
+//
+bool TrigTTL::doSomeHIm( int ip )
+{
+    CountsIm    &C = imCnt;
+
+    if( p.trgTTL.mode != DAQ::TrgTTLFollowAI && !C.remCt[ip] )
+        return true;
+
+    std::vector<AIQ::AIQBlock>  vB;
+    int                         nb;
+
+// ---------------
+// Fetch a la mode
+// ---------------
+
+    if( p.trgTTL.mode == DAQ::TrgTTLLatch ) {
+
+        // Latched case
+        // Get all since last fetch
+
+        nb = imQ[ip]->getAllScansFromCt( vB, C.nextCt[ip] );
+    }
+    else if( p.trgTTL.mode == DAQ::TrgTTLTimed ) {
+
+        // Timed case
+        // In-progress H fetch using counts
+
+        C.fallCt[ip]  = C.edgeCt[ip] + C.hiCtMax;
+        C.remCt[ip]   = C.hiCtMax - (C.nextCt[ip] - C.edgeCt[ip]);
+
+        nb = imQ[ip]->getNScansFromCt(
+                vB,
+                C.nextCt[ip],
+                (C.remCt[ip] <= C.maxFetch ? C.remCt[ip] : C.maxFetch) );
+    }
+    else {
+
+        // Follower case
+        // Fetch up to falling edge
+
+        if( !C.fallCt[ip] )
+            getFallEdge();
+        else
+            C.remCt[ip] = C.fallCt[ip] - C.nextCt[ip];
+
+        nb = imQ[ip]->getNScansFromCt(
+                vB,
+                C.nextCt[ip],
+                (C.remCt[ip] <= C.maxFetch ? C.remCt[ip] : C.maxFetch) );
+    }
+
+// ------------------------
+// Write/update all H cases
+// ------------------------
+
+    if( !nb )
+        return true;
+
+    C.nextCt[ip] = imQ[ip]->nextCt( vB );
+    C.remCt[ip] -= C.nextCt[ip] - vB[0].headCt;
+
+    return writeAndInvalVB( DstImec, ip, vB );
+}
+
+
 // Write margin up to but not including rising edge.
 //
 // Decrement remCt...
@@ -964,18 +889,15 @@ bool TrigTTL::doSomeHNi()
 //
 // Return true if no errors.
 //
-bool TrigTTL::xferAll( TrTTLShared &shr, int preMidPost )
+bool TrigTTL::xferAll( int preMidPost )
 {
     int niOK;
 
-    shr.preMidPost  = preMidPost;
-    shr.awake       = 0;
-    shr.asleep      = 0;
-    shr.errors      = 0;
+    this->preMidPost = preMidPost;
 
-// Wake all imec threads
+// Post imec tasks to pool
 
-    shr.condWake.wakeAll();
+    poolPost();
 
 // Do nidq locally
 
@@ -986,19 +908,9 @@ bool TrigTTL::xferAll( TrTTLShared &shr, int preMidPost )
     else
         niOK = writePostMarginNi();
 
-// Wait all threads started, and all done
-
-    shr.runMtx.lock();
-        while( shr.awake  < nThd
-            || shr.asleep < nThd ) {
-
-            shr.runMtx.unlock();
-                msleep( LOOP_MS/8 );
-            shr.runMtx.lock();
-        }
-    shr.runMtx.unlock();
+// Help with, then wait for, imec tasks
 
-    return niOK && !shr.errors;
+    return poolWait() && niOK;
 }
 
 
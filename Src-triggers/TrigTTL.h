@@ -3,99 +3,14 @@
 
 #include "TrigBase.h"
 
-#include <QWaitCondition>
-
 /* ---------------------------------------------------------------- */
 /* Types ---------------------------------------------------------- */
 /* ---------------------------------------------------------------- */
 
-struct TrTTLShared {
-    const DAQ::Params   &p;
-    QMutex              runMtx;
-    QWaitCondition      condWake;
-    int                 preMidPost, // {-1,0,+1}
-                        awake,
-                        asleep,
-                        errors;
-    bool                stop;
-
-    TrTTLShared( const DAQ::Params &p )
-    :   p(p), awake(0), asleep(0), stop(false)  {}
-
-    bool wake( bool ok )
-    {
-        bool    run;
-        runMtx.lock();
-            errors += !ok;
-            ++asleep;
-            condWake.wait( &runMtx );
-            ++awake;
-            run = !stop;
-        runMtx.unlock();
-        return run;
-    }
-
-    void kill()
-    {
-        runMtx.lock();
-            stop = true;
-        runMtx.unlock();
-        condWake.wakeAll();
-    }
-};
-
-
-class TrTTLWorker : public QObject
-{
-    Q_OBJECT
-
-private:
-    TrTTLShared         &shr;
-    const QVector<AIQ*> &imQ;
-    QVector<int>        vID;
-
-public:
-    TrTTLWorker(
-        TrTTLShared         &shr,
-        const QVector<AIQ*> &imQ,
-        QVector<int>        &vID )
-    :   shr(shr), imQ(imQ), vID(vID)    {}
-    virtual ~TrTTLWorker()              {}
-
-signals:
-    void finished();
-
-public slots:
-    void run();
-
-private:
-    bool writePreMarginIm( int ip );
-    bool writePostMarginIm( int ip );
-    bool doSomeHIm( int ip );
-};
-
-
-class TrTTLThread
-{
-public:
-    QThread     *thread;
-    TrTTLWorker *worker;
-
-public:
-    TrTTLThread(
-        TrTTLShared         &shr,
-        const QVector<AIQ*> &imQ,
-        QVector<int>        &vID );
-    virtual ~TrTTLThread();
-};
-
-
 class TrigTTL : public TrigBase
 {
     Q_OBJECT
 
-    friend class TrTTLWorker;
-
 private:
     struct Counts {
         const qint64    hiCtMax,
@@ -172,7 +87,7 @@ private:
                     aFallCtNext;
     const int       thresh,
                     digChan;
-    int             nThd,
+    int             preMidPost, // {-1,0,+1}
                     nH,
                     state;
 
@@ -186,6 +101,8 @@ public:
     virtual void setGate( bool hi );
     virtual void resetGTCounters();
 
+    virtual bool poolTask( int ip );
+
 public slots:
     virtual void run();
 
@@ -210,11 +127,15 @@ private:
     bool getRiseEdge();
     void getFallEdge();
 
+    bool writePreMarginIm( int ip );
+    bool writePostMarginIm( int ip );
+    bool doSomeHIm( int ip );
+
     bool writePreMarginNi();
     bool writePostMarginNi();
     bool doSomeHNi();
 
-    bool xferAll( TrTTLShared &shr, int preMidPost );
+    bool xferAll( int preMidPost );
 
     void statusProcess( QString &sT, bool inactive );
 };
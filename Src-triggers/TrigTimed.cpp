@@ -4,104 +4,12 @@
 #include "MainApp.h"
 #include "Run.h"
 
-#include <QThread>
 
-
-#define LOOP_MS     100
-
-
-static TrigTimed    *ME;
+#define LOOP_MS         100
+#define MIN_SLEEP_MS    1
+#define MAX_SLEEP_MS    250
 
 
-/* ---------------------------------------------------------------- */
-/* TrTimWorker ---------------------------------------------------- */
-/* ---------------------------------------------------------------- */
-
-void TrTimWorker::run()
-{
-    const int   nID = vID.size();
-    bool        ok  = true;
-
-    for(;;) {
-
-        if( !shr.wake( ok ) )
-            break;
-
-        for( int iID = 0; iID < nID; ++iID ) {
-
-            if( !(ok = doSomeHIm( vID[iID] )) )
-                break;
-        }
-    }
-
-    emit finished();
-}
-
-
-// Return true if no errors.
-//
-bool TrTimWorker::doSomeHIm( int ip )
-{
-    TrigTimed::CountsIm         &C = ME->imCnt;
-    std::vector<AIQ::AIQBlock>  vB;
-    int                         nb;
-    uint                        remCt = C.hiCtMax - C.hiCtCur[ip];
-
-    nb = imQ[ip]->getNScansFromCt(
-            vB,
-            C.nextCt[ip],
-            (remCt <= C.maxFetch ? remCt : C.maxFetch) );
-
-    if( !nb )
-        return true;
-
-// ---------------
-// Update counting
-// ---------------
-
-    C.nextCt[ip]   = imQ[ip]->nextCt( vB );
-    C.hiCtCur[ip] += C.nextCt[ip] - vB[0].headCt;
-
-// -----
-// Write
-// -----
-
-    return ME->writeAndInvalVB( ME->DstImec, ip, vB );
-}
-
-/* ---------------------------------------------------------------- */
-/* TrTimThread ---------------------------------------------------- */
-/* ---------------------------------------------------------------- */
-
-TrTimThread::TrTimThread(
-    TrTimShared         &shr,
-    const QVector<AIQ*> &imQ,
-    QVector<int>        &vID )
-{
-    thread  = new QThread;
-    worker  = new TrTimWorker( shr, imQ, vID );
-
-    worker->moveToThread( thread );
-
-    Connect( thread, SIGNAL(started()), worker, SLOT(run()) );
-    Connect( worker, SIGNAL(finished()), worker, SLOT(deleteLater()) );
-    Connect( worker, SIGNAL(destroyed()), thread, SLOT(quit()), Qt::DirectConnection );
-
-    thread->start();
-}
-
-
-TrTimThread::~TrTimThread()
-{
-// worker object auto-deleted asynchronously
-// thread object manually deleted synchronously (so we can call wait())
-
-    if( thread->isRunning() )
-        thread->wait();
-
-    delete thread;
-}
-
 /* ---------------------------------------------------------------- */
 /* TrigTimed ------------------------------------------------------ */
 /* ---------------------------------------------------------------- */
@@ -140,6 +48,15 @@ void TrigTimed::resetGTCounters()
 }
 
 
+// Pool task: per-probe work for xferAll().
+// Return true if no errors.
+//
+bool TrigTimed::poolTask( int ip )
+{
+    return doSomeHIm( ip );
+}
+
+
 #define SETSTATE_L0     (state = 0)
 #define SETSTATE_H      (state = 1)
 #define SETSTATE_L      (state = 2)
@@ -153,6 +70,12 @@ void TrigTimed::resetGTCounters()
 // Timed logic is driven by TrgTimParams: {tL0, tH, tL, nH}.
 // There are four corresponding states defined above.
 //
+// All phase boundaries are sample counts, fixed when the gate
+// opens: start = count(gateHiT) + tL0, and thereafter each H
+// is exactly tH and each L exactly tL samples. Rather than poll,
+// the thread sleeps until the stream should hold the next count
+// it needs: the next H start, or the next full fetch within H.
+//
 void TrigTimed::run()
 {
     Debug() << "Trigger thread started.";
@@ -161,42 +84,9 @@ void TrigTimed::run()
 // Configure
 // ---------
 
-    ME = this;
-
-// Create worker threads
-
-    const int               nPrbPerThd = 2;
-
-    QVector<TrTimThread*>   trT;
-    TrTimShared             shr( p );
-
-    nThd = 0;
-
-    for( int ip0 = 0; ip0 < nImQ; ip0 += nPrbPerThd ) {
-
-        QVector<int>    vID;
-
-        for( int id = 0; id < nPrbPerThd; ++id ) {
-
-            if( ip0 + id < nImQ )
-                vID.push_back( ip0 + id );
-            else
-                break;
-        }
-
-        trT.push_back( new TrTimThread( shr, imQ, vID ) );
-        ++nThd;
-    }
-
-// Wait for threads to reach ready (sleep) state
+// Per-probe task pool
 
-    shr.runMtx.lock();
-        while( shr.asleep < nThd ) {
-            shr.runMtx.unlock();
-                usleep( 10 );
-            shr.runMtx.lock();
-        }
-    shr.runMtx.unlock();
+    poolStart();
 
 // -----
 // Start
@@ -209,8 +99,8 @@ void TrigTimed::run()
     while( !isStopped() ) {
 
         double  loopT   = getTime(),
-                gHiT,
-                delT    = 0;
+                delT    = 0,
+                sleepT  = -1;
         bool    inactive;
 
         // -------
@@ -225,18 +115,24 @@ void TrigTimed::run()
             goto next_loop;
         }
 
-        // ------------------
-        // Current gate start
-        // ------------------
+        // ------------------------------
+        // L0 phase (fix start counts)
+        // ------------------------------
+
+        if( ISSTATE_L0 ) {
 
-        gHiT = getGateHiT();
+            if( !alignFirstFiles( getGateHiT() ) )
+                goto next_loop; // gate time not yet in stream
 
-        // ----------------------------
-        // L0 phase (waiting for start)
-        // ----------------------------
+            SETSTATE_L;
+        }
 
-        if( ISSTATE_L0 )
-            delT = remainingL0( loopT, gHiT );
+        // ---------------------------------
+        // L phase (waiting for start of H)
+        // ---------------------------------
+
+        if( ISSTATE_L )
+            sleepT = delT = remainingL();
 
         // -----------------
         // H phase (writing)
@@ -244,7 +140,7 @@ void TrigTimed::run()
 
         if( ISSTATE_H ) {
 
-            if( !allDoSomeH( shr, gHiT ) )
+            if( !allDoSomeH() )
                 break;
 
             // Done?
@@ -258,22 +154,13 @@ void TrigTimed::run()
                 else {
                     alignNextFiles();
                     SETSTATE_L;
+                    sleepT = delT = remainingL();
                 }
 
                 endTrig();
             }
-        }
-
-        // ----------------------------
-        // L phase (waiting for next H)
-        // ----------------------------
-
-        if( ISSTATE_L ) {
-
-            if( niQ )
-                delT = remainingL( niQ, niCnt.nextCt );
             else
-                delT = remainingL( imQ[0], imCnt.nextCt[0] );
+                sleepT = remainingH();
         }
 
         // ------
@@ -311,20 +198,16 @@ next_loop:
             statusT = loopT;
         }
 
-        // -------------------
-        // Moderate fetch rate
-        // -------------------
+        // ----------------------------------
+        // Sleep to deadline, else moderate
+        // ----------------------------------
 
-        yield( loopT );
+        if( sleepT >= 0 && !inactive )
+            sleepFor( sleepT );
+        else
+            yield( loopT );
     }
 
-// Kill all threads
-
-    shr.kill();
-
-    for( int iThd = 0; iThd < nThd; ++iThd )
-        delete trT[iThd];
-
 // Done
 
     endRun();
@@ -349,74 +232,105 @@ void TrigTimed::initState()
     imCnt.nextCt.clear();
     niCnt.nextCt = 0;
 
-    if( p.trgTim.tL0 > 0 )
-        SETSTATE_L0;
-    else
-        SETSTATE_H;
+    SETSTATE_L0;
 }
 
 
-// Return time remaining in L0 phase.
+// Seconds until the pacing stream (nidq if present, else
+// imec probe 0) holds count (ct); zero if it already does.
 //
-double TrigTimed::remainingL0( double loopT, double gHiT )
+double TrigTimed::secsUntil( quint64 ct ) const
 {
-    double  elapsedT = loopT - gHiT;
+    const AIQ   *aiQ = (niQ ? niQ : imQ[0]);
+    quint64     curCt = aiQ->curCount();
 
-    if( elapsedT < p.trgTim.tL0 )
-        return p.trgTim.tL0 - elapsedT;  // remainder
-
-    SETSTATE_H;
+    if( curCt < ct )
+        return (ct - curCt) / aiQ->sRate();
 
     return 0;
 }
 
 
-// Return time remaining in L phase.
+// Return time remaining in L phase (or L0 tail).
+//
+double TrigTimed::remainingL()
+{
+    double  delT;
+
+    if( niQ )
+        delT = secsUntil( niCnt.nextCt );
+    else
+        delT = secsUntil( imCnt.nextCt[0] );
+
+    if( delT <= 0 )
+        SETSTATE_H;
+
+    return delT;
+}
+
+
+// Return time until a full fetch (or the rest of H)
+// is available in the pacing stream.
 //
-double TrigTimed::remainingL( const AIQ *aiQ, quint64 nextCt )
+double TrigTimed::remainingH() const
 {
-    quint64 elapsedCt = aiQ->curCount();
+    if( niQ ) {
+
+        return secsUntil(
+                niCnt.nextCt
+                + qMin( quint64(niCnt.maxFetch),
+                        niCnt.hiCtMax - niCnt.hiCtCur ) );
+    }
 
-    if( elapsedCt < nextCt )
-        return (nextCt - elapsedCt) / aiQ->sRate();
+    return secsUntil(
+            imCnt.nextCt[0]
+            + qMin( quint64(imCnt.maxFetch),
+                    imCnt.hiCtMax - imCnt.hiCtCur[0] ) );
+}
 
-    SETSTATE_H;
 
-    return 0;
+void TrigTimed::sleepFor( double secs )
+{
+    int ms = qBound( MIN_SLEEP_MS, int(1000 * secs), MAX_SLEEP_MS );
+
+    usleep( 1000 * ms );
 }
 
 
-// Next file @ X12 boundary
+// First file @ X12 boundary
 //
-// One-time concurrent setting of tracking data.
-// mapTime2Ct may return false if the sought time mark
-// isn't in the stream. The most likely failure mode is
-// that the target time is newer than any sample tag,
-// which is fixed by retrying on another loop iteration.
+// One-time setting of tracking data, sample-exact:
+// start = count(gHiT) + tL0 in each stream. The gate
+// time is in the past, so mapTime2Ct fails only if no
+// sample tag is yet newer; retry on another iteration.
 //
 bool TrigTimed::alignFirstFiles( double gHiT )
 {
 // MS: Assuming sample counts and mapping for imQ[0] serve for all
-    if( (nImQ && !imCnt.nextCt.size()) || (niQ && !niCnt.nextCt) ) {
+    quint64 imNext = 0,
+            niNext = 0;
 
-        double  startT = gHiT + p.trgTim.tL0;
-        quint64 imNext, niNext;
+    if( niQ ) {
 
-        if( niQ && !niQ->mapTime2Ct( niNext, startT ) )
+        if( !niQ->mapTime2Ct( niNext, gHiT ) )
             return false;
 
-        if( nImQ ) {
+        niNext += niCnt.l0Ct;
+    }
 
-            if( !imQ[0]->mapTime2Ct( imNext, startT ) )
-                return false;
+    if( nImQ ) {
 
-            alignX12( imNext, niNext );
-            imCnt.nextCt.fill( imNext, nImQ );
-        }
+        if( !imQ[0]->mapTime2Ct( imNext, gHiT ) )
+            return false;
 
-        niCnt.nextCt = niNext;
+        imNext += imCnt.l0Ct;
+
+        alignX12( imNext, niNext, false );
+        imCnt.nextCt.fill( imNext, nImQ );
     }
 
+    niCnt.nextCt = niNext;
+
     return true;
 }
 
@@ -439,6 +353,38 @@ void TrigTimed::alignNextFiles()
 }
 
 
+// Return true if no errors.
+//
+bool TrigTimed::doSomeHIm( int ip )
+{
+    CountsIm                    &C = imCnt;
+    std::vector<AIQ::AIQBlock>  vB;
+    int                         nb;
+    uint                        remCt = C.hiCtMax - C.hiCtCur[ip];
+
+    nb = imQ[ip]->getNScansFromCt(
+            vB,
+            C.nextCt[ip],
+            (remCt <= C.maxFetch ? remCt : C.maxFetch) );
+
+    if( !nb )
+        return true;
+
+// ---------------
+// Update counting
+// ---------------
+
+    C.nextCt[ip]   = imQ[ip]->nextCt( vB );
+    C.hiCtCur[ip] += C.nextCt[ip] - vB[0].headCt;
+
+// -----
+// Write
+// -----
+
+    return writeAndInvalVB( DstImec, ip, vB );
+}
+
+
 // Return true if no errors.
 //
 bool TrigTimed::doSomeHNi()
@@ -476,41 +422,27 @@ bool TrigTimed::doSomeHNi()
 
 // Return true if no errors.
 //
-bool TrigTimed::xferAll( TrTimShared &shr )
+bool TrigTimed::xferAll()
 {
     int niOK;
 
-    shr.awake   = 0;
-    shr.asleep  = 0;
-    shr.errors  = 0;
+// Post imec tasks to pool
 
-// Wake all imec threads
-
-    shr.condWake.wakeAll();
+    poolPost();
 
 // Do nidq locally
 
     niOK = doSomeHNi();
 
-// Wait all threads started, and all done
-
-    shr.runMtx.lock();
-        while( shr.awake  < nThd
-            || shr.asleep < nThd ) {
+// Help with, then wait for, imec tasks
 
-            shr.runMtx.unlock();
-                msleep( LOOP_MS/8 );
-            shr.runMtx.lock();
-        }
-    shr.runMtx.unlock();
-
-    return niOK && !shr.errors;
+    return poolWait() && niOK;
 }
 
 
 // Return true if no errors.
 //
-bool TrigTimed::allDoSomeH( TrTimShared &shr, double gHiT )
+bool TrigTimed::allDoSomeH()
 {
 // -------------------
 // Open files together
@@ -528,18 +460,11 @@ bool TrigTimed::allDoSomeH( TrTimShared &shr, double gHiT )
             return false;
     }
 
-// ---------------------
-// Seek common sync time
-// ---------------------
-
-    if( !alignFirstFiles( gHiT ) )
-        return true;    // too early
-
 // ----------------------
 // Fetch from all streams
 // ----------------------
 
-    return xferAll( shr );
+    return xferAll();
 }
 
 
@@ -3,100 +3,19 @@
 
 #include "TrigBase.h"
 
-#include <QWaitCondition>
-
 /* ---------------------------------------------------------------- */
 /* Types ---------------------------------------------------------- */
 /* ---------------------------------------------------------------- */
 
-struct TrTimShared {
-    const DAQ::Params   &p;
-    QMutex              runMtx;
-    QWaitCondition      condWake;
-    int                 awake,
-                        asleep,
-                        errors;
-    bool                stop;
-
-    TrTimShared( const DAQ::Params &p )
-    :   p(p), awake(0), asleep(0), stop(false)  {}
-
-    bool wake( bool ok )
-    {
-        bool    run;
-        runMtx.lock();
-            errors += !ok;
-            ++asleep;
-            condWake.wait( &runMtx );
-            ++awake;
-            run = !stop;
-        runMtx.unlock();
-        return run;
-    }
-
-    void kill()
-    {
-        runMtx.lock();
-            stop = true;
-        runMtx.unlock();
-        condWake.wakeAll();
-    }
-};
-
-
-class TrTimWorker : public QObject
-{
-    Q_OBJECT
-
-private:
-    TrTimShared         &shr;
-    const QVector<AIQ*> &imQ;
-    QVector<int>        vID;
-
-public:
-    TrTimWorker(
-        TrTimShared         &shr,
-        const QVector<AIQ*> &imQ,
-        QVector<int>        &vID )
-    :   shr(shr), imQ(imQ), vID(vID)    {}
-    virtual ~TrTimWorker()              {}
-
-signals:
-    void finished();
-
-public slots:
-    void run();
-
-private:
-    bool doSomeHIm( int ip );
-};
-
-
-class TrTimThread
-{
-public:
-    QThread     *thread;
-    TrTimWorker *worker;
-
-public:
-    TrTimThread(
-        TrTimShared         &shr,
-        const QVector<AIQ*> &imQ,
-        QVector<int>        &vID );
-    virtual ~TrTimThread();
-};
-
-
 class TrigTimed : public TrigBase
 {
     Q_OBJECT
 
-    friend class TrTimWorker;
-
 private:
     struct Counts {
         const quint64   hiCtMax;
-        const qint64    loCt;
+        const qint64    l0Ct,
+                        loCt;
         const uint      maxFetch;
 
         Counts( const DAQ::Params &p, double srate )
@@ -104,6 +23,7 @@ private:
                 p.trgTim.isHInf ?
                 std::numeric_limits<qlonglong>::max()
                 : p.trgTim.tH * srate),
+            l0Ct(p.trgTim.tL0 * srate),
             loCt(p.trgTim.tL * srate),
             maxFetch(0.110 * srate)     {}
     };
@@ -142,8 +62,7 @@ private:
     CountsIm        imCnt;
     CountsNi        niCnt;
     const qint64    nCycMax;
-    int             nThd,
-                    nH,
+    int             nH,
                     state;
 
 public:
@@ -156,6 +75,8 @@ public:
     virtual void setGate( bool hi );
     virtual void resetGTCounters();
 
+    virtual bool poolTask( int ip );
+
 public slots:
     virtual void run();
 
@@ -163,16 +84,19 @@ private:
     void SETSTATE_Done();
     void initState();
 
-    double remainingL0( double loopT, double gHiT );
-    double remainingL( const AIQ *aiQ, quint64 nextCt );
+    double secsUntil( quint64 ct ) const;
+    double remainingL();
+    double remainingH() const;
+    void sleepFor( double secs );
 
     bool alignFirstFiles( double gHiT );
     void alignNextFiles();
 
+    bool doSomeHIm( int ip );
     bool doSomeHNi();
 
-    bool xferAll( TrTimShared &shr );
-    bool allDoSomeH( TrTimShared &shr, double gHiT );
+    bool xferAll();
+    bool allDoSomeH();
 };
 
 #endif  // TRIGTIMED_H